@@ -22,7 +22,7 @@ run_cpp() {
 }
 
 # runner
-for t in TestJson TestBminContainers TestConditionalEvaluator TestStringEvaluator \
+for t in TestJson TestJsonReader TestStartupProfiler TestBminContainers TestConditionalEvaluator TestStringEvaluator \
          TestSpecialEventRunner TestSpecialEventIntegration; do
   run_cpp "__test__/runner/${t}.cpp"
 done
@@ -32,6 +32,8 @@ for t in TestLoadItemTemplates TestLoadMapTemplates TestLoadAbilityTemplates \
          TestLoadCharacterTemplates TestLoadStatusEffectTemplates TestLoadSpecialEvents; do
   run_cpp "__test__/db/loaders/${t}.cpp"
 done
+run_cpp "__test__/db/TestContentPack.cpp"
+run_cpp "__test__/db/TestLazyMapTemplates.cpp"
 
 # model
 for t in TestCharacterEquip TestCharacterGive; do
@@ -53,6 +55,7 @@ elements	TestQuad
 elements	TestButtonGroup
 components	TestFloatingNotificationSection
 system	TestSystemFontScale
+system	TestSystemSpriteAtlas
 elements	TestTextBanner
 elements	TestOutsetRectangle
 components	TestBorderModalStandard
@@ -0,0 +1,152 @@
+#include "bmin/StringInterop.h"
+#include "db/ContentPack.h"
+#include "db/Database.h"
+#include "game/save/SaveBinary.h"
+#include "sdl2w/Logger.h"
+
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+
+namespace {
+
+std::string_view asView(const bmin::DynArray<uint8_t>& bytes) {
+  return std::string_view(reinterpret_cast<const char*>(bytes.data()), bytes.size());
+}
+
+bool rejects(std::string_view bytes, db::Database& database, const char* label) {
+  try {
+    db::decodeContentPack(bytes, database);
+  } catch (const std::runtime_error&) {
+    return true;
+  }
+  LOG(ERROR) << label << " should have been rejected" << LOG_ENDL;
+  return false;
+}
+
+// A pack with the header of packBytes around payload.
+std::string withPayload(std::string_view packBytes,
+                        const bmin::DynArray<uint8_t>& payload) {
+  game::SaveWriter file;
+  // magic and format version; then payload size and checksum
+  file.writeBytes(reinterpret_cast<const uint8_t*>(packBytes.data()), 4 + 2);
+  file.writeU32(static_cast<uint32_t>(payload.size()));
+  file.writeU32(game::saveChecksum(asView(payload)));
+  file.writeBytes(payload.data(), payload.size());
+  return std::string(asView(file.getBytes()));
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+  LOG(INFO) << "Starting TestContentPack" << LOG_ENDL;
+
+  try {
+    bool ok = true;
+    db::Database source;
+    source.loadFromJson(4);
+    const auto bytes = db::encodeContentPack(source);
+    LOG(INFO) << "Encoded content pack: " << bytes.size() << " bytes" << LOG_ENDL;
+
+    // Loading the files one at a time gives the same content as the concurrent load.
+    db::Database sequential;
+    sequential.loadFromJson(1);
+    if (asView(db::encodeContentPack(sequential)) != asView(bytes)) {
+      LOG(ERROR) << "Sequential load differs from the concurrent load" << LOG_ENDL;
+      ok = false;
+    }
+
+    // Round trip: decoding and encoding again must give the same bytes.
+    db::Database decoded;
+    db::decodeContentPack(asView(bytes), decoded);
+    const auto reencoded = db::encodeContentPack(decoded);
+    if (asView(reencoded) != asView(bytes)) {
+      LOG(ERROR) << "Re-encoded pack differs from the original" << LOG_ENDL;
+      ok = false;
+    }
+
+    auto& mapTemplates =
+        const_cast<bmin::Map<bmin::String, model::CarcerMapTemplate>&>(
+            source.getMapTemplates());
+    for (auto it = mapTemplates.begin(); it != mapTemplates.end(); ++it) {
+      const auto& expected = it->value;
+      const auto& actual = decoded.getMapTemplate(bmin::toStringView(expected.name));
+      bool same = actual.width == expected.width && actual.height == expected.height &&
+                  actual.tiles.size() == expected.tiles.size() &&
+                  actual.travelTriggers.size() == expected.travelTriggers.size();
+      for (size_t layer = 0; same && layer < expected.tiles.size(); layer++) {
+        same = actual.tiles[layer].size() == expected.tiles[layer].size();
+        for (size_t i = 0; same && i < expected.tiles[layer].size(); i++) {
+          same = actual.tiles[layer][i] == expected.tiles[layer][i];
+        }
+      }
+      if (!same) {
+        LOG(ERROR) << "Map " << expected.name << " differs after decoding" << LOG_ENDL;
+        ok = false;
+      }
+    }
+    if (decoded.getGameEvents().size() != source.getGameEvents().size()) {
+      LOG(ERROR) << "Event count differs after decoding" << LOG_ENDL;
+      ok = false;
+    }
+    decoded.validateCombatReferences();
+
+    // Damaged packs throw and leave the database as it was.
+    db::Database untouched;
+    const std::string_view view = asView(bytes);
+    ok = rejects(view.substr(0, view.size() - 1), untouched, "truncated") && ok;
+    ok = rejects(view.substr(0, 8), untouched, "header_only") && ok;
+    std::string corrupt(view);
+    corrupt[corrupt.size() / 2] = static_cast<char>(corrupt[corrupt.size() / 2] ^ 0x5a);
+    ok = rejects(corrupt, untouched, "corrupt") && ok;
+    std::string otherVersion(view);
+    otherVersion[4] = static_cast<char>(otherVersion[4] + 1);
+    ok = rejects(otherVersion, untouched, "other_version") && ok;
+    ok = rejects("{\"not\": \"a pack\"}", untouched, "json") && ok;
+    // Valid checksums around section ids that would truncate onto STATUS_EFFECTS
+    // (257) or overflow the seen-section mask (40).
+    for (const uint64_t unknownId :
+         {uint64_t{0}, uint64_t{9}, uint64_t{40}, uint64_t{257}}) {
+      game::SaveWriter payload;
+      payload.writeVarUint(0); // strings
+      payload.writeVarUint(1); // sections
+      payload.writeVarUint(unknownId);
+      payload.writeRawString(std::string_view("\0", 1)); // no templates
+      ok = rejects(withPayload(view, payload.getBytes()), untouched, "unknown_section") &&
+           ok;
+    }
+    if (untouched.getMapTemplates().size() != 0 || untouched.getGameEvents().size() != 0) {
+      LOG(ERROR) << "Rejected pack modified the database" << LOG_ENDL;
+      ok = false;
+    }
+
+    // Same bytes through the file path (mmap on native builds).
+    const auto packPath = std::filesystem::temp_directory_path() / "TestContentPack.pack";
+    {
+      std::ofstream out{packPath, std::ios::binary};
+      out.write(view.data(), static_cast<std::streamsize>(view.size()));
+    }
+    db::Database fromFile;
+    db::loadContentPackFile(packPath.string(), fromFile);
+    std::filesystem::remove(packPath);
+    if (asView(db::encodeContentPack(fromFile)) != view) {
+      LOG(ERROR) << "Pack loaded from file differs" << LOG_ENDL;
+      ok = false;
+    }
+
+    const auto warnings = db::findContentWarnings(source);
+    LOG(INFO) << "Content warnings: " << warnings.size() << LOG_ENDL;
+
+    if (!ok) {
+      return 1;
+    }
+  } catch (const std::exception& e) {
+    LOG(ERROR) << "Error in TestContentPack: " << e.what() << LOG_ENDL;
+    return 1;
+  }
+
+  LOG(INFO) << "TestContentPack passed" << LOG_ENDL;
+  return 0;
+}
@@ -0,0 +1,105 @@
+#include "db/ContentPack.h"
+#include "db/Database.h"
+#include "sdl2w/Logger.h"
+
+#include <stdexcept>
+#include <string_view>
+
+namespace {
+
+bool assertEqual(int actual, int expected, const char* label) {
+  if (actual != expected) {
+    LOG(ERROR) << label << " expected " << expected << " but got " << actual << LOG_ENDL;
+    return false;
+  }
+  return true;
+}
+
+bool sameTiles(const model::CarcerMapTemplate& a, const model::CarcerMapTemplate& b) {
+  if (a.tiles.size() != b.tiles.size() || a.characters.size() != b.characters.size() ||
+      a.travelTriggers.size() != b.travelTriggers.size()) {
+    return false;
+  }
+  for (size_t layer = 0; layer < a.tiles.size(); layer++) {
+    if (a.tiles[layer].size() != b.tiles[layer].size()) {
+      return false;
+    }
+    for (size_t i = 0; i < a.tiles[layer].size(); i++) {
+      if (a.tiles[layer][i] != b.tiles[layer][i]) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+int count(size_t value) { return static_cast<int>(value); }
+
+std::string_view asView(const bmin::DynArray<uint8_t>& bytes) {
+  return std::string_view(reinterpret_cast<const char*>(bytes.data()), bytes.size());
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+  LOG(INFO) << "Starting TestLazyMapTemplates" << LOG_ENDL;
+
+  try {
+    bool ok = true;
+    db::Database eager;
+    eager.loadFromJson(1);
+    const int mapCount = count(eager.getMapTemplates().size());
+
+    db::Database lazy;
+    lazy.setLazyMapLoading(true);
+    lazy.loadFromJson(1);
+    ok = assertEqual(count(lazy.getDecodedMapTemplateCount()), 0, "decoded.after_load") &&
+         ok;
+
+    // One lookup decodes one map, and it matches the eagerly loaded one.
+    const auto& expected = eager.getMapTemplate("alinea_outside1");
+    const auto& actual = lazy.getMapTemplate("alinea_outside1");
+    ok = assertEqual(actual.width, expected.width, "map.width") && ok;
+    ok = assertEqual(actual.height, expected.height, "map.height") && ok;
+    if (!sameTiles(actual, expected)) {
+      LOG(ERROR) << "Lazily decoded map differs from the eager one" << LOG_ENDL;
+      ok = false;
+    }
+    ok = assertEqual(count(lazy.getDecodedMapTemplateCount()), 1, "decoded.after_get") &&
+         ok;
+    ok = assertEqual(lazy.findMapTemplate("no_such_map") == nullptr ? 1 : 0,
+                     1,
+                     "find.unknown") &&
+         ok;
+
+    // Prefetch skips unknown and decoded names.
+    lazy.prefetchMapTemplates({"NewMapTest", "NewMapTest2", "alinea_outside1", "nope"});
+    lazy.waitForMapPrefetch();
+#ifndef __EMSCRIPTEN__
+    ok = assertEqual(count(lazy.getDecodedMapTemplateCount()),
+                     3,
+                     "decoded.after_prefetch") &&
+         ok;
+#endif
+
+    // Everything decoded: same content as the eager load, byte for byte.
+    const auto lazyPack = db::encodeContentPack(lazy);
+    const auto eagerPack = db::encodeContentPack(eager);
+    ok = assertEqual(count(lazy.getDecodedMapTemplateCount()), mapCount, "decoded.all") &&
+         ok;
+    if (asView(lazyPack) != asView(eagerPack)) {
+      LOG(ERROR) << "Lazy database differs from the eager one" << LOG_ENDL;
+      ok = false;
+    }
+
+    if (!ok) {
+      return 1;
+    }
+  } catch (const std::exception& e) {
+    LOG(ERROR) << "Error in TestLazyMapTemplates: " << e.what() << LOG_ENDL;
+    return 1;
+  }
+
+  LOG(INFO) << "TestLazyMapTemplates passed" << LOG_ENDL;
+  return 0;
+}
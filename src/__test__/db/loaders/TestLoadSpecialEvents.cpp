@@ -28,6 +28,17 @@ int main(int argc, char** argv) {
       return 1;
     }
 
+    bmin::Map<bmin::String, model::GameEvent> seEvents;
+    db::loadSpecialEvents("assets/db/special-events/events-alinea.se", seEvents);
+    LOG(INFO) << "Successfully loaded " << seEvents.size() << " .se special events"
+              << LOG_ENDL;
+    if (seEvents.size() != 2 ||
+        seEvents.find(bmin::String("Alinea_PreventLeaveIfNotPickedUpBag")) ==
+            seEvents.end()) {
+      LOG(ERROR) << "Expected the 2 events of events-alinea.se" << LOG_ENDL;
+      return 1;
+    }
+
     LOG(INFO) << "TestLoadSpecialEvents completed successfully" << LOG_ENDL;
     return 0;
   } catch (const std::exception& e) {
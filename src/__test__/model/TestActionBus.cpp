@@ -0,0 +1,176 @@
+#include "bmin/DynArray.h"
+#include "sdl2w/Logger.h"
+#include "state/AbstractAction.h"
+#include "state/ActionBus.h"
+#include "state/State.h"
+#include <thread>
+#include <typeinfo>
+#include <utility>
+
+namespace {
+
+bool assertTrue(bool cond, const char* label) {
+  if (!cond) {
+    LOG(ERROR) << label << " expected true" << LOG_ENDL;
+    return false;
+  }
+  return true;
+}
+
+bool assertEqual(int actual, int expected, const char* label) {
+  if (actual != expected) {
+    LOG(ERROR) << label << " expected " << expected << " but got " << actual << LOG_ENDL;
+    return false;
+  }
+  return true;
+}
+
+class PingAction : public state::AbstractAction {
+public:
+  int value = 0;
+  explicit PingAction(int _value) : value(_value) {}
+};
+
+class PongAction : public state::AbstractAction {};
+
+// Buckets match the exact dynamic type, like the previous typeid comparison.
+class LoudPingAction : public PingAction {
+public:
+  LoudPingAction() : PingAction(100) {}
+};
+
+template <int N> class NumberedAction : public state::AbstractAction {};
+
+template <int... N>
+void resolveNumberedActions(std::integer_sequence<int, N...>,
+                            bool reversed,
+                            state::ActionBus::ActionTypeId* outIds) {
+  const std::type_info* types[] = {&typeid(NumberedAction<N>)...};
+  constexpr int count = sizeof...(N);
+  for (int i = 0; i < count; i++) {
+    const int index = reversed ? count - 1 - i : i;
+    outIds[index] = state::ActionBus::getActionTypeId(*types[index]);
+  }
+}
+
+} // namespace
+
+int main() {
+  LOG(INFO) << "Starting TestActionBus" << LOG_ENDL;
+  auto ok = true;
+
+  state::State state;
+
+  ok = assertTrue(state::ActionBus::getActionTypeId<PingAction>() ==
+                      state::ActionBus::getActionTypeId<PingAction>(),
+                  "type id is stable") &&
+       ok;
+  ok = assertTrue(state::ActionBus::getActionTypeId<PingAction>() !=
+                      state::ActionBus::getActionTypeId<PongAction>(),
+                  "type ids are distinct") &&
+       ok;
+
+  {
+    // Classes first seen on several threads at once still get one id each.
+    constexpr int NUM_THREADS = 4;
+    constexpr int NUM_TYPES = 16;
+    state::ActionBus::ActionTypeId ids[NUM_THREADS][NUM_TYPES] = {};
+    bmin::DynArray<std::thread> threads;
+    for (int t = 0; t < NUM_THREADS; t++) {
+      threads.pushBack(std::thread([&ids, t]() {
+        resolveNumberedActions(
+            std::make_integer_sequence<int, NUM_TYPES>(), t % 2 == 1, ids[t]);
+      }));
+    }
+    for (auto& thread : threads) {
+      thread.join();
+    }
+    state::ActionBus::ActionTypeId mainIds[NUM_TYPES] = {};
+    resolveNumberedActions(std::make_integer_sequence<int, NUM_TYPES>(), false, mainIds);
+    auto sameIds = true;
+    auto distinctIds = true;
+    for (int i = 0; i < NUM_TYPES; i++) {
+      for (int t = 0; t < NUM_THREADS; t++) {
+        sameIds = sameIds && ids[t][i] == mainIds[i];
+      }
+      for (int j = 0; j < i; j++) {
+        distinctIds = distinctIds && mainIds[i] != mainIds[j];
+      }
+    }
+    ok = assertTrue(sameIds, "threads agree on type ids") && ok;
+    ok = assertTrue(distinctIds, "concurrently registered ids are distinct") && ok;
+  }
+
+  {
+    state::ActionBus bus;
+    int ownerA = 0;
+    int ownerB = 0;
+    int pingSum = 0;
+    int pongCount = 0;
+
+    bus.subscribe<PingAction>(&ownerA, [&](PingAction& action, state::State&) {
+      pingSum += action.value;
+    });
+    bus.subscribe<PingAction>(&ownerB, [&](PingAction& action, state::State&) {
+      pingSum += action.value * 10;
+    });
+    bus.subscribe<PongAction>(&ownerA, [&](PongAction&, state::State&) { pongCount++; });
+
+    PingAction ping(1);
+    bus.notify(ping, state);
+    ok = assertEqual(pingSum, 11, "both ping handlers called") && ok;
+    ok = assertEqual(pongCount, 0, "pong handler not called for ping") && ok;
+
+    LoudPingAction loudPing;
+    bus.notify(loudPing, state);
+    ok = assertEqual(pingSum, 11, "derived action does not match base bucket") && ok;
+
+    bus.unsubscribe(&ownerA);
+    bus.notify(ping, state);
+    PongAction pong;
+    bus.notify(pong, state);
+    ok = assertEqual(pingSum, 21, "unsubscribed owner skipped") && ok;
+    ok = assertEqual(pongCount, 0, "all of owner's handlers removed") && ok;
+    ok = assertEqual(static_cast<int>(bus.getNumHandlers(
+                         state::ActionBus::getActionTypeId<PingAction>())),
+                     1,
+                     "one live ping handler") &&
+         ok;
+  }
+
+  {
+    // Handlers may unsubscribe and subscribe while the bus is dispatching.
+    state::ActionBus bus;
+    int ownerA = 0;
+    int ownerB = 0;
+    int ownerC = 0;
+    int callsA = 0;
+    int callsB = 0;
+    int callsC = 0;
+
+    bus.subscribe<PingAction>(&ownerA, [&](PingAction&, state::State&) {
+      callsA++;
+      bus.unsubscribe(&ownerB);
+      bus.subscribe<PingAction>(&ownerC,
+                                [&](PingAction&, state::State&) { callsC++; });
+    });
+    bus.subscribe<PingAction>(&ownerB, [&](PingAction&, state::State&) { callsB++; });
+
+    PingAction ping(1);
+    bus.notify(ping, state);
+    ok = assertEqual(callsA, 1, "dispatching handler ran") && ok;
+    ok = assertEqual(callsB, 0, "handler unsubscribed mid-dispatch skipped") && ok;
+    ok = assertEqual(callsC, 0, "handler added mid-dispatch waits for next notify") && ok;
+
+    bus.unsubscribe(&ownerA);
+    bus.notify(ping, state);
+    ok = assertEqual(callsC, 1, "deferred handler receives next notify") && ok;
+  }
+
+  if (ok) {
+    LOG(INFO) << "TestActionBus PASSED" << LOG_ENDL;
+    return 0;
+  }
+  LOG(ERROR) << "TestActionBus FAILED" << LOG_ENDL;
+  return 1;
+}
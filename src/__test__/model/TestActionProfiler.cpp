@@ -0,0 +1,140 @@
+#include "bmin/StringInterop.h"
+#include "sdl2w/Logger.h"
+#include "state/AbstractAction.h"
+#include "state/ActionProfiler.h"
+#include "state/StateManager.h"
+#include <string_view>
+
+namespace {
+
+bool assertTrue(bool cond, const char* label) {
+  if (!cond) {
+    LOG(ERROR) << label << " expected true" << LOG_ENDL;
+    return false;
+  }
+  return true;
+}
+
+bool assertEqual(int actual, int expected, const char* label) {
+  if (actual != expected) {
+    LOG(ERROR) << label << " expected " << expected << " but got " << actual << LOG_ENDL;
+    return false;
+  }
+  return true;
+}
+
+bool contains(const bmin::String& haystack, std::string_view needle) {
+  return bmin::toStringView(haystack).find(needle) != std::string_view::npos;
+}
+
+class ProfiledAction : public state::AbstractAction {
+  void act() override {}
+};
+
+class OtherProfiledAction : public state::AbstractAction {
+  void act() override {}
+};
+
+} // namespace
+
+int main() {
+  LOG(INFO) << "Starting TestActionProfiler" << LOG_ENDL;
+  auto ok = true;
+
+  // Demangled names are cached per class
+  {
+    ProfiledAction a;
+    ProfiledAction b;
+    const auto id = state::ActionBus::getActionTypeId(typeid(a));
+    ok = assertTrue(id == state::ActionBus::getActionTypeId(typeid(b)),
+                    "type id is stable") &&
+         ok;
+    ok = assertTrue(id == state::ActionBus::getActionTypeId<ProfiledAction>(),
+                    "one registry for the bus and the profiler") &&
+         ok;
+    ok = assertTrue(id != state::ActionBus::getActionTypeId(typeid(OtherProfiledAction)),
+                    "type ids are distinct") &&
+         ok;
+    ok = assertTrue(&state::ActionBus::getActionTypeName(id) ==
+                        &state::ActionBus::getActionTypeName(id),
+                    "name is cached") &&
+         ok;
+    ok = assertTrue(contains(a.getName(), "ProfiledAction"), "getName is demangled") &&
+         ok;
+  }
+
+  // Disabled by default: nothing recorded
+  {
+    state::StateManager sm;
+    sm.enqueueAction(sm.getActionData(), new ProfiledAction(), 0);
+    sm.update(1);
+    ok = assertEqual(static_cast<int>(sm.getActionProfiler().getSortedEntries().size()),
+                     0,
+                     "disabled profiler records nothing") &&
+         ok;
+  }
+
+  // Per-class counts, notify fan-out and queue depths
+  {
+    state::StateManager sm;
+    auto& profiler = sm.getActionProfiler();
+    profiler.setEnabled(true);
+    int owner = 0;
+    int notified = 0;
+    sm.getActionBus().subscribe<OtherProfiledAction>(
+        &owner, [&](OtherProfiledAction&, state::State&) { notified++; });
+
+    for (int i = 0; i < 3; i++) {
+      sm.enqueueAction(sm.getActionData(), new ProfiledAction(), 0);
+    }
+    sm.enqueueAction(sm.getActionData(), new OtherProfiledAction(), 0);
+    sm.pllAction(sm.getActionData(), new OtherProfiledAction(), 0);
+    sm.update(1);
+
+    const auto entries = profiler.getSortedEntries();
+    ok = assertEqual(static_cast<int>(entries.size()), 2, "two classes profiled") && ok;
+    int profiledCount = 0;
+    int otherCount = 0;
+    int otherHandlers = 0;
+    for (const auto& entry : entries) {
+      const auto& name = state::ActionBus::getActionTypeName(entry.actionTypeId);
+      if (contains(name, "OtherProfiledAction")) {
+        otherCount = static_cast<int>(entry.executeCount);
+        otherHandlers = static_cast<int>(entry.handlersInvoked);
+      } else if (contains(name, "ProfiledAction")) {
+        profiledCount = static_cast<int>(entry.executeCount);
+      }
+    }
+    ok = assertEqual(profiledCount, 3, "sequential executions counted") && ok;
+    ok = assertEqual(otherCount, 2, "sequential + parallel executions counted") && ok;
+    ok = assertEqual(otherHandlers, 2, "notify fan-out counted") && ok;
+    ok = assertEqual(notified, 2, "handlers still run while profiling") && ok;
+
+    const auto& depths = profiler.getQueueDepthStats();
+    ok = assertEqual(static_cast<int>(depths.samples), 1, "one sample per update") && ok;
+    ok = assertEqual(static_cast<int>(depths.sequentialMax), 4, "sequential depth") && ok;
+    ok = assertEqual(static_cast<int>(depths.parallelMax), 1, "parallel depth") && ok;
+
+    const auto report = profiler.formatReport();
+    ok = assertTrue(contains(report, "ProfiledAction"), "report lists classes") && ok;
+    const auto trace = profiler.formatChromeTrace();
+    ok = assertTrue(contains(trace, "{\"traceEvents\":["), "trace header") && ok;
+    ok = assertTrue(contains(trace, "\"cat\":\"notify\""), "trace has notify spans") &&
+         ok;
+    ok = assertTrue(contains(trace, "\"name\":\"queues\""), "trace has queue counters") &&
+         ok;
+
+    profiler.reset();
+    ok = assertEqual(static_cast<int>(profiler.getSortedEntries().size()),
+                     0,
+                     "reset clears entries") &&
+         ok;
+  }
+
+  if (ok) {
+    LOG(INFO) << "TestActionProfiler PASSED" << LOG_ENDL;
+    return 0;
+  }
+  LOG(ERROR) << "TestActionProfiler FAILED" << LOG_ENDL;
+  return 1;
+}
@@ -0,0 +1,214 @@
+#include "db/Database.h"
+#include "game/map/MapPersistence.h"
+#include "game/save/SaveCompression.h"
+#include "game/save/SaveGame.h"
+#include "model/instances/CharacterPlayer.h"
+#include "model/templates/CharacterTemplate.h"
+#include "sdl2w/Logger.h"
+#include "state/AbstractAction.h"
+#include "state/Autosave.h"
+#include "state/DatabaseInterface.h"
+#include "state/StateManager.h"
+#include "state/actions/world/WorldAutosaveCompleted.hpp"
+#include "bmin/String.h"
+#include "bmin/StringInterop.h"
+#include <cstdio>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+
+namespace {
+
+bool assertEqual(int actual, int expected, const char* label) {
+  if (actual != expected) {
+    LOG(ERROR) << label << " expected " << expected << " but got " << actual << LOG_ENDL;
+    return false;
+  }
+  return true;
+}
+
+bool assertTrue(bool cond, const char* label) {
+  if (!cond) {
+    LOG(ERROR) << label << " expected true" << LOG_ENDL;
+    return false;
+  }
+  return true;
+}
+
+std::string_view asView(const bmin::DynArray<uint8_t>& bytes) {
+  return std::string_view(reinterpret_cast<const char*>(bytes.data()), bytes.size());
+}
+
+class IdleAction : public state::AbstractAction {
+  void act() override {}
+};
+
+void setupDatabase(db::Database& database) {
+  auto heroTemplate = model::CharacterTemplate{};
+  heroTemplate.type = model::CharacterTemplateType::TOWNSPERSON;
+  heroTemplate.name = "hero";
+  heroTemplate.combat.hp = 100;
+  database.addCharacterTemplate(heroTemplate);
+
+  auto mapTemplate = model::CarcerMapTemplate{};
+  mapTemplate.name = "autosave_test_map";
+  mapTemplate.width = 8;
+  mapTemplate.height = 8;
+  mapTemplate.tilesets.pushBack("test_terrain");
+  bmin::DynArray<int> flat;
+  for (int i = 0; i < 8 * 8; i++) {
+    flat.pushBack(0);
+    flat.pushBack(3);
+  }
+  mapTemplate.tiles.pushBack(std::move(flat));
+  database.addMapTemplate(mapTemplate);
+}
+
+void populateState(state::State& state, const db::Database& database) {
+  game::createMapInstances(state, database);
+  auto member = model::CharacterPlayer(database.getCharacterTemplate("hero"));
+  member.instanceId = "hero-1";
+  member.name = "Hero";
+  member.templateName = "hero";
+  member.currentHp = 77;
+  state.player.party.pushBack(std::move(member));
+  state.player.gold = 4321;
+  model::eventStorageSet(state.specialEventStorage, "vars.autosaved", "true");
+  state.world.activeMap.gridId = "autosave_test_map";
+}
+
+} // namespace
+
+int main(int /*argc*/, char** /*argv*/) {
+  LOG(INFO) << "Starting TestAutosave" << LOG_ENDL;
+  bool ok = true;
+
+  // Compression round trips and rejects damaged input
+  {
+    std::string raw;
+    for (int i = 0; i < 4000; i++) {
+      raw += "tile ";
+      raw += static_cast<char>('a' + (i * 7919) % 23);
+    }
+    const auto packed = game::compressSaveData(raw);
+    ok = assertTrue(game::isCompressedSaveData(asView(packed)), "compressed magic") && ok;
+    ok = assertTrue(packed.size() < raw.size() / 2, "repetitive input shrinks") && ok;
+    const auto unpacked = game::decompressSaveData(asView(packed));
+    ok = assertTrue(asView(unpacked) == raw, "decompressed matches") && ok;
+
+    const auto emptyPacked = game::compressSaveData("");
+    const auto emptyUnpacked = game::decompressSaveData(asView(emptyPacked));
+    ok = assertEqual(static_cast<int>(emptyUnpacked.size()), 0, "empty round trip") && ok;
+
+    bool threw = false;
+    try {
+      game::decompressSaveData(asView(packed).substr(0, packed.size() - 3));
+    } catch (const std::runtime_error&) {
+      threw = true;
+    }
+    ok = assertTrue(threw, "truncated compressed rejected") && ok;
+
+    // A tiny stream claiming a 4 GiB payload is rejected before anything is reserved.
+    const std::string_view oversized("CSAZ\xff\xff\xff\xff\x00", 9);
+    threw = false;
+    try {
+      game::decompressSaveData(oversized);
+    } catch (const std::runtime_error&) {
+      threw = true;
+    }
+    ok = assertTrue(threw, "oversized compressed rejected") && ok;
+  }
+
+  db::Database database;
+  setupDatabase(database);
+  state::DatabaseInterface::setDatabase(&database);
+  const std::string path = "TestAutosave.sav";
+  std::remove(path.c_str());
+
+  {
+    state::StateManager sm;
+    populateState(sm.getState(), database);
+    auto& autosave = sm.getAutosave();
+    int owner = 0;
+    int notified = 0;
+    state::AutosaveResult lastResult;
+    sm.getActionBus().subscribe<state::actions::WorldAutosaveCompleted>(
+        &owner, [&](state::actions::WorldAutosaveCompleted& action, state::State&) {
+          notified++;
+          lastResult = action.getResult();
+        });
+
+    // Off by default
+    sm.update(state::Autosave::DEFAULT_INTERVAL_MS + 1);
+    autosave.wait();
+    ok = assertTrue(!autosave.isEnabled(), "disabled by default") && ok;
+    ok = assertTrue(!autosave.isBusy(), "nothing started while disabled") && ok;
+
+    // Safe points
+    ok = assertTrue(state::Autosave::isSafePoint(sm), "idle is a safe point") && ok;
+    sm.enqueueAction(sm.getActionData(), new IdleAction(), 0);
+    ok = assertTrue(!state::Autosave::isSafePoint(sm), "queued action is not") && ok;
+    sm.update(1);
+    sm.getState().world.combat.active = true;
+    ok = assertTrue(!state::Autosave::isSafePoint(sm), "combat is not") && ok;
+
+    // Due during combat: deferred until the fight ends
+    autosave.setPath(bmin::String(path.data(), path.size()));
+    autosave.setIntervalMs(1000);
+    autosave.setEnabled(true);
+    sm.update(1500);
+    ok = assertTrue(!autosave.isBusy(), "deferred in combat") && ok;
+    sm.getState().world.combat.active = false;
+    sm.update(1);
+    autosave.wait();
+    ok = assertEqual(notified, 0, "reported through the bus, not inline") && ok;
+    // Queues the completion action, then runs it.
+    sm.update(1);
+    sm.update(1);
+    ok = assertEqual(notified, 1, "completion delivered once") && ok;
+    ok = assertTrue(lastResult.success, "autosave succeeded") && ok;
+    ok = assertTrue(lastResult.fileBytes > 0 && lastResult.rawBytes > 0, "sizes") && ok;
+    LOG(INFO) << "Autosave capture " << lastResult.captureMs << "ms, write "
+              << lastResult.writeMs << "ms, " << static_cast<int>(lastResult.rawBytes)
+              << " -> " << static_cast<int>(lastResult.fileBytes) << " bytes"
+              << LOG_ENDL;
+
+    // The file holds the state as of the snapshot, not later changes
+    sm.getState().player.gold = 1;
+    state::State restored;
+    ok = assertTrue(game::loadGameFromFile(path, restored, database), "load autosave") &&
+         ok;
+    ok = assertEqual(restored.player.gold, 4321, "gold restored") && ok;
+    ok = assertEqual(static_cast<int>(restored.player.party.size()), 1, "party") && ok;
+    ok = assertTrue(
+             model::eventStorageContains(restored.specialEventStorage, "vars.autosaved"),
+             "vars") &&
+         ok;
+
+    // request() saves at the next safe point without waiting out the interval
+    autosave.request();
+    sm.update(1);
+    autosave.wait();
+    sm.update(1);
+    sm.update(1);
+    ok = assertEqual(notified, 2, "requested save delivered") && ok;
+    ok = assertTrue(lastResult.generation == 2, "generation increments") && ok;
+    ok = assertTrue(game::loadGameFromFile(path, restored, database), "reload") && ok;
+    ok = assertEqual(restored.player.gold, 1, "replaced atomically") && ok;
+
+    // Snapshot encoding matches the direct encoder
+    const auto direct = game::encodeSaveGame(sm.getState(), database);
+    const auto viaSnapshot =
+        game::encodeSaveSnapshot(game::captureSaveSnapshot(sm.getState(), database));
+    ok = assertTrue(asView(direct) == asView(viaSnapshot), "snapshot encode identical") &&
+         ok;
+  }
+  std::remove(path.c_str());
+
+  if (ok) {
+    LOG(INFO) << "TestAutosave PASSED" << LOG_ENDL;
+    return 0;
+  }
+  LOG(ERROR) << "TestAutosave FAILED" << LOG_ENDL;
+  return 1;
+}
@@ -0,0 +1,135 @@
+#include "db/Database.h"
+#include "game/sim/CombatBalanceSimulator.h"
+#include "model/templates/CharacterTemplate.h"
+#include "sdl2w/Logger.h"
+#include "state/StateManager.h"
+#include <stdexcept>
+#include "bmin/String.h"
+
+namespace {
+
+bool assertEqual(int actual, int expected, const char* label) {
+  if (actual != expected) {
+    LOG(ERROR) << label << " expected " << expected << " but got " << actual << LOG_ENDL;
+    return false;
+  }
+  return true;
+}
+
+bool assertTrue(bool cond, const char* label) {
+  if (!cond) {
+    LOG(ERROR) << label << " expected true" << LOG_ENDL;
+    return false;
+  }
+  return true;
+}
+
+void addTestTemplates(db::Database& database) {
+  auto allyTemplate = model::CharacterTemplate{};
+  allyTemplate.type = model::CharacterTemplateType::TOWNSPERSON;
+  allyTemplate.name = "hero";
+  allyTemplate.combat.hp = 100;
+  database.addCharacterTemplate(allyTemplate);
+
+  auto enemyTemplate = model::CharacterTemplate{};
+  enemyTemplate.type = model::CharacterTemplateType::ENEMY;
+  enemyTemplate.name = "slime";
+  enemyTemplate.combat.hp = 20;
+  database.addCharacterTemplate(enemyTemplate);
+}
+
+bool sameDistribution(const game::CombatDistribution& a,
+                      const game::CombatDistribution& b) {
+  return a.mean == b.mean && a.min == b.min && a.p10 == b.p10 && a.p50 == b.p50 &&
+         a.p90 == b.p90 && a.max == b.max;
+}
+
+} // namespace
+
+int main(int /*argc*/, char** /*argv*/) {
+  LOG(INFO) << "Starting TestCombatBalance" << LOG_ENDL;
+  bool ok = true;
+
+  db::Database database;
+  addTestTemplates(database);
+  game::CombatBalanceSimulator simulator(database);
+
+  game::CombatBalanceParams params;
+  params.partyTemplateNames.pushBack("hero");
+  params.enemyTemplateNames.pushBack("slime");
+  params.enemyTemplateNames.pushBack("slime");
+  params.trials = 400;
+  params.seed = 7;
+
+  // Same trial index, same outcome
+  {
+    const auto a = simulator.runTrial(params, 3);
+    const auto b = simulator.runTrial(params, 3);
+    ok = assertEqual(a.rounds, b.rounds, "replayed rounds") && ok;
+    ok = assertEqual(a.partyDamageDealt, b.partyDamageDealt, "replayed damage") && ok;
+    ok = assertTrue(a.partyWon == b.partyWon, "replayed winner") && ok;
+  }
+
+  // A trial on the caller's thread leaves the StateManager's streams active, also
+  // when it throws
+  {
+    state::StateManager stateManager;
+    auto* stateRng = &stateManager.getState().rng;
+    simulator.runTrial(params, 0);
+    ok = assertTrue(model::isActiveRandomStreams(stateRng), "streams restored") && ok;
+
+    auto badParams = params;
+    badParams.partyTemplateNames.pushBack("missing");
+    bool threw = false;
+    try {
+      simulator.runTrial(badParams, 0);
+    } catch (const std::runtime_error&) {
+      threw = true;
+    }
+    ok = assertTrue(threw, "unknown template throws") && ok;
+    ok = assertTrue(model::isActiveRandomStreams(stateRng),
+                    "streams restored after a throw") &&
+         ok;
+  }
+
+  // Report does not depend on the number of worker threads
+  {
+    params.numThreads = 1;
+    const auto single = simulator.run(params);
+    params.numThreads = 4;
+    const auto multi = simulator.run(params);
+    LOG(INFO) << game::CombatBalanceSimulator::formatReport(multi) << LOG_ENDL;
+
+    ok = assertEqual(single.trials, 400, "trials") && ok;
+    ok = assertEqual(single.partyWins + single.enemyWins + single.draws,
+                     single.trials,
+                     "outcomes add up") &&
+         ok;
+    ok = assertEqual(multi.partyWins, single.partyWins, "party wins match") && ok;
+    ok = assertEqual(multi.draws, single.draws, "draws match") && ok;
+    ok = assertTrue(multi.partyHitRate == single.partyHitRate, "hit rate match") && ok;
+    ok = assertTrue(sameDistribution(multi.rounds, single.rounds), "rounds match") &&
+         ok;
+    ok = assertTrue(
+             sameDistribution(multi.enemyDamageDealt, single.enemyDamageDealt),
+             "enemy damage match") &&
+         ok;
+
+    // 100hp hero against two 20hp slimes should almost always win.
+    ok = assertTrue(single.getPartyWinRate() > 0.9, "party favoured") && ok;
+    ok = assertTrue(single.partyHitRate > 0. && single.partyHitRate < 1.,
+                    "hit rate in range") &&
+         ok;
+    ok = assertTrue(single.rounds.min <= single.rounds.p50 &&
+                        single.rounds.p50 <= single.rounds.max,
+                    "rounds ordered") &&
+         ok;
+  }
+
+  if (ok) {
+    LOG(INFO) << "TestCombatBalance PASSED" << LOG_ENDL;
+    return 0;
+  }
+  LOG(ERROR) << "TestCombatBalance FAILED" << LOG_ENDL;
+  return 1;
+}
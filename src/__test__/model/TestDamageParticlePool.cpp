@@ -0,0 +1,85 @@
+#include "model/instances/World.h"
+#include "sdl2w/Logger.h"
+
+namespace {
+
+bool assertTrue(bool cond, const char* label) {
+  if (!cond) {
+    LOG(ERROR) << label << " expected true" << LOG_ENDL;
+    return false;
+  }
+  return true;
+}
+
+bool assertEqual(int actual, int expected, const char* label) {
+  if (actual != expected) {
+    LOG(ERROR) << label << " expected " << expected << " but got " << actual << LOG_ENDL;
+    return false;
+  }
+  return true;
+}
+
+model::DamageParticle makeParticle(int value, int lifetimeMs) {
+  auto particle = model::DamageParticle{};
+  particle.animationName = "splash_attack";
+  particle.value = value;
+  model::timerStructStart(particle.lifetime, lifetimeMs);
+  return particle;
+}
+
+} // namespace
+
+int main() {
+  LOG(INFO) << "Starting TestDamageParticlePool" << LOG_ENDL;
+  auto ok = true;
+
+  {
+    auto activeMap = model::ActiveMap{};
+    const auto& first = model::spawnDamageParticle(activeMap, makeParticle(1, 500));
+    const auto firstId = static_cast<int>(first.id);
+    const auto& second = model::spawnDamageParticle(activeMap, makeParticle(2, 500));
+    ok = assertTrue(firstId != 0, "spawn assigns an id") && ok;
+    ok = assertTrue(static_cast<int>(second.id) != firstId, "ids are unique") && ok;
+
+    model::spawnDamageParticle(activeMap, makeParticle(3, 500));
+    model::removeDamageParticleAt(activeMap, 0);
+    ok = assertEqual(static_cast<int>(activeMap.damageParticles.size()), 2,
+                     "remove shrinks pool") &&
+         ok;
+    ok = assertEqual(activeMap.damageParticles[0].value, 3, "last particle swapped in") &&
+         ok;
+    ok = assertEqual(activeMap.damageParticles[1].value, 2, "other particle untouched") &&
+         ok;
+
+    model::removeDamageParticleAt(activeMap, 5);
+    ok = assertEqual(static_cast<int>(activeMap.damageParticles.size()), 2,
+                     "out of range remove ignored") &&
+         ok;
+  }
+
+  {
+    auto activeMap = model::ActiveMap{};
+    const auto capacity = static_cast<int>(model::DAMAGE_PARTICLE_CAPACITY);
+    for (auto i = 0; i < capacity; i++) {
+      model::spawnDamageParticle(activeMap, makeParticle(i + 1, 500));
+    }
+    // Particle at index 7 is furthest through its lifetime.
+    model::timerStructUpdate(activeMap.damageParticles[7].lifetime, 400);
+    model::timerStructUpdate(activeMap.damageParticles[3].lifetime, 100);
+
+    model::spawnDamageParticle(activeMap, makeParticle(999, 500));
+    ok = assertEqual(static_cast<int>(activeMap.damageParticles.size()), capacity,
+                     "full pool does not grow") &&
+         ok;
+    ok = assertEqual(activeMap.damageParticles[7].value, 999, "oldest particle recycled") &&
+         ok;
+    ok = assertEqual(activeMap.damageParticles[3].value, 4, "younger particle kept") && ok;
+  }
+
+  if (ok) {
+    LOG(INFO) << "TestDamageParticlePool PASSED" << LOG_ENDL;
+    return 0;
+  }
+  LOG(ERROR) << "TestDamageParticlePool FAILED" << LOG_ENDL;
+  return 1;
+}
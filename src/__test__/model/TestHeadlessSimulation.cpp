@@ -0,0 +1,87 @@
+#include "db/Database.h"
+#include "game/sim/HeadlessSimulation.h"
+#include "sdl2w/Logger.h"
+#include "state/DatabaseInterface.h"
+#include "state/StateManager.h"
+#include "state/StateManagerInterface.h"
+#include "bmin/String.h"
+
+// Soak run of the real database with scripted party inputs: no window, no layers.
+
+namespace {
+
+bool assertEqual(int actual, int expected, const char* label) {
+  if (actual != expected) {
+    LOG(ERROR) << label << " expected " << expected << " but got " << actual << LOG_ENDL;
+    return false;
+  }
+  return true;
+}
+
+bool assertTrue(bool cond, const char* label) {
+  if (!cond) {
+    LOG(ERROR) << label << " expected true" << LOG_ENDL;
+    return false;
+  }
+  return true;
+}
+
+} // namespace
+
+int main(int /*argc*/, char** /*argv*/) {
+  LOG(INFO) << "Starting TestHeadlessSimulation" << LOG_ENDL;
+  bool ok = true;
+
+  {
+    const auto inputs = game::HeadlessSimulation::parseScript("n, e s\tw wait nw bogus");
+    ok = assertEqual(static_cast<int>(inputs.size()), 6, "parseScript token count") && ok;
+    if (inputs.size() == 6) {
+      ok = assertTrue(inputs[1].type == game::SimulationInputType::MOVE &&
+                          inputs[1].dx == 1 && inputs[1].dy == 0,
+                      "parseScript e") &&
+           ok;
+      ok = assertTrue(inputs[4].type == game::SimulationInputType::WAIT,
+                      "parseScript wait") &&
+           ok;
+    }
+  }
+
+  try {
+    db::Database database;
+    state::DatabaseInterface::setDatabase(&database);
+    database.load();
+
+    state::StateManager stateManager;
+    state::StateManagerInterface::setStateManager(&stateManager);
+    bmin::DynArray<bmin::String> party;
+    party.pushBack("testPartyMember1");
+    party.pushBack("testPartyMember2");
+    ok = assertTrue(game::HeadlessSimulation::setupWorld(
+                        stateManager, database, "alinea_outsideAlinea1", party),
+                    "setupWorld") &&
+         ok;
+
+    game::HeadlessSimulationParams params;
+    params.script = game::HeadlessSimulation::parseScript(
+        "e e e s s wait w w w n n wait e s e n w wait");
+    params.maxPlayerInputs = 2000;
+    game::HeadlessSimulation simulation(stateManager, params);
+    const auto& stats = simulation.run();
+    simulation.logStats();
+
+    ok = assertTrue(!stats.stalled, "simulation did not stall") && ok;
+    ok = assertEqual(static_cast<int>(stats.playerInputs), 2000, "all inputs issued") &&
+         ok;
+    ok = assertTrue(stats.simulatedMs > 0, "simulated time advanced") && ok;
+  } catch (const std::exception& e) {
+    LOG(ERROR) << "TestHeadlessSimulation exception: " << e.what() << LOG_ENDL;
+    ok = false;
+  }
+
+  if (ok) {
+    LOG(INFO) << "TestHeadlessSimulation PASSED" << LOG_ENDL;
+    return 0;
+  }
+  LOG(ERROR) << "TestHeadlessSimulation FAILED" << LOG_ENDL;
+  return 1;
+}
@@ -176,6 +176,29 @@ int main() {
       "defeated record stored on MapInstance") &&
        ok;
 
+  // Lazy map loading: no instances up front, the grid's are created when it loads.
+  db::Database lazyDatabase;
+  lazyDatabase.setLazyMapLoading(true);
+  addTestTileset(lazyDatabase);
+  addEnemyTemplate(lazyDatabase);
+  lazyDatabase.addMapTemplate(mapTemplate);
+  auto otherMap = makeMapTemplate();
+  otherMap.name = "other_map";
+  lazyDatabase.addMapTemplate(otherMap);
+  lazyDatabase.addMapGridTemplate(grid);
+  state::DatabaseInterface::setDatabase(&lazyDatabase);
+
+  game::createMapInstances(state, lazyDatabase);
+  const auto& instances = state.mapInstances;
+  ok = assertEqual(static_cast<int>(instances.size()), 0, "lazy: no instances") && ok;
+  state::actions::WorldLoadActiveMap("test_grid").execute(&state);
+  ok = assertTrue(instances.contains("test_map"), "lazy: grid map created") && ok;
+  ok = assertTrue(!instances.contains("other_map"), "lazy: other map skipped") && ok;
+  ok = assertTrue(findEnemyOnActive(state.world.activeMap) != nullptr,
+                  "lazy: enemy hoisted from template") &&
+       ok;
+  state::DatabaseInterface::setDatabase(&database);
+
   if (ok) {
     LOG(INFO) << "TestMapPersistence PASSED" << LOG_ENDL;
     return 0;
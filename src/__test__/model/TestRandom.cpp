@@ -0,0 +1,134 @@
+#include "game/map/TileFields.h"
+#include "model/Random.h"
+#include "model/instances/MapInstance.h"
+#include "model/templates/UtilityTypes.h"
+#include "sdl2w/Logger.h"
+#include "bmin/StringInterop.h"
+
+namespace {
+
+bool assertEqual(int actual, int expected, const char* label) {
+  if (actual != expected) {
+    LOG(ERROR) << label << " expected " << expected << " but got " << actual << LOG_ENDL;
+    return false;
+  }
+  return true;
+}
+
+bool assertTrue(bool cond, const char* label) {
+  if (!cond) {
+    LOG(ERROR) << label << " expected true" << LOG_ENDL;
+    return false;
+  }
+  return true;
+}
+
+} // namespace
+
+int main(int /*argc*/, char** /*argv*/) {
+  LOG(INFO) << "Starting TestRandom" << LOG_ENDL;
+  bool ok = true;
+
+  // Same seed, same sequence; streams are independent of each other
+  {
+    model::RandomStreams a(42);
+    model::RandomStreams b(42);
+    bool same = true;
+    for (int i = 0; i < 100; i++) {
+      same = same && model::randomNext(a.combat) == model::randomNext(b.combat);
+    }
+    ok = assertTrue(same, "same seed replays") && ok;
+
+    model::RandomStreams c(42);
+    for (int i = 0; i < 50; i++) {
+      model::randomNext(c.ids);
+    }
+    model::RandomStreams d(42);
+    ok = assertTrue(model::randomNext(c.combat) == model::randomNext(d.combat),
+                    "drawing ids does not shift combat") &&
+         ok;
+
+    model::RandomStreams e(43);
+    model::RandomStreams f(42);
+    ok = assertTrue(model::randomNext(e.combat) != model::randomNext(f.combat),
+                    "different seeds differ") &&
+         ok;
+  }
+
+  // Bounds and rough uniformity
+  {
+    model::RandomStreams streams(7);
+    int buckets[4] = {0, 0, 0, 0};
+    bool inRange = true;
+    for (int i = 0; i < 4000; i++) {
+      const int value = model::randomInt(streams.loot, 4);
+      inRange = inRange && value >= 0 && value < 4;
+      if (value >= 0 && value < 4) {
+        buckets[value]++;
+      }
+      const int ranged = model::randomRange(streams.loot, -3, 3);
+      inRange = inRange && ranged >= -3 && ranged <= 3;
+    }
+    ok = assertTrue(inRange, "randomInt/randomRange stay in range") && ok;
+    for (int count : buckets) {
+      ok = assertTrue(count > 850 && count < 1150, "randomInt roughly uniform") && ok;
+    }
+    ok = assertEqual(model::randomInt(streams.loot, 0), 0, "randomInt(0)") && ok;
+    ok = assertTrue(!model::randomChancePercent(streams.combat, 0), "0% never hits") &&
+         ok;
+    ok = assertTrue(model::randomChancePercent(streams.combat, 100), "100% hits") && ok;
+  }
+
+  // Serialization round-trip resumes the exact sequence
+  {
+    model::RandomStreams streams(99);
+    model::randomNext(streams.combat);
+    model::randomNext(streams.effects);
+    const auto text = model::randomStreamsSerialize(streams);
+
+    model::RandomStreams restored(1);
+    ok = assertTrue(model::randomStreamsDeserialize(bmin::toStringView(text), restored),
+                    "deserialize succeeds") &&
+         ok;
+    ok = assertTrue(restored.seed == 99, "seed restored") && ok;
+    ok = assertTrue(model::randomNext(restored.combat) ==
+                        model::randomNext(streams.combat),
+                    "combat stream resumes") &&
+         ok;
+    ok = assertTrue(model::randomNext(restored.effects) ==
+                        model::randomNext(streams.effects),
+                    "effects stream resumes") &&
+         ok;
+    model::RandomStreams untouched(5);
+    ok = assertTrue(!model::randomStreamsDeserialize("zz", untouched), "rejects junk") &&
+         ok;
+    ok = assertTrue(untouched.seed == 5, "failed parse leaves streams alone") && ok;
+  }
+
+  // createRandomId and addTileField draw from the active streams
+  {
+    model::RandomStreams first(1234);
+    model::setActiveRandomStreams(&first);
+    const auto idA = model::createRandomId();
+    auto tileA = model::TileInstance{};
+    game::addTileField(tileA, game::TileFieldType::BLOOD);
+
+    model::RandomStreams second(1234);
+    model::setActiveRandomStreams(&second);
+    const auto idB = model::createRandomId();
+    auto tileB = model::TileInstance{};
+    game::addTileField(tileB, game::TileFieldType::BLOOD);
+    model::setActiveRandomStreams(nullptr);
+
+    ok = assertTrue(idA == idB, "createRandomId replays with the seed") && ok;
+    ok = assertEqual(tileA.fields[0].variant, tileB.fields[0].variant, "blood variant") &&
+         ok;
+  }
+
+  if (ok) {
+    LOG(INFO) << "TestRandom PASSED" << LOG_ENDL;
+    return 0;
+  }
+  LOG(ERROR) << "TestRandom FAILED" << LOG_ENDL;
+  return 1;
+}
@@ -0,0 +1,361 @@
+#include "db/Database.h"
+#include "game/map/MapPersistence.h"
+#include "game/save/SaveBinary.h"
+#include "game/save/SaveGame.h"
+#include "model/instances/CharacterPlayer.h"
+#include "model/instances/MapInstance.h"
+#include "model/templates/CharacterTemplate.h"
+#include "sdl2w/Logger.h"
+#include "state/State.h"
+#include "bmin/String.h"
+#include <chrono>
+#include <stdexcept>
+#include <string_view>
+
+namespace {
+
+bool assertEqual(int actual, int expected, const char* label) {
+  if (actual != expected) {
+    LOG(ERROR) << label << " expected " << expected << " but got " << actual << LOG_ENDL;
+    return false;
+  }
+  return true;
+}
+
+bool assertTrue(bool cond, const char* label) {
+  if (!cond) {
+    LOG(ERROR) << label << " expected true" << LOG_ENDL;
+    return false;
+  }
+  return true;
+}
+
+std::string_view asView(const bmin::DynArray<uint8_t>& bytes) {
+  return std::string_view(reinterpret_cast<const char*>(bytes.data()), bytes.size());
+}
+
+bool decodeThrows(const bmin::DynArray<uint8_t>& bytes,
+                  state::State& state,
+                  const db::Database& database) {
+  try {
+    game::decodeSaveGame(asView(bytes), state, database);
+  } catch (const std::runtime_error&) {
+    return true;
+  }
+  return false;
+}
+
+// bytes (an uncompressed save) with one more section, holding a body no known section
+// could parse, in front of the others; the header is rewritten to match.
+bmin::DynArray<uint8_t> withExtraSection(const bmin::DynArray<uint8_t>& bytes,
+                                         uint64_t sectionId) {
+  // magic, format version, payload size, checksum
+  constexpr size_t headerSize = 4 + 2 + 4 + 4;
+  const auto payload = asView(bytes).substr(headerSize);
+  game::SaveReader reader(payload);
+  const int stringCount = reader.readCount();
+  for (int i = 0; i < stringCount; i++) {
+    reader.readRawString();
+  }
+  const size_t stringTableSize = reader.getPos();
+  const int sectionCount = reader.readCount();
+
+  game::SaveWriter extended;
+  extended.writeBytes(bytes.data() + headerSize, stringTableSize);
+  extended.writeVarUint(static_cast<uint64_t>(sectionCount) + 1);
+  extended.writeVarUint(sectionId);
+  extended.writeVarUint(1);
+  extended.writeRawString("\xff\xff\xff");
+  extended.writeBytes(bytes.data() + headerSize + reader.getPos(), reader.remaining());
+
+  const auto& extendedBytes = extended.getBytes();
+  game::SaveWriter file;
+  file.writeBytes(bytes.data(), 4 + 2);
+  file.writeU32(static_cast<uint32_t>(extendedBytes.size()));
+  file.writeU32(game::saveChecksum(asView(extendedBytes)));
+  file.writeBytes(extendedBytes.data(), extendedBytes.size());
+  return file.getBytes();
+}
+
+void setupDatabase(db::Database& database) {
+  auto heroTemplate = model::CharacterTemplate{};
+  heroTemplate.type = model::CharacterTemplateType::TOWNSPERSON;
+  heroTemplate.name = "hero";
+  heroTemplate.combat.hp = 100;
+  database.addCharacterTemplate(heroTemplate);
+
+  auto slimeTemplate = model::CharacterTemplate{};
+  slimeTemplate.type = model::CharacterTemplateType::ENEMY;
+  slimeTemplate.name = "slime";
+  slimeTemplate.combat.hp = 20;
+  database.addCharacterTemplate(slimeTemplate);
+
+  // 6x4 map, two layers; every tile of layer 0 is tileset 0 / tile 3.
+  auto mapTemplate = model::CarcerMapTemplate{};
+  mapTemplate.name = "save_test_map";
+  mapTemplate.width = 6;
+  mapTemplate.height = 4;
+  mapTemplate.tilesets.pushBack("test_terrain");
+  for (int layer = 0; layer < 2; layer++) {
+    bmin::DynArray<int> flat;
+    for (int i = 0; i < 6 * 4; i++) {
+      flat.pushBack(0);
+      flat.pushBack(layer == 0 ? 3 : 0);
+    }
+    mapTemplate.tiles.pushBack(std::move(flat));
+  }
+  auto slime = model::MapCharacterPlacement{};
+  slime.i = 8;
+  slime.name = "slime";
+  mapTemplate.characters.pushBack(slime);
+  database.addMapTemplate(mapTemplate);
+
+  auto otherMap = mapTemplate;
+  otherMap.name = "save_test_other";
+  database.addMapTemplate(otherMap);
+}
+
+// A mid-game looking state: party with gear, a door opened and fog explored on one
+// map, blood on the floor, dialogue vars, and a fight in progress.
+void populateState(state::State& state, const db::Database& database) {
+  game::createMapInstances(state, database);
+
+  auto member = model::CharacterPlayer(database.getCharacterTemplate("hero"));
+  member.instanceId = "hero-1";
+  member.name = "Hero";
+  member.templateName = "hero";
+  member.currentHp = 63;
+  member.currentMp = 4;
+  member.stats.generic.str = 12;
+  member.stats.skills.stealth = -2;
+  member.inventory.pushBack(model::CharacterInventoryItem{"sword", "item-1", 1});
+  member.inventory.pushBack(model::CharacterInventoryItem{"ration", "item-2", 5});
+  member.equipment.weapon0Id = "item-1";
+  state.player.party.pushBack(std::move(member));
+  state.player.name = "Player";
+  state.player.gold = 1234;
+  state.player.food = 17;
+
+  auto& map = state.mapInstances["save_test_map"];
+  model::mapInstanceGetTileAt(map, 2, 1, 0)->tileId = 4;
+  model::mapInstanceGetTileAt(map, 3, 3, 0)->fields.pushBack(
+      game::TileField{game::TileFieldType::BLOOD, 2, 9});
+  for (int x = 0; x < 4; x++) {
+    model::mapInstanceGetTileAt(map, x, 0, 0)->isExplored = true;
+  }
+  map.persistentState.defeatedCharacters.pushBack(
+      model::DefeatedCharacterRecord{"slime", 2, 1});
+
+  model::eventStorageSet(state.specialEventStorage, "vars.metLark", "true");
+  model::eventStorageSet(state.specialEventStorage, "once.intro", "1");
+  model::eventStorageSet(state.specialEventStorage, "tmp.scratch", "x");
+
+  state.world.activeMap.gridId = "save_test_map";
+  auto avatar = model::CharacterInstance{};
+  avatar.id = "hero-1";
+  avatar.templateName = "hero";
+  avatar.x = 1;
+  avatar.y = 2;
+  avatar.facing = model::CharacterFacing::Left;
+  state.world.activeMap.characters.pushBack(avatar);
+  auto enemy = model::CharacterInstance{};
+  enemy.id = "slime-1";
+  enemy.templateName = "slime";
+  enemy.x = 4;
+  enemy.y = 2;
+  enemy.currentHp = 11;
+  enemy.hpInitialized = true;
+  model::tryApplyCharacterTemplateToInstance(enemy, database);
+  state.world.activeMap.characters.pushBack(enemy);
+  state.world.activeMap.items.pushBack(model::ItemInstance{"item-9", "ration", 2, 3, 3});
+
+  state.turnMode = model::TurnMode::TURN_COMBAT;
+  state.world.combat = model::createCombatFromWorld(state.world, state.player);
+  state.world.combat.activeTurnIndex = 1;
+  state.triggers.pendingTravel = model::TravelTrigger{};
+  state.triggers.pendingTravel->destinationMapName = "save_test_other";
+  state.triggers.pendingTravel->destinationX = 5;
+  state.playerMovementCount = 321;
+
+  state.rng = model::RandomStreams(99);
+  model::randomNext(state.rng.combat);
+  model::randomNext(state.rng.effects);
+}
+
+} // namespace
+
+int main(int /*argc*/, char** /*argv*/) {
+  LOG(INFO) << "Starting TestSaveGame" << LOG_ENDL;
+  bool ok = true;
+
+  db::Database database;
+  setupDatabase(database);
+  state::State original;
+  populateState(original, database);
+
+  const auto startTime = std::chrono::steady_clock::now();
+  const auto bytes = game::encodeSaveGame(original, database);
+  state::State restored;
+  restored.world.camera.viewW = 320;
+  game::decodeSaveGame(asView(bytes), restored, database);
+  const auto elapsedUs = std::chrono::duration_cast<std::chrono::microseconds>(
+                             std::chrono::steady_clock::now() - startTime)
+                             .count();
+  LOG(INFO) << "Save is " << static_cast<int>(bytes.size()) << " bytes, round trip "
+            << static_cast<int>(elapsedUs) << "us" << LOG_ENDL;
+
+  // Round trip
+  {
+    ok = assertTrue(bytes.size() < 2048, "save is small") && ok;
+    ok = assertEqual(static_cast<int>(restored.player.party.size()), 1, "party") && ok;
+    const auto& member = restored.player.party[0];
+    ok = assertTrue(member.instanceId == "hero-1", "member id") && ok;
+    ok = assertTrue(member.params == &database.getCharacterTemplate("hero"),
+                    "member params from database") &&
+         ok;
+    ok = assertEqual(member.currentHp, 63, "member hp") && ok;
+    ok = assertEqual(member.stats.generic.str, 12, "member str") && ok;
+    ok = assertEqual(member.stats.skills.stealth, -2, "member stealth") && ok;
+    ok = assertEqual(static_cast<int>(member.inventory.size()), 2, "inventory") && ok;
+    ok = assertEqual(member.inventory[1].quantity, 5, "inventory quantity") && ok;
+    ok = assertTrue(member.equipment.weapon0Id == "item-1", "equipment") && ok;
+    ok = assertEqual(restored.player.gold, 1234, "gold") && ok;
+
+    auto& map = restored.mapInstances["save_test_map"];
+    ok = assertEqual(model::mapInstanceGetTileAt(map, 2, 1, 0)->tileId, 4, "door") && ok;
+    ok = assertEqual(model::mapInstanceGetTileAt(map, 3, 1, 0)->tileId, 3, "wall") && ok;
+    const auto* bloodTile = model::mapInstanceGetTileAt(map, 3, 3, 0);
+    ok = assertEqual(static_cast<int>(bloodTile->fields.size()), 1, "field") && ok;
+    ok = assertEqual(bloodTile->fields[0].variant, 2, "field variant") && ok;
+    ok = assertEqual(bloodTile->fields[0].moveDuration, 9, "field duration") && ok;
+    ok = assertTrue(model::mapInstanceGetTileAt(map, 3, 0, 0)->isExplored, "explored") &&
+         ok;
+    ok = assertTrue(!model::mapInstanceGetTileAt(map, 4, 0, 0)->isExplored,
+                    "unexplored") &&
+         ok;
+    ok = assertEqual(static_cast<int>(map.persistentState.defeatedCharacters.size()),
+                     1,
+                     "defeated record") &&
+         ok;
+    ok = assertEqual(static_cast<int>(map.persistentState.characters.size()),
+                     1,
+                     "stowed characters") &&
+         ok;
+    ok = assertTrue(map.persistentState.characters[0].id ==
+                        original.mapInstances["save_test_map"]
+                            .persistentState.characters[0]
+                            .id,
+                    "stowed character id") &&
+         ok;
+
+    ok = assertTrue(
+             model::eventStorageContains(restored.specialEventStorage, "vars.metLark"),
+             "vars kept") &&
+         ok;
+    ok = assertTrue(
+             !model::eventStorageContains(restored.specialEventStorage, "tmp.scratch"),
+             "tmp dropped") &&
+         ok;
+
+    ok = assertEqual(static_cast<int>(restored.world.activeMap.characters.size()),
+                     2,
+                     "active characters") &&
+         ok;
+    ok = assertTrue(restored.world.activeMap.characters[0].facing ==
+                        model::CharacterFacing::Left,
+                    "facing") &&
+         ok;
+    ok = assertEqual(restored.world.activeMap.characters[1].currentHp, 11, "enemy hp") &&
+         ok;
+    ok = assertTrue(restored.world.activeMap.characters[1].characterTemplate ==
+                        &database.getCharacterTemplate("slime"),
+                    "enemy template shared with database") &&
+         ok;
+    ok = assertTrue(restored.world.combat.active, "combat active") && ok;
+    ok = assertEqual(static_cast<int>(restored.world.combat.turnOrderIds.size()),
+                     2,
+                     "turn order") &&
+         ok;
+    ok = assertEqual(restored.world.combat.activeTurnIndex, 1, "active turn") && ok;
+    ok = assertTrue(restored.turnMode == model::TurnMode::TURN_COMBAT, "turn mode") && ok;
+    ok = assertTrue(restored.triggers.pendingTravel.has_value() &&
+                        restored.triggers.pendingTravel->destinationX == 5,
+                    "pending travel") &&
+         ok;
+    ok = assertEqual(restored.playerMovementCount, 321, "movement count") && ok;
+    ok = assertEqual(restored.world.camera.viewW, 320, "view size kept") && ok;
+    ok = assertTrue(model::randomNext(restored.rng.combat) ==
+                        model::randomNext(original.rng.combat),
+                    "rng continues") &&
+         ok;
+  }
+
+  // Encoding is deterministic, so a reloaded state writes the same bytes
+  {
+    state::State again;
+    populateState(again, database);
+    game::decodeSaveGame(asView(bytes), again, database);
+    const auto reencoded = game::encodeSaveGame(again, database);
+    ok = assertTrue(asView(reencoded) == asView(bytes), "re-encode identical") && ok;
+  }
+
+  // Bad input throws and leaves state alone
+  {
+    state::State target;
+    target.player.gold = 5;
+
+    auto corrupt = bytes;
+    corrupt[corrupt.size() / 2] ^= 0x5a;
+    ok = assertTrue(decodeThrows(corrupt, target, database), "corrupt rejected") && ok;
+
+    auto truncated = bmin::DynArray<uint8_t>{};
+    for (size_t i = 0; i + 10 < bytes.size(); i++) {
+      truncated.pushBack(bytes[i]);
+    }
+    ok = assertTrue(decodeThrows(truncated, target, database), "truncated rejected") &&
+         ok;
+
+    auto newer = bytes;
+    newer[4] = static_cast<uint8_t>(game::SAVE_FORMAT_VERSION + 1);
+    ok = assertTrue(decodeThrows(newer, target, database), "newer rejected") && ok;
+
+    auto notSave = bytes;
+    notSave[0] = 'X';
+    ok = assertTrue(decodeThrows(notSave, target, database), "magic rejected") && ok;
+
+    // Compressed header claiming 4 GiB over a one byte stream.
+    const bmin::DynArray<uint8_t> oversized{
+        'C', 'S', 'A', 'Z', 0xff, 0xff, 0xff, 0xff, 0};
+    ok = assertTrue(decodeThrows(oversized, target, database), "oversized rejected") &&
+         ok;
+
+    ok = assertEqual(target.player.gold, 5, "state untouched") && ok;
+
+    // A bit count near SIZE_MAX must not wrap when rounded up to bytes.
+    const bmin::DynArray<uint8_t> hugeBits{
+        0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0x01};
+    bool bitsRejected = false;
+    try {
+      game::SaveReader(asView(hugeBits)).readBits();
+    } catch (const std::runtime_error&) {
+      bitsRejected = true;
+    }
+    ok = assertTrue(bitsRejected, "huge bit count rejected") && ok;
+  }
+
+  // Unknown sections are skipped, including ids that would truncate onto a known one
+  // (257 -> PLAYER) or overflow the seen-section mask.
+  for (const uint64_t unknownId : {uint64_t{5}, uint64_t{40}, uint64_t{257}}) {
+    state::State reloaded;
+    game::decodeSaveGame(asView(withExtraSection(bytes, unknownId)), reloaded, database);
+    const auto reencoded = game::encodeSaveGame(reloaded, database);
+    ok = assertTrue(asView(reencoded) == asView(bytes), "unknown section skipped") && ok;
+  }
+
+  if (ok) {
+    LOG(INFO) << "TestSaveGame PASSED" << LOG_ENDL;
+    return 0;
+  }
+  LOG(ERROR) << "TestSaveGame FAILED" << LOG_ENDL;
+  return 1;
+}
@@ -257,6 +257,38 @@ int main(int /*argc*/, char** /*argv*/) {
     ok = assertOrder(order, {1, 2}, "enqueue then pll both run same update") && ok;
   }
 
+  // Action storage is recycled through ActionPool once the first batch is freed
+  {
+    state::StateManager sm;
+    bmin::DynArray<int> order;
+
+    for (int i = 0; i < 4; i++) {
+      sm.enqueueAction(sm.getActionData(), new RecordAction(&order, i), 0);
+    }
+    sm.update(1);
+    state::ActionPool::resetStats();
+
+    for (int i = 0; i < 4; i++) {
+      sm.enqueueAction(sm.getActionData(), new RecordAction(&order, i), 0);
+    }
+    sm.enqueueAction(sm.getActionData(), nullptr, 10);
+    sm.update(1);
+
+    const auto& poolStats = state::ActionPool::getStats();
+    ok = assertEqual(static_cast<int>(poolStats.pooledAllocations),
+                     4,
+                     "second batch reuses pooled action storage") &&
+         ok;
+    ok = assertEqual(static_cast<int>(poolStats.heapAllocations),
+                     0,
+                     "second batch does not hit the heap") &&
+         ok;
+    ok = assertEqual(static_cast<int>(sm.getActionData().sequentialActions.size()),
+                     1,
+                     "delay-only entry stays queued") &&
+         ok;
+  }
+
   if (ok) {
     LOG(INFO) << "TestStateManagerActions passed" << LOG_ENDL;
     return 0;
@@ -3,22 +3,24 @@
 #include "lib/bmin/Map.h"
 #include "sdl2w/Logger.h"
 #include "runner/ConditionEvaluator.h"
+#include "runner/EventRunnerHelpers.h"
+#include "runner/ScriptCompiler.h"
 #include "bmin/Map.h"
 
 #define TEST_NAME "TestConditionalEvaluator"
 
 int main(int argc, char** argv) {
   LOG(INFO) << "Starting " << TEST_NAME << LOG_ENDL;
-  bmin::Map<bmin::String, bmin::String> initialStorage;
+  model::EventStorage initialStorage;
   // clang-format off
-  initialStorage.insert(bmin::String("a"), bmin::String("0"));
-  initialStorage.insert(bmin::String("b"), bmin::String("1"));
-  initialStorage.insert(bmin::String("c"), bmin::String("2"));
-  initialStorage.insert(bmin::String("d"), bmin::String("3"));
-  initialStorage.insert(bmin::String("vars.quests.WoodThief.started"), bmin::String("true"));
-  initialStorage.insert(bmin::String("vars.quests.WoodThief.completed"), bmin::String("false"));
-  initialStorage.insert(bmin::String("vars.quests.WoodThief.step"), bmin::String("2"));
-  initialStorage.insert(bmin::String("vars.items.BeerPappysLager"), bmin::String("1"));
+  runner::setStorage(initialStorage, "a", "0");
+  runner::setStorage(initialStorage, "b", "1");
+  runner::setStorage(initialStorage, "c", "2");
+  runner::setStorage(initialStorage, "d", "3");
+  runner::setStorage(initialStorage, "vars.quests.WoodThief.started", "true");
+  runner::setStorage(initialStorage, "vars.quests.WoodThief.completed", "false");
+  runner::setStorage(initialStorage, "vars.quests.WoodThief.step", "2");
+  runner::setStorage(initialStorage, "vars.items.BeerPappysLager", "1");
   // z is undefined
   // clang-format on
   const bmin::DynArray<std::pair<bmin::String, bool>> basicTestCases = {
@@ -136,6 +138,92 @@ int main(int argc, char** argv) {
         }
       }
     }
+    LOG(INFO) << "== Running compile tests ==" << LOG_ENDL;
+
+    // Invalid syntax is reported when compiling, before anything is evaluated.
+    for (const auto& [condition, expected] : invalidSyntax) {
+      bmin::DynArray<bmin::String> compileErrors;
+      runner::compileCondition(condition, compileErrors);
+      if (compileErrors.size() != 1) {
+        LOG(ERROR) << " Expected a compile error for: " << condition << LOG_ENDL;
+        failedTests.pushBack({condition, false});
+      }
+    }
+    {
+      bmin::DynArray<bmin::String> compileErrors;
+      const auto program =
+          runner::compileCondition("ALL(ONCE(x), ANY(IS(b), false))", compileErrors);
+      runner::ConditionEvaluator evaluator(initialStorage);
+      if (!compileErrors.empty() || !evaluator.evalProgram(program) ||
+          evaluator.funcs.onceKeysToCommit.size() != 1 ||
+          evaluator.funcs.onceKeysToCommit[0] != "once.x") {
+        LOG(ERROR) << " Compiled nested condition evaluated incorrectly" << LOG_ENDL;
+        failedTests.pushBack({"ALL(ONCE(x), ANY(IS(b), false))", false});
+      }
+    }
+
+    LOG(INFO) << "== Running typed storage tests ==" << LOG_ENDL;
+
+    // Canonical numbers are stored unboxed; other number texts keep comparing as text.
+    {
+      model::EventStorage storage = initialStorage;
+      runner::setStorage(storage, "n", "7");
+      runner::setStorage(storage, "padded", "07");
+      const auto* n = model::eventStorageGet(storage, "n");
+      const auto* padded = model::eventStorageGet(storage, "padded");
+      runner::ConditionEvaluator evaluator(storage);
+      if (!n || n->type != model::StorageValueType::INT || !padded ||
+          padded->type != model::StorageValueType::STRING ||
+          !evaluator.evalCondition("EQ(n, 7)") ||
+          evaluator.evalCondition("EQ(padded, 7)") ||
+          !evaluator.evalCondition("GT(padded, 6)") ||
+          runner::getStorage(storage, "padded").value_or("") != "07") {
+        LOG(ERROR) << " Typed storage values compared incorrectly" << LOG_ENDL;
+        failedTests.pushBack({"typed storage", false});
+      }
+    }
+
+    // Storage names are interned wherever they appear; literals are not.
+    {
+      bmin::DynArray<bmin::String> compileErrors;
+      const auto compared =
+          runner::compileCondition("GT(vars.test.compared, 10)", compileErrors);
+      runner::compileCondition("IS(vars.test.flag)", compileErrors);
+      runner::compileCondition("QUEST_IS_STARTED(TestQuest)", compileErrors);
+      runner::compileExec("SET_STR(vars.test.stored, vars.test.storedValue)\n"
+                          "SET_STR(vars.test.label, testLiteral)",
+                          compileErrors);
+      bool comparedHasKey = false;
+      for (const auto& constant : compared.constants) {
+        comparedHasKey = comparedHasKey || (constant.text == "vars.test.compared" &&
+                                            constant.key != model::NO_STORAGE_KEY);
+      }
+      if (!compileErrors.empty() || !comparedHasKey ||
+          model::findStorageKey("vars.test.compared") == model::NO_STORAGE_KEY ||
+          model::findStorageKey("vars.test.storedValue") == model::NO_STORAGE_KEY ||
+          model::findStorageKey("vars.test.flag") == model::NO_STORAGE_KEY ||
+          model::findStorageKey("vars.quests.TestQuest.started") ==
+              model::NO_STORAGE_KEY ||
+          model::findStorageKey("vars.test.stored") == model::NO_STORAGE_KEY ||
+          model::findStorageKey("10") != model::NO_STORAGE_KEY ||
+          model::findStorageKey("testLiteral") != model::NO_STORAGE_KEY) {
+        LOG(ERROR) << " Script constants interned the wrong operands" << LOG_ENDL;
+        failedTests.pushBack({"interned operands", false});
+      }
+
+      // Names outside vars/once/tmp are not interned but still read storage by name.
+      model::EventStorage storage = initialStorage;
+      runner::setStorage(storage, "vars.test.compared", "11");
+      runner::setStorage(storage, "testOther", "4");
+      const auto other = runner::compileCondition("EQ(testOther, 4)", compileErrors);
+      runner::ConditionEvaluator evaluator(storage);
+      if (!compileErrors.empty() || !evaluator.evalProgram(compared) ||
+          !evaluator.evalProgram(other)) {
+        LOG(ERROR) << " Compared operands did not read storage" << LOG_ENDL;
+        failedTests.pushBack({"GT(vars.test.compared, 10)", false});
+      }
+    }
+
     if (!failedTests.empty()) {
       LOG(ERROR) << "Test failed: " << failedTests.size() << " tests failed out of "
                  << basicTestCases.size() << LOG_ENDL;
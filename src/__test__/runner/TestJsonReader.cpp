@@ -0,0 +1,170 @@
+#include "lib/Json.h"
+#include "lib/JsonReader.h"
+#include "sdl2w/Logger.h"
+
+#include <stdexcept>
+#include <string_view>
+
+namespace {
+
+bool assertEqual(const bmin::String& actual, const char* expected, const char* label) {
+  if (actual != expected) {
+    LOG(ERROR) << label << " expected '" << expected << "' but got '" << actual.cStr()
+               << "'" << LOG_ENDL;
+    return false;
+  }
+  return true;
+}
+
+bool assertEqual(int actual, int expected, const char* label) {
+  if (actual != expected) {
+    LOG(ERROR) << label << " expected " << expected << " but got " << actual << LOG_ENDL;
+    return false;
+  }
+  return true;
+}
+
+void readWholeDocument(const char* text) {
+  JsonReader reader(text, true);
+  reader.skipValue();
+  reader.expectEnd();
+}
+
+bool throwsParseError(const char* text, const char* label) {
+  try {
+    readWholeDocument(text);
+  } catch (const Json::parse_error&) {
+    return true;
+  }
+  LOG(ERROR) << label << " expected a parse error" << LOG_ENDL;
+  return false;
+}
+
+bool throwsTypeError(const char* text, const char* label) {
+  try {
+    JsonReader reader(text, true);
+    bmin::DynArray<int> values;
+    reader.readIntArrayInto(values);
+  } catch (const Json::parse_error&) {
+    LOG(ERROR) << label << " expected a type error, got a parse error" << LOG_ENDL;
+    return false;
+  } catch (const std::runtime_error&) {
+    return true;
+  }
+  LOG(ERROR) << label << " expected a type error" << LOG_ENDL;
+  return false;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  LOG(INFO) << "Starting TestJsonReader" << LOG_ENDL;
+
+  try {
+    bool ok = true;
+
+    const char* mapDoc = R"(
+      // maps-style document
+      {
+        "name": "quote \"test\"\nline",
+        "width": -12,
+        "extra": {"nested": [1, {"deep": [true, false, 2.5e3]}], "s": "]}"},
+        "tiles": {"0": [1, 2, 3], "1": []},
+        /* block comment */
+        "label": 7,
+        "visible": true
+      }
+    )";
+    JsonReader reader(mapDoc, true);
+    reader.beginObject();
+    bmin::String name;
+    bmin::String label;
+    int width = 0;
+    bool visible = false;
+    bmin::DynArray<int> layer0;
+    int layerCount = 0;
+    std::string_view key;
+    while (reader.nextKey(key)) {
+      if (key == "name") {
+        name = reader.readString();
+      } else if (key == "width") {
+        width = reader.readInt();
+      } else if (key == "label") {
+        label = reader.readStringOr(bmin::String("fallback"));
+      } else if (key == "visible") {
+        visible = reader.readBool();
+      } else if (key == "tiles") {
+        reader.beginObject();
+        std::string_view layerKey;
+        while (reader.nextKey(layerKey)) {
+          ++layerCount;
+          if (layerKey == "0") {
+            reader.readIntArrayInto(layer0);
+          } else {
+            reader.skipValue();
+          }
+        }
+      } else {
+        reader.skipValue();
+      }
+    }
+    reader.expectEnd();
+    ok = assertEqual(name, "quote \"test\"\nline", "doc.name") && ok;
+    ok = assertEqual(width, -12, "doc.width") && ok;
+    ok = assertEqual(label, "fallback", "doc.label_default") && ok;
+    ok = assertEqual(visible ? 1 : 0, 1, "doc.visible") && ok;
+    ok = assertEqual(layerCount, 2, "doc.tiles.layer_count") && ok;
+    ok = assertEqual(static_cast<int>(layer0.size()), 3, "doc.tiles[0].size") && ok;
+    ok = assertEqual(layer0.size() == 3 ? layer0[2] : 0, 3, "doc.tiles[0][2]") && ok;
+
+    JsonReader arrays(R"([["a", "b"], {"x": 1}, 4])", false);
+    arrays.beginArray();
+    bmin::DynArray<bmin::String> strings;
+    ok = arrays.nextElement() && ok;
+    arrays.readStringArrayInto(strings);
+    ok = arrays.nextElement() && ok;
+    ok = !arrays.tryBeginArray() && ok;
+    ok = arrays.nextElement() && ok;
+    ok = assertEqual(arrays.readIntOr(0), 4, "arrays.int") && ok;
+    ok = !arrays.nextElement() && ok;
+    arrays.expectEnd();
+    ok = assertEqual(static_cast<int>(strings.size()), 2, "arrays.strings.size") && ok;
+    const bmin::String second = strings.size() == 2 ? strings[1] : bmin::String();
+    ok = assertEqual(second, "b", "arrays.strings[1]") && ok;
+
+    ok = throwsParseError("[1, 2,]", "syntax.trailing_comma") && ok;
+    ok = throwsParseError("[1 2]", "syntax.missing_comma") && ok;
+    ok = throwsParseError(R"({"a" 1})", "syntax.missing_colon") && ok;
+    ok = throwsParseError(R"({"a": null})", "syntax.null") && ok;
+    ok = throwsParseError("[1] 2", "syntax.trailing_input") && ok;
+    ok = throwsParseError("[01]", "syntax.leading_zero") && ok;
+    ok = throwsParseError("[\"open", "syntax.unterminated_string") && ok;
+    ok = throwsParseError("", "syntax.empty") && ok;
+    ok = throwsTypeError("[1, 2.5]", "type.float_in_int_array") && ok;
+    ok = throwsTypeError("[1, \"2\"]", "type.string_in_int_array") && ok;
+    ok = throwsTypeError("{}", "type.object_for_array") && ok;
+
+    bool outOfRange = false;
+    try {
+      JsonReader big("[2147483648]", false);
+      bmin::DynArray<int> values;
+      big.readIntArrayInto(values);
+    } catch (const Json::parse_error&) {
+      outOfRange = true;
+    }
+    ok = assertEqual(outOfRange ? 1 : 0, 1, "range.int_overflow") && ok;
+
+    JsonReader smallest("-2147483648", false);
+    ok = assertEqual(smallest.readInt(), -2147483647 - 1, "range.int_min") && ok;
+
+    if (!ok) {
+      return 1;
+    }
+  } catch (const std::exception& e) {
+    LOG(ERROR) << "Error in TestJsonReader: " << e.what() << LOG_ENDL;
+    return 1;
+  }
+
+  LOG(INFO) << "TestJsonReader passed" << LOG_ENDL;
+  return 0;
+}
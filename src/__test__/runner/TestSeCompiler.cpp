@@ -0,0 +1,270 @@
+#include "bmin/DynArray.h"
+#include "bmin/Map.h"
+#include "bmin/String.h"
+#include "db/loaders/LoadSpecialEvents.h"
+#include "lib/Json.h"
+#include "runner/EventBundle.h"
+#include "runner/EventRunnerHelpers.h"
+#include "runner/ScriptCompiler.h"
+#include "runner/SeCompiler.h"
+#include "runner/SpecialEventRunner.h"
+#include "sdl2w/AssetLoader.h"
+#include "sdl2w/Logger.h"
+#include <filesystem>
+#include <fstream>
+#include <variant>
+
+#define TEST_NAME "TestSeCompiler"
+
+namespace {
+
+// clang-format off
+const char* VALID_SOURCE =
+    "// greeting used by the test\n"
+    "!greet,talk,Old Man, Fisher,portraits0_1\n"
+    "@FLAG=vars.test.greeted\n"
+    "@GOLD = vars.test.gold\n"
+    ">root,switch\n"
+    "  +check: IS:@FLAG|again\n"
+    "  +default: hello\n"
+    ">hello,exec\n"
+    "  +p: \"Hello there.\"\n"
+    "  +p: He waves.\n"
+    "  +e: SET_BOOL:@FLAG|MOD_NUM:@GOLD,5\n"
+    "  +n: ask\n"
+    ">again,exec\n"
+    "  +p: \"You again.\"\n"
+    "  +auto: true\n"
+    "  +n: ask\n"
+    ">ask,choice\n"
+    "  +p: \"Anything else?\"\n"
+    "  +c: rich|Am I rich?|GTE(@GOLD, 5)\n"
+    "  +c: done|Goodbye.\n"
+    ">rich,bool\n"
+    "  +check: GT:@GOLD,100\n"
+    "  +pass: done\n"
+    "  +fail: done\n"
+    ">done,end\n";
+
+// Line numbers matter: see the expected diagnostics below.
+const char* INVALID_SOURCE =
+    ">orphan,exec\n"                    // 1: before any event
+    "!bad,modal,Bad,\n"                 // 2
+    ">a,exec\n"                         // 3
+    "  +e: NOT_A_FUNC:1\n"              // 4: script error
+    "  +n: nowhere\n"                   // 5: unknown next (warning)
+    ">b,loop\n"                         // 6: unknown node type
+    "  +p: skipped with its node\n"     // 7
+    ">c,switch\n"                       // 8
+    "  +check: IS:x\n"                  // 9: missing next
+    "  +p: not a switch field\n"        // 10
+    ">k,keyword\n"                      // 11: unsupported (warning)
+    "  +k: look|ignored\n"              // 12
+    "    |default:ignored\n";           // 13
+// clang-format on
+
+struct ExpectedDiagnostic {
+  int line;
+  bool isError;
+};
+
+bool hasDiagnostic(const bmin::DynArray<runner::SeDiagnostic>& diagnostics,
+                   const ExpectedDiagnostic& expected) {
+  for (const auto& diagnostic : diagnostics) {
+    if (diagnostic.line == expected.line && diagnostic.isError == expected.isError) {
+      return true;
+    }
+  }
+  return false;
+}
+
+struct ShippedSource {
+  const char* path;
+  size_t eventCount;
+  bmin::DynArray<int> errorLines;
+};
+
+template <typename T>
+const T* findChild(const model::GameEvent& event, const char* id) {
+  const auto* child = model::findGameEventChild(event, id);
+  return child ? std::get_if<T>(child) : nullptr;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+  LOG(INFO) << "Starting " << TEST_NAME << LOG_ENDL;
+  try {
+    LOG(INFO) << "== Compiling a valid source ==" << LOG_ENDL;
+    bmin::DynArray<runner::SeDiagnostic> diagnostics;
+    auto events = runner::compileSeSource(VALID_SOURCE, diagnostics);
+    for (const auto& diagnostic : diagnostics) {
+      LOG(ERROR) << runner::formatSeDiagnostic("valid.se", diagnostic) << LOG_ENDL;
+    }
+    if (!diagnostics.empty() || events.size() != 1) {
+      LOG(ERROR) << "Expected one event and no diagnostics" << LOG_ENDL;
+      return 1;
+    }
+    const auto& event = events[0];
+    const auto* root = findChild<model::GameEventChildSwitch>(event, "root");
+    const auto* hello = findChild<model::GameEventChildExec>(event, "hello");
+    const auto* again = findChild<model::GameEventChildExec>(event, "again");
+    const auto* ask = findChild<model::GameEventChildChoice>(event, "ask");
+    const auto* rich = findChild<model::GameEventChildSwitch>(event, "rich");
+    if (event.title != "Old Man, Fisher" || event.icon != "portraits0_1" ||
+        event.eventType != model::GameEventType::TALK || event.vars.size() != 2 ||
+        event.vars[1].key != "GOLD" || event.vars[1].value != "vars.test.gold" ||
+        !root || root->cases.size() != 1 || root->cases[0].conditionStr != "IS(@FLAG)" ||
+        root->defaultNext != "hello" || !hello || hello->paragraphs.size() != 2 ||
+        hello->execStr != "SET_BOOL(@FLAG)\nMOD_NUM(@GOLD, 5)" || hello->autoAdvance ||
+        !again || !again->autoAdvance || !ask || ask->choices.size() != 2 ||
+        ask->choices[0].conditionStr != "GTE(@GOLD, 5)" ||
+        !ask->choices[1].conditionStr.empty() || !rich || rich->cases.size() != 1 ||
+        rich->cases[0].conditionStr != "GT(@GOLD, 100)" || rich->defaultNext != "done") {
+      LOG(ERROR) << "Compiled event does not match the source" << LOG_ENDL;
+      return 1;
+    }
+
+    LOG(INFO) << "== Running the compiled event ==" << LOG_ENDL;
+    bmin::Map<bmin::String, model::GameEvent> gameEvents;
+    gameEvents[event.id] = event;
+    auto& loaded = gameEvents[event.id];
+    if (!runner::compileGameEventScripts(loaded, gameEvents).empty()) {
+      LOG(ERROR) << "Compiled event has script errors" << LOG_ENDL;
+      return 1;
+    }
+    {
+      model::EventStorage storage;
+      runner::SpecialEventRunner eventRunner(storage, loaded, gameEvents);
+      runner::SpecialEventRunnerInterface ui(eventRunner);
+      ui.startEvent();
+      if (eventRunner.displayText.find("Hello there.") == bmin::String::npos ||
+          runner::getStorage(eventRunner.storage, "vars.test.greeted").value_or("") !=
+              "true" ||
+          runner::getStorage(eventRunner.storage, "vars.test.gold").value_or("") != "5" ||
+          !eventRunner.errors.empty()) {
+        LOG(ERROR) << "Compiled event ran incorrectly: " << eventRunner.displayText
+                   << LOG_ENDL;
+        return 1;
+      }
+    }
+
+    LOG(INFO) << "== JSON and bundle output ==" << LOG_ENDL;
+    const bmin::String json = runner::gameEventsToJson(events);
+    const Json parsed = Json::parse(json.cStr(), nullptr, true, true);
+    if (!parsed.is_array() || parsed.size() != 1 ||
+        parsed[0]["children"].size() != event.children.size() ||
+        parsed[0]["children"][1]["execStr"].get<bmin::String>() != hello->execStr) {
+      LOG(ERROR) << "JSON output does not match the event:\n" << json << LOG_ENDL;
+      return 1;
+    }
+    const auto bundle = runner::encodeEventBundle(events);
+    const auto decoded = runner::decodeEventBundle(
+        std::string_view(reinterpret_cast<const char*>(bundle.data()), bundle.size()));
+    if (runner::gameEventsToJson(decoded) != json) {
+      LOG(ERROR) << "Bundle did not round-trip" << LOG_ENDL;
+      return 1;
+    }
+    bool rejected = false;
+    try {
+      runner::decodeEventBundle(std::string_view(
+          reinterpret_cast<const char*>(bundle.data()), bundle.size() - 1));
+    } catch (const std::exception& e) {
+      rejected = true;
+    }
+    if (!rejected) {
+      LOG(ERROR) << "Truncated bundle was accepted" << LOG_ENDL;
+      return 1;
+    }
+
+    LOG(INFO) << "== Diagnostics ==" << LOG_ENDL;
+    diagnostics.clear();
+    events = runner::compileSeSource(INVALID_SOURCE, diagnostics);
+    for (const auto& diagnostic : diagnostics) {
+      LOG(INFO) << runner::formatSeDiagnostic("invalid.se", diagnostic) << LOG_ENDL;
+    }
+    const ExpectedDiagnostic expected[] = {
+        {1, true}, {4, true}, {5, false}, {6, true}, {9, true}, {10, true}, {11, false}};
+    for (const auto& expectedDiagnostic : expected) {
+      if (!hasDiagnostic(diagnostics, expectedDiagnostic)) {
+        LOG(ERROR) << "Missing diagnostic on line " << expectedDiagnostic.line
+                   << LOG_ENDL;
+        return 1;
+      }
+    }
+    if (diagnostics.size() != sizeof(expected) / sizeof(expected[0]) ||
+        events.size() != 1 || events[0].children.size() != 2) {
+      LOG(ERROR) << "Unexpected diagnostics or nodes for the invalid source" << LOG_ENDL;
+      return 1;
+    }
+
+    LOG(INFO) << "== Shipped example ==" << LOG_ENDL;
+    diagnostics.clear();
+    events = runner::compileSeSource(sdl2w::loadFileAsString("assets/db/events-test.se"),
+                                     diagnostics, false);
+    for (const auto& diagnostic : diagnostics) {
+      LOG(INFO) << runner::formatSeDiagnostic("events-test.se", diagnostic) << LOG_ENDL;
+    }
+    if (runner::hasSeErrors(diagnostics) || events.size() != 2 ||
+        events[0].children.size() != 6 || events[1].children.size() != 2) {
+      LOG(ERROR) << "events-test.se did not compile as expected" << LOG_ENDL;
+      return 1;
+    }
+
+    // Compiled with checkScripts, as SECOMPILER does. talk-alinea.se still calls the
+    // editor's old SET and MOD and has a switch case without a next, so those errors
+    // must be reported on their lines while the rest of the event still compiles.
+    LOG(INFO) << "== Shipped sources ==" << LOG_ENDL;
+    const ShippedSource shippedSources[] = {
+        {"assets/db/special-events/events-alinea.se", 2, {}},
+        {"assets/db/talk/talk-alinea.se", 1, {9, 38, 41, 41}},
+    };
+    const auto jsonPath = std::filesystem::temp_directory_path() / "TestSeCompiler.json";
+    for (const auto& shipped : shippedSources) {
+      diagnostics.clear();
+      events =
+          runner::compileSeSource(sdl2w::loadFileAsString(shipped.path), diagnostics);
+      size_t errorCount = 0;
+      for (const auto& diagnostic : diagnostics) {
+        LOG(INFO) << runner::formatSeDiagnostic(shipped.path, diagnostic) << LOG_ENDL;
+        errorCount += diagnostic.isError ? 1 : 0;
+      }
+      bool expectedErrors = errorCount == shipped.errorLines.size();
+      for (const int line : shipped.errorLines) {
+        expectedErrors = expectedErrors && hasDiagnostic(diagnostics, {line, true});
+      }
+      if (!expectedErrors || events.size() != shipped.eventCount) {
+        LOG(ERROR) << shipped.path << " did not compile as expected" << LOG_ENDL;
+        return 1;
+      }
+
+      // The JSON loader reads the JSON output back into the same events.
+      const bmin::String shippedJson = runner::gameEventsToJson(events);
+      {
+        std::ofstream out{jsonPath, std::ios::binary};
+        out.write(shippedJson.cStr(), static_cast<std::streamsize>(shippedJson.size()));
+      }
+      bmin::Map<bmin::String, model::GameEvent> jsonEvents;
+      db::loadSpecialEvents(jsonPath.string().c_str(), jsonEvents);
+      std::filesystem::remove(jsonPath);
+      bmin::DynArray<model::GameEvent> reloaded;
+      for (const auto& shippedEvent : events) {
+        auto it = jsonEvents.find(shippedEvent.id);
+        if (it != jsonEvents.end()) {
+          reloaded.pushBack((*it).value);
+        }
+      }
+      if (jsonEvents.size() != events.size() ||
+          runner::gameEventsToJson(reloaded) != shippedJson) {
+        LOG(ERROR) << shipped.path << " differs once loaded as JSON" << LOG_ENDL;
+        return 1;
+      }
+    }
+
+    LOG(INFO) << TEST_NAME << " completed successfully" << LOG_ENDL;
+    return 0;
+  } catch (const std::exception& e) {
+    LOG(ERROR) << "Error in test: " << e.what() << LOG_ENDL;
+    return 1;
+  }
+}
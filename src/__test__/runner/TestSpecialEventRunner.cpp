@@ -2,6 +2,7 @@
 #include "sdl2w/Logger.h"
 #include "model/templates/SpecialEvents.h"
 #include "runner/EventRunnerHelpers.h"
+#include "runner/ScriptCompiler.h"
 #include "runner/SpecialEventRunner.h"
 #include "bmin/String.h"
 #include "bmin/Map.h"
@@ -68,9 +69,21 @@ int main(int argc, char** argv) {
     testEvent.children.pushBack(endNode);
 
     bmin::Map<bmin::String, model::GameEvent> gameEvents;
+    const bmin::Map<bmin::String, model::GameEvent> noEvents;
+
+    // Test: indexed lookup matches the authored children
+    model::GameEvent indexedEvent = testEvent;
+    model::indexGameEventChildren(indexedEvent);
+    const auto* children = indexedEvent.children.data();
+    if (model::findGameEventChild(indexedEvent, "end_node") != &children[2] ||
+        model::findGameEventChild(indexedEvent, "root") != &children[0] ||
+        model::findGameEventChild(indexedEvent, "missing") != nullptr) {
+      LOG(ERROR) << "Indexed child lookup returned the wrong node" << LOG_ENDL;
+      return 1;
+    }
 
-    bmin::Map<bmin::String, bmin::String> initialStorage;
-    initialStorage.insert(bmin::String("initial_value"), bmin::String("100"));
+    model::EventStorage initialStorage;
+    runner::setStorage(initialStorage, "initial_value", "100");
 
     // Create the runner
     runner::SpecialEventRunner runner(initialStorage, testEvent, gameEvents);
@@ -79,11 +92,16 @@ int main(int argc, char** argv) {
               << LOG_ENDL;
 
     // Test: Check initial node
-    auto currentNode = runner.getCurrentNode();
-    if (!currentNode.has_value()) {
+    const auto* currentNode = runner.getCurrentNode();
+    if (!currentNode) {
       LOG(ERROR) << "Failed to get current node" << LOG_ENDL;
       return 1;
     }
+    if (currentNode < testEvent.children.data() ||
+        currentNode >= testEvent.children.data() + testEvent.children.size()) {
+      LOG(ERROR) << "Current node should point into the event, not a copy" << LOG_ENDL;
+      return 1;
+    }
     if (runner.currentNodeId != "root") {
       LOG(ERROR) << "Expected to start at root node, but got: " << runner.currentNodeId
                  << LOG_ENDL;
@@ -101,12 +119,12 @@ int main(int argc, char** argv) {
     }
 
     // Check that storage was updated
-    auto testValue = runner.storage.find("test_key");
-    if (testValue == runner.storage.end() || testValue->value != "test_value") {
+    auto testValue = runner::getStorage(runner.storage, "test_key");
+    if (!testValue || *testValue != "test_value") {
       LOG(ERROR) << "Storage was not updated correctly by SET_STR" << LOG_ENDL;
       return 1;
     }
-    LOG(INFO) << "Storage correctly updated: test_key = " << testValue->value
+    LOG(INFO) << "Storage correctly updated: test_key = " << *testValue
               << LOG_ENDL;
 
     // Test: Advance to CHOICE node (this will process the choice node)
@@ -140,8 +158,8 @@ int main(int argc, char** argv) {
       runner.advance(choice1.next, choice1.onceKeysToCommit, choice1.execStr);
 
       // Check that choice1_selected was set
-      auto choice1Selected = runner.storage.find("choice1_selected");
-      if (choice1Selected == runner.storage.end() || choice1Selected->value != "true") {
+      auto choice1Selected = runner::getStorage(runner.storage, "choice1_selected");
+      if (!choice1Selected || *choice1Selected != "true") {
         LOG(ERROR) << "choice1_selected was not set correctly" << LOG_ENDL;
         return 1;
       }
@@ -183,8 +201,8 @@ int main(int argc, char** argv) {
       LOG(ERROR) << "Exec string evaluation failed" << LOG_ENDL;
       return 1;
     }
-    auto numTest = runner.storage.find("num_test");
-    if (numTest == runner.storage.end() || numTest->value != "42") {
+    auto numTest = runner::getStorage(runner.storage, "num_test");
+    if (!numTest || *numTest != "42") {
       LOG(ERROR) << "SET_NUM did not work correctly" << LOG_ENDL;
       return 1;
     }
@@ -220,7 +238,7 @@ int main(int argc, char** argv) {
       endNode.id = "end_node";
       talkEvent.children.pushBack(endNode);
 
-      runner::SpecialEventRunner talkRunner({}, talkEvent, {});
+      runner::SpecialEventRunner talkRunner({}, talkEvent, noEvents);
       runner::SpecialEventRunnerInterface talkIface(talkRunner);
       talkIface.startEvent();
 
@@ -257,7 +275,7 @@ int main(int argc, char** argv) {
       endNode.id = "end_node";
       talkEvent.children.pushBack(endNode);
 
-      runner::SpecialEventRunner talkRunner({}, talkEvent, {});
+      runner::SpecialEventRunner talkRunner({}, talkEvent, noEvents);
       runner::SpecialEventRunnerInterface talkIface(talkRunner);
       talkIface.startEvent();
 
@@ -316,7 +334,7 @@ int main(int argc, char** argv) {
       endNode.id = "end_node";
       talkEvent.children.pushBack(endNode);
 
-      runner::SpecialEventRunner talkRunner({}, talkEvent, {});
+      runner::SpecialEventRunner talkRunner({}, talkEvent, noEvents);
       runner::SpecialEventRunnerInterface talkIface(talkRunner);
       talkIface.startEvent();
       if (talkRunner.displayTextChoices.size() != 2 ||
@@ -342,29 +360,29 @@ int main(int argc, char** argv) {
 
     // Persisted dialogue storage keeps vars.*/once.* and drops tmp.*.
     {
-      bmin::Map<bmin::String, bmin::String> storage;
-      storage.insert(bmin::String("vars.exposition.alinea.realmKnown"),
-                     bmin::String("true"));
-      storage.insert(bmin::String("once.vars.hasSpokenToalinea_claire"),
-                     bmin::String("true"));
-      storage.insert(bmin::String("once.tmp.askedPriestess"), bmin::String("true"));
-      storage.insert(bmin::String("tmp.calledLark"), bmin::String("true"));
-      storage.insert(bmin::String("tmp.otherScratch"), bmin::String("1"));
+      model::EventStorage storage;
+      runner::setStorage(storage, "vars.exposition.alinea.realmKnown", "true");
+      runner::setStorage(storage, "once.vars.hasSpokenToalinea_claire", "true");
+      runner::setStorage(storage, "once.tmp.askedPriestess", "true");
+      runner::setStorage(storage, "tmp.calledLark", "true");
+      runner::setStorage(storage, "tmp.otherScratch", "1");
 
       runner::clearTmpStorageKeys(storage);
 
-      if (!storage.contains("vars.exposition.alinea.realmKnown") ||
-          !storage.contains("once.vars.hasSpokenToalinea_claire") ||
-          !storage.contains("once.tmp.askedPriestess")) {
+      if (!model::eventStorageContains(storage, "vars.exposition.alinea.realmKnown") ||
+          !model::eventStorageContains(storage, "once.vars.hasSpokenToalinea_claire") ||
+          !model::eventStorageContains(storage, "once.tmp.askedPriestess")) {
         LOG(ERROR) << "clearTmpStorageKeys should keep vars.* and once.*" << LOG_ENDL;
         return 1;
       }
-      if (storage.contains("tmp.calledLark") || storage.contains("tmp.otherScratch")) {
+      if (model::eventStorageContains(storage, "tmp.calledLark") ||
+          model::eventStorageContains(storage, "tmp.otherScratch")) {
         LOG(ERROR) << "clearTmpStorageKeys should erase tmp.* keys" << LOG_ENDL;
         return 1;
       }
-      if (storage.size() != 3) {
-        LOG(ERROR) << "clearTmpStorageKeys left unexpected key count: " << storage.size()
+      if (model::eventStorageSize(storage) != 3) {
+        LOG(ERROR) << "clearTmpStorageKeys left unexpected key count: "
+                   << model::eventStorageSize(storage)
                    << LOG_ENDL;
         return 1;
       }
@@ -395,7 +413,7 @@ int main(int argc, char** argv) {
       endNode.id = "end_node";
       talkEvent.children.pushBack(endNode);
 
-      runner::SpecialEventRunner talkRunner(storage, talkEvent, {});
+      runner::SpecialEventRunner talkRunner(storage, talkEvent, noEvents);
       runner::SpecialEventRunnerInterface talkIface(talkRunner);
       talkIface.startEvent();
       if (talkRunner.displayTextChoices.size() != 1 ||
@@ -407,6 +425,33 @@ int main(int argc, char** argv) {
       LOG(INFO) << "Dialogue storage persist / tmp clear test passed" << LOG_ENDL;
     }
 
+    // Test: compiled text templates render the same text as variable replacement
+    {
+      model::GameEvent compiledEvent = testEvent;
+      model::indexGameEventChildren(compiledEvent);
+      runner::compileGameEventScripts(compiledEvent, noEvents);
+      const auto& execNode =
+          std::get<model::GameEventChildExec>(compiledEvent.children[0]);
+      const auto& segments = execNode.textTemplate.segments;
+      if (segments.size() != 3 || segments[1].variableIndex != 0 ||
+          compiledEvent.variableValues.size() != 1) {
+        LOG(ERROR) << "Expected literal/variable/literal segments for root text"
+                   << LOG_ENDL;
+        return 1;
+      }
+
+      runner::SpecialEventRunner compiledRunner(initialStorage, compiledEvent, noEvents);
+      runner::SpecialEventRunnerInterface compiledIface(compiledRunner);
+      compiledIface.startEvent();
+      if (compiledRunner.displayText !=
+          "This is a test paragraph with Hello variable.") {
+        LOG(ERROR) << "Compiled text mismatch: " << compiledRunner.displayText
+                   << LOG_ENDL;
+        return 1;
+      }
+      LOG(INFO) << "Compiled text template test passed" << LOG_ENDL;
+    }
+
     LOG(INFO) << "TestSpecialEventRunner completed successfully" << LOG_ENDL;
     return 0;
   } catch (const std::exception& e) {
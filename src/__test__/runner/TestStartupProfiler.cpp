@@ -0,0 +1,131 @@
+#include "bmin/StringInterop.h"
+#include "lib/StartupProfiler.h"
+#include "sdl2w/Logger.h"
+#include <string_view>
+#include <thread>
+
+namespace {
+
+bool assertTrue(bool cond, const char* label) {
+  if (!cond) {
+    LOG(ERROR) << label << " expected true" << LOG_ENDL;
+    return false;
+  }
+  return true;
+}
+
+bool assertEqual(int actual, int expected, const char* label) {
+  if (actual != expected) {
+    LOG(ERROR) << label << " expected " << expected << " but got " << actual << LOG_ENDL;
+    return false;
+  }
+  return true;
+}
+
+bool contains(const bmin::String& haystack, std::string_view needle) {
+  return bmin::toStringView(haystack).find(needle) != std::string_view::npos;
+}
+
+// Written through a volatile pointer so the compiler cannot elide the new/delete pair.
+int* volatile allocated = nullptr;
+
+void allocateInts(size_t count) {
+  allocated = new int[count];
+  delete[] allocated;
+}
+
+const StartupPhase* findPhase(const bmin::DynArray<StartupPhase>& phases,
+                              std::string_view name) {
+  for (const auto& phase : phases) {
+    if (bmin::toStringView(phase.name) == name) {
+      return &phase;
+    }
+  }
+  return nullptr;
+}
+
+} // namespace
+
+int main() {
+  LOG(INFO) << "Starting TestStartupProfiler" << LOG_ENDL;
+  auto ok = true;
+
+  // Allocation counters are per thread and count every new.
+  {
+    const auto before = getThreadAllocationCounts();
+    allocateInts(16);
+    const auto after = getThreadAllocationCounts();
+    ok = assertEqual(static_cast<int>(after.allocations - before.allocations),
+                     1,
+                     "new[] counted") &&
+         ok;
+    ok = assertTrue(after.bytes - before.bytes >= 16 * sizeof(int), "new[] bytes") && ok;
+  }
+
+  // Disabled: scopes record nothing.
+  {
+    StartupProfiler::Scope scope("disabled");
+  }
+  ok = assertEqual(static_cast<int>(StartupProfiler::getPhases().size()),
+                   0,
+                   "disabled records nothing") &&
+       ok;
+
+  StartupProfiler::setEnabled(true);
+  {
+    StartupProfiler::Scope outer("outer");
+    {
+      StartupProfiler::Scope inner("inner");
+      for (int i = 0; i < 3; i++) {
+        allocateInts(1);
+      }
+    }
+    StartupProfiler::Scope ended("ended early");
+    ended.end();
+    std::thread worker([]() { StartupProfiler::Scope scope("worker \"job\""); });
+    worker.join();
+  }
+  StartupProfiler::setEnabled(false);
+
+  const auto phases = StartupProfiler::getPhases();
+  ok = assertEqual(static_cast<int>(phases.size()), 4, "phase count") && ok;
+  ok = assertTrue(phases.size() == 4 && phases[0].name == "outer",
+                  "parent sorts first") &&
+       ok;
+  const auto* outer = findPhase(phases, "outer");
+  const auto* inner = findPhase(phases, "inner");
+  const auto* worker = findPhase(phases, "worker \"job\"");
+  if (outer && inner && worker) {
+    ok = assertEqual(static_cast<int>(inner->depth), 1, "inner depth") && ok;
+    ok = assertEqual(static_cast<int>(inner->allocated.allocations), 3, "inner allocs") &&
+         ok;
+    ok = assertTrue(outer->allocated.allocations >= inner->allocated.allocations,
+                    "outer includes inner") &&
+         ok;
+    ok = assertTrue(outer->durationNs >= inner->durationNs, "outer outlasts inner") && ok;
+    ok = assertTrue(worker->thread != outer->thread, "worker thread index") && ok;
+    ok = assertEqual(static_cast<int>(worker->depth), 0, "worker depth") && ok;
+  } else {
+    ok = assertTrue(false, "phases found") && ok;
+  }
+
+  const auto report = StartupProfiler::formatReport();
+  ok = assertTrue(contains(report, "  inner"), "report indents nested phases") && ok;
+  const auto trace = StartupProfiler::formatChromeTrace();
+  ok = assertTrue(contains(trace, "\"name\":\"worker \\\"job\\\"\""),
+                  "trace escapes names") &&
+       ok;
+  ok = assertTrue(contains(trace, "\"args\":{\"allocations\":3,"), "trace allocations") &&
+       ok;
+
+  StartupProfiler::reset();
+  ok = assertEqual(static_cast<int>(StartupProfiler::getPhases().size()), 0, "reset") &&
+       ok;
+
+  if (ok) {
+    LOG(INFO) << "TestStartupProfiler PASSED" << LOG_ENDL;
+    return 0;
+  }
+  LOG(ERROR) << "TestStartupProfiler FAILED" << LOG_ENDL;
+  return 1;
+}
@@ -3,6 +3,7 @@
 #include "lib/bmin/Map.h"
 #include "sdl2w/Logger.h"
 #include "runner/EventRunnerHelpers.h"
+#include "runner/ScriptCompiler.h"
 #include "runner/StringEvaluator.h"
 #include "bmin/Map.h"
 
@@ -10,12 +11,12 @@
 
 int main(int argc, char** argv) {
   LOG(INFO) << "Starting " << TEST_NAME << LOG_ENDL;
-  bmin::Map<bmin::String, bmin::String> initialStorage;
+  model::EventStorage initialStorage;
   // clang-format off
-  initialStorage.insert(bmin::String("a"), bmin::String("0"));
-  initialStorage.insert(bmin::String("b"), bmin::String("1"));
-  initialStorage.insert(bmin::String("c"), bmin::String("2"));
-  initialStorage.insert(bmin::String("d"), bmin::String("3"));
+  runner::setStorage(initialStorage, "a", "0");
+  runner::setStorage(initialStorage, "b", "1");
+  runner::setStorage(initialStorage, "c", "2");
+  runner::setStorage(initialStorage, "d", "3");
   // z is undefined
   // clang-format on
 
@@ -74,7 +75,7 @@ int main(int argc, char** argv) {
     for (int i = 0; i < static_cast<int>(invalidSyntax.size()); i++) {
       const auto& [expression, expected] = invalidSyntax[i];
       if (i == runOnlyIndex || runOnlyIndex == -1) {
-        bmin::Map<bmin::String, bmin::String> storage = initialStorage;
+        model::EventStorage storage = initialStorage;
         runner::StringEvaluator evaluator(storage, expression);
         try {
           LOG(INFO) << "Running invalid syntax test " << i << ": " << expression
@@ -89,6 +90,26 @@ int main(int argc, char** argv) {
       }
     }
 
+    LOG(INFO) << "== Running compile tests ==" << LOG_ENDL;
+
+    // A bad statement is reported at compile time; the others still run.
+    {
+      bmin::DynArray<bmin::String> compileErrors;
+      const auto program = runner::compileExec(
+          "SET_NUM(num4, 2.50)\nSET_NUM(num5, abc); MOD_NUM(num4, 1)", compileErrors);
+      model::EventStorage storage = initialStorage;
+      runner::StringEvaluator evaluator(storage);
+      bmin::DynArray<bmin::String> runErrors;
+      evaluator.evalProgram(program, runErrors);
+      const bmin::String num4 = runner::getStorage(storage, "num4").value_or("");
+      if (compileErrors.size() != 1 || runErrors.size() != 1 || num4 != "3.5" ||
+          runner::getStorage(storage, "num5").has_value()) {
+        LOG(ERROR) << " Compiled exec statements ran incorrectly: num4=" << num4
+                   << LOG_ENDL;
+        failedTests.pushBack({"compileExec", num4});
+      }
+    }
+
     if (!failedTests.empty()) {
       LOG(ERROR) << "Test failed: " << failedTests.size() << " tests failed" << LOG_ENDL;
       return 1;
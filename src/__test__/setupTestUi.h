@@ -1,6 +1,8 @@
 #pragma once
 
 #include "bmin/String.h"
+#include "bmin/StringInterop.h"
+#include "lib/StartupProfiler.h"
 #include "sdl2w/AssetLoader.h"
 #include "sdl2w/Draw.h"
 #include "sdl2w/Events.h"
@@ -8,14 +10,39 @@
 #include "sdl2w/L10n.h"
 #include "sdl2w/Logger.h"
 #include "sdl2w/Window.h"
+#include "ui/SpriteAtlas.h"
 #include <functional>
+#include <initializer_list>
+#include <string_view>
+
+#if defined(MIYOOA30) || defined(MIYOOMINI)
+#include <SDL.h>
+#else
+#include <SDL2/SDL.h>
+#endif
 
 struct TestUiParams {
   int width;
   int height;
   bmin::String title = "UI Test";
+  // SDL dummy video/audio drivers + software renderer: no GPU or display needed.
+  // Also enabled by passing --headless on the command line.
+  bool headless = false;
 };
 
+// --startup-profile: log the StartupProfiler table and write it as a Chrome trace at
+// exit.
+inline constexpr char TEST_UI_STARTUP_PROFILE_PATH[] = "startup-profile.json";
+
+inline bool hasTestUiArg(int argc, char** argv, std::string_view arg) {
+  for (int i = 1; i < argc; i++) {
+    if (arg == argv[i]) {
+      return true;
+    }
+  }
+  return false;
+}
+
 // Runs after the render loop exits, while window/store are still alive.
 // Clear UI elements here so Quad and other SDL-owned resources are released
 // before the window is destroyed and SDL_Quit is called.
@@ -26,13 +53,27 @@ inline void setupTestUi(int argc,
                         std::function<bool(sdl2w::Window&, sdl2w::Store&)> _updateRender,
                         std::function<void()> _teardown = {}) {
   LOG(INFO) << "Starting UI Test: " << params.title << LOG_ENDL;
-  sdl2w::Window::init();
+  const bool headless = params.headless || hasTestUiArg(argc, argv, "--headless");
+  if (headless) {
+    // Must be set before SDL_Init picks the drivers.
+    SDL_setenv("SDL_VIDEODRIVER", "dummy", 1);
+    SDL_setenv("SDL_AUDIODRIVER", "dummy", 1);
+    LOG(INFO) << "Headless mode: dummy video driver, software renderer" << LOG_ENDL;
+  }
+  const bool profileStartup = hasTestUiArg(argc, argv, "--startup-profile");
+  StartupProfiler::setEnabled(profileStartup);
+  {
+    StartupProfiler::Scope scope("sdl2w init");
+    sdl2w::Window::init();
+  }
 
   {
     sdl2w::Store store;
+    StartupProfiler::Scope windowScope("window");
     sdl2w::Window window(store,
                          {
-                             .mode = sdl2w::DrawMode::GPU,
+                             .mode = headless ? sdl2w::DrawMode::CPU
+                                              : sdl2w::DrawMode::GPU,
                              .title = params.title.cStr(),
                              .w = params.width,
                              .h = params.height,
@@ -41,20 +82,30 @@ inline void setupTestUi(int argc,
                              .renderW = params.width,
                              .renderH = params.height,
                          });
+    windowScope.end();
 
-    sdl2w::L10n::init({{"en"}});
-    sdl2w::setupStartupArgs(argc, argv, window);
-    sdl2w::L10n::setLanguage(DISABLE_TRANSLATIONS);
+    {
+      StartupProfiler::Scope scope("l10n");
+      sdl2w::L10n::init({{"en"}});
+      sdl2w::setupStartupArgs(argc, argv, window);
+      sdl2w::L10n::setLanguage(DISABLE_TRANSLATIONS);
+    }
     window.getDraw().setBackgroundColor({0, 0, 0});
 
     sdl2w::AssetLoader assetLoader(window.getDraw(), window.getStore());
-    window.getStore().loadAndStoreFont("title", "assets/squealer.ttf");
-    window.getStore().loadAndStoreFont("default", "assets/monofonto.ttf");
-    window.getStore().loadAndStoreFont("alternate", "assets/monofonto.ttf");
-    window.getStore().loadAndStoreFont("text", "assets/notosans-regular.ttf");
-    window.getStore().loadAndStoreFont("text-bold", "assets/notosans-bold.ttf");
-    assetLoader.loadAssetsFromFile(sdl2w::ASSET_FILE, "assets/assets.ui.txt");
-    assetLoader.loadAssetsFromFile(sdl2w::ASSET_FILE, "assets/assets.game.txt");
+    auto loadFont = [&](const char* name, const char* path) {
+      StartupProfiler::Scope scope(bmin::toStringView(bmin::String("font ") + name));
+      window.getStore().loadAndStoreFont(name, path);
+    };
+    loadFont("title", "assets/squealer.ttf");
+    loadFont("default", "assets/monofonto.ttf");
+    loadFont("alternate", "assets/monofonto.ttf");
+    loadFont("text", "assets/notosans-regular.ttf");
+    loadFont("text-bold", "assets/notosans-bold.ttf");
+    for (const char* path : {"assets/assets.ui.txt", "assets/assets.game.txt"}) {
+      StartupProfiler::Scope scope(bmin::toStringView(bmin::String("asset ") + path));
+      ui::loadAssetsPreferAtlas(assetLoader, window.getStore(), path);
+    }
 
     window.setSoundPct(33);
 
@@ -89,4 +140,8 @@ inline void setupTestUi(int argc,
   }
 
   sdl2w::Window::unInit();
+  if (profileStartup) {
+    StartupProfiler::logReport();
+    StartupProfiler::writeChromeTrace(TEST_UI_STARTUP_PROFILE_PATH);
+  }
 }
@@ -0,0 +1,266 @@
+#include "../../setupTestUi.h"
+#include "bmin/DynArray.h"
+#include "bmin/String.h"
+#include "bmin/StringInterop.h"
+#include "bmin/UniquePtr.h"
+#include "db/Database.h"
+#include "game/map/ActiveMapOrchestrator.h"
+#include "game/map/MapPersistence.h"
+#include "game/map/MapVision.h"
+#include "game/map/TileTriggers.h"
+#include "layers/LayerManager.h"
+#include "layers/ui/LayerWorld.h"
+#include "model/instances/CharacterPlayer.h"
+#include "sdl2w/Draw.h"
+#include "sdl2w/Logger.h"
+#include "sdl2w/Window.h"
+#include "state/DatabaseInterface.h"
+#include "state/LayerManagerInterface.h"
+#include "state/StateManagerInterface.h"
+#include "state/actions/world/WorldLoadActiveMap.hpp"
+#include "state/actions/world/WorldSpawnPlayerAtMarker.hpp"
+#include "ui/RenderStats.h"
+#include "ui/SdlPixels.h" // IWYU pragma: keep
+#include "ui/components/MapView.h"
+#include "ui/layouts/InGameLayout.h"
+#include <algorithm>
+#include <iterator>
+
+// Render benchmark: loads a real map from assets/db, moves the party avatar through
+// scripted positions and times MapView, InGameLayout and LayerWorld renders
+// separately. Runs headless by default (see test-runners/ui/BenchRenderWorld.sh).
+//
+// Args: --frames <n per phase> --map <map name> --headless
+
+namespace {
+
+constexpr int FIXED_DT_MS = 16;
+
+constexpr const char* BENCH_PARTY_TEMPLATE_NAMES[] = {
+    "testPartyMember1",
+    "testPartyMember2",
+    "testPartyMember3",
+    "testPartyMember4",
+    "testPartyMember5",
+    "testPartyMember6",
+};
+
+// Tile offsets from MarkerPlayer; clamped to the map bounds.
+constexpr int BENCH_POSITION_OFFSETS[][2] = {
+    {0, 0}, {6, 0}, {6, 6}, {0, 6}, {-6, 3}, {-6, -6}, {3, -6}, {0, 0},
+};
+
+enum class BenchPhase { MAP_VIEW, IN_GAME_LAYOUT, LAYER_WORLD, DONE };
+
+struct PhaseSamples {
+  const char* name = "";
+  bmin::DynArray<double> frameMs;
+  bmin::DynArray<ui::RenderStats> drawCalls;
+};
+
+bmin::String getArgValue(int argc, char** argv, std::string_view arg) {
+  for (int i = 1; i + 1 < argc; i++) {
+    if (arg == argv[i]) {
+      return bmin::String(argv[i + 1]);
+    }
+  }
+  return bmin::String();
+}
+
+void setupBenchParty(model::Player& player, db::Database& database) {
+  player.party.clear();
+  player.currentPartyMemberIndex = 0;
+  for (const auto* templateName : BENCH_PARTY_TEMPLATE_NAMES) {
+    player.party.pushBack(
+        model::CharacterPlayer(database.getCharacterTemplate(templateName)));
+  }
+}
+
+double percentile(const bmin::DynArray<double>& sorted, double pct) {
+  if (sorted.empty()) {
+    return 0.;
+  }
+  // Nearest-rank.
+  auto rank = static_cast<size_t>(pct / 100. * static_cast<double>(sorted.size()));
+  rank = std::min(rank, sorted.size() - 1);
+  return sorted[rank];
+}
+
+void reportPhase(const PhaseSamples& samples) {
+  if (samples.frameMs.empty()) {
+    return;
+  }
+  auto sorted = samples.frameMs;
+  std::sort(sorted.begin(), sorted.end());
+
+  double totalMs = 0.;
+  for (const auto ms : sorted) {
+    totalMs += ms;
+  }
+  ui::RenderStats drawTotals;
+  for (const auto& stats : samples.drawCalls) {
+    drawTotals.sprites += stats.sprites;
+    drawTotals.rects += stats.rects;
+    drawTotals.lines += stats.lines;
+    drawTotals.text += stats.text;
+    drawTotals.renderTargets += stats.renderTargets;
+  }
+  const auto frames = static_cast<double>(sorted.size());
+
+  LOG(INFO) << samples.name << ": frames=" << static_cast<int>(sorted.size())
+            << " mean=" << totalMs / frames << "ms p50=" << percentile(sorted, 50.)
+            << "ms p90=" << percentile(sorted, 90.)
+            << "ms p99=" << percentile(sorted, 99.) << "ms max=" << sorted.back() << "ms"
+            << LOG_ENDL;
+  LOG(INFO) << samples.name << ": draw calls/frame=" << drawTotals.total() / frames
+            << " (sprites=" << drawTotals.sprites / frames
+            << " rects=" << drawTotals.rects / frames
+            << " lines=" << drawTotals.lines / frames
+            << " text=" << drawTotals.text / frames
+            << " renderTargets=" << drawTotals.renderTargets / frames << ")" << LOG_ENDL;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+  LOG(INFO) << "Start render benchmark" << LOG_ENDL;
+
+  auto framesPerPhase = 300;
+  const auto framesArg = getArgValue(argc, argv, "--frames");
+  if (!framesArg.empty() && bmin::isInt(framesArg)) {
+    framesPerPhase = std::max(1, bmin::parseInt(framesArg));
+  }
+  auto mapName = getArgValue(argc, argv, "--map");
+  if (mapName.empty()) {
+    mapName = "OutsideAlinea";
+  }
+
+  db::Database database;
+  state::DatabaseInterface::setDatabase(&database);
+  database.load();
+
+  state::StateManager stateManager;
+  state::StateManagerInterface::setStateManager(&stateManager);
+  setupBenchParty(stateManager.getState().player, database);
+
+  auto spawnX = 0;
+  auto spawnY = 0;
+  auto mapW = 0;
+  auto mapH = 0;
+  {
+    auto& state = stateManager.getState();
+    game::createMapInstances(state, database);
+
+    auto loadMap = state::actions::WorldLoadActiveMap(mapName);
+    loadMap.execute(&state);
+    auto spawnPlayer = state::actions::WorldSpawnPlayerAtMarker("MarkerPlayer");
+    spawnPlayer.execute(&state);
+
+    game::ActiveMapOrchestrator orch;
+    orch.fetchMapGrid(state.world.activeMap.gridId);
+    const auto total = orch.getTotalMapTilesSize();
+    mapW = total.x;
+    mapH = total.y;
+    if (const auto* avatar = orch.findCharacterById(state.player.party[0].instanceId)) {
+      spawnX = avatar->x;
+      spawnY = avatar->y;
+    }
+  }
+
+  const auto numPositions = static_cast<int>(std::size(BENCH_POSITION_OFFSETS));
+  auto moveToScriptedPosition = [&](int frame) {
+    const auto framesPerPosition = std::max(1, framesPerPhase / numPositions);
+    if (frame % framesPerPosition != 0) {
+      return;
+    }
+    const auto positionIndex = (frame / framesPerPosition) % numPositions;
+    const auto& offset = BENCH_POSITION_OFFSETS[positionIndex];
+    const auto x = std::clamp(spawnX + offset[0], 0, std::max(0, mapW - 1));
+    const auto y = std::clamp(spawnY + offset[1], 0, std::max(0, mapH - 1));
+    auto& state = stateManager.getState();
+    game::placePartyAvatarAt(state.world.activeMap, state.player, x, y, &database);
+    game::updateActiveMapVisibilityFromPlayer(state.world, x, y, database);
+  };
+
+  bmin::UniquePtr<layers::LayerManager> layerManager;
+  layers::LayerWorld* layerWorld = nullptr;
+  ui::MapView* mapView = nullptr;
+  ui::InGameLayout* inGameLayout = nullptr;
+
+  PhaseSamples phases[] = {
+      {.name = "MapView"}, {.name = "InGameLayout"}, {.name = "LayerWorld"}};
+  auto phase = BenchPhase::MAP_VIEW;
+  auto phaseFrame = 0;
+
+  auto _init = [&](sdl2w::Window& window, sdl2w::Store& store) {
+    layerManager = bmin::makeUnique<layers::LayerManager>(&window);
+    state::LayerManagerInterface::setLayerManager(layerManager.get());
+
+    layerWorld = new layers::LayerWorld(&window);
+    layerWorld->setMapScale(2.f);
+    layerManager->addLayer(layerWorld);
+    mapView = layerWorld->getUiElement<ui::MapView>("mapView");
+    inGameLayout = layerWorld->getUiElement<ui::InGameLayout>("inGameLayout");
+
+    for (auto& samples : phases) {
+      samples.frameMs.reserve(static_cast<size_t>(framesPerPhase));
+      samples.drawCalls.reserve(static_cast<size_t>(framesPerPhase));
+    }
+    LOG(INFO) << "Benchmarking " << mapName << " (" << mapW << "x" << mapH << " tiles), "
+              << framesPerPhase << " frames per phase" << LOG_ENDL;
+  };
+
+  auto _updateRender = [&](sdl2w::Window& window, sdl2w::Store& store) {
+    if (phase == BenchPhase::DONE || !mapView || !inGameLayout) {
+      return false;
+    }
+
+    moveToScriptedPosition(phaseFrame);
+    // Fixed dt keeps camera and animation state identical between runs.
+    layerManager->update(FIXED_DT_MS);
+    stateManager.update(FIXED_DT_MS);
+
+    auto& draw = window.getDraw();
+    draw.setBackgroundColor(SDL_Color{100, 100, 100, 255});
+    draw.clearScreen();
+
+    auto& samples = phases[static_cast<int>(phase)];
+    ui::resetRenderStats();
+    const auto start = SDL_GetPerformanceCounter();
+    switch (phase) {
+    case BenchPhase::MAP_VIEW:
+      mapView->render(FIXED_DT_MS);
+      break;
+    case BenchPhase::IN_GAME_LAYOUT:
+      inGameLayout->render(FIXED_DT_MS);
+      break;
+    case BenchPhase::LAYER_WORLD:
+      layerWorld->render(FIXED_DT_MS);
+      break;
+    case BenchPhase::DONE:
+      break;
+    }
+    const auto end = SDL_GetPerformanceCounter();
+    samples.frameMs.pushBack(static_cast<double>(end - start) * 1000. /
+                             static_cast<double>(SDL_GetPerformanceFrequency()));
+    samples.drawCalls.pushBack(ui::renderStats());
+
+    if (++phaseFrame >= framesPerPhase) {
+      phaseFrame = 0;
+      phase = static_cast<BenchPhase>(static_cast<int>(phase) + 1);
+    }
+    return phase != BenchPhase::DONE;
+  };
+
+  TestUiParams params{800, 600, "Render Benchmark"};
+  params.headless = true;
+  setupTestUi(argc, argv, params, _init, _updateRender, [&]() {
+    for (const auto& samples : phases) {
+      reportPhase(samples);
+    }
+    layerManager.reset();
+  });
+
+  LOG(INFO) << "End render benchmark" << LOG_ENDL;
+  return 0;
+}
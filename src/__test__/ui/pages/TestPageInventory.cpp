@@ -105,7 +105,8 @@ int main(int argc, char** argv) {
     pageProps.width = static_cast<int>(windowWidth / scale);
     pageProps.height = static_cast<int>(windowHeight / scale);
     pageProps.characterPlayerId = characterPlayer.instanceId;
-    pageProps.characterPlayerLabel = characterPlayer.params.label;
+    pageProps.characterPlayerLabel =
+        model::characterPlayerGetParams(characterPlayer).label;
     pageProps.partyMemberInventoryIndex = player.currentPartyMemberInventoryIndex;
     for (const auto& member : player.party) {
       pageProps.partyMembers.pushBack(
@@ -0,0 +1,220 @@
+#include "../../setupTestUi.h"
+#include "bmin/DynArray.h"
+#include "bmin/Map.h"
+#include "bmin/String.h"
+#include "bmin/StringInterop.h"
+#include "sdl2w/Draw.h"
+#include "sdl2w/Store.h"
+#include "ui/SpriteAtlas.h"
+#include <cassert>
+#include <iostream>
+#include <stdexcept>
+#include <string_view>
+
+namespace {
+
+constexpr char ASSET_FILE[] = "# test sheets\n"
+                              "Pic,tiles,img/tiles.png\n"
+                              "Sprites,tiles,6,10,10\n"
+                              "Pic,big,img/big.png\n"
+                              "Sprites,big,2,40,30\n"
+                              "Pic,big_half,img/big.png\n"
+                              "Sprites,big_half,4,20,30\n"
+                              "Pic,overlay,img/overlay.png\n"
+                              "Sound,hit,snd/hit.wav\n"
+                              "Anim,flash,noloop\n"
+                              "tiles_1 100\n"
+                              "EndAnim\n";
+
+const ui::AtlasSprite& findSprite(const ui::SpriteAtlasLayout& layout,
+                                  const char* name) {
+  for (const auto& sprite : layout.sprites) {
+    if (sprite.name == name) {
+      return sprite;
+    }
+  }
+  throw std::runtime_error(name);
+}
+
+bool overlaps(const ui::AtlasImage& a, const ui::AtlasImage& b) {
+  return a.page == b.page && a.x < b.x + b.width && b.x < a.x + a.width &&
+         a.y < b.y + b.height && b.y < a.y + a.height;
+}
+
+void testParse() {
+  const auto assetFile = ui::parseSpriteAssetFile(ASSET_FILE);
+  assert(assetFile.sheets.size() == 3);
+  assert(assetFile.sheets[0].alias == "tiles");
+  assert(assetFile.sheets[0].path == "img/tiles.png");
+  assert(assetFile.sheets[0].count == 6);
+  assert(assetFile.sheets[2].alias == "big_half");
+  assert(assetFile.sheets[2].path == "img/big.png");
+  assert(assetFile.sheets[2].width == 20);
+
+  // Sheets are dropped; the Pic without sprites, sounds and animations stay.
+  const auto& passThrough = assetFile.passThrough;
+  assert(passThrough.find("Sprites") == bmin::String::npos);
+  assert(passThrough.find("Pic,tiles") == bmin::String::npos);
+  assert(passThrough.find("Pic,overlay,img/overlay.png") != bmin::String::npos);
+  assert(passThrough.find("Sound,hit,snd/hit.wav") != bmin::String::npos);
+  assert(passThrough.find("Anim,flash,noloop\ntiles_1 100\nEndAnim") !=
+         bmin::String::npos);
+
+  bool threw = false;
+  try {
+    ui::parseSpriteAssetFile("Sprites,missing,4,8,8\n");
+  } catch (const std::runtime_error&) {
+    threw = true;
+  }
+  assert(threw);
+}
+
+void testPack() {
+  const auto assetFile = ui::parseSpriteAssetFile(ASSET_FILE);
+  bmin::Map<bmin::String, ui::ImageSize> sizes;
+  // tiles holds 2x2 cells of the 6 it declares.
+  sizes["img/tiles.png"] = ui::ImageSize{20, 20};
+  sizes["img/big.png"] = ui::ImageSize{40, 60};
+
+  const auto layout = ui::packSpriteAtlas(assetFile.sheets, sizes, "test", "out", 128);
+  assert(layout.pages.size() == 1);
+  assert(layout.pages[0].alias == "atlas_test_0");
+  assert(layout.pages[0].path == "out/test_0.png");
+  assert(layout.images.size() == 2);
+  assert(!overlaps(layout.images[0], layout.images[1]));
+  assert(layout.sprites.size() == 12);
+
+  // Names and cell sizes are those of the source sheets.
+  const auto& tile3 = findSprite(layout, "tiles_3");
+  const auto& tiles = layout.images[0];
+  assert(tile3.atlas == "atlas_test_0");
+  assert(tile3.x == tiles.x + 10 && tile3.y == tiles.y + 10);
+  assert(tile3.w == 10 && tile3.h == 10);
+  // Two sheets over one picture share its copy.
+  const auto& big1 = findSprite(layout, "big_1");
+  const auto& half2 = findSprite(layout, "big_half_2");
+  assert(big1.x == half2.x && big1.y == half2.y && big1.w == 40 && half2.w == 20);
+
+  // Cells beyond the picture share one rect outside every picture.
+  const auto& tile4 = findSprite(layout, "tiles_4");
+  const auto& tile5 = findSprite(layout, "tiles_5");
+  assert(tile4.x == tile5.x && tile4.y == tile5.y && tile4.w == 10);
+  for (const auto& image : layout.images) {
+    assert(!overlaps(image, ui::AtlasImage{.x = tile4.x, .y = tile4.y, .width = 10,
+                                           .height = 10}));
+  }
+  for (const auto& sprite : layout.sprites) {
+    assert(sprite.x + sprite.w <= layout.pages[0].width);
+    assert(sprite.y + sprite.h <= layout.pages[0].height);
+  }
+
+  // A smaller page size spills onto a second page.
+  const auto paged = ui::packSpriteAtlas(assetFile.sheets, sizes, "test", "out", 64);
+  assert(paged.pages.size() == 2);
+  assert(paged.pages[1].alias == "atlas_test_1");
+
+  // big is 60 pixels tall once cropped.
+  bool threw = false;
+  try {
+    ui::packSpriteAtlas(assetFile.sheets, sizes, "test", "out", 50);
+  } catch (const std::runtime_error&) {
+    threw = true;
+  }
+  assert(threw);
+}
+
+void testManifest() {
+  const auto assetFile = ui::parseSpriteAssetFile(ASSET_FILE);
+  bmin::Map<bmin::String, ui::ImageSize> sizes;
+  sizes["img/tiles.png"] = ui::ImageSize{20, 20};
+  sizes["img/big.png"] = ui::ImageSize{40, 60};
+  const auto layout = ui::packSpriteAtlas(assetFile.sheets, sizes, "test", "out", 64);
+
+  const auto parsed =
+      ui::parseAtlasSprites(bmin::toStringView(ui::formatAtlasSprites(layout)));
+  assert(ui::formatAtlasSprites(parsed) == ui::formatAtlasSprites(layout));
+  assert(parsed.pages.size() == layout.pages.size());
+  assert(parsed.images.size() == layout.images.size());
+  assert(parsed.sprites.size() == layout.sprites.size());
+
+  const auto atlasAssetFile =
+      ui::formatAtlasAssetFile(layout, bmin::toStringView(assetFile.passThrough));
+  assert(atlasAssetFile.find("Pic,atlas_test_0,out/test_0.png") != bmin::String::npos);
+  assert(atlasAssetFile.find("Pic,atlas_test_1,out/test_1.png") != bmin::String::npos);
+  assert(atlasAssetFile.find("Sound,hit,snd/hit.wav") != bmin::String::npos);
+
+  bool threw = false;
+  try {
+    ui::parseAtlasSprites("Sprite,tiles_0,atlas_missing,0,0,10,10\n");
+  } catch (const std::runtime_error&) {
+    threw = true;
+  }
+  assert(threw);
+
+  // Rejected before loading: a page missing from the asset file, a sprite outside its
+  // page, and a page picture that does not exist.
+  auto validateThrows = [](const ui::SpriteAtlasLayout& candidate,
+                           std::string_view atlasAssetFile) {
+    try {
+      ui::validateSpriteAtlas(candidate, atlasAssetFile);
+    } catch (const std::runtime_error&) {
+      return true;
+    }
+    return false;
+  };
+  assert(validateThrows(layout, "Sound,hit,snd/hit.wav\n"));
+  auto outside = layout;
+  outside.sprites[0].x = outside.pages[0].width;
+  assert(validateThrows(outside, bmin::toStringView(atlasAssetFile)));
+  // out/test_0.png is never written.
+  assert(validateThrows(layout, bmin::toStringView(atlasAssetFile)));
+
+  assert(ui::getAtlasAssetFilePath("assets/assets.game.txt", "assets/atlas") ==
+         "assets/atlas/assets.game.txt");
+  assert(ui::getAtlasSpritesPath("assets/assets.game.txt", "assets/atlas") ==
+         "assets/atlas/assets.game.sprites.txt");
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+  testParse();
+  testPack();
+  testManifest();
+
+  // Shows sprites by their original names; they come from assets/atlas when ATLASPACK
+  // has been run (see the log), else from the source sheets.
+  const bmin::DynArray<bmin::String> previewSheets{
+      "terrain0", "terrain_borders", "actors0", "portraits0", "projectiles"};
+
+  auto _init = [&](sdl2w::Window& window, sdl2w::Store& store) {
+    (void)window;
+    (void)store;
+  };
+
+  auto _updateRender = [&](sdl2w::Window& window, sdl2w::Store& store) {
+    auto& draw = window.getDraw();
+    for (size_t row = 0; row < previewSheets.size(); row++) {
+      for (int i = 0; i < 16; i++) {
+        const bmin::String name = previewSheets[row] + "_" + bmin::toString(i);
+        draw.drawSprite(store.getSprite(bmin::toStringView(name)),
+                        sdl2w::RenderableParams{
+                            .scale = {1.0, 1.0},
+                            .x = 20 + i * 56,
+                            .y = 20 + static_cast<int>(row) * 60,
+                            .centered = false,
+                        });
+      }
+    }
+    return true;
+  };
+
+  setupTestUi(argc,
+              argv,
+              TestUiParams{940, 340, "System Sprite Atlas Preview"},
+              _init,
+              _updateRender);
+
+  std::cout << "TestSystemSpriteAtlas passed\n";
+  return 0;
+}
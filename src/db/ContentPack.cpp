@@ -0,0 +1,1195 @@
+#include "ContentPack.h"
+#include "bmin/StringInterop.h"
+#include "db/Database.h"
+#include "db/loaders/LoadSpecialEvents.h"
+#include "game/save/SaveBinary.h"
+#include "runner/EventBundle.h"
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <optional>
+#include <stdexcept>
+#include <string>
+
+#if !defined(__EMSCRIPTEN__) && !defined(_WIN32)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace db {
+
+namespace {
+
+constexpr size_t CONTENT_PACK_HEADER_SIZE = 4 + 2 + 4 + 4;
+
+struct PackContext {
+  game::SaveStringTable strings;
+};
+
+// bmin::Map iteration needs a non-const begin(); keys are sorted so that the same
+// content always encodes to the same bytes.
+template <typename V>
+bmin::DynArray<const V*> sortedValues(const bmin::Map<bmin::String, V>& map) {
+  auto& mutableMap = const_cast<bmin::Map<bmin::String, V>&>(map);
+  bmin::DynArray<bmin::String> keys;
+  for (auto it = mutableMap.begin(); it != mutableMap.end(); ++it) {
+    keys.pushBack((*it).key);
+  }
+  std::sort(keys.begin(), keys.end());
+  bmin::DynArray<const V*> values;
+  values.reserve(keys.size());
+  for (const auto& key : keys) {
+    values.pushBack(&(*mutableMap.find(key)).value);
+  }
+  return values;
+}
+
+template <typename Enum>
+void writeEnum(game::SaveWriter& w, Enum value) {
+  w.writeU8(static_cast<uint8_t>(value));
+}
+
+template <typename Enum>
+Enum readEnum(game::SaveReader& r, Enum maxValue) {
+  const uint8_t value = r.readU8();
+  if (value > static_cast<uint8_t>(maxValue)) {
+    throw std::runtime_error("Content pack enum value out of range");
+  }
+  return static_cast<Enum>(value);
+}
+
+void writeFloat(game::SaveWriter& w, float value) {
+  w.writeU32(std::bit_cast<uint32_t>(value));
+}
+
+float readFloat(game::SaveReader& r) {
+  return std::bit_cast<float>(r.readU32());
+}
+
+void writeOptionalInt(game::SaveWriter& w, const std::optional<int>& value) {
+  w.writeBool(value.has_value());
+  if (value.has_value()) {
+    w.writeVarInt(*value);
+  }
+}
+
+std::optional<int> readOptionalInt(game::SaveReader& r) {
+  if (!r.readBool()) {
+    return std::nullopt;
+  }
+  return r.readInt();
+}
+
+void writeStrings(game::SaveWriter& w,
+                  PackContext& ctx,
+                  const bmin::DynArray<bmin::String>& values) {
+  w.writeVarUint(values.size());
+  for (const auto& value : values) {
+    w.writeString(ctx.strings, value);
+  }
+}
+
+bmin::DynArray<bmin::String> readStrings(game::SaveReader& r, const PackContext& ctx) {
+  bmin::DynArray<bmin::String> values;
+  const int count = r.readCount();
+  values.reserve(count);
+  for (int i = 0; i < count; i++) {
+    values.pushBack(r.readString(ctx.strings));
+  }
+  return values;
+}
+
+// Tile layers: count, then count little-endian int32s copied in one go on load.
+void writeTileArray(game::SaveWriter& w, const bmin::DynArray<int>& values) {
+  w.writeVarUint(values.size());
+  for (const int value : values) {
+    w.writeU32(static_cast<uint32_t>(value));
+  }
+}
+
+bmin::DynArray<int> readTileArray(game::SaveReader& r) {
+  const auto count = static_cast<size_t>(r.readVarUint());
+  if (count > r.remaining() / 4) {
+    throw std::runtime_error("Content pack tile array out of range");
+  }
+  const auto bytes = r.readBytes(count * 4);
+  bmin::DynArray<int> values;
+  values.resize(count);
+  if constexpr (std::endian::native == std::endian::little) {
+    if (count > 0) {
+      std::memcpy(values.data(), bytes.data(), bytes.size());
+    }
+  } else {
+    for (size_t i = 0; i < count; i++) {
+      uint32_t value = 0;
+      for (size_t b = 0; b < 4; b++) {
+        value |= static_cast<uint32_t>(static_cast<uint8_t>(bytes[i * 4 + b])) << (b * 8);
+      }
+      values[i] = static_cast<int>(value);
+    }
+  }
+  return values;
+}
+
+void writeDice(game::SaveWriter& w, const bmin::DynArray<model::Dice>& dice) {
+  w.writeVarUint(dice.size());
+  for (const auto die : dice) {
+    writeEnum(w, die);
+  }
+}
+
+bmin::DynArray<model::Dice> readDice(game::SaveReader& r) {
+  bmin::DynArray<model::Dice> dice;
+  const int count = r.readCount();
+  for (int i = 0; i < count; i++) {
+    dice.pushBack(readEnum(r, model::Dice::D100));
+  }
+  return dice;
+}
+
+void writeSave(game::SaveWriter& w, const model::AbilitySave& save) {
+  writeEnum(w, save.saveStat);
+  w.writeVarInt(save.saveBase);
+  writeEnum(w, save.saveAgainst);
+  w.writeVarInt(save.saveAgainstBase);
+}
+
+model::AbilitySave readSave(game::SaveReader& r) {
+  model::AbilitySave save;
+  save.saveStat = readEnum(r, model::StatsEnum::STAT_LCK);
+  save.saveBase = r.readInt();
+  save.saveAgainst = readEnum(r, model::StatsEnum::STAT_LCK);
+  save.saveAgainstBase = r.readInt();
+  return save;
+}
+
+void writeOptionalSave(game::SaveWriter& w,
+                       const std::optional<model::AbilitySave>& save) {
+  w.writeBool(save.has_value());
+  if (save.has_value()) {
+    writeSave(w, *save);
+  }
+}
+
+std::optional<model::AbilitySave> readOptionalSave(game::SaveReader& r) {
+  if (!r.readBool()) {
+    return std::nullopt;
+  }
+  return readSave(r);
+}
+
+void writeAttackDmg(game::SaveWriter& w, const model::AbilityAttackDmg& dmg) {
+  writeDice(w, dmg.dmgDice);
+  w.writeVarInt(dmg.dmgBonus);
+  writeEnum(w, dmg.dmgStat);
+  w.writeVarInt(dmg.dmgStatMult);
+  w.writeVarInt(dmg.attackBonus);
+}
+
+model::AbilityAttackDmg readAttackDmg(game::SaveReader& r) {
+  model::AbilityAttackDmg dmg;
+  dmg.dmgDice = readDice(r);
+  dmg.dmgBonus = r.readInt();
+  dmg.dmgStat = readEnum(r, model::StatsEnum::STAT_LCK);
+  dmg.dmgStatMult = r.readInt();
+  dmg.attackBonus = r.readInt();
+  return dmg;
+}
+
+void writeAttackDmgs(game::SaveWriter& w,
+                     const bmin::DynArray<model::AbilityAttackDmg>& dmgs) {
+  w.writeVarUint(dmgs.size());
+  for (const auto& dmg : dmgs) {
+    writeAttackDmg(w, dmg);
+  }
+}
+
+bmin::DynArray<model::AbilityAttackDmg> readAttackDmgs(game::SaveReader& r) {
+  bmin::DynArray<model::AbilityAttackDmg> dmgs;
+  const int count = r.readCount();
+  for (int i = 0; i < count; i++) {
+    dmgs.pushBack(readAttackDmg(r));
+  }
+  return dmgs;
+}
+
+void writeRestore(game::SaveWriter& w, const model::AbilityRestore& restore) {
+  writeEnum(w, restore.restoreWhich);
+  writeDice(w, restore.restoreDice);
+  w.writeVarInt(restore.restoreBonus);
+  writeEnum(w, restore.restoreStat);
+  w.writeVarInt(restore.restoreStatMult);
+}
+
+model::AbilityRestore readRestore(game::SaveReader& r) {
+  model::AbilityRestore restore;
+  restore.restoreWhich = readEnum(r, model::CurrentStatEnum::CURRENT_STAT_AC);
+  restore.restoreDice = readDice(r);
+  restore.restoreBonus = r.readInt();
+  restore.restoreStat = readEnum(r, model::StatsEnum::STAT_LCK);
+  restore.restoreStatMult = r.readInt();
+  return restore;
+}
+
+void writeRestores(game::SaveWriter& w,
+                   const bmin::DynArray<model::AbilityRestore>& restores) {
+  w.writeVarUint(restores.size());
+  for (const auto& restore : restores) {
+    writeRestore(w, restore);
+  }
+}
+
+bmin::DynArray<model::AbilityRestore> readRestores(game::SaveReader& r) {
+  bmin::DynArray<model::AbilityRestore> restores;
+  const int count = r.readCount();
+  for (int i = 0; i < count; i++) {
+    restores.pushBack(readRestore(r));
+  }
+  return restores;
+}
+
+// --- status effects
+
+void writeStatusEffect(game::SaveWriter& w,
+                       PackContext& ctx,
+                       const model::StatusEffectTemplate& status) {
+  w.writeString(ctx.strings, status.name);
+  w.writeString(ctx.strings, status.description);
+  w.writeVarInt(status.baseDuration);
+  w.writeBool(status.durationScale.has_value());
+  if (status.durationScale.has_value()) {
+    writeEnum(w, status.durationScale->durationStat);
+    w.writeVarInt(status.durationScale->durationStatMult);
+  }
+  w.writeBool(status.applyBonuses.has_value());
+  if (status.applyBonuses.has_value()) {
+    const auto& bonuses = *status.applyBonuses;
+    for (const int value :
+         {bonuses.STR, bonuses.MND, bonuses.CON, bonuses.AGI, bonuses.LCK}) {
+      w.writeVarInt(value);
+    }
+  }
+  w.writeBool(status.applyCurrentStatChange.has_value());
+  if (status.applyCurrentStatChange.has_value()) {
+    const auto& change = *status.applyCurrentStatChange;
+    for (const int value : {change.HP, change.AP, change.MANA, change.AC}) {
+      w.writeVarInt(value);
+    }
+  }
+  w.writeVarUint(status.applyResistances.size());
+  for (const auto& resistance : status.applyResistances) {
+    writeEnum(w, resistance.attackType);
+    w.writeVarInt(resistance.mod);
+  }
+  w.writeVarUint(status.actions.size());
+  for (const auto& action : status.actions) {
+    writeEnum(w, action.statusActionTargetType);
+    w.writeString(ctx.strings, action.abilityName);
+    w.writeVarUint(action.events.size());
+    for (const auto& event : action.events) {
+      writeEnum(w, event.type);
+      writeEnum(w, event.condition);
+    }
+  }
+}
+
+model::StatusEffectTemplate readStatusEffect(game::SaveReader& r,
+                                             const PackContext& ctx) {
+  model::StatusEffectTemplate status;
+  status.name = r.readString(ctx.strings);
+  status.description = r.readString(ctx.strings);
+  status.baseDuration = r.readInt();
+  if (r.readBool()) {
+    model::StatusEffectDurationScale scale;
+    scale.durationStat = readEnum(r, model::StatsEnum::STAT_LCK);
+    scale.durationStatMult = r.readInt();
+    status.durationScale = scale;
+  }
+  if (r.readBool()) {
+    model::Stats bonuses;
+    for (int* value :
+         {&bonuses.STR, &bonuses.MND, &bonuses.CON, &bonuses.AGI, &bonuses.LCK}) {
+      *value = r.readInt();
+    }
+    status.applyBonuses = bonuses;
+  }
+  if (r.readBool()) {
+    model::CurrentStats change;
+    for (int* value : {&change.HP, &change.AP, &change.MANA, &change.AC}) {
+      *value = r.readInt();
+    }
+    status.applyCurrentStatChange = change;
+  }
+  const int resistanceCount = r.readCount();
+  for (int i = 0; i < resistanceCount; i++) {
+    model::Resistance resistance;
+    resistance.attackType = readEnum(r, model::DamageType::DAMAGE_TYPE_TRUE);
+    resistance.mod = r.readInt();
+    status.applyResistances.pushBack(resistance);
+  }
+  const int actionCount = r.readCount();
+  for (int i = 0; i < actionCount; i++) {
+    model::StatusEffectAction action;
+    action.statusActionTargetType = readEnum(
+        r, model::StatusActionTargetType::STATUS_ACTION_TARGET_LAST_LOCATION);
+    action.abilityName = r.readString(ctx.strings);
+    const int eventCount = r.readCount();
+    for (int j = 0; j < eventCount; j++) {
+      model::StatusEffectEvent event;
+      event.type = readEnum(r, model::StatusEventType::STATUS_EVENT_ON_ROUND_START);
+      event.condition =
+          readEnum(r, model::StatusEffectCondition::CONDITION_FIRST_TIME_ATTACKED);
+      action.events.pushBack(event);
+    }
+    status.actions.pushBack(std::move(action));
+  }
+  return status;
+}
+
+// --- abilities
+
+void writeAbility(game::SaveWriter& w,
+                  PackContext& ctx,
+                  const model::AbilityTemplate& ability) {
+  w.writeString(ctx.strings, ability.name);
+  w.writeString(ctx.strings, ability.label);
+  w.writeString(ctx.strings, ability.description);
+  w.writeString(ctx.strings, ability.icon);
+  writeEnum(w, ability.type);
+  writeEnum(w, ability.targetSelect.targetType);
+  writeEnum(w, ability.targetSelect.allegianceSelectType);
+  w.writeVarInt(ability.targetSelect.numTargetableUnits);
+  w.writeVarInt(ability.targetSelect.zoneSize.x);
+  w.writeVarInt(ability.targetSelect.zoneSize.y);
+  w.writeVarInt(ability.targetSelect.range);
+  w.writeVarInt(ability.apCost);
+  writeEnum(w, ability.costType);
+  w.writeVarInt(ability.costValue);
+  w.writeString(ctx.strings, ability.depiction.dmgAnim);
+  writeEnum(w, ability.depiction.projectileType);
+  writeEnum(w, ability.depiction.projectilePath);
+  w.writeString(ctx.strings, ability.depiction.startSound);
+  w.writeString(ctx.strings, ability.depiction.dmgSound);
+  w.writeVarUint(ability.attacks.size());
+  for (const auto& attack : ability.attacks) {
+    writeEnum(w, attack.attackClass);
+    w.writeBool(attack.dmg.has_value());
+    if (attack.dmg.has_value()) {
+      writeAttackDmg(w, *attack.dmg);
+    }
+    writeOptionalSave(w, attack.save);
+  }
+  w.writeVarUint(ability.statuses.size());
+  for (const auto& status : ability.statuses) {
+    w.writeString(ctx.strings, status.statusEffect);
+    writeOptionalSave(w, status.save);
+    writeOptionalInt(w, status.baseDuration);
+    writeOptionalInt(w, status.durationBonus);
+  }
+  writeRestores(w, ability.restores);
+}
+
+model::AbilityTemplate readAbility(game::SaveReader& r, const PackContext& ctx) {
+  model::AbilityTemplate ability;
+  ability.name = r.readString(ctx.strings);
+  ability.label = r.readString(ctx.strings);
+  ability.description = r.readString(ctx.strings);
+  ability.icon = r.readString(ctx.strings);
+  ability.type = readEnum(r, model::AbilityType::ABILITY_SUB_ATTACK);
+  ability.targetSelect.targetType =
+      readEnum(r, model::TargetSelectType::TARGET_ALL_IN_RANGE);
+  ability.targetSelect.allegianceSelectType = readEnum(
+      r, model::TargetAllegianceSelectType::TARGET_ALLEGIANCE_ALL_AND_SELF);
+  ability.targetSelect.numTargetableUnits = r.readInt();
+  ability.targetSelect.zoneSize.x = r.readInt();
+  ability.targetSelect.zoneSize.y = r.readInt();
+  ability.targetSelect.range = r.readInt();
+  ability.apCost = r.readInt();
+  ability.costType = readEnum(r, model::AbilityCostType::ABILITY_COST_HP);
+  ability.costValue = r.readInt();
+  ability.depiction.dmgAnim = r.readString(ctx.strings);
+  ability.depiction.projectileType =
+      readEnum(r, model::ProjectileType::ARROW_NORMAL);
+  ability.depiction.projectilePath =
+      readEnum(r, model::ProjectilePath::PROJECTILE_PATH_NONE);
+  ability.depiction.startSound = r.readString(ctx.strings);
+  ability.depiction.dmgSound = r.readString(ctx.strings);
+  const int attackCount = r.readCount();
+  for (int i = 0; i < attackCount; i++) {
+    model::AbilityAttack attack;
+    attack.attackClass = readEnum(r, model::AttackClass::ATTACK_CLASS_AUTO_HIT);
+    if (r.readBool()) {
+      attack.dmg = readAttackDmg(r);
+    }
+    attack.save = readOptionalSave(r);
+    ability.attacks.pushBack(std::move(attack));
+  }
+  const int statusCount = r.readCount();
+  for (int i = 0; i < statusCount; i++) {
+    model::AbilityStatus status;
+    status.statusEffect = r.readString(ctx.strings);
+    status.save = readOptionalSave(r);
+    status.baseDuration = readOptionalInt(r);
+    status.durationBonus = readOptionalInt(r);
+    ability.statuses.pushBack(std::move(status));
+  }
+  ability.restores = readRestores(r);
+  return ability;
+}
+
+// --- items
+
+void writeItem(game::SaveWriter& w, PackContext& ctx, const model::ItemTemplate& item) {
+  writeEnum(w, item.itemType);
+  w.writeString(ctx.strings, item.name);
+  w.writeString(ctx.strings, item.label);
+  w.writeString(ctx.strings, item.iconSpriteName);
+  w.writeString(ctx.strings, item.description);
+  w.writeVarInt(item.weight);
+  w.writeVarInt(item.value);
+  w.writeBool(item.stackable);
+  w.writeBool(item.indestructable);
+  writeEnum(w, item.itemUsability);
+  w.writeBool(item.useAbility.has_value());
+  if (item.useAbility.has_value()) {
+    w.writeString(ctx.strings, item.useAbility->abilityName);
+    writeAttackDmgs(w, item.useAbility->dmgOverrides);
+    writeRestores(w, item.useAbility->restoreOverrides);
+  }
+  w.writeBool(item.useSpecialEvent.has_value());
+  if (item.useSpecialEvent.has_value()) {
+    w.writeString(ctx.strings, *item.useSpecialEvent);
+  }
+  writeStrings(w, ctx, item.statusEffectNames);
+  w.writeBool(item.weapon.has_value());
+  if (item.weapon.has_value()) {
+    w.writeString(ctx.strings, item.weapon->abilityName);
+    writeAttackDmgs(w, item.weapon->dmgOverrides);
+  }
+}
+
+model::ItemTemplate readItem(game::SaveReader& r, const PackContext& ctx) {
+  model::ItemTemplate item;
+  item.itemType = readEnum(r, model::ItemType::UNKNOWN);
+  item.name = r.readString(ctx.strings);
+  item.label = r.readString(ctx.strings);
+  item.iconSpriteName = r.readString(ctx.strings);
+  item.description = r.readString(ctx.strings);
+  item.weight = r.readInt();
+  item.value = r.readInt();
+  item.stackable = r.readBool();
+  item.indestructable = r.readBool();
+  item.itemUsability = readEnum(r, model::ItemUsability::USABLE_TOWN_AND_COMBAT);
+  if (r.readBool()) {
+    model::ItemUseAbilityConfig useAbility;
+    useAbility.abilityName = r.readString(ctx.strings);
+    useAbility.dmgOverrides = readAttackDmgs(r);
+    useAbility.restoreOverrides = readRestores(r);
+    item.useAbility = std::move(useAbility);
+  }
+  if (r.readBool()) {
+    item.useSpecialEvent = r.readString(ctx.strings);
+  }
+  item.statusEffectNames = readStrings(r, ctx);
+  if (r.readBool()) {
+    model::ItemWeaponConfig weapon;
+    weapon.abilityName = r.readString(ctx.strings);
+    weapon.dmgOverrides = readAttackDmgs(r);
+    item.weapon = std::move(weapon);
+  }
+  return item;
+}
+
+// --- characters
+
+template <typename Stats, typename Visit>
+void visitCharacterStats(Stats& stats, Visit&& visit) {
+  visit(stats.generic.str);
+  visit(stats.generic.mnd);
+  visit(stats.generic.con);
+  visit(stats.generic.agi);
+  visit(stats.generic.lck);
+  visit(stats.trainable.weapon.edged);
+  visit(stats.trainable.weapon.pole);
+  visit(stats.trainable.weapon.blunt);
+  visit(stats.trainable.weapon.range);
+  visit(stats.trainable.weapon.unarmed);
+  visit(stats.trainable.magic.mana);
+  visit(stats.trainable.magic.abilityPower);
+  visit(stats.trainable.magic.attunement);
+  visit(stats.trainable.magic.faith);
+  visit(stats.trainable.magic.lore);
+  visit(stats.trainable.body.resistPhysical);
+  visit(stats.trainable.body.resistMagical);
+  visit(stats.trainable.body.healingEffectiveness);
+  visit(stats.trainable.body.dr);
+  visit(stats.trainable.body.armorTraining);
+  visit(stats.skills.trickery);
+  visit(stats.skills.stealth);
+  visit(stats.skills.social);
+  visit(stats.skills.magicItemUse);
+  visit(stats.skills.cooking);
+  visit(stats.skills.acrobatics);
+  visit(stats.skills.survival);
+  visit(stats.skills.focus);
+  visit(stats.skills.conditioning);
+}
+
+void writeCharacter(game::SaveWriter& w,
+                    PackContext& ctx,
+                    const model::CharacterTemplate& character) {
+  writeEnum(w, character.type);
+  w.writeString(ctx.strings, character.name);
+  w.writeString(ctx.strings, character.label);
+  w.writeString(ctx.strings, character.spritesheetName);
+  w.writeString(ctx.strings, character.spriteOffset);
+  w.writeString(ctx.strings, character.talk.talkName);
+  w.writeString(ctx.strings, character.talk.portraitName);
+  w.writeString(ctx.strings, character.behavior.behaviorName);
+  visitCharacterStats(character.stats, [&](int value) { w.writeVarInt(value); });
+  w.writeVarInt(character.combat.hp);
+  w.writeVarInt(character.combat.mp);
+  w.writeString(ctx.strings, character.combat.dropTable);
+  writeEnum(w, character.combatBehavior.town);
+  writeEnum(w, character.combatBehavior.combat);
+  w.writeString(ctx.strings, character.sound.deathSoundName);
+  w.writeString(ctx.strings, character.sound.weaponSoundName);
+  w.writeVarUint(character.statuses.size());
+  for (const auto& status : character.statuses) {
+    w.writeString(ctx.strings, status.status);
+  }
+  w.writeVarInt(character.vision.radius);
+}
+
+model::CharacterTemplate readCharacter(game::SaveReader& r, const PackContext& ctx) {
+  model::CharacterTemplate character;
+  character.type = readEnum(r, model::CharacterTemplateType::ENEMY_STATIC);
+  character.name = r.readString(ctx.strings);
+  character.label = r.readString(ctx.strings);
+  character.spritesheetName = r.readString(ctx.strings);
+  character.spriteOffset = r.readString(ctx.strings);
+  character.talk.talkName = r.readString(ctx.strings);
+  character.talk.portraitName = r.readString(ctx.strings);
+  character.behavior.behaviorName = r.readString(ctx.strings);
+  visitCharacterStats(character.stats, [&](int& value) { value = r.readInt(); });
+  character.combat.hp = r.readInt();
+  character.combat.mp = r.readInt();
+  character.combat.dropTable = r.readString(ctx.strings);
+  const auto lastBehavior = model::CombatBehaviorName::SEEK_AND_MELEE;
+  character.combatBehavior.town = readEnum(r, lastBehavior);
+  character.combatBehavior.combat = readEnum(r, lastBehavior);
+  character.sound.deathSoundName = r.readString(ctx.strings);
+  character.sound.weaponSoundName = r.readString(ctx.strings);
+  const int statusCount = r.readCount();
+  for (int i = 0; i < statusCount; i++) {
+    character.statuses.pushBack(
+        model::CharacterTemplateStatus{r.readString(ctx.strings)});
+  }
+  character.vision.radius = r.readInt();
+  return character;
+}
+
+// --- maps
+
+void writeTileRef(game::SaveWriter& w, const model::MapTileRef& ref) {
+  w.writeVarInt(ref.l);
+  w.writeVarInt(ref.i);
+}
+
+void readTileRef(game::SaveReader& r, model::MapTileRef& ref) {
+  ref.l = r.readInt();
+  ref.i = r.readInt();
+}
+
+void writeLightSource(game::SaveWriter& w, const model::TileLightSource& light) {
+  writeFloat(w, light.angle);
+  writeFloat(w, light.intensity);
+  w.writeVarInt(light.radius);
+}
+
+void readLightSource(game::SaveReader& r, model::TileLightSource& light) {
+  light.angle = readFloat(r);
+  light.intensity = readFloat(r);
+  light.radius = r.readInt();
+}
+
+void writeOptionalBool(game::SaveWriter& w, const std::optional<bool>& value) {
+  w.writeU8(value.has_value() ? (*value ? 2 : 1) : 0);
+}
+
+std::optional<bool> readOptionalBool(game::SaveReader& r) {
+  const uint8_t value = r.readU8();
+  if (value > 2) {
+    throw std::runtime_error("Content pack enum value out of range");
+  }
+  return value == 0 ? std::nullopt : std::optional<bool>(value == 2);
+}
+
+void writeMap(game::SaveWriter& w,
+              PackContext& ctx,
+              const model::CarcerMapTemplate& map) {
+  w.writeString(ctx.strings, map.name);
+  w.writeString(ctx.strings, map.label);
+  writeEnum(w, map.type);
+  w.writeVarInt(map.width);
+  w.writeVarInt(map.height);
+  w.writeVarInt(map.spriteWidth);
+  w.writeVarInt(map.spriteHeight);
+  writeStrings(w, ctx, map.tilesets);
+  w.writeVarUint(map.layers.size());
+  for (const int layer : map.layers) {
+    w.writeVarInt(layer);
+  }
+  w.writeVarUint(map.tiles.size());
+  for (const auto& layerTiles : map.tiles) {
+    writeTileArray(w, layerTiles);
+  }
+
+  w.writeVarUint(map.characters.size());
+  for (const auto& placement : map.characters) {
+    writeTileRef(w, placement);
+    w.writeString(ctx.strings, placement.name);
+  }
+  w.writeVarUint(map.items.size());
+  for (const auto& placement : map.items) {
+    writeTileRef(w, placement);
+    w.writeString(ctx.strings, placement.name);
+    w.writeVarInt(placement.quantity);
+  }
+  w.writeVarUint(map.markers.size());
+  for (const auto& placement : map.markers) {
+    writeTileRef(w, placement);
+    w.writeString(ctx.strings, placement.name);
+  }
+  w.writeVarUint(map.eventTriggers.size());
+  for (const auto& placement : map.eventTriggers) {
+    writeTileRef(w, placement);
+    w.writeString(ctx.strings, placement.eventId);
+    w.writeBool(placement.requiresNonCombat);
+    w.writeBool(placement.requiresLook);
+    writeEnum(w, placement.overlayVisibility);
+  }
+  w.writeVarUint(map.travelTriggers.size());
+  for (const auto& placement : map.travelTriggers) {
+    writeTileRef(w, placement);
+    w.writeString(ctx.strings, placement.destinationMapName);
+    w.writeString(ctx.strings, placement.destinationMarkerName);
+    w.writeVarInt(placement.destinationX);
+    w.writeVarInt(placement.destinationY);
+    w.writeVarInt(placement.destinationLayer);
+    w.writeBool(placement.requiresAction);
+    writeEnum(w, placement.overlayVisibility);
+  }
+  w.writeVarUint(map.tileOverrides.size());
+  for (const auto& placement : map.tileOverrides) {
+    writeTileRef(w, placement);
+    writeOptionalBool(w, placement.overrides.isWalkableOverride);
+    writeOptionalBool(w, placement.overrides.isSeeThroughOverride);
+    writeOptionalBool(w, placement.overrides.isContainerOverride);
+    w.writeBool(placement.overrides.lightSourceOverride.has_value());
+    if (placement.overrides.lightSourceOverride.has_value()) {
+      writeLightSource(w, *placement.overrides.lightSourceOverride);
+    }
+  }
+  w.writeVarUint(map.lightSources.size());
+  for (const auto& placement : map.lightSources) {
+    writeTileRef(w, placement);
+    writeLightSource(w, placement);
+  }
+}
+
+model::CarcerMapTemplate readMap(game::SaveReader& r, const PackContext& ctx) {
+  model::CarcerMapTemplate map;
+  map.name = r.readString(ctx.strings);
+  map.label = r.readString(ctx.strings);
+  map.type = readEnum(r, model::MapType::OUTDOOR);
+  map.width = r.readInt();
+  map.height = r.readInt();
+  map.spriteWidth = r.readInt();
+  map.spriteHeight = r.readInt();
+  map.tilesets = readStrings(r, ctx);
+  const int layerCount = r.readCount();
+  for (int i = 0; i < layerCount; i++) {
+    map.layers.pushBack(r.readInt());
+  }
+  const int tileLayerCount = r.readCount();
+  map.tiles.reserve(tileLayerCount);
+  for (int i = 0; i < tileLayerCount; i++) {
+    map.tiles.pushBack(readTileArray(r));
+  }
+
+  const auto overlay = model::TileOverlayVisibility::SHOW_TRAVEL_DOWN;
+  int count = r.readCount();
+  map.characters.reserve(count);
+  for (int i = 0; i < count; i++) {
+    model::MapCharacterPlacement placement;
+    readTileRef(r, placement);
+    placement.name = r.readString(ctx.strings);
+    map.characters.pushBack(std::move(placement));
+  }
+  count = r.readCount();
+  map.items.reserve(count);
+  for (int i = 0; i < count; i++) {
+    model::MapItemPlacement placement;
+    readTileRef(r, placement);
+    placement.name = r.readString(ctx.strings);
+    placement.quantity = r.readInt();
+    map.items.pushBack(std::move(placement));
+  }
+  count = r.readCount();
+  map.markers.reserve(count);
+  for (int i = 0; i < count; i++) {
+    model::MapMarkerPlacement placement;
+    readTileRef(r, placement);
+    placement.name = r.readString(ctx.strings);
+    map.markers.pushBack(std::move(placement));
+  }
+  count = r.readCount();
+  map.eventTriggers.reserve(count);
+  for (int i = 0; i < count; i++) {
+    model::MapEventTriggerPlacement placement;
+    readTileRef(r, placement);
+    placement.eventId = r.readString(ctx.strings);
+    placement.requiresNonCombat = r.readBool();
+    placement.requiresLook = r.readBool();
+    placement.overlayVisibility = readEnum(r, overlay);
+    map.eventTriggers.pushBack(std::move(placement));
+  }
+  count = r.readCount();
+  map.travelTriggers.reserve(count);
+  for (int i = 0; i < count; i++) {
+    model::MapTravelTriggerPlacement placement;
+    readTileRef(r, placement);
+    placement.destinationMapName = r.readString(ctx.strings);
+    placement.destinationMarkerName = r.readString(ctx.strings);
+    placement.destinationX = r.readInt();
+    placement.destinationY = r.readInt();
+    placement.destinationLayer = r.readInt();
+    placement.requiresAction = r.readBool();
+    placement.overlayVisibility = readEnum(r, overlay);
+    map.travelTriggers.pushBack(std::move(placement));
+  }
+  count = r.readCount();
+  map.tileOverrides.reserve(count);
+  for (int i = 0; i < count; i++) {
+    model::MapTileOverridePlacement placement;
+    readTileRef(r, placement);
+    placement.overrides.isWalkableOverride = readOptionalBool(r);
+    placement.overrides.isSeeThroughOverride = readOptionalBool(r);
+    placement.overrides.isContainerOverride = readOptionalBool(r);
+    if (r.readBool()) {
+      model::TileLightSource light;
+      readLightSource(r, light);
+      placement.overrides.lightSourceOverride = light;
+    }
+    map.tileOverrides.pushBack(std::move(placement));
+  }
+  count = r.readCount();
+  map.lightSources.reserve(count);
+  for (int i = 0; i < count; i++) {
+    model::MapLightSourcePlacement placement;
+    readTileRef(r, placement);
+    readLightSource(r, placement);
+    map.lightSources.pushBack(placement);
+  }
+  return map;
+}
+
+// --- map grids and tilesets
+
+void writeMapGrid(game::SaveWriter& w,
+                  PackContext& ctx,
+                  const model::MapGridTemplate& grid) {
+  w.writeString(ctx.strings, grid.name);
+  w.writeString(ctx.strings, grid.label);
+  w.writeVarInt(grid.gridWidth);
+  w.writeVarInt(grid.gridHeight);
+  w.writeVarInt(grid.mapWidth);
+  w.writeVarInt(grid.mapHeight);
+  w.writeVarUint(grid.cells.size());
+  for (const auto& row : grid.cells) {
+    writeStrings(w, ctx, row);
+  }
+}
+
+model::MapGridTemplate readMapGrid(game::SaveReader& r, const PackContext& ctx) {
+  model::MapGridTemplate grid;
+  grid.name = r.readString(ctx.strings);
+  grid.label = r.readString(ctx.strings);
+  grid.gridWidth = r.readInt();
+  grid.gridHeight = r.readInt();
+  grid.mapWidth = r.readInt();
+  grid.mapHeight = r.readInt();
+  const int rowCount = r.readCount();
+  for (int i = 0; i < rowCount; i++) {
+    grid.cells.pushBack(readStrings(r, ctx));
+  }
+  return grid;
+}
+
+void writeTileset(game::SaveWriter& w,
+                  PackContext& ctx,
+                  const model::TilesetTemplate& tileset) {
+  w.writeString(ctx.strings, tileset.name);
+  w.writeString(ctx.strings, tileset.spriteBase);
+  w.writeVarInt(tileset.tileWidth);
+  w.writeVarInt(tileset.tileHeight);
+  w.writeVarUint(tileset.tiles.size());
+  for (const auto& tile : tileset.tiles) {
+    w.writeVarInt(tile.id);
+    w.writeString(ctx.strings, tile.description);
+    writeEnum(w, tile.stepSound);
+    w.writeU8(static_cast<uint8_t>((tile.isWalkable ? 1 : 0) |
+                                   (tile.isSeeThrough ? 2 : 0) | (tile.isDoor ? 4 : 0) |
+                                   (tile.isContainer ? 8 : 0)));
+  }
+}
+
+model::TilesetTemplate readTileset(game::SaveReader& r, const PackContext& ctx) {
+  model::TilesetTemplate tileset;
+  tileset.name = r.readString(ctx.strings);
+  tileset.spriteBase = r.readString(ctx.strings);
+  tileset.tileWidth = r.readInt();
+  tileset.tileHeight = r.readInt();
+  const int tileCount = r.readCount();
+  tileset.tiles.reserve(tileCount);
+  for (int i = 0; i < tileCount; i++) {
+    model::TileMetadata tile{};
+    tile.id = r.readInt();
+    tile.description = r.readString(ctx.strings);
+    tile.stepSound = readEnum(r, model::TILE_STEP_SOUND_GRAVEL);
+    const uint8_t flags = r.readU8();
+    tile.isWalkable = (flags & 1) != 0;
+    tile.isSeeThrough = (flags & 2) != 0;
+    tile.isDoor = (flags & 4) != 0;
+    tile.isContainer = (flags & 8) != 0;
+    tileset.tiles.pushBack(std::move(tile));
+  }
+  return tileset;
+}
+
+// --- sections
+
+template <typename V, typename Write>
+void writeTemplates(game::SaveWriter& w,
+                    PackContext& ctx,
+                    const bmin::Map<bmin::String, V>& templates,
+                    Write writeTemplate) {
+  const auto values = sortedValues(templates);
+  w.writeVarUint(values.size());
+  for (const V* value : values) {
+    writeTemplate(w, ctx, *value);
+  }
+}
+
+template <typename V, typename Read>
+void readTemplates(game::SaveReader& r,
+                   const PackContext& ctx,
+                   bmin::Map<bmin::String, V>& templates,
+                   Read readTemplate) {
+  const int count = r.readCount();
+  for (int i = 0; i < count; i++) {
+    V value = readTemplate(r, ctx);
+    const bmin::String name = value.name;
+    templates[name] = std::move(value);
+  }
+}
+
+void writeSection(game::SaveWriter& payload,
+                  ContentPackSectionId id,
+                  const game::SaveWriter& section) {
+  payload.writeVarUint(static_cast<uint8_t>(id));
+  payload.writeVarUint(section.size());
+  payload.writeBytes(section.getBytes().data(), section.size());
+}
+
+// Owns the bytes of a pack file: a read-only mapping where available, otherwise a
+// buffer filled with one read.
+class ContentPackFile {
+  std::string buffer;
+  const char* mapped = nullptr;
+  size_t mappedSize = 0;
+
+public:
+  explicit ContentPackFile(std::string_view path) {
+    const bmin::String pathStr(path.data(), path.size());
+#if !defined(__EMSCRIPTEN__) && !defined(_WIN32)
+    const int fd = ::open(pathStr.cStr(), O_RDONLY);
+    if (fd < 0) {
+      throw std::runtime_error(
+          (bmin::String("Cannot open content pack ") + pathStr).cStr());
+    }
+    struct stat info{};
+    if (::fstat(fd, &info) == 0 && info.st_size > 0) {
+      void* data = ::mmap(nullptr, static_cast<size_t>(info.st_size), PROT_READ,
+                          MAP_PRIVATE, fd, 0);
+      if (data != MAP_FAILED) {
+        mapped = static_cast<const char*>(data);
+        mappedSize = static_cast<size_t>(info.st_size);
+      }
+    }
+    ::close(fd);
+    if (mapped != nullptr) {
+      return;
+    }
+#endif
+    std::ifstream in{std::filesystem::path(pathStr.cStr()), std::ios::binary};
+    if (!in) {
+      throw std::runtime_error(
+          (bmin::String("Cannot open content pack ") + pathStr).cStr());
+    }
+    buffer.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+  }
+
+  ~ContentPackFile() {
+#if !defined(__EMSCRIPTEN__) && !defined(_WIN32)
+    if (mapped != nullptr) {
+      ::munmap(const_cast<char*>(mapped), mappedSize);
+    }
+#endif
+  }
+
+  ContentPackFile(const ContentPackFile&) = delete;
+  ContentPackFile& operator=(const ContentPackFile&) = delete;
+
+  std::string_view bytes() const {
+    return mapped != nullptr ? std::string_view(mapped, mappedSize)
+                             : std::string_view(buffer);
+  }
+};
+
+template <typename V>
+bool containsName(const bmin::Map<bmin::String, V>& map, const bmin::String& name) {
+  return map.contains(name);
+}
+
+} // namespace
+
+bmin::DynArray<uint8_t> encodeContentPack(const Database& database) {
+  PackContext ctx;
+  game::SaveWriter statusEffects;
+  writeTemplates(statusEffects, ctx, database.statusEffectTemplates, writeStatusEffect);
+  game::SaveWriter abilities;
+  writeTemplates(abilities, ctx, database.abilityTemplates, writeAbility);
+  game::SaveWriter items;
+  writeTemplates(items, ctx, database.itemTemplates, writeItem);
+  game::SaveWriter characters;
+  writeTemplates(characters, ctx, database.characterTemplates, writeCharacter);
+  game::SaveWriter maps;
+  writeTemplates(maps, ctx, database.getMapTemplates(), writeMap);
+  game::SaveWriter mapGrids;
+  writeTemplates(mapGrids, ctx, database.mapGridTemplates, writeMapGrid);
+  game::SaveWriter tilesets;
+  writeTemplates(tilesets, ctx, database.tilesetTemplates, writeTileset);
+
+  // Events keep the event bundle encoding (runner/EventBundle.h).
+  bmin::DynArray<model::GameEvent> events;
+  for (const auto* event : sortedValues(database.gameEvents)) {
+    events.pushBack(*event);
+  }
+  const auto bundle = runner::encodeEventBundle(events);
+  game::SaveWriter specialEvents;
+  specialEvents.writeBytes(bundle.data(), bundle.size());
+
+  game::SaveWriter payload;
+  payload.writeVarUint(ctx.strings.size());
+  for (size_t i = 0; i < ctx.strings.size(); i++) {
+    payload.writeRawString(bmin::toStringView(ctx.strings.at(static_cast<uint32_t>(i))));
+  }
+  payload.writeVarUint(8);
+  writeSection(payload, ContentPackSectionId::STATUS_EFFECTS, statusEffects);
+  writeSection(payload, ContentPackSectionId::ABILITIES, abilities);
+  writeSection(payload, ContentPackSectionId::ITEMS, items);
+  writeSection(payload, ContentPackSectionId::CHARACTERS, characters);
+  writeSection(payload, ContentPackSectionId::MAPS, maps);
+  writeSection(payload, ContentPackSectionId::MAP_GRIDS, mapGrids);
+  writeSection(payload, ContentPackSectionId::TILESETS, tilesets);
+  writeSection(payload, ContentPackSectionId::SPECIAL_EVENTS, specialEvents);
+
+  const auto& payloadBytes = payload.getBytes();
+  const std::string_view payloadView(reinterpret_cast<const char*>(payloadBytes.data()),
+                                     payloadBytes.size());
+  game::SaveWriter file;
+  file.writeBytes(reinterpret_cast<const uint8_t*>(CONTENT_PACK_MAGIC),
+                  sizeof(CONTENT_PACK_MAGIC));
+  file.writeU16(CONTENT_PACK_FORMAT_VERSION);
+  file.writeU32(static_cast<uint32_t>(payloadBytes.size()));
+  file.writeU32(game::saveChecksum(payloadView));
+  file.writeBytes(payloadBytes.data(), payloadBytes.size());
+  return file.getBytes();
+}
+
+void decodeContentPack(std::string_view bytes, Database& database) {
+  if (bytes.size() < CONTENT_PACK_HEADER_SIZE ||
+      bytes.substr(0, sizeof(CONTENT_PACK_MAGIC)) !=
+          std::string_view(CONTENT_PACK_MAGIC, sizeof(CONTENT_PACK_MAGIC))) {
+    throw std::runtime_error("Not a content pack");
+  }
+  game::SaveReader header(bytes.substr(sizeof(CONTENT_PACK_MAGIC),
+                                       CONTENT_PACK_HEADER_SIZE -
+                                           sizeof(CONTENT_PACK_MAGIC)));
+  if (header.readU16() != CONTENT_PACK_FORMAT_VERSION) {
+    throw std::runtime_error("Content pack was written by a different build");
+  }
+  const uint32_t payloadSize = header.readU32();
+  const uint32_t checksum = header.readU32();
+  const auto payload = bytes.substr(CONTENT_PACK_HEADER_SIZE);
+  if (payload.size() != payloadSize || game::saveChecksum(payload) != checksum) {
+    throw std::runtime_error("Content pack is truncated or corrupt");
+  }
+
+  game::SaveReader reader(payload);
+  PackContext ctx;
+  const int stringCount = reader.readCount();
+  for (int i = 0; i < stringCount; i++) {
+    const auto text = reader.readRawString();
+    ctx.strings.append(bmin::String(text.data(), text.size()));
+  }
+
+  // Decode into a scratch database so a bad pack leaves the current one alone.
+  Database loaded;
+  bmin::DynArray<model::GameEvent> events;
+  uint32_t seenSections = 0;
+  const int sectionCount = reader.readCount();
+  for (int i = 0; i < sectionCount; i++) {
+    const uint64_t id = reader.readVarUint();
+    // Checked before the cast, which would truncate a large id onto a known one.
+    if (id < static_cast<uint64_t>(ContentPackSectionId::STATUS_EFFECTS) ||
+        id > static_cast<uint64_t>(ContentPackSectionId::SPECIAL_EVENTS)) {
+      throw std::runtime_error("Content pack has an unknown section");
+    }
+    const auto sectionBytes = reader.readBytes(static_cast<size_t>(reader.readVarUint()));
+    game::SaveReader section(sectionBytes);
+    switch (static_cast<ContentPackSectionId>(id)) {
+    case ContentPackSectionId::STATUS_EFFECTS:
+      readTemplates(section, ctx, loaded.statusEffectTemplates, readStatusEffect);
+      break;
+    case ContentPackSectionId::ABILITIES:
+      readTemplates(section, ctx, loaded.abilityTemplates, readAbility);
+      break;
+    case ContentPackSectionId::ITEMS:
+      readTemplates(section, ctx, loaded.itemTemplates, readItem);
+      break;
+    case ContentPackSectionId::CHARACTERS:
+      readTemplates(section, ctx, loaded.characterTemplates, readCharacter);
+      break;
+    case ContentPackSectionId::MAPS:
+      readTemplates(section, ctx, loaded.mapTemplates, readMap);
+      break;
+    case ContentPackSectionId::MAP_GRIDS:
+      readTemplates(section, ctx, loaded.mapGridTemplates, readMapGrid);
+      break;
+    case ContentPackSectionId::TILESETS:
+      readTemplates(section, ctx, loaded.tilesetTemplates, readTileset);
+      break;
+    case ContentPackSectionId::SPECIAL_EVENTS:
+      events = runner::decodeEventBundle(sectionBytes);
+      section = game::SaveReader(std::string_view());
+      break;
+    }
+    if (!section.atEnd()) {
+      throw std::runtime_error("Content pack section has trailing data");
+    }
+    seenSections |= 1u << id;
+  }
+  if (!reader.atEnd() || seenSections != 0x1feu) {
+    throw std::runtime_error("Content pack is missing a section");
+  }
+  storeSpecialEvents(events, loaded.gameEvents);
+
+  database.clear();
+  database.statusEffectTemplates = std::move(loaded.statusEffectTemplates);
+  database.abilityTemplates = std::move(loaded.abilityTemplates);
+  database.itemTemplates = std::move(loaded.itemTemplates);
+  database.characterTemplates = std::move(loaded.characterTemplates);
+  database.mapTemplates = std::move(loaded.mapTemplates);
+  database.mapGridTemplates = std::move(loaded.mapGridTemplates);
+  database.tilesetTemplates = std::move(loaded.tilesetTemplates);
+  database.gameEvents = std::move(loaded.gameEvents);
+}
+
+void loadContentPackFile(std::string_view path, Database& database) {
+  const ContentPackFile file(path);
+  decodeContentPack(file.bytes(), database);
+}
+
+bmin::DynArray<bmin::String> findContentWarnings(const Database& database) {
+  bmin::DynArray<bmin::String> warnings;
+  auto warn = [&](const bmin::String& owner, const char* what, const bmin::String& name) {
+    warnings.pushBack(owner + ": " + what + " '" + name + "'");
+  };
+
+  for (const auto* map : sortedValues(database.getMapTemplates())) {
+    const bmin::String owner = bmin::String("Map ") + map->name;
+    for (const auto& tileset : map->tilesets) {
+      if (!tileset.empty() && !containsName(database.tilesetTemplates, tileset)) {
+        warn(owner, "unknown tileset", tileset);
+      }
+    }
+    for (size_t layer = 0; layer < map->tiles.size(); layer++) {
+      const auto& layerTiles = map->tiles[layer];
+      // (tileset index, tile id) per cell.
+      if (!layerTiles.empty() &&
+          layerTiles.size() != static_cast<size_t>(2 * map->width * map->height)) {
+        warn(owner, "tile layer size does not match 2 * width * height for layer",
+             bmin::toString(static_cast<int>(layer)));
+      }
+    }
+    for (const auto& placement : map->characters) {
+      if (!containsName(database.characterTemplates, placement.name)) {
+        warn(owner, "unknown character", placement.name);
+      }
+    }
+    for (const auto& placement : map->items) {
+      if (!containsName(database.itemTemplates, placement.name)) {
+        warn(owner, "unknown item", placement.name);
+      }
+    }
+    for (const auto& placement : map->eventTriggers) {
+      if (!containsName(database.gameEvents, placement.eventId)) {
+        warn(owner, "unknown event", placement.eventId);
+      }
+    }
+    for (const auto& placement : map->travelTriggers) {
+      if (!placement.destinationMapName.empty() &&
+          !containsName(database.mapTemplates, placement.destinationMapName)) {
+        warn(owner, "unknown travel destination", placement.destinationMapName);
+      }
+    }
+  }
+
+  for (const auto* grid : sortedValues(database.mapGridTemplates)) {
+    const bmin::String owner = bmin::String("Map grid ") + grid->name;
+    for (const auto& row : grid->cells) {
+      for (const auto& cell : row) {
+        if (!cell.empty() && !containsName(database.mapTemplates, cell)) {
+          warn(owner, "unknown map", cell);
+        }
+      }
+    }
+  }
+
+  for (const auto* item : sortedValues(database.itemTemplates)) {
+    const bmin::String owner = bmin::String("Item ") + item->name;
+    if (item->useSpecialEvent.has_value() &&
+        !containsName(database.gameEvents, *item->useSpecialEvent)) {
+      warn(owner, "unknown event", *item->useSpecialEvent);
+    }
+    if (item->useAbility.has_value() && !item->useAbility->abilityName.empty() &&
+        !containsName(database.abilityTemplates, item->useAbility->abilityName)) {
+      warn(owner, "unknown ability", item->useAbility->abilityName);
+    }
+    if (item->weapon.has_value() && !item->weapon->abilityName.empty() &&
+        !containsName(database.abilityTemplates, item->weapon->abilityName)) {
+      warn(owner, "unknown ability", item->weapon->abilityName);
+    }
+  }
+  return warnings;
+}
+
+} // namespace db
@@ -0,0 +1,50 @@
+#pragma once
+
+#include "bmin/DynArray.h"
+#include "bmin/String.h"
+#include <cstdint>
+#include <string_view>
+
+namespace db {
+
+class Database;
+
+// Every database template in one binary file, written offline by the CONTENTPACK tool
+// so the game does not parse JSON at startup. Layout (header fields little-endian):
+//   "CPAK" | u16 format version | u32 payload size | u32 payload checksum | payload
+// The payload is a string table followed by one section per template kind, each
+//   varuint id | varuint byte size | bytes
+// Records are written field by field with game::SaveWriter; map tile layers are stored
+// as flat little-endian int32 arrays. The pack is a build artifact for one build, so any
+// layout change bumps CONTENT_PACK_FORMAT_VERSION and older packs are rejected.
+inline constexpr char CONTENT_PACK_MAGIC[4] = {'C', 'P', 'A', 'K'};
+inline constexpr uint16_t CONTENT_PACK_FORMAT_VERSION = 1;
+inline constexpr char CONTENT_PACK_PATH[] = "assets/db/content.pack";
+
+enum class ContentPackSectionId : uint8_t {
+  STATUS_EFFECTS = 1,
+  ABILITIES = 2,
+  ITEMS = 3,
+  CHARACTERS = 4,
+  MAPS = 5,
+  MAP_GRIDS = 6,
+  TILESETS = 7,
+  SPECIAL_EVENTS = 8,
+};
+
+bmin::DynArray<uint8_t> encodeContentPack(const Database& database);
+
+// Replaces the database's templates with the pack's. Throws std::runtime_error for a
+// file that is not a pack, is truncated or corrupt, or has another format version;
+// the database is left unchanged then.
+void decodeContentPack(std::string_view bytes, Database& database);
+
+// Maps the file (reads it into one buffer on Emscripten and Windows) and decodes it.
+void loadContentPackFile(std::string_view path, Database& database);
+
+// Cross-reference problems that do not stop the game from running (unknown tilesets,
+// characters, items, events or travel destinations, tile layers of the wrong size).
+// The content tool reports them; validateCombatReferences covers the fatal ones.
+bmin::DynArray<bmin::String> findContentWarnings(const Database& database);
+
+} // namespace db
@@ -1,5 +1,7 @@
 #include "Database.h"
+#include "LazyMapTemplates.h"
 #include "sdl2w/Logger.h"
+#include "lib/StartupProfiler.h"
 #include "loaders/LoadAbilityTemplates.h"
 #include "loaders/LoadCharacterTemplates.h"
 #include "loaders/LoadItemTemplates.h"
@@ -8,12 +10,77 @@
 #include "loaders/LoadSpecialEvents.h"
 #include "loaders/LoadStatusEffectTemplates.h"
 #include "loaders/LoadTilesetTemplates.h"
+#include "runner/ScriptCompiler.h"
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <filesystem>
+#include <functional>
+#include <iterator>
 #include <stdexcept>
+#include <thread>
 
 namespace db {
 
+namespace {
+
+constexpr const char* DATABASE_JSON_PATHS[] = {
+    "assets/db/status-effects.json",
+    "assets/db/abilities.json",
+    "assets/db/items.json",
+    "assets/db/characters.json",
+    "assets/db/maps.json",
+    "assets/db/map-grids.json",
+    "assets/db/tilesets.json",
+    "assets/db/special-events.json",
+};
+
+// A pack older than any JSON file is stale (content edited since the last build).
+bool contentPackIsCurrent() {
+  std::error_code ec;
+  const auto packTime = std::filesystem::last_write_time(CONTENT_PACK_PATH, ec);
+  if (ec) {
+    return false;
+  }
+  for (const char* path : DATABASE_JSON_PATHS) {
+    const auto jsonTime = std::filesystem::last_write_time(path, ec);
+    if (!ec && jsonTime > packTime) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// Loaders only touch their own map, so a handful of threads is enough to overlap them.
+constexpr int MAX_LOAD_THREADS = 4;
+
+int resolveLoadThreadCount(int requested, int jobs) {
+  int threads = requested;
+  if (threads <= 0) {
+    threads = std::min(static_cast<int>(std::thread::hardware_concurrency()),
+                       MAX_LOAD_THREADS);
+  }
+  return std::clamp(threads, 1, jobs);
+}
+
+} // namespace
+
 Database::Database() {}
 
+Database::~Database() = default;
+
+void Database::clear() {
+  lazyMaps.reset();
+  itemTemplates = decltype(itemTemplates){};
+  characterTemplates = decltype(characterTemplates){};
+  abilityTemplates = decltype(abilityTemplates){};
+  statusEffectTemplates = decltype(statusEffectTemplates){};
+  gameEvents = decltype(gameEvents){};
+  mapTemplates = decltype(mapTemplates){};
+  mapGridTemplates = decltype(mapGridTemplates){};
+  tilesetTemplates = decltype(tilesetTemplates){};
+}
+
 void Database::validateCombatReferences() const {
   auto& abilities = const_cast<decltype(abilityTemplates)&>(abilityTemplates);
   for (auto it = abilities.begin(); it != abilities.end(); ++it) {
@@ -59,19 +126,107 @@ void Database::validateCombatReferences() const {
 }
 
 void Database::load() {
+  StartupProfiler::Scope scope("db load");
   LOG(INFO) << "Loading database..." << LOG_ENDL;
-  loadStatusEffectTemplates("assets/db/status-effects.json", statusEffectTemplates);
-  loadAbilityTemplates("assets/db/abilities.json", abilityTemplates);
-  loadItemTemplates("assets/db/items.json", itemTemplates);
-  loadCharacterTemplates("assets/db/characters.json", characterTemplates);
-  loadMapTemplates("assets/db/maps.json", mapTemplates);
-  loadMapGridTemplates("assets/db/map-grids.json", mapGridTemplates);
-  loadTilesetTemplates("assets/db/tilesets.json", tilesetTemplates);
-  loadSpecialEvents("assets/db/special-events.json", gameEvents);
-  validateCombatReferences();
+  if (contentPackIsCurrent()) {
+    try {
+      {
+        StartupProfiler::Scope packScope("db content pack");
+        loadContentPackFile(CONTENT_PACK_PATH, *this);
+      }
+      validateCombatReferences();
+      LOG(INFO) << "Loaded database from " << CONTENT_PACK_PATH << "." << LOG_ENDL;
+      return;
+    } catch (const std::exception& e) {
+      LOG(WARN) << "Ignoring content pack " << CONTENT_PACK_PATH << ": " << e.what()
+                << LOG_ENDL;
+      clear();
+    }
+  }
+  loadFromJson();
   LOG(INFO) << "Loaded database." << LOG_ENDL;
 }
 
+void Database::loadFromJson(int numThreads) {
+  StartupProfiler::Scope scope("db json");
+  // Slowest first (events compile their scripts, maps hold the tile layers), so the
+  // total is close to the largest file rather than the sum.
+  struct LoadJob {
+    // StartupProfiler phase name.
+    const char* name;
+    std::function<void()> run;
+  };
+  const LoadJob jobs[] = {
+      {"db events", [this]() { loadSpecialEvents(DATABASE_JSON_PATHS[7], gameEvents); }},
+      {"db maps",
+       [this]() {
+         if (!lazyMapLoading) {
+           loadMapTemplates(DATABASE_JSON_PATHS[4], mapTemplates);
+           return;
+         }
+         bmin::DynArray<MapTemplateSource> sources;
+         auto text = indexMapTemplates(DATABASE_JSON_PATHS[4], mapTemplates, sources);
+         lazyMaps = bmin::makeUnique<LazyMapTemplates>(
+             std::move(text), std::move(sources), mapTemplates);
+       }},
+      {"db tilesets",
+       [this]() { loadTilesetTemplates(DATABASE_JSON_PATHS[6], tilesetTemplates); }},
+      {"db characters",
+       [this]() { loadCharacterTemplates(DATABASE_JSON_PATHS[3], characterTemplates); }},
+      {"db items",
+       [this]() { loadItemTemplates(DATABASE_JSON_PATHS[2], itemTemplates); }},
+      {"db abilities",
+       [this]() { loadAbilityTemplates(DATABASE_JSON_PATHS[1], abilityTemplates); }},
+      {"db status effects",
+       [this]() {
+         loadStatusEffectTemplates(DATABASE_JSON_PATHS[0], statusEffectTemplates);
+       }},
+      {"db map grids",
+       [this]() { loadMapGridTemplates(DATABASE_JSON_PATHS[5], mapGridTemplates); }},
+  };
+  constexpr int jobCount = static_cast<int>(std::size(jobs));
+  std::exception_ptr errors[jobCount];
+  std::atomic<int> nextJob{0};
+  auto worker = [&]() {
+    for (int i = nextJob.fetch_add(1); i < jobCount; i = nextJob.fetch_add(1)) {
+      try {
+        StartupProfiler::Scope scope(jobs[i].name);
+        jobs[i].run();
+      } catch (...) {
+        errors[i] = std::current_exception();
+      }
+    }
+  };
+
+#ifdef __EMSCRIPTEN__
+  (void)numThreads;
+  worker();
+#else
+  const int threadsUsed = resolveLoadThreadCount(numThreads, jobCount);
+  if (threadsUsed <= 1) {
+    worker();
+  } else {
+    bmin::DynArray<std::thread> threads;
+    threads.reserve(static_cast<size_t>(threadsUsed - 1));
+    for (int i = 1; i < threadsUsed; i++) {
+      threads.pushBack(std::thread(worker));
+    }
+    worker();
+    for (auto& thread : threads) {
+      thread.join();
+    }
+  }
+#endif
+
+  for (const auto& error : errors) {
+    if (error) {
+      std::rethrow_exception(error);
+    }
+  }
+  StartupProfiler::Scope validateScope("db validate");
+  validateCombatReferences();
+}
+
 const model::ItemTemplate& Database::getItemTemplate(std::string_view itemName) const {
   return mapGet(itemTemplates, itemName, "Item template not found: ");
 }
@@ -85,6 +240,18 @@ Database::getCharacterTemplate(std::string_view templateName) const {
   return mapGet(characterTemplates, templateName, "Character template not found: ");
 }
 
+const model::CharacterTemplate*
+Database::findCharacterTemplate(std::string_view templateName) const {
+  const auto mapKey = bmin::String(templateName.data(), templateName.size());
+  auto& map =
+      const_cast<bmin::Map<bmin::String, model::CharacterTemplate>&>(characterTemplates);
+  auto it = map.find(mapKey);
+  if (it == map.end()) {
+    return nullptr;
+  }
+  return &(*it).value;
+}
+
 void Database::addCharacterTemplate(const model::CharacterTemplate& characterTemplate) {
   characterTemplates[characterTemplate.name] = characterTemplate;
 }
@@ -115,21 +282,74 @@ const bmin::Map<bmin::String, model::GameEvent>& Database::getGameEvents() const
 }
 
 void Database::addGameEvent(const model::GameEvent& gameEvent) {
-  gameEvents[gameEvent.id] = gameEvent;
+  auto& stored = gameEvents[gameEvent.id];
+  stored = gameEvent;
+  model::indexGameEventChildren(stored);
+  for (const auto& error : runner::compileGameEventScripts(stored, gameEvents)) {
+    LOG(ERROR) << "Special event '" << stored.id << "' node '" << error.nodeId
+               << "': " << error.message << LOG_ENDL;
+  }
 }
 
 const model::CarcerMapTemplate& Database::getMapTemplate(std::string_view mapName) const {
-  return mapGet(mapTemplates, mapName, "Map template not found: ");
+  const auto& mapTemplate = mapGet(mapTemplates, mapName, "Map template not found: ");
+  if (lazyMaps.get() != nullptr) {
+    lazyMaps->ensure(mapName);
+  }
+  return mapTemplate;
+}
+
+const model::CarcerMapTemplate*
+Database::findMapTemplate(std::string_view mapName) const {
+  const auto mapKey = bmin::String(mapName.data(), mapName.size());
+  auto& map =
+      const_cast<bmin::Map<bmin::String, model::CarcerMapTemplate>&>(mapTemplates);
+  auto it = map.find(mapKey);
+  if (it == map.end()) {
+    return nullptr;
+  }
+  if (lazyMaps.get() != nullptr) {
+    lazyMaps->ensure(mapName);
+  }
+  return &(*it).value;
 }
 
 void Database::addMapTemplate(const model::CarcerMapTemplate& mapTemplate) {
+  if (lazyMaps.get() != nullptr) {
+    lazyMaps->store(mapTemplate);
+    return;
+  }
   mapTemplates[mapTemplate.name] = mapTemplate;
 }
 
 const bmin::Map<bmin::String, model::CarcerMapTemplate>& Database::getMapTemplates() const {
+  if (lazyMaps.get() != nullptr) {
+    lazyMaps->ensureAll();
+  }
   return mapTemplates;
 }
 
+void Database::setLazyMapLoading(bool lazy) { lazyMapLoading = lazy; }
+
+void Database::prefetchMapTemplates(const bmin::DynArray<bmin::String>& mapNames) const {
+  if (lazyMaps.get() != nullptr) {
+    lazyMaps->prefetch(mapNames);
+  }
+}
+
+void Database::waitForMapPrefetch() const {
+  if (lazyMaps.get() != nullptr) {
+    lazyMaps->waitForPrefetch();
+  }
+}
+
+size_t Database::getDecodedMapTemplateCount() const {
+  if (lazyMaps.get() != nullptr) {
+    return lazyMaps->getDecodedCount();
+  }
+  return mapTemplates.size();
+}
+
 const model::MapGridTemplate& Database::getMapGridTemplate(std::string_view gridName) const {
   return mapGet(mapGridTemplates, gridName, "Map grid template not found: ");
 }
@@ -1,6 +1,8 @@
 #pragma once
 
 #include "bmin/String.h"
+#include "bmin/UniquePtr.h"
+#include "db/ContentPack.h"
 #include "lib/bmin/Map.h"
 #include "model/templates/Abilities.h"
 #include "model/templates/CharacterTemplate.h"
@@ -24,9 +26,14 @@ const V& mapGet(const bmin::Map<bmin::String, V>& map, std::string_view key, con
   return (*const_cast<bmin::Map<bmin::String, V>&>(map).find(mapKey)).value;
 }
 
+class LazyMapTemplates;
+
 class Database {
 private:
   bmin::Map<bmin::String, model::ItemTemplate> itemTemplates;
+  // CharacterPlayer::params and CharacterInstance::characterTemplate point into this
+  // map, so character templates are only added during load (or test setup), before
+  // any character is created.
   bmin::Map<bmin::String, model::CharacterTemplate> characterTemplates;
   bmin::Map<bmin::String, model::AbilityTemplate> abilityTemplates;
   bmin::Map<bmin::String, model::StatusEffectTemplate> statusEffectTemplates;
@@ -34,14 +41,27 @@ private:
   bmin::Map<bmin::String, model::CarcerMapTemplate> mapTemplates;
   bmin::Map<bmin::String, model::MapGridTemplate> mapGridTemplates;
   bmin::Map<bmin::String, model::TilesetTemplate> tilesetTemplates;
+  // Set by a lazy loadFromJson; points into mapTemplates, so it is declared after it.
+  bmin::UniquePtr<LazyMapTemplates> lazyMaps;
+  bool lazyMapLoading = false;
+
+  // Drops every template (the lazy map state included).
+  void clear();
+
+  friend bmin::DynArray<uint8_t> encodeContentPack(const Database& database);
+  friend void decodeContentPack(std::string_view bytes, Database& database);
+  friend bmin::DynArray<bmin::String> findContentWarnings(const Database& database);
 
 public:
   Database();
-  ~Database() = default;
+  ~Database();
+  Database(const Database&) = delete;
+  Database& operator=(const Database&) = delete;
 
   const model::ItemTemplate& getItemTemplate(std::string_view itemName) const;
   void addItemTemplate(const model::ItemTemplate& itemTemplate);
   const model::CharacterTemplate& getCharacterTemplate(std::string_view templateName) const;
+  const model::CharacterTemplate* findCharacterTemplate(std::string_view templateName) const;
   void addCharacterTemplate(const model::CharacterTemplate& characterTemplate);
   const model::AbilityTemplate& getAbilityTemplate(std::string_view abilityName) const;
   void addAbilityTemplate(const model::AbilityTemplate& abilityTemplate);
@@ -50,9 +70,24 @@ public:
   const model::GameEvent& getGameEvent(std::string_view eventId) const;
   const bmin::Map<bmin::String, model::GameEvent>& getGameEvents() const;
   void addGameEvent(const model::GameEvent& gameEvent);
+  // With lazy map loading, the map lookups decode a map's tiles and placements the
+  // first time it is asked for; getMapTemplates() decodes every map.
   const model::CarcerMapTemplate& getMapTemplate(std::string_view mapName) const;
+  const model::CarcerMapTemplate* findMapTemplate(std::string_view mapName) const;
   void addMapTemplate(const model::CarcerMapTemplate& mapTemplate);
   const bmin::Map<bmin::String, model::CarcerMapTemplate>& getMapTemplates() const;
+  // Off by default. When on, loadFromJson stores only the map headers (name, label,
+  // type, size, tilesets, layers) and a map is decoded on its first lookup; packs are
+  // always loaded whole. Map instances are then created per grid on its first visit
+  // (game::ensureGridMapInstances) instead of all at once.
+  void setLazyMapLoading(bool lazy);
+  bool isLazyMapLoading() const { return lazyMapLoading; }
+  // Decodes the named maps on a background thread ahead of their first lookup. Does
+  // nothing unless maps were loaded lazily, and on Emscripten.
+  void prefetchMapTemplates(const bmin::DynArray<bmin::String>& mapNames) const;
+  void waitForMapPrefetch() const;
+  // Maps whose tiles are in memory: all of them unless loaded lazily.
+  size_t getDecodedMapTemplateCount() const;
   const model::MapGridTemplate& getMapGridTemplate(std::string_view gridName) const;
   const model::MapGridTemplate* findMapGridTemplate(std::string_view gridName) const;
   const bmin::Map<bmin::String, model::MapGridTemplate>& getMapGridTemplates() const;
@@ -60,7 +95,13 @@ public:
   const model::TilesetTemplate& getTilesetTemplate(std::string_view tilesetName) const;
   const model::TilesetTemplate* findTilesetTemplate(std::string_view tilesetName) const;
   void addTilesetTemplate(const model::TilesetTemplate& tilesetTemplate);
+  // Reads CONTENT_PACK_PATH when it is newer than the JSON sources, else loadFromJson.
   void load();
+  // Parses every assets/db JSON file; the content pack tool builds packs from this.
+  // Files are parsed concurrently, each into its own map, on numThreads workers
+  // (0 = std::thread::hardware_concurrency(), capped at 4; 1 = in sequence). Always 1 on
+  // Emscripten.
+  void loadFromJson(int numThreads = 0);
   void validateCombatReferences() const;
 };
 
@@ -0,0 +1,156 @@
+#include "db/LazyMapTemplates.h"
+#include "bmin/StringInterop.h"
+#include "lib/StartupProfiler.h"
+#include "sdl2w/Logger.h"
+#include <exception>
+#include <utility>
+
+namespace db {
+
+LazyMapTemplates::LazyMapTemplates(
+    bmin::String _source,
+    bmin::DynArray<MapTemplateSource> _slots,
+    bmin::Map<bmin::String, model::CarcerMapTemplate>& _templates)
+    : source(std::move(_source)),
+      slots(std::move(_slots)),
+      decoded(std::make_unique<std::atomic<bool>[]>(slots.size())),
+      templates(&_templates) {
+  for (size_t i = 0; i < slots.size(); i++) {
+    slotByName[slots[i].name] = i;
+  }
+}
+
+LazyMapTemplates::~LazyMapTemplates() {
+#ifndef __EMSCRIPTEN__
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    stopping = true;
+  }
+  wakeWorker.notify_all();
+  if (worker.joinable()) {
+    worker.join();
+  }
+#endif
+}
+
+const size_t* LazyMapTemplates::findSlot(std::string_view mapName) const {
+  auto& map = const_cast<bmin::Map<bmin::String, size_t>&>(slotByName);
+  auto it = map.find(bmin::String(mapName.data(), mapName.size()));
+  if (it == map.end()) {
+    return nullptr;
+  }
+  return &(*it).value;
+}
+
+void LazyMapTemplates::decodeSlot(size_t slot) {
+  if (decoded[slot].load(std::memory_order_acquire)) {
+    return;
+  }
+  // The text is never modified, so decoding needs no lock; a map requested by the main
+  // thread and the worker at once is decoded twice and stored once.
+  StartupProfiler::Scope scope(
+      bmin::toStringView(bmin::String("map decode ") + slots[slot].name));
+  auto mapTemplate = decodeMapTemplateAt(source, slots[slot].offset);
+  std::lock_guard<std::mutex> lock(decodeMutex);
+  if (decoded[slot].load(std::memory_order_relaxed)) {
+    return;
+  }
+  // find() rather than operator[]: other threads may be looking up entries meanwhile.
+  auto it = templates->find(slots[slot].name);
+  if (it != templates->end()) {
+    (*it).value = std::move(mapTemplate);
+  }
+  decoded[slot].store(true, std::memory_order_release);
+}
+
+void LazyMapTemplates::ensure(std::string_view mapName) {
+  if (const size_t* slot = findSlot(mapName)) {
+    decodeSlot(*slot);
+  }
+}
+
+void LazyMapTemplates::ensureAll() {
+  for (size_t i = 0; i < slots.size(); i++) {
+    decodeSlot(i);
+  }
+}
+
+void LazyMapTemplates::store(const model::CarcerMapTemplate& mapTemplate) {
+  std::lock_guard<std::mutex> lock(decodeMutex);
+  (*templates)[mapTemplate.name] = mapTemplate;
+  if (const size_t* slot = findSlot(bmin::toStringView(mapTemplate.name))) {
+    decoded[*slot].store(true, std::memory_order_release);
+  }
+}
+
+size_t LazyMapTemplates::getDecodedCount() const {
+  size_t count = 0;
+  for (size_t i = 0; i < slots.size(); i++) {
+    if (decoded[i].load(std::memory_order_acquire)) {
+      count++;
+    }
+  }
+  return count;
+}
+
+#ifndef __EMSCRIPTEN__
+void LazyMapTemplates::workerLoop() {
+  std::unique_lock<std::mutex> lock(mutex);
+  while (true) {
+    wakeWorker.wait(lock, [this]() { return stopping || !queue.empty(); });
+    if (stopping) {
+      return;
+    }
+    auto batch = std::move(queue);
+    queue.clear();
+    lock.unlock();
+    for (const size_t slot : batch) {
+      try {
+        decodeSlot(slot);
+      } catch (const std::exception& e) {
+        // Left undecoded: the lookup that needs the map reports the error.
+        LOG(WARN) << "Could not prefetch map " << slots[slot].name << ": " << e.what()
+                  << LOG_ENDL;
+      }
+    }
+    lock.lock();
+    if (queue.empty()) {
+      busy = false;
+      queueDone.notify_all();
+    }
+  }
+}
+#endif
+
+void LazyMapTemplates::prefetch(const bmin::DynArray<bmin::String>& mapNames) {
+#ifdef __EMSCRIPTEN__
+  (void)mapNames;
+#else
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    for (const auto& mapName : mapNames) {
+      const size_t* slot = findSlot(bmin::toStringView(mapName));
+      if (slot && !decoded[*slot].load(std::memory_order_acquire)) {
+        queue.pushBack(*slot);
+      }
+    }
+    if (queue.empty()) {
+      return;
+    }
+    busy = true;
+  }
+  if (!worker.joinable()) {
+    worker = std::thread([this]() { workerLoop(); });
+  }
+  wakeWorker.notify_one();
+#endif
+}
+
+void LazyMapTemplates::waitForPrefetch() {
+#ifndef __EMSCRIPTEN__
+  std::unique_lock<std::mutex> lock(mutex);
+  queueDone.wait(lock, [this]() { return !busy; });
+#endif
+}
+
+} // namespace db
@@ -0,0 +1,73 @@
+#pragma once
+
+#include "bmin/DynArray.h"
+#include "bmin/String.h"
+#include "db/loaders/LoadMapTemplates.h"
+#include "lib/bmin/Map.h"
+#include "model/templates/Maps.h"
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <string_view>
+
+#ifndef __EMSCRIPTEN__
+#include <condition_variable>
+#include <thread>
+#endif
+
+namespace db {
+
+// Map templates that are decoded on first use. Owned by Database when lazy map loading
+// is on: the load stores only each map's header (indexMapTemplates) and keeps the
+// maps JSON text; the first lookup of a map decodes its tiles and placements into the
+// existing entry, so references into the template map stay valid. prefetch() decodes
+// maps ahead of time on a worker thread; Emscripten builds have no worker and ignore
+// it.
+class LazyMapTemplates {
+public:
+  LazyMapTemplates(bmin::String _source,
+                   bmin::DynArray<MapTemplateSource> _slots,
+                   bmin::Map<bmin::String, model::CarcerMapTemplate>& _templates);
+  ~LazyMapTemplates();
+  LazyMapTemplates(const LazyMapTemplates&) = delete;
+  LazyMapTemplates& operator=(const LazyMapTemplates&) = delete;
+
+  // Decodes mapName unless it is decoded already or was never indexed. Throws
+  // std::runtime_error when its JSON does not decode.
+  void ensure(std::string_view mapName);
+  void ensureAll();
+  // Stores mapTemplate (addMapTemplate) and marks it decoded so the indexed text does
+  // not overwrite it later.
+  void store(const model::CarcerMapTemplate& mapTemplate);
+  // Queues the named maps for the worker. Unknown and decoded names are skipped.
+  void prefetch(const bmin::DynArray<bmin::String>& mapNames);
+  // Blocks until every queued prefetch is decoded.
+  void waitForPrefetch();
+  size_t getDecodedCount() const;
+
+private:
+  bmin::String source;
+  bmin::DynArray<MapTemplateSource> slots;
+  bmin::Map<bmin::String, size_t> slotByName;
+  std::unique_ptr<std::atomic<bool>[]> decoded;
+  bmin::Map<bmin::String, model::CarcerMapTemplate>* templates;
+  // Held while an entry of templates is written.
+  std::mutex decodeMutex;
+#ifndef __EMSCRIPTEN__
+  bool stopping = false;
+  bool busy = false;
+  bmin::DynArray<size_t> queue;
+  std::mutex mutex;
+  std::condition_variable wakeWorker;
+  std::condition_variable queueDone;
+  std::thread worker;
+
+  void workerLoop();
+#endif
+
+  const size_t* findSlot(std::string_view mapName) const;
+  void decodeSlot(size_t slot);
+};
+
+} // namespace db
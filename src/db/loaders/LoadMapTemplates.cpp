@@ -1,228 +1,328 @@
 #include "LoadMapTemplates.h"
 #include "bmin/StringInterop.h"
 #include "lib/Json.h"
+#include "lib/JsonReader.h"
 #include "sdl2w/AssetLoader.h"
 #include <stdexcept>
+#include <string_view>
 
 namespace db {
 namespace {
 
-void loadTileOverrides(const Json& json, model::TileOverrides& overrides) {
-  if (json.contains("isWalkableOverride")) {
-    overrides.isWalkableOverride = json["isWalkableOverride"].get<bool>();
+void readLightSourceField(JsonReader& reader,
+                          std::string_view key,
+                          model::TileLightSource& light) {
+  if (key == "angle") {
+    light.angle = reader.readInt();
+  } else if (key == "intensity") {
+    light.intensity = reader.readInt();
+  } else if (key == "radius") {
+    light.radius = reader.readInt();
+  } else {
+    reader.skipValue();
   }
-  if (json.contains("isSeeThroughOverride")) {
-    overrides.isSeeThroughOverride = json["isSeeThroughOverride"].get<bool>();
-  }
-  if (json.contains("isContainerOverride")) {
-    overrides.isContainerOverride = json["isContainerOverride"].get<bool>();
-  }
-  if (json.contains("lightSourceOverride") && json["lightSourceOverride"].is_object()) {
-    const auto& ls = json["lightSourceOverride"];
-    model::TileLightSource light{};
-    if (ls.contains("angle")) {
-      light.angle = ls["angle"].get<int>();
-    }
-    if (ls.contains("intensity")) {
-      light.intensity = ls["intensity"].get<int>();
-    }
-    if (ls.contains("radius")) {
-      light.radius = ls["radius"].get<int>();
+}
+
+void readTileOverrides(JsonReader& reader, model::TileOverrides& overrides) {
+  std::string_view key;
+  while (reader.nextKey(key)) {
+    if (key == "isWalkableOverride") {
+      overrides.isWalkableOverride = reader.readBool();
+    } else if (key == "isSeeThroughOverride") {
+      overrides.isSeeThroughOverride = reader.readBool();
+    } else if (key == "isContainerOverride") {
+      overrides.isContainerOverride = reader.readBool();
+    } else if (key == "lightSourceOverride" && reader.tryBeginObject()) {
+      model::TileLightSource light{};
+      while (reader.nextKey(key)) {
+        readLightSourceField(reader, key, light);
+      }
+      overrides.lightSourceOverride = light;
+    } else if (key != "lightSourceOverride") {
+      reader.skipValue();
     }
-    overrides.lightSourceOverride = light;
   }
 }
 
-void loadLightSource(const Json& json, model::TileLightSource& light) {
-  if (json.contains("angle")) {
-    light.angle = json["angle"].get<int>();
-  }
-  if (json.contains("intensity")) {
-    light.intensity = json["intensity"].get<int>();
+// Reads an array of placements. l and i are common to all of them; readField consumes
+// the value of any other key. Entries that are not objects keep their defaults.
+template <typename Placement, typename ReadField>
+void readPlacements(JsonReader& reader,
+                    bmin::DynArray<Placement>& placements,
+                    ReadField readField) {
+  if (!reader.tryBeginArray()) {
+    return;
   }
-  if (json.contains("radius")) {
-    light.radius = json["radius"].get<int>();
+  while (reader.nextElement()) {
+    Placement placement;
+    if (reader.tryBeginObject()) {
+      std::string_view key;
+      while (reader.nextKey(key)) {
+        if (key == "l") {
+          placement.l = reader.readIntOr(0);
+        } else if (key == "i") {
+          placement.i = reader.readIntOr(0);
+        } else {
+          readField(key, placement);
+        }
+      }
+    }
+    placements.pushBack(std::move(placement));
   }
 }
 
-model::CarcerMapTemplate parseFlatMap(const Json& mapJson) {
-  model::CarcerMapTemplate mapTemplate;
-
-  if (!mapJson.contains("name") || !mapJson["name"].is_string()) {
-    throw std::runtime_error("Map template missing name");
-  }
-  mapTemplate.name = mapJson["name"].get<bmin::String>();
+model::TileOverlayVisibility readOverlayVisibility(JsonReader& reader) {
+  return model::getTileOverlayVisibilityFromString(
+      reader.readStringOr(bmin::String("HIDDEN")));
+}
 
-  if (mapJson.contains("label") && mapJson["label"].is_string()) {
-    mapTemplate.label = mapJson["label"].get<bmin::String>();
-  }
-  if (mapJson.contains("type") && mapJson["type"].is_string()) {
-    mapTemplate.type = model::getMapTypeFromString(mapJson["type"].get<bmin::String>());
-  }
-  if (mapJson.contains("width")) {
-    mapTemplate.width = mapJson["width"].get<int>();
-  }
-  if (mapJson.contains("height")) {
-    mapTemplate.height = mapJson["height"].get<int>();
-  }
-  if (mapJson.contains("spriteWidth")) {
-    mapTemplate.spriteWidth = mapJson["spriteWidth"].get<int>();
+void readTiles(JsonReader& reader, model::CarcerMapTemplate& mapTemplate) {
+  if (!reader.tryBeginObject()) {
+    return;
   }
-  if (mapJson.contains("spriteHeight")) {
-    mapTemplate.spriteHeight = mapJson["spriteHeight"].get<int>();
-  }
-
-  if (mapJson.contains("tilesets") && mapJson["tilesets"].is_array()) {
-    for (const auto& tilesetJson : mapJson["tilesets"]) {
-      mapTemplate.tilesets.pushBack(tilesetJson.get<bmin::String>());
+  std::string_view layerKey;
+  while (reader.nextKey(layerKey)) {
+    const int layer = bmin::parseInt(bmin::String(layerKey.data(), layerKey.size()));
+    if (reader.peekType() != JsonReader::Type::Array || layer < 0) {
+      reader.skipValue();
+      continue;
     }
-  }
-  if (mapTemplate.tilesets.empty()) {
-    mapTemplate.tilesets.pushBack("");
-  }
-
-  if (mapJson.contains("layers") && mapJson["layers"].is_array()) {
-    for (const auto& layerJson : mapJson["layers"]) {
-      mapTemplate.layers.pushBack(layerJson.get<int>());
+    const auto idx = static_cast<size_t>(layer);
+    if (mapTemplate.tiles.size() <= idx) {
+      mapTemplate.tiles.resize(idx + 1);
     }
+    mapTemplate.tiles[idx].clear();
+    reader.readIntArrayInto(mapTemplate.tiles[idx]);
   }
-  if (mapTemplate.layers.empty()) {
-    mapTemplate.layers.pushBack(0);
-  }
+}
 
-  if (mapJson.contains("tiles") && mapJson["tiles"].is_object()) {
-    for (const auto& [layerKey, graphicsJson] : mapJson["tiles"].items()) {
-      if (!graphicsJson.is_array()) {
-        continue;
-      }
-      const int layer = bmin::parseInt(bmin::String(layerKey.c_str()));
-      bmin::DynArray<int> graphics;
-      graphics.reserve(graphicsJson.size());
-      for (const auto& value : graphicsJson) {
-        graphics.pushBack(value.get<int>());
-      }
-      if (layer >= 0) {
-        const auto idx = static_cast<size_t>(layer);
-        if (mapTemplate.tiles.size() <= idx) {
-          mapTemplate.tiles.resize(idx + 1);
+// With headerOnly, everything after the header fields (tiles, placements) is skipped:
+// the values are still checked for syntax but nothing is stored.
+model::CarcerMapTemplate readFlatMap(JsonReader& reader, bool headerOnly) {
+  model::CarcerMapTemplate mapTemplate;
+  bool hasName = false;
+
+  if (reader.tryBeginObject()) {
+    std::string_view key;
+    while (reader.nextKey(key)) {
+      if (key == "name") {
+        hasName = reader.peekType() == JsonReader::Type::String;
+        mapTemplate.name = reader.readStringOr(bmin::String());
+      } else if (key == "label") {
+        mapTemplate.label = reader.readStringOr(mapTemplate.label);
+      } else if (key == "type") {
+        if (reader.peekType() == JsonReader::Type::String) {
+          mapTemplate.type = model::getMapTypeFromString(reader.readString());
+        } else {
+          reader.skipValue();
         }
-        mapTemplate.tiles[idx] = std::move(graphics);
+      } else if (key == "width") {
+        mapTemplate.width = reader.readInt();
+      } else if (key == "height") {
+        mapTemplate.height = reader.readInt();
+      } else if (key == "spriteWidth") {
+        mapTemplate.spriteWidth = reader.readInt();
+      } else if (key == "spriteHeight") {
+        mapTemplate.spriteHeight = reader.readInt();
+      } else if (key == "tilesets") {
+        mapTemplate.tilesets.clear();
+        if (reader.peekType() == JsonReader::Type::Array) {
+          reader.readStringArrayInto(mapTemplate.tilesets);
+        } else {
+          reader.skipValue();
+        }
+      } else if (key == "layers") {
+        mapTemplate.layers.clear();
+        if (reader.peekType() == JsonReader::Type::Array) {
+          reader.readIntArrayInto(mapTemplate.layers);
+        } else {
+          reader.skipValue();
+        }
+      } else if (headerOnly) {
+        reader.skipValue();
+      } else if (key == "tiles") {
+        readTiles(reader, mapTemplate);
+      } else if (key == "characters") {
+        readPlacements(
+            reader, mapTemplate.characters,
+            [&](std::string_view field, model::MapCharacterPlacement& placement) {
+              if (field == "name") {
+                placement.name = reader.readStringOr(bmin::String());
+              } else {
+                reader.skipValue();
+              }
+            });
+      } else if (key == "items") {
+        readPlacements(
+            reader, mapTemplate.items,
+            [&](std::string_view field, model::MapItemPlacement& placement) {
+              if (field == "name") {
+                placement.name = reader.readStringOr(bmin::String());
+              } else if (field == "quantity") {
+                placement.quantity = reader.readIntOr(1);
+              } else {
+                reader.skipValue();
+              }
+            });
+      } else if (key == "markers") {
+        readPlacements(
+            reader, mapTemplate.markers,
+            [&](std::string_view field, model::MapMarkerPlacement& placement) {
+              if (field == "name") {
+                placement.name = reader.readStringOr(bmin::String());
+              } else {
+                reader.skipValue();
+              }
+            });
+      } else if (key == "eventTriggers") {
+        readPlacements(
+            reader, mapTemplate.eventTriggers,
+            [&](std::string_view field, model::MapEventTriggerPlacement& placement) {
+              if (field == "eventId") {
+                placement.eventId = reader.readStringOr(bmin::String());
+              } else if (field == "requiresNonCombat") {
+                placement.requiresNonCombat = reader.readBoolOr(true);
+              } else if (field == "requiresLook") {
+                placement.requiresLook = reader.readBoolOr(false);
+              } else if (field == "overlayVisibility") {
+                placement.overlayVisibility = readOverlayVisibility(reader);
+              } else {
+                reader.skipValue();
+              }
+            });
+      } else if (key == "travelTriggers") {
+        readPlacements(
+            reader, mapTemplate.travelTriggers,
+            [&](std::string_view field, model::MapTravelTriggerPlacement& placement) {
+              if (field == "destinationMapName") {
+                placement.destinationMapName = reader.readStringOr(bmin::String());
+              } else if (field == "destinationMarkerName") {
+                placement.destinationMarkerName = reader.readStringOr(bmin::String());
+              } else if (field == "destinationX") {
+                placement.destinationX = reader.readIntOr(0);
+              } else if (field == "destinationY") {
+                placement.destinationY = reader.readIntOr(0);
+              } else if (field == "destinationLayer") {
+                placement.destinationLayer = reader.readIntOr(0);
+              } else if (field == "requiresAction") {
+                placement.requiresAction = reader.readBoolOr(false);
+              } else if (field == "overlayVisibility") {
+                placement.overlayVisibility = readOverlayVisibility(reader);
+              } else {
+                reader.skipValue();
+              }
+            });
+      } else if (key == "tileOverrides") {
+        readPlacements(
+            reader, mapTemplate.tileOverrides,
+            [&](std::string_view field, model::MapTileOverridePlacement& placement) {
+              if (field == "overrides" && reader.tryBeginObject()) {
+                readTileOverrides(reader, placement.overrides);
+              } else if (field != "overrides") {
+                reader.skipValue();
+              }
+            });
+      } else if (key == "lightSources") {
+        readPlacements(
+            reader, mapTemplate.lightSources,
+            [&](std::string_view field, model::MapLightSourcePlacement& placement) {
+              readLightSourceField(reader, field, placement);
+            });
+      } else {
+        reader.skipValue();
       }
     }
   }
 
-  if (mapJson.contains("characters") && mapJson["characters"].is_array()) {
-    for (const auto& entry : mapJson["characters"]) {
-      model::MapCharacterPlacement placement;
-      placement.l = entry.value("l", 0);
-      placement.i = entry.value("i", 0);
-      placement.name = entry.value("name", bmin::String());
-      mapTemplate.characters.pushBack(std::move(placement));
-    }
-  }
-
-  if (mapJson.contains("items") && mapJson["items"].is_array()) {
-    for (const auto& entry : mapJson["items"]) {
-      model::MapItemPlacement placement;
-      placement.l = entry.value("l", 0);
-      placement.i = entry.value("i", 0);
-      placement.name = entry.value("name", bmin::String());
-      placement.quantity = entry.value("quantity", 1);
-      mapTemplate.items.pushBack(std::move(placement));
-    }
+  if (!hasName) {
+    throw std::runtime_error("Map template missing name");
   }
-
-  if (mapJson.contains("markers") && mapJson["markers"].is_array()) {
-    for (const auto& entry : mapJson["markers"]) {
-      model::MapMarkerPlacement placement;
-      placement.l = entry.value("l", 0);
-      placement.i = entry.value("i", 0);
-      placement.name = entry.value("name", bmin::String());
-      mapTemplate.markers.pushBack(std::move(placement));
-    }
+  if (mapTemplate.tilesets.empty()) {
+    mapTemplate.tilesets.pushBack("");
   }
-
-  if (mapJson.contains("eventTriggers") && mapJson["eventTriggers"].is_array()) {
-    for (const auto& entry : mapJson["eventTriggers"]) {
-      model::MapEventTriggerPlacement placement;
-      placement.l = entry.value("l", 0);
-      placement.i = entry.value("i", 0);
-      placement.eventId = entry.value("eventId", bmin::String());
-      placement.requiresNonCombat = entry.value("requiresNonCombat", true);
-      placement.requiresLook = entry.value("requiresLook", false);
-      placement.overlayVisibility = model::getTileOverlayVisibilityFromString(
-          entry.value("overlayVisibility", bmin::String("HIDDEN")));
-      mapTemplate.eventTriggers.pushBack(std::move(placement));
-    }
+  if (mapTemplate.layers.empty()) {
+    mapTemplate.layers.pushBack(0);
   }
+  return mapTemplate;
+}
 
-  if (mapJson.contains("travelTriggers") && mapJson["travelTriggers"].is_array()) {
-    for (const auto& entry : mapJson["travelTriggers"]) {
-      model::MapTravelTriggerPlacement placement;
-      placement.l = entry.value("l", 0);
-      placement.i = entry.value("i", 0);
-      placement.destinationMapName = entry.value("destinationMapName", bmin::String());
-      placement.destinationMarkerName = entry.value("destinationMarkerName", bmin::String());
-      placement.destinationX = entry.value("destinationX", 0);
-      placement.destinationY = entry.value("destinationY", 0);
-      placement.destinationLayer = entry.value("destinationLayer", 0);
-      placement.requiresAction = entry.value("requiresAction", false);
-      placement.overlayVisibility = model::getTileOverlayVisibilityFromString(
-          entry.value("overlayVisibility", bmin::String("HIDDEN")));
-      mapTemplate.travelTriggers.pushBack(std::move(placement));
+// Reads the top-level maps array, calling onMap(reader, offset) with the reader at the
+// start of each element.
+template <typename OnMap>
+void readMapsArray(const bmin::String& fileContent, OnMap onMap) {
+  try {
+    JsonReader reader(fileContent.cStr(), true);
+    if (reader.peekType() != JsonReader::Type::Array) {
+      throw std::runtime_error("Maps JSON must be an array");
     }
-  }
-
-  if (mapJson.contains("tileOverrides") && mapJson["tileOverrides"].is_array()) {
-    for (const auto& entry : mapJson["tileOverrides"]) {
-      model::MapTileOverridePlacement placement;
-      placement.l = entry.value("l", 0);
-      placement.i = entry.value("i", 0);
-      if (entry.contains("overrides") && entry["overrides"].is_object()) {
-        loadTileOverrides(entry["overrides"], placement.overrides);
-      }
-      mapTemplate.tileOverrides.pushBack(std::move(placement));
+    reader.beginArray();
+    while (reader.nextElement()) {
+      onMap(reader, reader.getOffset());
     }
+    reader.expectEnd();
+  } catch (const Json::parse_error& e) {
+    throw std::runtime_error((bmin::String("Failed to parse maps JSON: ") + e.what()).cStr());
   }
+}
 
-  if (mapJson.contains("lightSources") && mapJson["lightSources"].is_array()) {
-    for (const auto& entry : mapJson["lightSources"]) {
-      model::MapLightSourcePlacement placement;
-      placement.l = entry.value("l", 0);
-      placement.i = entry.value("i", 0);
-      loadLightSource(entry, placement);
-      mapTemplate.lightSources.pushBack(std::move(placement));
-    }
+void checkUniqueName(
+    const bmin::Map<bmin::String, model::CarcerMapTemplate>& mapTemplates,
+    const bmin::String& name) {
+  if (mapTemplates.contains(name)) {
+    throw std::runtime_error(
+        (bmin::String("Duplicate map template name: ") + name).cStr());
   }
-
-  return mapTemplate;
 }
 
 } // namespace
 
+// Decoded with JsonReader rather than a Json tree: the tile layers are thousands of
+// integers per map and are read straight into the template.
 void loadMapTemplates(const bmin::String& mapsFilePath,
                       bmin::Map<bmin::String, model::CarcerMapTemplate>& mapTemplates) {
   const bmin::String fileContent = sdl2w::loadFileAsString(bmin::toStringView(mapsFilePath));
 
-  Json jsonData;
-  try {
-    jsonData = Json::parse(fileContent.cStr(), nullptr, true, true);
-  } catch (const Json::parse_error& e) {
-    throw std::runtime_error((bmin::String("Failed to parse maps JSON: ") + e.what()).cStr());
-  }
+  bmin::DynArray<model::CarcerMapTemplate> loaded;
+  readMapsArray(fileContent, [&](JsonReader& reader, size_t) {
+    loaded.pushBack(readFlatMap(reader, false));
+  });
 
-  if (!jsonData.is_array()) {
-    throw std::runtime_error("Maps JSON must be an array");
+  for (auto& mapTemplate : loaded) {
+    checkUniqueName(mapTemplates, mapTemplate.name);
+    mapTemplates[mapTemplate.name] = std::move(mapTemplate);
   }
+}
 
-  for (const auto& mapJson : jsonData) {
-    model::CarcerMapTemplate mapTemplate = parseFlatMap(mapJson);
-    if (mapTemplates.contains(mapTemplate.name)) {
-      throw std::runtime_error((bmin::String("Duplicate map template name: ") + mapTemplate.name)
-                                   .cStr());
-    }
+bmin::String
+indexMapTemplates(const bmin::String& mapsFilePath,
+                  bmin::Map<bmin::String, model::CarcerMapTemplate>& mapTemplates,
+                  bmin::DynArray<MapTemplateSource>& sources) {
+  bmin::String fileContent = sdl2w::loadFileAsString(bmin::toStringView(mapsFilePath));
+
+  bmin::DynArray<model::CarcerMapTemplate> loaded;
+  readMapsArray(fileContent, [&](JsonReader& reader, size_t offset) {
+    loaded.pushBack(readFlatMap(reader, true));
+    sources.pushBack(MapTemplateSource{loaded.back().name, offset});
+  });
+
+  for (auto& mapTemplate : loaded) {
+    checkUniqueName(mapTemplates, mapTemplate.name);
     mapTemplates[mapTemplate.name] = std::move(mapTemplate);
   }
+  return fileContent;
+}
+
+model::CarcerMapTemplate decodeMapTemplateAt(const bmin::String& fileContent,
+                                             size_t offset) {
+  if (offset >= fileContent.size()) {
+    throw std::runtime_error("Map template offset is past the end of the maps JSON");
+  }
+  try {
+    JsonReader reader(fileContent.cStr() + offset, true);
+    return readFlatMap(reader, false);
+  } catch (const Json::parse_error& e) {
+    throw std::runtime_error((bmin::String("Failed to parse maps JSON: ") + e.what()).cStr());
+  }
 }
 
 } // namespace db
@@ -1,5 +1,6 @@
 #pragma once
 
+#include "bmin/DynArray.h"
 #include "bmin/String.h"
 #include "lib/bmin/Map.h"
 #include "model/templates/Maps.h"
@@ -9,4 +10,23 @@ namespace db {
 void loadMapTemplates(const bmin::String& mapsFilePath,
                       bmin::Map<bmin::String, model::CarcerMapTemplate>& mapTemplates);
 
+// Where a map's JSON object starts in the maps file text.
+struct MapTemplateSource {
+  bmin::String name;
+  size_t offset = 0;
+};
+
+// Like loadMapTemplates, but stores only each map's header (name, label, type, size,
+// tilesets, layers): tiles and placements are syntax-checked and skipped. Appends the
+// position of every map to sources and returns the file text that decodeMapTemplateAt
+// reads the full maps from.
+bmin::String
+indexMapTemplates(const bmin::String& mapsFilePath,
+                  bmin::Map<bmin::String, model::CarcerMapTemplate>& mapTemplates,
+                  bmin::DynArray<MapTemplateSource>& sources);
+
+// Decodes the complete map whose JSON object starts at offset in fileContent.
+model::CarcerMapTemplate decodeMapTemplateAt(const bmin::String& fileContent,
+                                             size_t offset);
+
 } // namespace db
@@ -1,12 +1,22 @@
 #include "LoadSpecialEvents.h"
 #include "bmin/StringInterop.h"
 #include "lib/Json.h"
+#include "lib/JsonReader.h"
 #include "lib/StringUtil.h"
 #include "sdl2w/AssetLoader.h"
 #include "model/templates/SpecialEvents.h"
+#include "runner/EventBundle.h"
+#include "runner/ScriptCompiler.h"
+#include "runner/SeCompiler.h"
+#include "sdl2w/Logger.h"
 #include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
 #include <optional>
 #include <stdexcept>
+#include <string>
+#include <string_view>
 
 namespace db {
 
@@ -52,29 +62,176 @@ static bmin::DynArray<bmin::String> splitParagraphs(const bmin::String& p) {
   return paragraphs;
 }
 
-static model::AudioInfo parseAudioInfo(const Json& audioJson) {
-  model::AudioInfo audioInfo;
-  if (audioJson.contains("audioName") && audioJson["audioName"].is_string()) {
-    audioInfo.audioName = audioJson["audioName"].get<bmin::String>();
+static std::optional<bmin::String> readOptionalString(JsonReader& reader) {
+  if (reader.peekType() != JsonReader::Type::String) {
+    reader.skipValue();
+    return std::nullopt;
   }
-  if (audioJson.contains("volume") && audioJson["volume"].is_number_integer()) {
-    audioInfo.volume = audioJson["volume"].get<int>();
+  return reader.readString();
+}
+
+static std::optional<model::AudioInfo> readAudioInfo(JsonReader& reader) {
+  if (!reader.tryBeginObject()) {
+    return std::nullopt;
   }
-  if (audioJson.contains("offset") && audioJson["offset"].is_number_integer()) {
-    audioInfo.offset = audioJson["offset"].get<int>();
+  model::AudioInfo audioInfo{};
+  std::string_view key;
+  while (reader.nextKey(key)) {
+    if (key == "audioName") {
+      audioInfo.audioName = reader.readStringOr(audioInfo.audioName);
+    } else if (key == "volume") {
+      audioInfo.volume = reader.readIntOr(audioInfo.volume);
+    } else if (key == "offset") {
+      audioInfo.offset = reader.readIntOr(audioInfo.offset);
+    } else {
+      reader.skipValue();
+    }
   }
   return audioInfo;
 }
 
-static std::optional<model::GameEventChild> parseGameEventChild(const Json& childJson) {
-  if (!childJson.contains("eventChildType") || !childJson["eventChildType"].is_string()) {
+static bmin::DynArray<model::ChoiceSwitchText> readChoiceSwitchText(JsonReader& reader) {
+  bmin::DynArray<model::ChoiceSwitchText> switchTexts;
+  if (!reader.tryBeginArray()) {
+    return switchTexts;
+  }
+  while (reader.nextElement()) {
+    model::ChoiceSwitchText switchText;
+    if (reader.tryBeginObject()) {
+      std::string_view key;
+      while (reader.nextKey(key)) {
+        if (key == "conditionStr") {
+          switchText.conditionStr = reader.readStringOr(switchText.conditionStr);
+        } else if (key == "text") {
+          switchText.text = reader.readStringOr(switchText.text);
+        } else {
+          reader.skipValue();
+        }
+      }
+    }
+    switchTexts.pushBack(std::move(switchText));
+  }
+  return switchTexts;
+}
+
+static bmin::DynArray<model::Choice> readChoices(JsonReader& reader) {
+  bmin::DynArray<model::Choice> choices;
+  if (!reader.tryBeginArray()) {
+    return choices;
+  }
+  while (reader.nextElement()) {
+    model::Choice choice;
+    if (reader.tryBeginObject()) {
+      std::string_view key;
+      while (reader.nextKey(key)) {
+        if (key == "text") {
+          choice.text = reader.readStringOr(choice.text);
+        } else if (key == "prefixText") {
+          choice.prefixText = reader.readStringOr(choice.prefixText);
+        } else if (key == "conditionStr") {
+          choice.conditionStr = reader.readStringOr(choice.conditionStr);
+        } else if (key == "evalStr") {
+          choice.evalStr = reader.readStringOr(choice.evalStr);
+        } else if (key == "next") {
+          choice.next = reader.readStringOr(choice.next);
+        } else if (key == "switchText") {
+          choice.switchText = readChoiceSwitchText(reader);
+        } else {
+          reader.skipValue();
+        }
+      }
+    }
+    choices.pushBack(std::move(choice));
+  }
+  return choices;
+}
+
+static bmin::DynArray<model::SwitchCase> readSwitchCases(JsonReader& reader) {
+  bmin::DynArray<model::SwitchCase> cases;
+  if (!reader.tryBeginArray()) {
+    return cases;
+  }
+  while (reader.nextElement()) {
+    model::SwitchCase switchCase;
+    if (reader.tryBeginObject()) {
+      std::string_view key;
+      while (reader.nextKey(key)) {
+        if (key == "conditionStr") {
+          switchCase.conditionStr = reader.readStringOr(switchCase.conditionStr);
+        } else if (key == "next") {
+          switchCase.next = reader.readStringOr(switchCase.next);
+        } else {
+          reader.skipValue();
+        }
+      }
+    }
+    cases.pushBack(std::move(switchCase));
+  }
+  return cases;
+}
+
+// Every member a child object may carry. Which of them apply depends on
+// eventChildType, which is only known once the whole object has been read.
+struct JsonEventChildFields {
+  std::optional<bmin::String> eventChildType;
+  std::optional<bmin::String> id;
+  bmin::String p;
+  bmin::String execStr;
+  bmin::String next;
+  bmin::String text;
+  bmin::String defaultNext;
+  bool autoAdvance = false;
+  std::optional<model::AudioInfo> audioInfo;
+  bmin::DynArray<model::Choice> choices;
+  bmin::DynArray<model::SwitchCase> cases;
+};
+
+static JsonEventChildFields readGameEventChildFields(JsonReader& reader) {
+  JsonEventChildFields fields;
+  if (!reader.tryBeginObject()) {
+    return fields;
+  }
+  std::string_view key;
+  while (reader.nextKey(key)) {
+    if (key == "eventChildType") {
+      fields.eventChildType = readOptionalString(reader);
+    } else if (key == "id") {
+      fields.id = readOptionalString(reader);
+    } else if (key == "p") {
+      fields.p = reader.readStringOr(bmin::String());
+    } else if (key == "execStr") {
+      fields.execStr = reader.readStringOr(bmin::String());
+    } else if (key == "next") {
+      fields.next = reader.readStringOr(bmin::String());
+    } else if (key == "text") {
+      fields.text = reader.readStringOr(bmin::String());
+    } else if (key == "defaultNext") {
+      fields.defaultNext = reader.readStringOr(bmin::String());
+    } else if (key == "autoAdvance") {
+      fields.autoAdvance = reader.readBoolOr(false);
+    } else if (key == "audioInfo") {
+      fields.audioInfo = readAudioInfo(reader);
+    } else if (key == "choices") {
+      fields.choices = readChoices(reader);
+    } else if (key == "cases") {
+      fields.cases = readSwitchCases(reader);
+    } else {
+      reader.skipValue();
+    }
+  }
+  return fields;
+}
+
+static std::optional<model::GameEventChild>
+makeGameEventChild(JsonEventChildFields& fields) {
+  if (!fields.eventChildType.has_value()) {
     throw std::runtime_error("Child missing required field: eventChildType");
   }
-  if (!childJson.contains("id") || !childJson["id"].is_string()) {
+  if (!fields.id.has_value()) {
     throw std::runtime_error("Child missing required field: id");
   }
 
-  const bmin::String eventChildTypeStr = childJson["eventChildType"].get<bmin::String>();
+  const bmin::String& eventChildTypeStr = *fields.eventChildType;
 
   if (eventChildTypeStr == "COMMENT") {
     return std::nullopt;
@@ -85,124 +242,33 @@ static std::optional<model::GameEventChild> parseGameEventChild(const Json& chil
   if (childType == model::GameEventChildType::EXEC) {
     model::GameEventChildExec execNode;
     execNode.eventChildType = model::GameEventChildType::EXEC;
-    execNode.id = childJson["id"].get<bmin::String>();
-
-    if (childJson.contains("p") && childJson["p"].is_string()) {
-      execNode.paragraphs = splitParagraphs(childJson["p"].get<bmin::String>());
-    } else {
-      execNode.paragraphs = {};
-    }
-
-    if (childJson.contains("execStr") && childJson["execStr"].is_string()) {
-      execNode.execStr = childJson["execStr"].get<bmin::String>();
-    } else {
-      execNode.execStr = "";
-    }
-
-    if (childJson.contains("next") && childJson["next"].is_string()) {
-      execNode.next = childJson["next"].get<bmin::String>();
-    } else {
-      execNode.next = "";
-    }
-
-    if (childJson.contains("autoAdvance") && childJson["autoAdvance"].is_boolean()) {
-      execNode.autoAdvance = childJson["autoAdvance"].get<bool>();
-    } else {
-      execNode.autoAdvance = false;
-    }
-
-    if (childJson.contains("audioInfo") && childJson["audioInfo"].is_object()) {
-      execNode.audioInfo = parseAudioInfo(childJson["audioInfo"]);
-    }
-
+    execNode.id = std::move(*fields.id);
+    execNode.paragraphs = splitParagraphs(fields.p);
+    execNode.execStr = std::move(fields.execStr);
+    execNode.next = std::move(fields.next);
+    execNode.autoAdvance = fields.autoAdvance;
+    execNode.audioInfo = std::move(fields.audioInfo);
     return execNode;
   } else if (childType == model::GameEventChildType::CHOICE) {
     model::GameEventChildChoice choiceNode;
     choiceNode.eventChildType = model::GameEventChildType::CHOICE;
-    choiceNode.id = childJson["id"].get<bmin::String>();
-
-    if (childJson.contains("text") && childJson["text"].is_string()) {
-      choiceNode.text = childJson["text"].get<bmin::String>();
-    } else {
-      choiceNode.text = "";
-    }
-
-    if (childJson.contains("choices") && childJson["choices"].is_array()) {
-      for (const auto& choiceJson : childJson["choices"]) {
-        model::Choice choice;
-        if (choiceJson.contains("text") && choiceJson["text"].is_string()) {
-          choice.text = choiceJson["text"].get<bmin::String>();
-        }
-        if (choiceJson.contains("prefixText") && choiceJson["prefixText"].is_string()) {
-          choice.prefixText = choiceJson["prefixText"].get<bmin::String>();
-        }
-        if (choiceJson.contains("conditionStr") && choiceJson["conditionStr"].is_string()) {
-          choice.conditionStr = choiceJson["conditionStr"].get<bmin::String>();
-        }
-        if (choiceJson.contains("evalStr") && choiceJson["evalStr"].is_string()) {
-          choice.evalStr = choiceJson["evalStr"].get<bmin::String>();
-        }
-        if (choiceJson.contains("next") && choiceJson["next"].is_string()) {
-          choice.next = choiceJson["next"].get<bmin::String>();
-        }
-        if (choiceJson.contains("switchText") && choiceJson["switchText"].is_array()) {
-          for (const auto& switchTextJson : choiceJson["switchText"]) {
-            model::ChoiceSwitchText switchText;
-            if (switchTextJson.contains("conditionStr") &&
-                switchTextJson["conditionStr"].is_string()) {
-              switchText.conditionStr = switchTextJson["conditionStr"].get<bmin::String>();
-            }
-            if (switchTextJson.contains("text") && switchTextJson["text"].is_string()) {
-              switchText.text = switchTextJson["text"].get<bmin::String>();
-            }
-            choice.switchText.pushBack(switchText);
-          }
-        }
-        choiceNode.choices.pushBack(choice);
-      }
-    }
-
-    if (childJson.contains("audioInfo") && childJson["audioInfo"].is_object()) {
-      choiceNode.audioInfo = parseAudioInfo(childJson["audioInfo"]);
-    }
-
+    choiceNode.id = std::move(*fields.id);
+    choiceNode.text = std::move(fields.text);
+    choiceNode.choices = std::move(fields.choices);
+    choiceNode.audioInfo = std::move(fields.audioInfo);
     return choiceNode;
   } else if (childType == model::GameEventChildType::SWITCH) {
     model::GameEventChildSwitch switchNode;
     switchNode.eventChildType = model::GameEventChildType::SWITCH;
-    switchNode.id = childJson["id"].get<bmin::String>();
-
-    if (childJson.contains("defaultNext") && childJson["defaultNext"].is_string()) {
-      switchNode.defaultNext = childJson["defaultNext"].get<bmin::String>();
-    } else {
-      switchNode.defaultNext = "";
-    }
-
-    if (childJson.contains("cases") && childJson["cases"].is_array()) {
-      for (const auto& caseJson : childJson["cases"]) {
-        model::SwitchCase switchCase;
-        if (caseJson.contains("conditionStr") && caseJson["conditionStr"].is_string()) {
-          switchCase.conditionStr = caseJson["conditionStr"].get<bmin::String>();
-        }
-        if (caseJson.contains("next") && caseJson["next"].is_string()) {
-          switchCase.next = caseJson["next"].get<bmin::String>();
-        }
-        switchNode.cases.pushBack(switchCase);
-      }
-    }
-
+    switchNode.id = std::move(*fields.id);
+    switchNode.defaultNext = std::move(fields.defaultNext);
+    switchNode.cases = std::move(fields.cases);
     return switchNode;
   } else if (childType == model::GameEventChildType::END) {
     model::GameEventChildEnd endNode;
     endNode.eventChildType = model::GameEventChildType::END;
-    endNode.id = childJson["id"].get<bmin::String>();
-
-    if (childJson.contains("next") && childJson["next"].is_string()) {
-      endNode.next = childJson["next"].get<bmin::String>();
-    } else {
-      endNode.next = "";
-    }
-
+    endNode.id = std::move(*fields.id);
+    endNode.next = std::move(fields.next);
     return endNode;
   } else {
     throw std::runtime_error((bmin::String("Unsupported eventChildType: ") + eventChildTypeStr)
@@ -210,100 +276,220 @@ static std::optional<model::GameEventChild> parseGameEventChild(const Json& chil
   }
 }
 
+static model::Variable readVariable(JsonReader& reader) {
+  model::Variable var;
+  if (!reader.tryBeginObject()) {
+    return var;
+  }
+  std::string_view key;
+  while (reader.nextKey(key)) {
+    if (key == "id") {
+      var.id = reader.readStringOr(var.id);
+    } else if (key == "key") {
+      var.key = reader.readStringOr(var.key);
+    } else if (key == "value") {
+      var.value = reader.readStringOr(var.value);
+    } else if (key == "importFrom") {
+      var.importFrom = reader.readStringOr(var.importFrom);
+    } else {
+      reader.skipValue();
+    }
+  }
+  return var;
+}
+
 void loadSpecialEvents(const bmin::String& specialEventsFilePath,
                        bmin::Map<bmin::String, model::GameEvent>& specialEvents) {
   bmin::DynArray<bmin::String> emptyEventsToLoad;
   loadSpecialEvents(specialEventsFilePath, specialEvents, emptyEventsToLoad);
 }
 
-void loadSpecialEvents(const bmin::String& specialEventsFilePath,
-                       bmin::Map<bmin::String, model::GameEvent>& specialEvents,
-                       bmin::DynArray<bmin::String>& eventsToLoad) {
+static bool hasExtension(const bmin::String& path, const char* extension) {
+  const bmin::String ext = extension;
+  return path.size() >= ext.size() && path.substr(path.size() - ext.size()) == ext;
+}
+
+static bool shouldLoadEvent(const bmin::String& eventId,
+                            const bmin::DynArray<bmin::String>& eventsToLoad) {
+  return eventsToLoad.empty() ||
+         std::find(eventsToLoad.begin(), eventsToLoad.end(), eventId) != eventsToLoad.end();
+}
+
+// Events are decoded member by member with JsonReader; the required-field checks run
+// once an event object has been read, since its members may come in any order.
+static bmin::DynArray<model::GameEvent>
+parseSpecialEventsJson(const bmin::String& specialEventsFilePath,
+                       const bmin::DynArray<bmin::String>& eventsToLoad) {
   const bmin::String fileContent = sdl2w::loadFileAsString(bmin::toStringView(specialEventsFilePath));
 
-  Json jsonData;
+  bmin::DynArray<model::GameEvent> gameEvents;
   try {
-    jsonData = Json::parse(fileContent.cStr(), nullptr, true, true);
-  } catch (const Json::parse_error& e) {
-    throw std::runtime_error((bmin::String("Failed to parse JSON file ") + specialEventsFilePath.cStr() +
-                              ": " + e.what())
-                                 .cStr());
-  }
+    JsonReader reader(fileContent.cStr(), true);
+    if (reader.peekType() != JsonReader::Type::Array) {
+      throw std::runtime_error("JSON file must contain an array of events");
+    }
+    reader.beginArray();
+    while (reader.nextElement()) {
+      model::GameEvent gameEvent;
+      std::optional<bmin::String> id;
+      std::optional<bmin::String> title;
+      std::optional<bmin::String> eventTypeStr;
+      std::optional<bmin::String> icon;
+
+      if (reader.tryBeginObject()) {
+        std::string_view key;
+        while (reader.nextKey(key)) {
+          if (key == "id") {
+            id = readOptionalString(reader);
+          } else if (key == "title") {
+            title = readOptionalString(reader);
+          } else if (key == "eventType") {
+            eventTypeStr = readOptionalString(reader);
+          } else if (key == "icon") {
+            icon = readOptionalString(reader);
+          } else if (key == "vars" && reader.tryBeginArray()) {
+            gameEvent.vars.clear();
+            while (reader.nextElement()) {
+              gameEvent.vars.pushBack(readVariable(reader));
+            }
+          } else if (key == "children" && reader.tryBeginArray()) {
+            gameEvent.children.clear();
+            while (reader.nextElement()) {
+              auto fields = readGameEventChildFields(reader);
+              try {
+                auto childOpt = makeGameEventChild(fields);
+                if (childOpt.has_value()) {
+                  gameEvent.children.pushBack(std::move(childOpt.value()));
+                }
+              } catch (const std::exception&) {
+                continue;
+              }
+            }
+          } else if (key != "vars" && key != "children") {
+            reader.skipValue();
+          }
+        }
+      }
 
-  if (!jsonData.is_array()) {
-    throw std::runtime_error("JSON file must contain an array of events");
-  }
+      if (!id.has_value()) {
+        throw std::runtime_error("Event missing required field: id");
+      }
+      gameEvent.id = std::move(*id);
 
-  const bool filterByEventsToLoad = !eventsToLoad.empty();
+      if (!shouldLoadEvent(gameEvent.id, eventsToLoad)) {
+        continue;
+      }
 
-  for (const auto& eventJson : jsonData) {
-    model::GameEvent gameEvent;
+      if (!title.has_value()) {
+        throw std::runtime_error("Event missing required field: title");
+      }
+      gameEvent.title = std::move(*title);
 
-    if (!eventJson.contains("id") || !eventJson["id"].is_string()) {
-      throw std::runtime_error("Event missing required field: id");
-    }
-    gameEvent.id = eventJson["id"].get<bmin::String>();
+      if (!eventTypeStr.has_value()) {
+        throw std::runtime_error("Event missing required field: eventType");
+      }
+      gameEvent.eventType = getGameEventTypeFromString(*eventTypeStr);
 
-    if (filterByEventsToLoad) {
-      if (std::find(eventsToLoad.begin(), eventsToLoad.end(), gameEvent.id) ==
-          eventsToLoad.end()) {
-        continue;
+      if (!icon.has_value()) {
+        throw std::runtime_error("Event missing required field: icon");
       }
-    }
+      gameEvent.icon = std::move(*icon);
 
-    if (!eventJson.contains("title") || !eventJson["title"].is_string()) {
-      throw std::runtime_error("Event missing required field: title");
+      gameEvents.pushBack(std::move(gameEvent));
     }
-    gameEvent.title = eventJson["title"].get<bmin::String>();
+    reader.expectEnd();
+  } catch (const Json::parse_error& e) {
+    throw std::runtime_error((bmin::String("Failed to parse JSON file ") + specialEventsFilePath.cStr() +
+                              ": " + e.what())
+                                 .cStr());
+  }
+  return gameEvents;
+}
 
-    if (!eventJson.contains("eventType") || !eventJson["eventType"].is_string()) {
-      throw std::runtime_error("Event missing required field: eventType");
+// Scripts are left to compileGameEventScripts, as for JSON; only malformed structure
+// fails the load.
+static bmin::DynArray<model::GameEvent>
+parseSpecialEventsSe(const bmin::String& specialEventsFilePath) {
+  const bmin::String source =
+      sdl2w::loadFileAsString(bmin::toStringView(specialEventsFilePath));
+  bmin::DynArray<runner::SeDiagnostic> diagnostics;
+  auto gameEvents = runner::compileSeSource(source, diagnostics, false);
+  for (const auto& diagnostic : diagnostics) {
+    if (diagnostic.isError) {
+      LOG(ERROR) << runner::formatSeDiagnostic(specialEventsFilePath, diagnostic)
+                 << LOG_ENDL;
+    } else {
+      LOG(WARN) << runner::formatSeDiagnostic(specialEventsFilePath, diagnostic)
+                << LOG_ENDL;
     }
-    const bmin::String eventTypeStr = eventJson["eventType"].get<bmin::String>();
-    gameEvent.eventType = getGameEventTypeFromString(eventTypeStr);
+  }
+  if (runner::hasSeErrors(diagnostics)) {
+    throw std::runtime_error(
+        (bmin::String("Failed to compile ") + specialEventsFilePath).cStr());
+  }
+  return gameEvents;
+}
 
-    if (!eventJson.contains("icon") || !eventJson["icon"].is_string()) {
-      throw std::runtime_error("Event missing required field: icon");
-    }
-    gameEvent.icon = eventJson["icon"].get<bmin::String>();
+static bmin::DynArray<model::GameEvent>
+parseSpecialEventsBundle(const bmin::String& specialEventsFilePath) {
+  std::ifstream in{std::filesystem::path(specialEventsFilePath.cStr()), std::ios::binary};
+  if (!in) {
+    throw std::runtime_error(
+        (bmin::String("Failed to open event bundle ") + specialEventsFilePath).cStr());
+  }
+  const std::string content{std::istreambuf_iterator<char>(in),
+                            std::istreambuf_iterator<char>()};
+  try {
+    return runner::decodeEventBundle(content);
+  } catch (const std::exception& e) {
+    throw std::runtime_error((bmin::String("Failed to read event bundle ") +
+                              specialEventsFilePath + ": " + e.what())
+                                 .cStr());
+  }
+}
 
-    if (eventJson.contains("vars") && eventJson["vars"].is_array()) {
-      for (const auto& varJson : eventJson["vars"]) {
-        model::Variable var;
-        if (varJson.contains("id") && varJson["id"].is_string()) {
-          var.id = varJson["id"].get<bmin::String>();
-        }
-        if (varJson.contains("key") && varJson["key"].is_string()) {
-          var.key = varJson["key"].get<bmin::String>();
-        }
-        if (varJson.contains("value") && varJson["value"].is_string()) {
-          var.value = varJson["value"].get<bmin::String>();
-        }
-        if (varJson.contains("importFrom") && varJson["importFrom"].is_string()) {
-          var.importFrom = varJson["importFrom"].get<bmin::String>();
-        }
-        gameEvent.vars.pushBack(var);
-      }
-    }
+void loadSpecialEvents(const bmin::String& specialEventsFilePath,
+                       bmin::Map<bmin::String, model::GameEvent>& specialEvents,
+                       bmin::DynArray<bmin::String>& eventsToLoad) {
+  bmin::DynArray<model::GameEvent> gameEvents;
+  if (hasExtension(specialEventsFilePath, ".se")) {
+    gameEvents = parseSpecialEventsSe(specialEventsFilePath);
+  } else if (hasExtension(specialEventsFilePath, runner::EVENT_BUNDLE_EXTENSION)) {
+    gameEvents = parseSpecialEventsBundle(specialEventsFilePath);
+  } else {
+    gameEvents = parseSpecialEventsJson(specialEventsFilePath, eventsToLoad);
+  }
 
-    if (eventJson.contains("children") && eventJson["children"].is_array()) {
-      for (const auto& childJson : eventJson["children"]) {
-        try {
-          auto childOpt = parseGameEventChild(childJson);
-          if (childOpt.has_value()) {
-            gameEvent.children.pushBack(childOpt.value());
-          }
-        } catch (const std::exception&) {
-          continue;
-        }
-      }
+  bmin::DynArray<model::GameEvent> selected;
+  for (auto& gameEvent : gameEvents) {
+    if (shouldLoadEvent(gameEvent.id, eventsToLoad)) {
+      selected.pushBack(std::move(gameEvent));
     }
+  }
+  storeSpecialEvents(selected, specialEvents);
+}
 
+void storeSpecialEvents(bmin::DynArray<model::GameEvent>& gameEvents,
+                        bmin::Map<bmin::String, model::GameEvent>& specialEvents) {
+  bmin::DynArray<bmin::String> loadedEventIds;
+  for (auto& gameEvent : gameEvents) {
     if (specialEvents.contains(gameEvent.id)) {
       throw std::runtime_error((bmin::String("Event already exists: ") + gameEvent.id).cStr());
     }
 
-    specialEvents[gameEvent.id] = gameEvent;
+    model::indexGameEventChildren(gameEvent);
+    loadedEventIds.pushBack(gameEvent.id);
+    specialEvents[gameEvent.id] = std::move(gameEvent);
+  }
+
+  // Compiled once all events are in, so imported variables resolve. Bad scripts are
+  // reported here and raise the same error if a conversation reaches them.
+  for (const auto& eventId : loadedEventIds) {
+    for (const auto& error :
+         runner::compileGameEventScripts(specialEvents[eventId], specialEvents)) {
+      LOG(ERROR) << "Special event '" << eventId << "' node '" << error.nodeId
+                 << "': " << error.message << LOG_ENDL;
+    }
   }
 }
 
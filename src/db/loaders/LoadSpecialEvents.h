@@ -7,6 +7,8 @@
 
 namespace db {
 
+// Reads special-events JSON, .se source (runner/SeCompiler.h) or an event bundle
+// (runner/EventBundle.h), chosen by the file extension.
 void loadSpecialEvents(const bmin::String& specialEventsFilePath,
                        bmin::Map<bmin::String, model::GameEvent>& specialEvents);
 
@@ -14,4 +16,9 @@ void loadSpecialEvents(const bmin::String& specialEventsFilePath,
                        bmin::Map<bmin::String, model::GameEvent>& specialEvents,
                        bmin::DynArray<bmin::String>& eventsToLoad);
 
+// Indexes and adds already decoded events (moved out of gameEvents), then compiles
+// their scripts. Throws if an id is already present.
+void storeSpecialEvents(bmin::DynArray<model::GameEvent>& gameEvents,
+                        bmin::Map<bmin::String, model::GameEvent>& specialEvents);
+
 } // namespace db
@@ -1,19 +1,23 @@
 #include "LoadTilesetTemplates.h"
 #include "bmin/StringInterop.h"
 #include "lib/Json.h"
+#include "lib/JsonReader.h"
 #include "sdl2w/AssetLoader.h"
 #include <stdexcept>
+#include <string_view>
 
 namespace db {
 namespace {
 
-model::TileStepSound parseStepSound(const Json& value) {
+model::TileStepSound readStepSound(JsonReader& reader) {
   auto asInt = int{0};
-  if (value.is_number_integer()) {
-    asInt = value.get<int>();
-  } else if (value.is_string()) {
-    asInt = bmin::parseInt(value.get<bmin::String>());
+  const auto type = reader.peekType();
+  if (type == JsonReader::Type::Int) {
+    asInt = reader.readInt();
+  } else if (type == JsonReader::Type::String) {
+    asInt = bmin::parseInt(reader.readString());
   } else {
+    reader.skipValue();
     return model::TILE_STEP_SOUND_FLOOR;
   }
 
@@ -30,56 +34,64 @@ model::TileStepSound parseStepSound(const Json& value) {
   }
 }
 
-model::TileMetadata parseTileMetadata(const Json& tileJson) {
+model::TileMetadata readTileMetadata(JsonReader& reader) {
   auto meta = model::TileMetadata{};
-  if (tileJson.contains("id")) {
-    meta.id = tileJson["id"].get<int>();
-  }
-  if (tileJson.contains("description") && tileJson["description"].is_string()) {
-    meta.description = tileJson["description"].get<bmin::String>();
-  }
-  if (tileJson.contains("stepSound")) {
-    meta.stepSound = parseStepSound(tileJson["stepSound"]);
-  }
-  if (tileJson.contains("isWalkable")) {
-    meta.isWalkable = tileJson["isWalkable"].get<bool>();
-  }
-  if (tileJson.contains("isSeeThrough")) {
-    meta.isSeeThrough = tileJson["isSeeThrough"].get<bool>();
-  }
-  if (tileJson.contains("isDoor")) {
-    meta.isDoor = tileJson["isDoor"].get<bool>();
-  }
-  if (tileJson.contains("isContainer")) {
-    meta.isContainer = tileJson["isContainer"].get<bool>();
+  if (!reader.tryBeginObject()) {
+    return meta;
+  }
+  std::string_view key;
+  while (reader.nextKey(key)) {
+    if (key == "id") {
+      meta.id = reader.readInt();
+    } else if (key == "description") {
+      meta.description = reader.readStringOr(meta.description);
+    } else if (key == "stepSound") {
+      meta.stepSound = readStepSound(reader);
+    } else if (key == "isWalkable") {
+      meta.isWalkable = reader.readBool();
+    } else if (key == "isSeeThrough") {
+      meta.isSeeThrough = reader.readBool();
+    } else if (key == "isDoor") {
+      meta.isDoor = reader.readBool();
+    } else if (key == "isContainer") {
+      meta.isContainer = reader.readBool();
+    } else {
+      reader.skipValue();
+    }
   }
   return meta;
 }
 
-model::TilesetTemplate parseTileset(const Json& tilesetJson) {
+model::TilesetTemplate readTileset(JsonReader& reader) {
   auto tileset = model::TilesetTemplate{};
+  bool hasName = false;
 
-  if (!tilesetJson.contains("name") || !tilesetJson["name"].is_string()) {
-    throw std::runtime_error("Tileset template missing name");
-  }
-  tileset.name = tilesetJson["name"].get<bmin::String>();
-
-  if (tilesetJson.contains("spriteBase") && tilesetJson["spriteBase"].is_string()) {
-    tileset.spriteBase = tilesetJson["spriteBase"].get<bmin::String>();
-  }
-  if (tilesetJson.contains("tileWidth")) {
-    tileset.tileWidth = tilesetJson["tileWidth"].get<int>();
-  }
-  if (tilesetJson.contains("tileHeight")) {
-    tileset.tileHeight = tilesetJson["tileHeight"].get<int>();
-  }
-
-  if (tilesetJson.contains("tiles") && tilesetJson["tiles"].is_array()) {
-    for (const auto& tileJson : tilesetJson["tiles"]) {
-      tileset.tiles.pushBack(parseTileMetadata(tileJson));
+  if (reader.tryBeginObject()) {
+    std::string_view key;
+    while (reader.nextKey(key)) {
+      if (key == "name") {
+        hasName = reader.peekType() == JsonReader::Type::String;
+        tileset.name = reader.readStringOr(bmin::String());
+      } else if (key == "spriteBase") {
+        tileset.spriteBase = reader.readStringOr(tileset.spriteBase);
+      } else if (key == "tileWidth") {
+        tileset.tileWidth = reader.readInt();
+      } else if (key == "tileHeight") {
+        tileset.tileHeight = reader.readInt();
+      } else if (key == "tiles" && reader.tryBeginArray()) {
+        tileset.tiles.clear();
+        while (reader.nextElement()) {
+          tileset.tiles.pushBack(readTileMetadata(reader));
+        }
+      } else if (key != "tiles") {
+        reader.skipValue();
+      }
     }
   }
 
+  if (!hasName) {
+    throw std::runtime_error("Tileset template missing name");
+  }
   return tileset;
 }
 
@@ -89,20 +101,23 @@ void loadTilesetTemplates(const bmin::String& tilesetsFilePath,
                           bmin::Map<bmin::String, model::TilesetTemplate>& tilesetTemplates) {
   const auto fileContent = sdl2w::loadFileAsString(bmin::toStringView(tilesetsFilePath));
 
-  Json jsonData;
+  bmin::DynArray<model::TilesetTemplate> loaded;
   try {
-    jsonData = Json::parse(fileContent.cStr(), nullptr, true, true);
+    JsonReader reader(fileContent.cStr(), true);
+    if (reader.peekType() != JsonReader::Type::Array) {
+      throw std::runtime_error("Tilesets JSON must be an array");
+    }
+    reader.beginArray();
+    while (reader.nextElement()) {
+      loaded.pushBack(readTileset(reader));
+    }
+    reader.expectEnd();
   } catch (const Json::parse_error& e) {
     throw std::runtime_error(
         (bmin::String("Failed to parse tilesets JSON: ") + e.what()).cStr());
   }
 
-  if (!jsonData.is_array()) {
-    throw std::runtime_error("Tilesets JSON must be an array");
-  }
-
-  for (const auto& tilesetJson : jsonData) {
-    auto tileset = parseTileset(tilesetJson);
+  for (auto& tileset : loaded) {
     if (tilesetTemplates.contains(tileset.name)) {
       throw std::runtime_error(
           (bmin::String("Duplicate tileset template name: ") + tileset.name).cStr());
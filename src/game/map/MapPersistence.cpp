@@ -2,26 +2,100 @@
 #include "bmin/StringInterop.h"
 #include "game/map/ActiveMapOrchestrator.h"
 #include "game/map/TileFields.h"
+#include "lib/StartupProfiler.h"
 #include "model/templates/CharacterTemplate.h"
 
 namespace game {
 
+namespace {
+
+model::MapInstance createMapInstance(const model::CarcerMapTemplate& mapTemplate,
+                                     const db::Database& database) {
+  model::MapInstance instance = model::createMapInstanceFromTemplate(mapTemplate);
+  for (size_t ci = 0; ci < instance.persistentState.characters.size(); ci++) {
+    model::tryApplyCharacterTemplateToInstance(instance.persistentState.characters[ci],
+                                               database);
+  }
+  return instance;
+}
+
+void appendMapsOf(const db::Database& database,
+                  const bmin::String& mapOrGridName,
+                  bmin::DynArray<bmin::String>& mapNames) {
+  const auto* grid = database.findMapGridTemplate(bmin::toStringView(mapOrGridName));
+  if (!grid) {
+    mapNames.pushBack(mapOrGridName);
+    return;
+  }
+  for (const auto& row : grid->cells) {
+    for (const auto& cell : row) {
+      if (!cell.empty()) {
+        mapNames.pushBack(cell);
+      }
+    }
+  }
+}
+
+} // namespace
+
 void createMapInstances(state::State& state, const db::Database& database) {
+  StartupProfiler::Scope scope("map instances");
   state.mapInstances = bmin::Map<bmin::String, model::MapInstance>{};
+  if (database.isLazyMapLoading()) {
+    return;
+  }
 
   // getMapTemplates() returns const Map&; bmin::Map iteration needs a non-const begin().
   auto& templates = const_cast<bmin::Map<bmin::String, model::CarcerMapTemplate>&>(
       database.getMapTemplates());
   for (auto it = templates.begin(); it != templates.end(); ++it) {
-    model::MapInstance instance = model::createMapInstanceFromTemplate(it->value);
-    for (size_t ci = 0; ci < instance.persistentState.characters.size(); ci++) {
-      model::tryApplyCharacterTemplateToInstance(instance.persistentState.characters[ci],
-                                                 database);
-    }
+    model::MapInstance instance = createMapInstance(it->value, database);
     state.mapInstances[instance.templateName] = std::move(instance);
   }
 }
 
+model::MapInstance*
+ensureMapInstance(bmin::Map<bmin::String, model::MapInstance>& mapInstances,
+                  const db::Database& database,
+                  const bmin::String& mapName) {
+  auto it = mapInstances.find(mapName);
+  if (it != mapInstances.end()) {
+    return &it->value;
+  }
+  const auto* mapTemplate = database.findMapTemplate(bmin::toStringView(mapName));
+  if (!mapTemplate) {
+    return nullptr;
+  }
+  auto& stored = mapInstances[mapName];
+  stored = createMapInstance(*mapTemplate, database);
+  return &stored;
+}
+
+void ensureGridMapInstances(state::State& state,
+                            const db::Database& database,
+                            const model::MapGridTemplate& grid) {
+  StartupProfiler::Scope scope(bmin::toStringView(bmin::String("map grid ") + grid.name));
+  bmin::DynArray<bmin::String> reachable;
+  for (const auto& row : grid.cells) {
+    for (const auto& mapName : row) {
+      if (mapName.empty()) {
+        continue;
+      }
+      auto* map = ensureMapInstance(state.mapInstances, database, mapName);
+      if (!map) {
+        continue;
+      }
+      const auto& mapTemplate = database.getMapTemplate(bmin::toStringView(mapName));
+      for (const auto& trigger : mapTemplate.travelTriggers) {
+        if (!trigger.destinationMapName.empty()) {
+          appendMapsOf(database, trigger.destinationMapName, reachable);
+        }
+      }
+    }
+  }
+  database.prefetchMapTemplates(reachable);
+}
+
 void advanceWorldMovementTicks(state::State& state, int steps) {
   if (steps <= 0) {
     return;
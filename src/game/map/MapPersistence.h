@@ -7,9 +7,23 @@
 namespace game {
 
 // Create a MapInstance for every map template in the database and store them on
-// state.mapInstances.
+// state.mapInstances. With lazy map loading (db::Database::isLazyMapLoading) this only
+// clears state.mapInstances; instances are created per grid by ensureGridMapInstances.
 void createMapInstances(state::State& state, const db::Database& database);
 
+// The MapInstance for mapName, created from its template if there is none yet. Returns
+// nullptr when the database has no such map.
+model::MapInstance*
+ensureMapInstance(bmin::Map<bmin::String, model::MapInstance>& mapInstances,
+                  const db::Database& database,
+                  const bmin::String& mapName);
+
+// Create the missing MapInstances of the grid's maps before it is loaded, then queue
+// the maps its travel triggers lead to for db::Database::prefetchMapTemplates.
+void ensureGridMapInstances(state::State& state,
+                            const db::Database& database,
+                            const model::MapGridTemplate& grid);
+
 // Age tile fields on every MapInstance (and bump playerMovementCount).
 void advanceWorldMovementTicks(state::State& state, int steps);
 
@@ -1,7 +1,7 @@
 #include "game/map/TileFields.h"
 #include "game/map/MapWalkability.h"
 #include "model/instances/World.h"
-#include <cstdlib>
+#include "model/Random.h"
 
 namespace game {
 
@@ -85,7 +85,7 @@ void addTileField(model::TileInstance& tile, TileFieldType type) {
   field.type = type;
   field.moveDuration = tileFieldDefaultMoveDuration(type);
   if (type == TileFieldType::BLOOD) {
-    field.variant = std::rand() % 4;
+    field.variant = model::randomInt(model::getActiveRandomStreams().effects, 4);
     tile.fields.insert(tile.fields.begin(), field);
     return;
   }
@@ -85,11 +85,11 @@ model::CharacterInstance* placePartyAvatarAt(model::ActiveMap& activeMap,
     return avatar;
   }
 
+  const auto& params = model::characterPlayerGetParams(leader);
   auto instance = model::CharacterInstance{};
   instance.id = leader.instanceId;
-  instance.name = leader.name.empty() ? leader.params.name : leader.name;
-  instance.templateName =
-      leader.templateName.empty() ? leader.params.name : leader.templateName;
+  instance.name = leader.name.empty() ? params.name : leader.name;
+  instance.templateName = leader.templateName.empty() ? params.name : leader.templateName;
   instance.x = x;
   instance.y = y;
   instance.spawnX = x;
@@ -0,0 +1,199 @@
+#include "game/save/SaveBinary.h"
+#include <limits>
+#include <stdexcept>
+
+namespace game {
+
+uint32_t SaveStringTable::intern(const bmin::String& value) {
+  auto it = indexByString.find(value);
+  if (it != indexByString.end()) {
+    return (*it).value;
+  }
+  const auto index = static_cast<uint32_t>(strings.size());
+  indexByString.insert(value, index);
+  strings.pushBack(value);
+  return index;
+}
+
+const bmin::String& SaveStringTable::at(uint32_t index) const {
+  if (index >= strings.size()) {
+    throw std::runtime_error("Save string index out of range");
+  }
+  return strings[index];
+}
+
+void SaveStringTable::clear() {
+  indexByString.clear();
+  strings.clear();
+}
+
+void SaveStringTable::append(bmin::String value) { strings.pushBack(std::move(value)); }
+
+void SaveWriter::writeU8(uint8_t value) { bytes.pushBack(value); }
+
+void SaveWriter::writeU16(uint16_t value) {
+  writeU8(static_cast<uint8_t>(value & 0xff));
+  writeU8(static_cast<uint8_t>(value >> 8));
+}
+
+void SaveWriter::writeU32(uint32_t value) {
+  for (int i = 0; i < 4; i++) {
+    writeU8(static_cast<uint8_t>((value >> (i * 8)) & 0xff));
+  }
+}
+
+void SaveWriter::writeVarUint(uint64_t value) {
+  while (value >= 0x80) {
+    writeU8(static_cast<uint8_t>((value & 0x7f) | 0x80));
+    value >>= 7;
+  }
+  writeU8(static_cast<uint8_t>(value));
+}
+
+void SaveWriter::writeVarInt(int64_t value) {
+  const auto zigzag =
+      (static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63);
+  writeVarUint(zigzag);
+}
+
+void SaveWriter::writeRawString(std::string_view value) {
+  writeVarUint(value.size());
+  writeBytes(reinterpret_cast<const uint8_t*>(value.data()), value.size());
+}
+
+void SaveWriter::writeString(SaveStringTable& table, const bmin::String& value) {
+  writeVarUint(table.intern(value));
+}
+
+void SaveWriter::writeBits(const bmin::DynArray<uint8_t>& bits) {
+  writeVarUint(bits.size());
+  uint8_t current = 0;
+  for (size_t i = 0; i < bits.size(); i++) {
+    if (bits[i]) {
+      current |= static_cast<uint8_t>(1u << (i % 8));
+    }
+    if (i % 8 == 7) {
+      writeU8(current);
+      current = 0;
+    }
+  }
+  if (bits.size() % 8 != 0) {
+    writeU8(current);
+  }
+}
+
+void SaveWriter::writeBytes(const uint8_t* data, size_t size) {
+  for (size_t i = 0; i < size; i++) {
+    bytes.pushBack(data[i]);
+  }
+}
+
+void SaveReader::require(size_t count) const {
+  if (count > data.size() - pos) {
+    throw std::runtime_error("Save data truncated");
+  }
+}
+
+uint8_t SaveReader::readU8() {
+  require(1);
+  return static_cast<uint8_t>(data[pos++]);
+}
+
+uint16_t SaveReader::readU16() {
+  const uint16_t lo = readU8();
+  const uint16_t hi = readU8();
+  return static_cast<uint16_t>(lo | (hi << 8));
+}
+
+uint32_t SaveReader::readU32() {
+  uint32_t value = 0;
+  for (int i = 0; i < 4; i++) {
+    value |= static_cast<uint32_t>(readU8()) << (i * 8);
+  }
+  return value;
+}
+
+uint64_t SaveReader::readVarUint() {
+  uint64_t value = 0;
+  for (int shift = 0; shift < 64; shift += 7) {
+    const uint8_t byte = readU8();
+    value |= static_cast<uint64_t>(byte & 0x7f) << shift;
+    if ((byte & 0x80) == 0) {
+      return value;
+    }
+  }
+  throw std::runtime_error("Save varint too long");
+}
+
+int64_t SaveReader::readVarInt() {
+  const uint64_t zigzag = readVarUint();
+  return static_cast<int64_t>(zigzag >> 1) ^ -static_cast<int64_t>(zigzag & 1);
+}
+
+int SaveReader::readInt() {
+  const int64_t value = readVarInt();
+  if (value < std::numeric_limits<int>::min() ||
+      value > std::numeric_limits<int>::max()) {
+    throw std::runtime_error("Save integer out of range");
+  }
+  return static_cast<int>(value);
+}
+
+int SaveReader::readCount() {
+  const uint64_t value = readVarUint();
+  // Every counted element takes at least one byte, so larger counts are corrupt.
+  if (value > remaining() + 1 || value > std::numeric_limits<int>::max()) {
+    throw std::runtime_error("Save count out of range");
+  }
+  return static_cast<int>(value);
+}
+
+std::string_view SaveReader::readRawString() {
+  const auto size = static_cast<size_t>(readVarUint());
+  return readBytes(size);
+}
+
+const bmin::String& SaveReader::readString(const SaveStringTable& table) {
+  const uint64_t index = readVarUint();
+  if (index > std::numeric_limits<uint32_t>::max()) {
+    throw std::runtime_error("Save string index out of range");
+  }
+  return table.at(static_cast<uint32_t>(index));
+}
+
+bmin::DynArray<uint8_t> SaveReader::readBits() {
+  const uint64_t value = readVarUint();
+  // Compared before rounding up to bytes, which would wrap for huge counts.
+  if (value > remaining() * 8) {
+    throw std::runtime_error("Save data truncated");
+  }
+  const auto count = static_cast<size_t>(value);
+  bmin::DynArray<uint8_t> bits;
+  bits.reserve(count);
+  uint8_t current = 0;
+  for (size_t i = 0; i < count; i++) {
+    if (i % 8 == 0) {
+      current = readU8();
+    }
+    bits.pushBack(static_cast<uint8_t>((current >> (i % 8)) & 1));
+  }
+  return bits;
+}
+
+std::string_view SaveReader::readBytes(size_t size) {
+  require(size);
+  const auto view = data.substr(pos, size);
+  pos += size;
+  return view;
+}
+
+uint32_t saveChecksum(std::string_view data) {
+  uint32_t hash = 2166136261u;
+  for (const char c : data) {
+    hash ^= static_cast<uint8_t>(c);
+    hash *= 16777619u;
+  }
+  return hash;
+}
+
+} // namespace game
@@ -0,0 +1,83 @@
+#pragma once
+
+#include "bmin/DynArray.h"
+#include "bmin/Map.h"
+#include "bmin/String.h"
+#include <cstdint>
+#include <string_view>
+
+namespace game {
+
+// Interned strings for one save file. Sections store a varuint index instead of the
+// text, so template names, tileset names and ids repeated across maps cost a byte or
+// two after their first use.
+class SaveStringTable {
+  bmin::Map<bmin::String, uint32_t> indexByString;
+  bmin::DynArray<bmin::String> strings;
+
+public:
+  uint32_t intern(const bmin::String& value);
+  const bmin::String& at(uint32_t index) const;
+  size_t size() const { return strings.size(); }
+  void clear();
+  // Decoding only: appends without deduplication so indices match the writer.
+  void append(bmin::String value);
+};
+
+// Little-endian byte writer with LEB128 varints. Signed values are zigzag encoded.
+class SaveWriter {
+  bmin::DynArray<uint8_t> bytes;
+
+public:
+  void writeU8(uint8_t value);
+  void writeU16(uint16_t value);
+  void writeU32(uint32_t value);
+  void writeVarUint(uint64_t value);
+  void writeVarInt(int64_t value);
+  void writeBool(bool value) { writeU8(value ? 1 : 0); }
+  // varuint length + raw bytes.
+  void writeRawString(std::string_view value);
+  void writeString(SaveStringTable& table, const bmin::String& value);
+  // One flag (0/1) per entry; written as varuint count + ceil(count / 8) bytes, LSB
+  // first.
+  void writeBits(const bmin::DynArray<uint8_t>& bits);
+  void writeBytes(const uint8_t* data, size_t size);
+
+  const bmin::DynArray<uint8_t>& getBytes() const { return bytes; }
+  size_t size() const { return bytes.size(); }
+};
+
+// Bounds-checked reader over a SaveWriter buffer. Any overrun or malformed value
+// throws std::runtime_error.
+class SaveReader {
+  std::string_view data;
+  size_t pos = 0;
+
+  void require(size_t count) const;
+
+public:
+  explicit SaveReader(std::string_view _data) : data(_data) {}
+
+  uint8_t readU8();
+  uint16_t readU16();
+  uint32_t readU32();
+  uint64_t readVarUint();
+  int64_t readVarInt();
+  // readVarInt/readVarUint narrowed to int, throwing when out of range.
+  int readInt();
+  int readCount();
+  bool readBool() { return readU8() != 0; }
+  std::string_view readRawString();
+  const bmin::String& readString(const SaveStringTable& table);
+  bmin::DynArray<uint8_t> readBits();
+  std::string_view readBytes(size_t size);
+
+  size_t getPos() const { return pos; }
+  size_t remaining() const { return data.size() - pos; }
+  bool atEnd() const { return pos >= data.size(); }
+};
+
+// FNV-1a over the payload; guards against truncated or text-mode mangled files.
+uint32_t saveChecksum(std::string_view data);
+
+} // namespace game
@@ -0,0 +1,151 @@
+#include "game/save/SaveCompression.h"
+#include "game/save/SaveBinary.h"
+#include <array>
+#include <cstring>
+#include <stdexcept>
+
+namespace game {
+
+namespace {
+
+constexpr size_t MIN_MATCH = 4;
+constexpr size_t MAX_OFFSET = 65535;
+constexpr int HASH_BITS = 12;
+constexpr size_t HEADER_SIZE = sizeof(SAVE_COMPRESSED_MAGIC) + 4;
+
+uint32_t hashAt(const uint8_t* p) {
+  uint32_t v = 0;
+  std::memcpy(&v, p, sizeof(v));
+  return (v * 2654435761u) >> (32 - HASH_BITS);
+}
+
+// Lengths >= 15 spill into extra bytes of 255 + remainder, as in LZ4.
+void writeLength(SaveWriter& w, size_t length) {
+  while (length >= 255) {
+    w.writeU8(255);
+    length -= 255;
+  }
+  w.writeU8(static_cast<uint8_t>(length));
+}
+
+size_t readLength(SaveReader& r, size_t nibble) {
+  size_t length = nibble;
+  if (nibble == 15) {
+    uint8_t byte = 0;
+    do {
+      byte = r.readU8();
+      length += byte;
+    } while (byte == 255);
+  }
+  return length;
+}
+
+void writeSequence(SaveWriter& w,
+                   const uint8_t* literals,
+                   size_t literalCount,
+                   size_t matchLength,
+                   size_t offset) {
+  const size_t matchCode = matchLength == 0 ? 0 : matchLength - MIN_MATCH;
+  const uint8_t token = static_cast<uint8_t>(
+      ((literalCount < 15 ? literalCount : 15) << 4) | (matchCode < 15 ? matchCode : 15));
+  w.writeU8(token);
+  if (literalCount >= 15) {
+    writeLength(w, literalCount - 15);
+  }
+  w.writeBytes(literals, literalCount);
+  if (matchLength == 0) {
+    return;
+  }
+  w.writeU16(static_cast<uint16_t>(offset));
+  if (matchCode >= 15) {
+    writeLength(w, matchCode - 15);
+  }
+}
+
+} // namespace
+
+bmin::DynArray<uint8_t> compressSaveData(std::string_view raw) {
+  SaveWriter w;
+  w.writeBytes(reinterpret_cast<const uint8_t*>(SAVE_COMPRESSED_MAGIC),
+               sizeof(SAVE_COMPRESSED_MAGIC));
+  w.writeU32(static_cast<uint32_t>(raw.size()));
+
+  const auto* data = reinterpret_cast<const uint8_t*>(raw.data());
+  const size_t size = raw.size();
+  // Positions + 1, so 0 means empty.
+  std::array<uint32_t, 1u << HASH_BITS> table{};
+  size_t anchor = 0;
+  size_t pos = 0;
+  while (size >= MIN_MATCH && pos + MIN_MATCH <= size) {
+    const uint32_t h = hashAt(data + pos);
+    const size_t candidate = table[h];
+    table[h] = static_cast<uint32_t>(pos + 1);
+    if (candidate == 0 || pos - (candidate - 1) > MAX_OFFSET ||
+        std::memcmp(data + candidate - 1, data + pos, MIN_MATCH) != 0) {
+      pos++;
+      continue;
+    }
+    const size_t matchStart = candidate - 1;
+    size_t length = MIN_MATCH;
+    while (pos + length < size && data[matchStart + length] == data[pos + length]) {
+      length++;
+    }
+    writeSequence(w, data + anchor, pos - anchor, length, pos - matchStart);
+    pos += length;
+    anchor = pos;
+  }
+  // Always end with a literal-only sequence (possibly empty) so the reader knows
+  // where the stream stops.
+  writeSequence(w, data + anchor, size - anchor, 0, 0);
+  return w.getBytes();
+}
+
+bool isCompressedSaveData(std::string_view data) {
+  return data.size() >= HEADER_SIZE &&
+         data.substr(0, sizeof(SAVE_COMPRESSED_MAGIC)) ==
+             std::string_view(SAVE_COMPRESSED_MAGIC, sizeof(SAVE_COMPRESSED_MAGIC));
+}
+
+bmin::DynArray<uint8_t> decompressSaveData(std::string_view compressed) {
+  if (!isCompressedSaveData(compressed)) {
+    throw std::runtime_error("Not compressed save data");
+  }
+  SaveReader r(compressed.substr(sizeof(SAVE_COMPRESSED_MAGIC)));
+  const uint32_t rawSize = r.readU32();
+  // No stream byte expands to more than 255 output bytes (a 255 length byte), so a
+  // larger size is a lie; reject it before a 9 byte file reserves 4 GiB.
+  if (rawSize > (compressed.size() - HEADER_SIZE) * 255) {
+    throw std::runtime_error("Compressed save data is corrupt");
+  }
+  bmin::DynArray<uint8_t> out;
+  out.reserve(rawSize);
+
+  while (true) {
+    const uint8_t token = r.readU8();
+    const size_t literalCount = readLength(r, token >> 4);
+    const auto literals = r.readBytes(literalCount);
+    for (const char c : literals) {
+      out.pushBack(static_cast<uint8_t>(c));
+    }
+    if (r.atEnd()) {
+      break;
+    }
+    const size_t offset = r.readU16();
+    const size_t matchLength = readLength(r, token & 0x0f) + MIN_MATCH;
+    if (offset == 0 || offset > out.size() || out.size() + matchLength > rawSize) {
+      throw std::runtime_error("Compressed save data is corrupt");
+    }
+    // Byte by byte: overlapping matches (offset < length) repeat a run.
+    const size_t start = out.size() - offset;
+    for (size_t i = 0; i < matchLength; i++) {
+      const uint8_t byte = out[start + i];
+      out.pushBack(byte);
+    }
+  }
+  if (out.size() != rawSize) {
+    throw std::runtime_error("Compressed save data has the wrong size");
+  }
+  return out;
+}
+
+} // namespace game
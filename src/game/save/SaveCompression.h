@@ -0,0 +1,22 @@
+#pragma once
+
+#include "bmin/DynArray.h"
+#include <cstdint>
+#include <string_view>
+
+namespace game {
+
+// Wrapper for compressed saves: "CSAZ" | u32 uncompressed size | LZ77 stream.
+inline constexpr char SAVE_COMPRESSED_MAGIC[4] = {'C', 'S', 'A', 'Z'};
+
+// Byte-oriented LZ77 (LZ4-style sequences of literals + back-reference, 64 KiB
+// window). Saves are mostly small varints, repeated ids and explored bitsets, so a
+// fast greedy matcher gets most of the gain without pulling in a compression library.
+bmin::DynArray<uint8_t> compressSaveData(std::string_view raw);
+
+bool isCompressedSaveData(std::string_view data);
+
+// Throws std::runtime_error on malformed input.
+bmin::DynArray<uint8_t> decompressSaveData(std::string_view compressed);
+
+} // namespace game
@@ -0,0 +1,948 @@
+#include "game/save/SaveGame.h"
+#include "bmin/StringInterop.h"
+#include "db/Database.h"
+#include "game/map/MapPersistence.h"
+#include "game/save/SaveBinary.h"
+#include "game/save/SaveCompression.h"
+#include "sdl2w/Logger.h"
+#include "state/State.h"
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+
+namespace game {
+
+namespace {
+
+constexpr size_t SAVE_HEADER_SIZE = 4 + 2 + 4 + 4;
+
+struct SaveContext {
+  SaveStringTable strings;
+  // Reading only: resolves template pointers, and the version of the section being read.
+  const db::Database* database = nullptr;
+  uint64_t sectionVersion = 0;
+};
+
+template <typename Stats, typename Visit>
+void visitCharacterStats(Stats& stats, Visit&& visit) {
+  visit(stats.generic.str);
+  visit(stats.generic.mnd);
+  visit(stats.generic.con);
+  visit(stats.generic.agi);
+  visit(stats.generic.lck);
+  visit(stats.trainable.weapon.edged);
+  visit(stats.trainable.weapon.pole);
+  visit(stats.trainable.weapon.blunt);
+  visit(stats.trainable.weapon.range);
+  visit(stats.trainable.weapon.unarmed);
+  visit(stats.trainable.magic.mana);
+  visit(stats.trainable.magic.abilityPower);
+  visit(stats.trainable.magic.attunement);
+  visit(stats.trainable.magic.faith);
+  visit(stats.trainable.magic.lore);
+  visit(stats.trainable.body.resistPhysical);
+  visit(stats.trainable.body.resistMagical);
+  visit(stats.trainable.body.healingEffectiveness);
+  visit(stats.trainable.body.dr);
+  visit(stats.trainable.body.armorTraining);
+  visit(stats.skills.trickery);
+  visit(stats.skills.stealth);
+  visit(stats.skills.social);
+  visit(stats.skills.magicItemUse);
+  visit(stats.skills.cooking);
+  visit(stats.skills.acrobatics);
+  visit(stats.skills.survival);
+  visit(stats.skills.focus);
+  visit(stats.skills.conditioning);
+}
+
+template <typename Equipment, typename Visit>
+void visitEquipment(Equipment& equipment, Visit&& visit) {
+  visit(equipment.weapon0Id);
+  visit(equipment.weapon1Id);
+  visit(equipment.ammoId);
+  visit(equipment.hatId);
+  visit(equipment.garbId);
+  visit(equipment.glovesId);
+  visit(equipment.pantsId);
+  visit(equipment.shoesId);
+  visit(equipment.necklaceId);
+  visit(equipment.shieldId);
+}
+
+// bmin::Map iteration needs a non-const begin(); keys are sorted so that the same
+// state always encodes to the same bytes.
+template <typename V>
+bmin::DynArray<bmin::String> sortedKeys(const bmin::Map<bmin::String, V>& map) {
+  auto& mutableMap = const_cast<bmin::Map<bmin::String, V>&>(map);
+  bmin::DynArray<bmin::String> keys;
+  for (auto it = mutableMap.begin(); it != mutableMap.end(); ++it) {
+    keys.pushBack(it->key);
+  }
+  std::sort(keys.begin(), keys.end());
+  return keys;
+}
+
+template <typename Enum>
+Enum readEnum(SaveReader& reader, Enum maxValue) {
+  const uint8_t value = reader.readU8();
+  if (value > static_cast<uint8_t>(maxValue)) {
+    throw std::runtime_error("Save enum value out of range");
+  }
+  return static_cast<Enum>(value);
+}
+
+void writeCharacterInstance(SaveWriter& w,
+                            SaveContext& ctx,
+                            const model::CharacterInstance& character) {
+  w.writeString(ctx.strings, character.id);
+  w.writeString(ctx.strings, character.name);
+  w.writeString(ctx.strings, character.templateName);
+  w.writeVarInt(character.x);
+  w.writeVarInt(character.y);
+  w.writeVarInt(character.spawnX);
+  w.writeVarInt(character.spawnY);
+  w.writeVarInt(character.currentAp);
+  w.writeVarInt(character.currentHp);
+  w.writeBool(character.hpInitialized);
+  w.writeU8(static_cast<uint8_t>(character.facing));
+}
+
+model::CharacterInstance readCharacterInstance(SaveReader& r, const SaveContext& ctx) {
+  model::CharacterInstance character;
+  character.id = r.readString(ctx.strings);
+  character.name = r.readString(ctx.strings);
+  character.templateName = r.readString(ctx.strings);
+  character.x = r.readInt();
+  character.y = r.readInt();
+  character.spawnX = r.readInt();
+  character.spawnY = r.readInt();
+  character.currentAp = r.readInt();
+  character.currentHp = r.readInt();
+  if (ctx.sectionVersion < 2) {
+    r.readInt(); // maxHp
+  }
+  character.hpInitialized = r.readBool();
+  character.facing = readEnum(r, model::CharacterFacing::Left);
+  if (ctx.sectionVersion < 2) {
+    // Version 1 copied these from the template; they now come from the database.
+    readEnum(r, model::CharacterTemplateType::ENEMY_STATIC);
+    r.readString(ctx.strings); // label
+    r.readString(ctx.strings); // behaviorName
+    r.readInt();               // visionRadius
+    readEnum(r, model::CombatBehaviorName::SEEK_AND_MELEE);
+    readEnum(r, model::CombatBehaviorName::SEEK_AND_MELEE);
+  }
+  // Only the pointer: name and templateName are restored as saved.
+  character.characterTemplate =
+      ctx.database->findCharacterTemplate(bmin::toStringView(character.templateName));
+  return character;
+}
+
+void writeCharacters(SaveWriter& w,
+                     SaveContext& ctx,
+                     const bmin::DynArray<model::CharacterInstance>& characters) {
+  w.writeVarUint(characters.size());
+  for (const auto& character : characters) {
+    writeCharacterInstance(w, ctx, character);
+  }
+}
+
+bmin::DynArray<model::CharacterInstance> readCharacters(SaveReader& r,
+                                                        const SaveContext& ctx) {
+  bmin::DynArray<model::CharacterInstance> characters;
+  const int count = r.readCount();
+  characters.reserve(static_cast<size_t>(count));
+  for (int i = 0; i < count; i++) {
+    characters.pushBack(readCharacterInstance(r, ctx));
+  }
+  return characters;
+}
+
+void writeItems(SaveWriter& w,
+                SaveContext& ctx,
+                const bmin::DynArray<model::ItemInstance>& items) {
+  w.writeVarUint(items.size());
+  for (const auto& item : items) {
+    w.writeString(ctx.strings, item.id);
+    w.writeString(ctx.strings, item.itemTemplateName);
+    w.writeVarInt(item.quantity);
+    w.writeVarInt(item.x);
+    w.writeVarInt(item.y);
+  }
+}
+
+bmin::DynArray<model::ItemInstance> readItems(SaveReader& r, const SaveContext& ctx) {
+  bmin::DynArray<model::ItemInstance> items;
+  const int count = r.readCount();
+  items.reserve(static_cast<size_t>(count));
+  for (int i = 0; i < count; i++) {
+    model::ItemInstance item;
+    item.id = r.readString(ctx.strings);
+    item.itemTemplateName = r.readString(ctx.strings);
+    item.quantity = r.readInt();
+    item.x = r.readInt();
+    item.y = r.readInt();
+    items.pushBack(std::move(item));
+  }
+  return items;
+}
+
+void writeTileFields(SaveWriter& w, const bmin::DynArray<TileField>& fields) {
+  w.writeVarUint(fields.size());
+  for (const auto& field : fields) {
+    w.writeU8(static_cast<uint8_t>(field.type));
+    w.writeVarInt(field.variant);
+    w.writeVarInt(field.moveDuration);
+  }
+}
+
+bmin::DynArray<TileField> readTileFields(SaveReader& r) {
+  bmin::DynArray<TileField> fields;
+  const int count = r.readCount();
+  for (int i = 0; i < count; i++) {
+    TileField field;
+    field.type = readEnum(r, TileFieldType::STATIC);
+    field.variant = r.readInt();
+    field.moveDuration = r.readInt();
+    fields.pushBack(field);
+  }
+  return fields;
+}
+
+void writeTravelTrigger(SaveWriter& w,
+                        SaveContext& ctx,
+                        const model::TravelTrigger& travel) {
+  w.writeString(ctx.strings, travel.destinationMapName);
+  w.writeString(ctx.strings, travel.destinationMarkerName);
+  w.writeVarInt(travel.destinationX);
+  w.writeVarInt(travel.destinationY);
+  w.writeVarInt(travel.destinationLayer);
+  w.writeBool(travel.requiresAction);
+  w.writeU8(static_cast<uint8_t>(travel.overlayVisibility));
+}
+
+model::TravelTrigger readTravelTrigger(SaveReader& r, const SaveContext& ctx) {
+  model::TravelTrigger travel;
+  travel.destinationMapName = r.readString(ctx.strings);
+  travel.destinationMarkerName = r.readString(ctx.strings);
+  travel.destinationX = r.readInt();
+  travel.destinationY = r.readInt();
+  travel.destinationLayer = r.readInt();
+  travel.requiresAction = r.readBool();
+  travel.overlayVisibility = readEnum(r, model::TileOverlayVisibility::SHOW_TRAVEL_DOWN);
+  return travel;
+}
+
+void writeRandomStream(SaveWriter& w, const model::RandomStream& stream) {
+  w.writeVarUint(stream.state);
+  w.writeVarUint(stream.inc);
+}
+
+void readRandomStream(SaveReader& r, model::RandomStream& stream) {
+  stream.state = r.readVarUint();
+  stream.inc = r.readVarUint();
+}
+
+void writePlayerSection(SaveWriter& w, SaveContext& ctx, const model::Player& player) {
+  w.writeString(ctx.strings, player.name);
+  w.writeVarInt(player.currentPartyMemberIndex);
+  w.writeVarInt(player.currentPartyMemberInventoryIndex);
+  w.writeVarInt(player.gold);
+  w.writeVarInt(player.food);
+  w.writeVarUint(player.party.size());
+  for (const auto& member : player.party) {
+    w.writeString(ctx.strings, member.instanceId);
+    w.writeString(ctx.strings, member.name);
+    w.writeString(ctx.strings, member.templateName);
+    // params points into the database; store its name and look it up again.
+    w.writeString(ctx.strings, model::characterPlayerGetParams(member).name);
+    w.writeVarInt(member.currentHp);
+    w.writeVarInt(member.currentMp);
+    visitCharacterStats(member.stats, [&](int value) { w.writeVarInt(value); });
+    visitEquipment(member.equipment,
+                   [&](const bmin::String& id) { w.writeString(ctx.strings, id); });
+    w.writeVarUint(member.inventory.size());
+    for (const auto& item : member.inventory) {
+      w.writeString(ctx.strings, item.itemName);
+      w.writeString(ctx.strings, item.id);
+      w.writeVarInt(item.quantity);
+    }
+  }
+}
+
+void readPlayerSection(SaveReader& r,
+                       const SaveContext& ctx,
+                       const db::Database& database,
+                       model::Player& player) {
+  player.name = r.readString(ctx.strings);
+  player.currentPartyMemberIndex = r.readInt();
+  player.currentPartyMemberInventoryIndex = r.readInt();
+  player.gold = r.readInt();
+  player.food = r.readInt();
+  player.party.clear();
+  const int partySize = r.readCount();
+  for (int i = 0; i < partySize; i++) {
+    const auto instanceId = r.readString(ctx.strings);
+    const auto name = r.readString(ctx.strings);
+    const auto templateName = r.readString(ctx.strings);
+    const auto& paramsName = r.readString(ctx.strings);
+    model::CharacterPlayer member(
+        database.getCharacterTemplate(bmin::toStringView(paramsName)));
+    member.instanceId = instanceId;
+    member.name = name;
+    member.templateName = templateName;
+    member.currentHp = r.readInt();
+    member.currentMp = r.readInt();
+    visitCharacterStats(member.stats, [&](int& value) { value = r.readInt(); });
+    visitEquipment(member.equipment,
+                   [&](bmin::String& id) { id = r.readString(ctx.strings); });
+    const int inventorySize = r.readCount();
+    for (int j = 0; j < inventorySize; j++) {
+      model::CharacterInventoryItem item;
+      item.itemName = r.readString(ctx.strings);
+      item.id = r.readString(ctx.strings);
+      item.quantity = r.readInt();
+      member.inventory.pushBack(std::move(item));
+    }
+    player.party.pushBack(std::move(member));
+  }
+}
+
+int templateTileIdAt(const model::CarcerMapTemplate& mapTemplate,
+                     int layer,
+                     size_t index) {
+  if (layer < 0 || static_cast<size_t>(layer) >= mapTemplate.tiles.size()) {
+    return 0;
+  }
+  const auto& flat = mapTemplate.tiles[static_cast<size_t>(layer)];
+  const size_t pairIdx = index * 2 + 1;
+  return pairIdx < flat.size() ? flat[pairIdx] : 0;
+}
+
+// Diff of one layer against the template: explored flags (only when any tile is
+// explored), tile ids that differ from the template (door opened, ...), and the tiles
+// that carry fields.
+SaveMapLayerDiff captureMapLayer(const model::CarcerMapTemplate* mapTemplate,
+                                 int layer,
+                                 const bmin::DynArray<model::TileInstance>& tiles) {
+  SaveMapLayerDiff diff;
+  diff.layer = layer;
+  bool anyExplored = false;
+  for (size_t i = 0; i < tiles.size(); i++) {
+    const auto& tile = tiles[i];
+    anyExplored = anyExplored || tile.isExplored;
+    const int baseline = mapTemplate ? templateTileIdAt(*mapTemplate, layer, i) : 0;
+    if (tile.tileId != baseline) {
+      diff.tileIds.pushBack(SaveTileIdDiff{static_cast<uint32_t>(i), tile.tileId});
+    }
+    if (!tile.fields.empty()) {
+      diff.fields.pushBack(SaveTileFieldsDiff{static_cast<uint32_t>(i), tile.fields});
+    }
+  }
+  if (anyExplored) {
+    diff.explored.reserve(tiles.size());
+    for (const auto& tile : tiles) {
+      diff.explored.pushBack(tile.isExplored ? 1 : 0);
+    }
+  }
+  return diff;
+}
+
+// Indices are delta encoded.
+void writeMapLayer(SaveWriter& w, const SaveMapLayerDiff& diff) {
+  w.writeVarInt(diff.layer);
+  w.writeBool(!diff.explored.empty());
+  if (!diff.explored.empty()) {
+    w.writeBits(diff.explored);
+  }
+
+  w.writeVarUint(diff.tileIds.size());
+  uint32_t prev = 0;
+  for (const auto& entry : diff.tileIds) {
+    w.writeVarUint(entry.index - prev);
+    w.writeVarInt(entry.tileId);
+    prev = entry.index;
+  }
+
+  w.writeVarUint(diff.fields.size());
+  prev = 0;
+  for (const auto& entry : diff.fields) {
+    w.writeVarUint(entry.index - prev);
+    writeTileFields(w, entry.fields);
+    prev = entry.index;
+  }
+}
+
+void readMapLayer(SaveReader& r, model::MapInstance& map) {
+  const int layer = r.readInt();
+  auto* tiles = model::mapLayerPtr(model::mapInstanceTiles(map), layer);
+  auto tileAt = [&](uint64_t index) -> model::TileInstance* {
+    if (tiles == nullptr || index >= tiles->size()) {
+      return nullptr;
+    }
+    return &(*tiles)[static_cast<size_t>(index)];
+  };
+
+  if (r.readBool()) {
+    const auto bits = r.readBits();
+    for (size_t i = 0; i < bits.size(); i++) {
+      if (auto* tile = tileAt(i)) {
+        tile->isExplored = bits[i] != 0;
+      }
+    }
+  }
+
+  const int changedCount = r.readCount();
+  uint64_t index = 0;
+  for (int i = 0; i < changedCount; i++) {
+    index += r.readVarUint();
+    const int tileId = r.readInt();
+    if (auto* tile = tileAt(index)) {
+      tile->tileId = tileId;
+    }
+  }
+
+  const int fieldTileCount = r.readCount();
+  index = 0;
+  for (int i = 0; i < fieldTileCount; i++) {
+    index += r.readVarUint();
+    auto fields = readTileFields(r);
+    if (auto* tile = tileAt(index)) {
+      tile->fields = std::move(fields);
+    }
+  }
+}
+
+SaveMapSnapshot captureMapInstance(const db::Database& database,
+                                   const model::MapInstance& map) {
+  const model::CarcerMapTemplate* mapTemplate =
+      database.findMapTemplate(bmin::toStringView(map.templateName));
+
+  SaveMapSnapshot snapshot;
+  snapshot.templateName = map.templateName;
+  const auto& persistent = map.persistentState;
+  // Everything but the tiles, which are reduced to layer diffs below.
+  snapshot.persistent.version = persistent.version;
+  snapshot.persistent.explored = persistent.explored;
+  snapshot.persistent.openedDoors = persistent.openedDoors;
+  snapshot.persistent.defeatedCharacters = persistent.defeatedCharacters;
+  snapshot.persistent.tileFields = persistent.tileFields;
+  snapshot.persistent.characters = persistent.characters;
+  snapshot.persistent.items = persistent.items;
+
+  auto& layers = const_cast<model::TileLayerMap&>(persistent.tiles);
+  bmin::DynArray<int> layerKeys;
+  for (auto it = layers.begin(); it != layers.end(); ++it) {
+    layerKeys.pushBack(it->key);
+  }
+  std::sort(layerKeys.begin(), layerKeys.end());
+  for (const int layer : layerKeys) {
+    snapshot.layers.pushBack(captureMapLayer(mapTemplate, layer, layers[layer]));
+  }
+  return snapshot;
+}
+
+void writeMapInstance(SaveWriter& w, SaveContext& ctx, const SaveMapSnapshot& map) {
+  w.writeString(ctx.strings, map.templateName);
+  const auto& persistent = map.persistent;
+  w.writeVarInt(persistent.version);
+
+  w.writeVarInt(persistent.explored.width);
+  w.writeVarInt(persistent.explored.height);
+  w.writeVarUint(persistent.explored.bits.size());
+  w.writeBytes(persistent.explored.bits.data(), persistent.explored.bits.size());
+
+  w.writeVarUint(persistent.openedDoors.size());
+  for (const auto& door : persistent.openedDoors) {
+    w.writeVarInt(door.layer);
+    w.writeVarInt(door.x);
+    w.writeVarInt(door.y);
+    w.writeVarInt(door.tileId);
+  }
+  w.writeVarUint(persistent.defeatedCharacters.size());
+  for (const auto& record : persistent.defeatedCharacters) {
+    w.writeString(ctx.strings, record.templateName);
+    w.writeVarInt(record.x);
+    w.writeVarInt(record.y);
+  }
+  w.writeVarUint(persistent.tileFields.size());
+  for (const auto& record : persistent.tileFields) {
+    w.writeVarInt(record.layer);
+    w.writeVarInt(record.x);
+    w.writeVarInt(record.y);
+    writeTileFields(w, record.fields);
+  }
+  writeCharacters(w, ctx, persistent.characters);
+  writeItems(w, ctx, persistent.items);
+
+  w.writeVarUint(map.layers.size());
+  for (const auto& layer : map.layers) {
+    writeMapLayer(w, layer);
+  }
+}
+
+void readMapInstance(SaveReader& r,
+                     const SaveContext& ctx,
+                     bmin::Map<bmin::String, model::MapInstance>& mapInstances) {
+  const auto& templateName = r.readString(ctx.strings);
+  model::MapInstance discarded;
+  model::MapInstance* map = &discarded;
+  // Lazily loaded databases create instances on demand (createMapInstances left the
+  // map empty).
+  if (auto* found = ensureMapInstance(mapInstances, *ctx.database, templateName)) {
+    map = found;
+  } else {
+    LOG(WARN) << "decodeSaveGame: map template no longer exists, skipping: "
+              << templateName << LOG_ENDL;
+  }
+
+  auto& persistent = map->persistentState;
+  persistent.version = r.readInt();
+  persistent.explored.width = r.readInt();
+  persistent.explored.height = r.readInt();
+  const auto exploredBytes = r.readBytes(static_cast<size_t>(r.readCount()));
+  persistent.explored.bits.clear();
+  for (const char c : exploredBytes) {
+    persistent.explored.bits.pushBack(static_cast<uint8_t>(c));
+  }
+
+  persistent.openedDoors.clear();
+  const int doorCount = r.readCount();
+  for (int i = 0; i < doorCount; i++) {
+    model::OpenedDoorRecord door;
+    door.layer = r.readInt();
+    door.x = r.readInt();
+    door.y = r.readInt();
+    door.tileId = r.readInt();
+    persistent.openedDoors.pushBack(door);
+  }
+  persistent.defeatedCharacters.clear();
+  const int defeatedCount = r.readCount();
+  for (int i = 0; i < defeatedCount; i++) {
+    model::DefeatedCharacterRecord record;
+    record.templateName = r.readString(ctx.strings);
+    record.x = r.readInt();
+    record.y = r.readInt();
+    persistent.defeatedCharacters.pushBack(std::move(record));
+  }
+  persistent.tileFields.clear();
+  const int tileFieldCount = r.readCount();
+  for (int i = 0; i < tileFieldCount; i++) {
+    model::PersistentTileFieldRecord record;
+    record.layer = r.readInt();
+    record.x = r.readInt();
+    record.y = r.readInt();
+    record.fields = readTileFields(r);
+    persistent.tileFields.pushBack(std::move(record));
+  }
+  persistent.characters = readCharacters(r, ctx);
+  persistent.items = readItems(r, ctx);
+
+  const int layerCount = r.readCount();
+  for (int i = 0; i < layerCount; i++) {
+    readMapLayer(r, *map);
+  }
+}
+
+void writeMapsSection(SaveWriter& w,
+                      SaveContext& ctx,
+                      const bmin::DynArray<SaveMapSnapshot>& maps) {
+  w.writeVarUint(maps.size());
+  for (const auto& map : maps) {
+    writeMapInstance(w, ctx, map);
+  }
+}
+
+void readMapsSection(SaveReader& r,
+                     const SaveContext& ctx,
+                     bmin::Map<bmin::String, model::MapInstance>& mapInstances) {
+  const int count = r.readCount();
+  for (int i = 0; i < count; i++) {
+    readMapInstance(r, ctx, mapInstances);
+  }
+}
+
+void writeEventStorageSection(SaveWriter& w,
+                              SaveContext& ctx,
+                              const bmin::DynArray<SaveStorageEntry>& storage) {
+  w.writeVarUint(storage.size());
+  for (const auto& entry : storage) {
+    w.writeString(ctx.strings, entry.key);
+    w.writeString(ctx.strings, entry.value);
+  }
+}
+
+void readEventStorageSection(SaveReader& r,
+                             const SaveContext& ctx,
+                             model::EventStorage& storage) {
+  model::eventStorageClear(storage);
+  const int count = r.readCount();
+  for (int i = 0; i < count; i++) {
+    const auto& key = r.readString(ctx.strings);
+    const auto& value = r.readString(ctx.strings);
+    model::eventStorageSet(storage, key, value);
+  }
+}
+
+void writeWorldSection(SaveWriter& w, SaveContext& ctx, const SaveSnapshot& snapshot) {
+  w.writeU8(static_cast<uint8_t>(snapshot.turnMode));
+  w.writeVarInt(snapshot.playerMovementCount);
+
+  w.writeString(ctx.strings, snapshot.gridId);
+  w.writeVarInt(snapshot.mapLayer);
+  writeCharacters(w, ctx, snapshot.characters);
+  writeItems(w, ctx, snapshot.items);
+
+  w.writeVarInt(snapshot.camera.camX);
+  w.writeVarInt(snapshot.camera.camY);
+  w.writeU8(static_cast<uint8_t>(snapshot.camera.cameraMode));
+  w.writeString(ctx.strings, snapshot.camera.cameraFollowCharacterId);
+
+  const auto& combat = snapshot.combat;
+  w.writeBool(combat.active);
+  w.writeVarUint(combat.turnOrderIds.size());
+  for (const auto& id : combat.turnOrderIds) {
+    w.writeString(ctx.strings, id);
+  }
+  w.writeVarInt(combat.activeTurnIndex);
+  w.writeString(ctx.strings, combat.activeCharacterId);
+  w.writeBool(combat.isWaitingForAction);
+
+  const auto& triggers = snapshot.triggers;
+  w.writeBool(triggers.pendingSpecialEventId.has_value());
+  if (triggers.pendingSpecialEventId) {
+    w.writeString(ctx.strings, *triggers.pendingSpecialEventId);
+  }
+  w.writeBool(triggers.pendingTravel.has_value());
+  if (triggers.pendingTravel) {
+    writeTravelTrigger(w, ctx, *triggers.pendingTravel);
+  }
+
+  w.writeVarUint(snapshot.rng.seed);
+  writeRandomStream(w, snapshot.rng.combat);
+  writeRandomStream(w, snapshot.rng.loot);
+  writeRandomStream(w, snapshot.rng.ids);
+  writeRandomStream(w, snapshot.rng.effects);
+}
+
+void readWorldSection(SaveReader& r, const SaveContext& ctx, state::State& state) {
+  auto& world = state.world;
+  state.turnMode = readEnum(r, model::TurnMode::TURN_COMBAT);
+  state.playerMovementCount = r.readInt();
+
+  world.activeMap.gridId = r.readString(ctx.strings);
+  world.activeMap.mapLayer = r.readInt();
+  world.activeMap.characters = readCharacters(r, ctx);
+  world.activeMap.items = readItems(r, ctx);
+
+  world.camera.camX = r.readInt();
+  world.camera.camY = r.readInt();
+  world.camera.cameraMode = readEnum(r, model::CameraMode::Controlled);
+  world.camera.cameraFollowCharacterId = r.readString(ctx.strings);
+
+  auto& combat = world.combat;
+  combat.active = r.readBool();
+  combat.turnOrderIds.clear();
+  const int turnOrderCount = r.readCount();
+  for (int i = 0; i < turnOrderCount; i++) {
+    combat.turnOrderIds.pushBack(r.readString(ctx.strings));
+  }
+  combat.activeTurnIndex = r.readInt();
+  combat.activeCharacterId = r.readString(ctx.strings);
+  combat.isWaitingForAction = r.readBool();
+
+  auto& triggers = state.triggers;
+  triggers.pendingSpecialEventId.reset();
+  if (r.readBool()) {
+    triggers.pendingSpecialEventId = r.readString(ctx.strings);
+  }
+  triggers.pendingTravel.reset();
+  if (r.readBool()) {
+    triggers.pendingTravel = readTravelTrigger(r, ctx);
+  }
+
+  state.rng.seed = r.readVarUint();
+  readRandomStream(r, state.rng.combat);
+  readRandomStream(r, state.rng.loot);
+  readRandomStream(r, state.rng.ids);
+  readRandomStream(r, state.rng.effects);
+}
+
+void writeSection(SaveWriter& payload,
+                  SaveSectionId id,
+                  uint32_t version,
+                  const SaveWriter& section) {
+  payload.writeVarUint(static_cast<uint8_t>(id));
+  payload.writeVarUint(version);
+  payload.writeVarUint(section.size());
+  payload.writeBytes(section.getBytes().data(), section.size());
+}
+
+} // namespace
+
+SaveSnapshot captureSaveSnapshot(const state::State& state,
+                                 const db::Database& database) {
+  SaveSnapshot snapshot;
+  snapshot.player = state.player;
+
+  const auto mapKeys = sortedKeys(state.mapInstances);
+  auto& maps =
+      const_cast<bmin::Map<bmin::String, model::MapInstance>&>(state.mapInstances);
+  snapshot.maps.reserve(mapKeys.size());
+  for (const auto& key : mapKeys) {
+    snapshot.maps.pushBack(captureMapInstance(database, maps[key]));
+  }
+
+  for (const auto* entry : model::eventStorageSortedEntries(state.specialEventStorage)) {
+    // tmp.* is per-conversation scratch (clearTmpStorageKeys).
+    if (model::getStorageKeyNamespace(entry->key) != model::StorageNamespace::TMP) {
+      snapshot.eventStorage.pushBack(
+          SaveStorageEntry{model::getStorageKeyName(entry->key),
+                           model::storageValueToText(entry->value)});
+    }
+  }
+
+  snapshot.turnMode = state.turnMode;
+  snapshot.playerMovementCount = state.playerMovementCount;
+  snapshot.gridId = state.world.activeMap.gridId;
+  snapshot.mapLayer = state.world.activeMap.mapLayer;
+  snapshot.characters = state.world.activeMap.characters;
+  snapshot.items = state.world.activeMap.items;
+  snapshot.camera = state.world.camera;
+  snapshot.combat = state.world.combat;
+  snapshot.triggers = state.triggers;
+  snapshot.rng = state.rng;
+  return snapshot;
+}
+
+bmin::DynArray<uint8_t> encodeSaveSnapshot(const SaveSnapshot& snapshot) {
+  SaveContext ctx;
+  SaveWriter player;
+  writePlayerSection(player, ctx, snapshot.player);
+  SaveWriter maps;
+  writeMapsSection(maps, ctx, snapshot.maps);
+  SaveWriter storage;
+  writeEventStorageSection(storage, ctx, snapshot.eventStorage);
+  SaveWriter world;
+  writeWorldSection(world, ctx, snapshot);
+
+  SaveWriter payload;
+  payload.writeVarUint(ctx.strings.size());
+  for (size_t i = 0; i < ctx.strings.size(); i++) {
+    payload.writeRawString(bmin::toStringView(ctx.strings.at(static_cast<uint32_t>(i))));
+  }
+  payload.writeVarUint(4);
+  writeSection(payload, SaveSectionId::PLAYER, SAVE_PLAYER_VERSION, player);
+  writeSection(payload, SaveSectionId::MAPS, SAVE_MAPS_VERSION, maps);
+  writeSection(
+      payload, SaveSectionId::EVENT_STORAGE, SAVE_EVENT_STORAGE_VERSION, storage);
+  writeSection(payload, SaveSectionId::WORLD, SAVE_WORLD_VERSION, world);
+
+  const auto& payloadBytes = payload.getBytes();
+  const std::string_view payloadView(reinterpret_cast<const char*>(payloadBytes.data()),
+                                     payloadBytes.size());
+  SaveWriter file;
+  file.writeBytes(reinterpret_cast<const uint8_t*>(SAVE_MAGIC), sizeof(SAVE_MAGIC));
+  file.writeU16(SAVE_FORMAT_VERSION);
+  file.writeU32(static_cast<uint32_t>(payloadBytes.size()));
+  file.writeU32(saveChecksum(payloadView));
+  file.writeBytes(payloadBytes.data(), payloadBytes.size());
+  return file.getBytes();
+}
+
+bmin::DynArray<uint8_t> encodeSaveGame(const state::State& state,
+                                       const db::Database& database) {
+  return encodeSaveSnapshot(captureSaveSnapshot(state, database));
+}
+
+void decodeSaveGame(std::string_view bytes,
+                    state::State& state,
+                    const db::Database& database) {
+  if (isCompressedSaveData(bytes)) {
+    const auto raw = decompressSaveData(bytes);
+    const std::string_view rawView(reinterpret_cast<const char*>(raw.data()), raw.size());
+    decodeSaveGame(rawView, state, database);
+    return;
+  }
+  if (bytes.size() < SAVE_HEADER_SIZE ||
+      bytes.substr(0, sizeof(SAVE_MAGIC)) !=
+          std::string_view(SAVE_MAGIC, sizeof(SAVE_MAGIC))) {
+    throw std::runtime_error("Not a save file");
+  }
+  SaveReader header(
+      bytes.substr(sizeof(SAVE_MAGIC), SAVE_HEADER_SIZE - sizeof(SAVE_MAGIC)));
+  const uint16_t formatVersion = header.readU16();
+  if (formatVersion > SAVE_FORMAT_VERSION) {
+    throw std::runtime_error("Save format is newer than this build");
+  }
+  const uint32_t payloadSize = header.readU32();
+  const uint32_t checksum = header.readU32();
+  const auto payload = bytes.substr(SAVE_HEADER_SIZE);
+  if (payload.size() != payloadSize || saveChecksum(payload) != checksum) {
+    throw std::runtime_error("Save file is truncated or corrupt");
+  }
+
+  SaveReader reader(payload);
+  SaveContext ctx;
+  ctx.database = &database;
+  const int stringCount = reader.readCount();
+  for (int i = 0; i < stringCount; i++) {
+    const auto text = reader.readRawString();
+    ctx.strings.append(bmin::String(text.data(), text.size()));
+  }
+
+  // Decode into a scratch State so a bad save leaves the running game alone.
+  state::State loaded;
+  createMapInstances(loaded, database);
+  auto sectionBit = [](SaveSectionId id) { return 1u << static_cast<int>(id); };
+  uint32_t seenSections = 0;
+  const int sectionCount = reader.readCount();
+  for (int i = 0; i < sectionCount; i++) {
+    const uint64_t id = reader.readVarUint();
+    const uint64_t version = reader.readVarUint();
+    const auto sectionBytes = reader.readBytes(static_cast<size_t>(reader.readVarUint()));
+    SaveReader section(sectionBytes);
+
+    // Checked before the cast, which would truncate an unknown id onto a known one.
+    if (id < static_cast<uint64_t>(SaveSectionId::PLAYER) ||
+        id > static_cast<uint64_t>(SaveSectionId::WORLD)) {
+      LOG(WARN) << "decodeSaveGame: skipping unknown section " << id << LOG_ENDL;
+      continue;
+    }
+    const auto sectionId = static_cast<SaveSectionId>(id);
+
+    uint64_t supportedVersion = 0;
+    switch (sectionId) {
+    case SaveSectionId::PLAYER:
+      supportedVersion = SAVE_PLAYER_VERSION;
+      break;
+    case SaveSectionId::MAPS:
+      supportedVersion = SAVE_MAPS_VERSION;
+      break;
+    case SaveSectionId::EVENT_STORAGE:
+      supportedVersion = SAVE_EVENT_STORAGE_VERSION;
+      break;
+    case SaveSectionId::WORLD:
+      supportedVersion = SAVE_WORLD_VERSION;
+      break;
+    }
+    if (version > supportedVersion) {
+      throw std::runtime_error("Save section is newer than this build");
+    }
+    ctx.sectionVersion = version;
+
+    switch (sectionId) {
+    case SaveSectionId::PLAYER:
+      readPlayerSection(section, ctx, database, loaded.player);
+      break;
+    case SaveSectionId::MAPS:
+      readMapsSection(section, ctx, loaded.mapInstances);
+      break;
+    case SaveSectionId::EVENT_STORAGE:
+      readEventStorageSection(section, ctx, loaded.specialEventStorage);
+      break;
+    case SaveSectionId::WORLD:
+      readWorldSection(section, ctx, loaded);
+      break;
+    }
+    seenSections |= sectionBit(sectionId);
+  }
+
+  const uint32_t requiredSections =
+      sectionBit(SaveSectionId::PLAYER) | sectionBit(SaveSectionId::MAPS) |
+      sectionBit(SaveSectionId::EVENT_STORAGE) | sectionBit(SaveSectionId::WORLD);
+  if ((seenSections & requiredSections) != requiredSections) {
+    throw std::runtime_error("Save file is missing a section");
+  }
+
+  // Layout (viewW/viewH) belongs to the current window, not the save.
+  loaded.world.camera.viewW = state.world.camera.viewW;
+  loaded.world.camera.viewH = state.world.camera.viewH;
+  state.player = std::move(loaded.player);
+  state.world = std::move(loaded.world);
+  state.triggers = std::move(loaded.triggers);
+  state.mapInstances = std::move(loaded.mapInstances);
+  state.specialEventStorage = std::move(loaded.specialEventStorage);
+  state.turnMode = loaded.turnMode;
+  state.playerMovementCount = loaded.playerMovementCount;
+  // Copy the values: the StateManager points the active streams at state.rng.
+  state.rng = loaded.rng;
+}
+
+bool writeSaveFileAtomic(std::string_view path,
+                         const bmin::DynArray<uint8_t>& bytes,
+                         bmin::String* error) {
+  auto fail = [&](const char* what, const std::filesystem::path& file) {
+    bmin::String message(what);
+    message += file.string().c_str();
+    if (error != nullptr) {
+      *error = std::move(message);
+    } else {
+      LOG(ERROR) << "writeSaveFileAtomic: " << message << LOG_ENDL;
+    }
+    return false;
+  };
+
+  const std::filesystem::path target(path);
+  std::filesystem::path tmpPath = target;
+  tmpPath += ".tmp";
+  {
+    std::ofstream out(tmpPath, std::ios::binary | std::ios::trunc);
+    out.write(reinterpret_cast<const char*>(bytes.data()),
+              static_cast<std::streamsize>(bytes.size()));
+    out.flush();
+    if (!out) {
+      return fail("failed to write ", tmpPath);
+    }
+  }
+  std::error_code ec;
+  std::filesystem::rename(tmpPath, target, ec);
+  if (ec) {
+    // Some platforms refuse to rename over an existing file.
+    std::filesystem::remove(target, ec);
+    std::filesystem::rename(tmpPath, target, ec);
+  }
+  if (ec) {
+    return fail("failed to replace ", target);
+  }
+  return true;
+}
+
+bool saveGameToFile(std::string_view path,
+                    const state::State& state,
+                    const db::Database& database) {
+  try {
+    const auto bytes = encodeSaveGame(state, database);
+    const std::string_view raw(reinterpret_cast<const char*>(bytes.data()), bytes.size());
+    return writeSaveFileAtomic(path, compressSaveData(raw));
+  } catch (const std::exception& e) {
+    LOG(ERROR) << "saveGameToFile: " << e.what() << LOG_ENDL;
+    return false;
+  }
+}
+
+bool loadGameFromFile(std::string_view path,
+                      state::State& state,
+                      const db::Database& database) {
+  try {
+    std::ifstream in{std::filesystem::path(path), std::ios::binary};
+    if (!in) {
+      LOG(ERROR) << "loadGameFromFile: cannot open "
+                 << bmin::String(path.data(), path.size()) << LOG_ENDL;
+      return false;
+    }
+    const std::string content{std::istreambuf_iterator<char>(in),
+                              std::istreambuf_iterator<char>()};
+    decodeSaveGame(content, state, database);
+    return true;
+  } catch (const std::exception& e) {
+    LOG(ERROR) << "loadGameFromFile: " << e.what() << LOG_ENDL;
+    return false;
+  }
+}
+
+} // namespace game
@@ -0,0 +1,126 @@
+#pragma once
+
+#include "bmin/DynArray.h"
+#include "bmin/String.h"
+#include "state/State.h"
+#include <cstdint>
+#include <string_view>
+
+namespace db {
+class Database;
+}
+
+namespace game {
+
+// File layout (all multi-byte header fields little-endian):
+//   "CSAV" | u16 format version | u32 payload size | u32 payload checksum | payload
+// The payload is a string table followed by sections, each written as
+//   varuint id | varuint version | varuint byte size | bytes
+// so a loader can skip sections it does not know and reject ones that are newer
+// than it understands. Strings inside sections are string table indices.
+inline constexpr char SAVE_MAGIC[4] = {'C', 'S', 'A', 'V'};
+inline constexpr uint16_t SAVE_FORMAT_VERSION = 1;
+
+enum class SaveSectionId : uint8_t {
+  PLAYER = 1,
+  MAPS = 2,
+  EVENT_STORAGE = 3,
+  WORLD = 4,
+};
+
+inline constexpr uint32_t SAVE_PLAYER_VERSION = 1;
+// 2: characters no longer store template fields (resolved from the database).
+inline constexpr uint32_t SAVE_MAPS_VERSION = 2;
+inline constexpr uint32_t SAVE_EVENT_STORAGE_VERSION = 1;
+// 2: as SAVE_MAPS_VERSION 2.
+inline constexpr uint32_t SAVE_WORLD_VERSION = 2;
+
+struct SaveTileIdDiff {
+  uint32_t index = 0;
+  int tileId = 0;
+};
+
+struct SaveTileFieldsDiff {
+  uint32_t index = 0;
+  bmin::DynArray<TileField> fields;
+};
+
+// One map layer reduced to its differences from the map template.
+struct SaveMapLayerDiff {
+  int layer = 0;
+  // One 0/1 flag per tile; empty when nothing on the layer is explored.
+  bmin::DynArray<uint8_t> explored;
+  bmin::DynArray<SaveTileIdDiff> tileIds;
+  bmin::DynArray<SaveTileFieldsDiff> fields;
+};
+
+struct SaveMapSnapshot {
+  bmin::String templateName;
+  // persistentState with tiles left empty; they live in layers.
+  model::PersistentMapState persistent;
+  bmin::DynArray<SaveMapLayerDiff> layers;
+};
+
+struct SaveStorageEntry {
+  bmin::String key;
+  bmin::String value;
+};
+
+// Everything a save contains, detached from state::State. Capturing is a tile scan
+// plus copies of the small parts; the byte encoding can then run on another thread.
+struct SaveSnapshot {
+  model::Player player;
+  // Sorted by template name.
+  bmin::DynArray<SaveMapSnapshot> maps;
+  // Sorted by key, tmp.* removed.
+  bmin::DynArray<SaveStorageEntry> eventStorage;
+  model::TurnMode turnMode = model::TurnMode::TURN_TOWN;
+  int playerMovementCount = 0;
+  bmin::String gridId;
+  int mapLayer = 0;
+  bmin::DynArray<model::CharacterInstance> characters;
+  bmin::DynArray<model::ItemInstance> items;
+  model::CameraInfo camera;
+  model::Combat combat;
+  state::Triggers triggers;
+  model::RandomStreams rng;
+};
+
+SaveSnapshot captureSaveSnapshot(const state::State& state, const db::Database& database);
+bmin::DynArray<uint8_t> encodeSaveSnapshot(const SaveSnapshot& snapshot);
+
+// Serializes what a save needs to resume: the party, every MapInstance as a diff
+// against its map template (tile id changes, explored bits, tile fields, records,
+// stowed characters/items), specialEventStorage without tmp.* keys, and the world
+// (active map entities, combat, pending triggers, RNG streams). UI state, settings,
+// visibility and transient animation state are not saved.
+// Same as encodeSaveSnapshot(captureSaveSnapshot(state, database)).
+bmin::DynArray<uint8_t> encodeSaveGame(const state::State& state,
+                                       const db::Database& database);
+
+// Rebuilds map instances from the database, applies the save on top and then
+// replaces the saved parts of state. Throws std::runtime_error on malformed or
+// newer-format data; state is left untouched in that case. Compressed files
+// (compressSaveData) are accepted as well. Visibility is not saved, so callers
+// recompute it (updateActiveMapVisibilityFromParty) after loading.
+void decodeSaveGame(std::string_view bytes,
+                    state::State& state,
+                    const db::Database& database);
+
+// Writes bytes to path + ".tmp" and renames it over path, so a crash mid-write
+// leaves the previous save intact. Returns false on any IO error; the message is
+// stored in error when given (worker threads), logged otherwise.
+bool writeSaveFileAtomic(std::string_view path,
+                         const bmin::DynArray<uint8_t>& bytes,
+                         bmin::String* error = nullptr);
+
+// Synchronous save/load of a compressed file. They log and return false instead of
+// throwing. Autosaves go through state::Autosave instead.
+bool saveGameToFile(std::string_view path,
+                    const state::State& state,
+                    const db::Database& database);
+bool loadGameFromFile(std::string_view path,
+                      state::State& state,
+                      const db::Database& database);
+
+} // namespace game
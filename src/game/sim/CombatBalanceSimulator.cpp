@@ -0,0 +1,314 @@
+#include "game/sim/CombatBalanceSimulator.h"
+#include "bmin/StringStream.h"
+#include "db/Database.h"
+#include "lib/Profiling.h"
+#include "model/Combat.h"
+#include "model/Random.h"
+#include "model/instances/CharacterInstance.h"
+#include "model/instances/CharacterPlayer.h"
+#include "model/instances/Player.h"
+#include "model/instances/World.h"
+#include "model/templates/CharacterTemplate.h"
+#include "model/templates/UtilityTypes.h"
+#include "sdl2w/Logger.h"
+#include <algorithm>
+#include <atomic>
+
+#ifndef __EMSCRIPTEN__
+#include <thread>
+#endif
+
+namespace game {
+
+namespace {
+
+struct TrialSetup {
+  model::World world;
+  model::Player player;
+};
+
+bool isOpponent(const model::Player& player,
+                const model::CharacterInstance& actor,
+                const model::CharacterInstance& other) {
+  return model::isCharacterAlly(player, actor) != model::isCharacterAlly(player, other);
+}
+
+model::CharacterInstance* findCharacter(model::World& world, const bmin::String& id) {
+  for (auto& character : world.activeMap.characters) {
+    if (character.id == id) {
+      return &character;
+    }
+  }
+  return nullptr;
+}
+
+model::CharacterInstance* chooseTarget(TrialSetup& setup,
+                                       const model::CharacterInstance& actor,
+                                       CombatTargetPolicy policy) {
+  model::CharacterInstance* best = nullptr;
+  for (const auto& id : setup.world.combat.turnOrderIds) {
+    auto* candidate = findCharacter(setup.world, id);
+    if (candidate == nullptr || !isOpponent(setup.player, actor, *candidate) ||
+        model::isCharacterDefeated(setup.player, *candidate)) {
+      continue;
+    }
+    if (policy == CombatTargetPolicy::FIRST_IN_TURN_ORDER) {
+      return candidate;
+    }
+    if (best == nullptr || model::getCharacterHp(setup.player, *candidate) <
+                               model::getCharacterHp(setup.player, *best)) {
+      best = candidate;
+    }
+  }
+  return best;
+}
+
+bool isSideStanding(TrialSetup& setup, bool party) {
+  for (auto& character : setup.world.activeMap.characters) {
+    if (model::isCharacterAlly(setup.player, character) == party &&
+        !model::isCharacterDefeated(setup.player, character)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+CombatDistribution makeDistribution(bmin::DynArray<int> values) {
+  CombatDistribution distribution;
+  if (values.empty()) {
+    return distribution;
+  }
+  std::sort(values.begin(), values.end());
+  double total = 0.;
+  for (const int value : values) {
+    total += value;
+  }
+  auto at = [&](double pct) {
+    const auto size = static_cast<double>(values.size());
+    const auto rank = static_cast<size_t>(pct / 100. * size);
+    return values[std::min(rank, values.size() - 1)];
+  };
+  distribution.mean = total / static_cast<double>(values.size());
+  distribution.min = values[0];
+  distribution.p10 = at(10.);
+  distribution.p50 = at(50.);
+  distribution.p90 = at(90.);
+  distribution.max = values.back();
+  return distribution;
+}
+
+void appendDistribution(bmin::StringStream& ss,
+                        const char* label,
+                        const CombatDistribution& distribution) {
+  ss << "  " << label << ": mean=" << distribution.mean << " min=" << distribution.min
+     << " p10=" << distribution.p10 << " p50=" << distribution.p50
+     << " p90=" << distribution.p90 << " max=" << distribution.max << "\n";
+}
+
+int resolveThreadCount(int requested, int trials) {
+#ifdef __EMSCRIPTEN__
+  (void)requested;
+  (void)trials;
+  return 1;
+#else
+  int threads = requested;
+  if (threads <= 0) {
+    threads = static_cast<int>(std::thread::hardware_concurrency());
+  }
+  return std::clamp(threads, 1, std::max(1, trials));
+#endif
+}
+
+} // namespace
+
+double CombatBalanceReport::getPartyWinRate() const {
+  return trials > 0 ? static_cast<double>(partyWins) / trials : 0.;
+}
+
+CombatBalanceSimulator::CombatBalanceSimulator(const db::Database& _database)
+    : database(_database) {}
+
+CombatTrialResult CombatBalanceSimulator::runTrial(const CombatBalanceParams& params,
+                                                   int trialIndex) const {
+  model::RandomStreams rng(
+      model::randomDeriveSeed(params.seed, static_cast<uint64_t>(trialIndex)));
+  // Instance ids come from the active streams; keep them per trial as well. The
+  // guard hands them back to the caller's State when run on its thread.
+  const model::ScopedActiveRandomStreams activeStreams(&rng);
+
+  TrialSetup setup;
+  for (const auto& templateName : params.partyTemplateNames) {
+    setup.player.party.pushBack(
+        model::CharacterPlayer(database.getCharacterTemplate(templateName)));
+  }
+  for (const auto& templateName : params.enemyTemplateNames) {
+    auto enemy = model::CharacterInstance{};
+    enemy.id = model::createRandomId();
+    enemy.templateName = templateName;
+    model::tryApplyCharacterTemplateToInstance(enemy, database);
+    setup.world.activeMap.characters.pushBack(std::move(enemy));
+  }
+
+  // Same sequence as StartCombat.
+  model::addPartyMembersToCombatMap(setup.world, setup.player, database);
+  setup.world.combat = model::createCombatFromWorld(setup.world, setup.player);
+  model::resetAllCombatAp(setup.world, model::COMBAT_STARTING_AP);
+
+  CombatTrialResult result;
+  auto& combat = setup.world.combat;
+  bool decided = false;
+  for (int round = 1; round <= params.maxRounds && !decided; round++) {
+    result.rounds = round;
+    if (round > 1) {
+      model::resetAllCombatAp(setup.world, model::COMBAT_STARTING_AP);
+    }
+    for (size_t turnIndex = 0; turnIndex < combat.turnOrderIds.size() && !decided;
+         turnIndex++) {
+      auto* actor = findCharacter(setup.world, combat.turnOrderIds[turnIndex]);
+      if (actor == nullptr || model::isCharacterDefeated(setup.player, *actor)) {
+        continue;
+      }
+      combat.activeTurnIndex = static_cast<int>(turnIndex);
+      combat.activeCharacterId = actor->id;
+      result.turns++;
+
+      const bool actorIsParty = model::isCharacterAlly(setup.player, *actor);
+      const auto policy =
+          actorIsParty ? params.partyTargetPolicy : params.enemyTargetPolicy;
+      while (actor->currentAp >= model::COMBAT_ATTACK_COST) {
+        auto* target = chooseTarget(setup, *actor, policy);
+        if (target == nullptr) {
+          break;
+        }
+        const auto attack = model::resolveMeleeAttack(rng.combat);
+        actor->currentAp -= model::COMBAT_ATTACK_COST;
+        (actorIsParty ? result.partyAttacks : result.enemyAttacks)++;
+        if (!attack.hit) {
+          continue;
+        }
+        (actorIsParty ? result.partyHits : result.enemyHits)++;
+        (actorIsParty ? result.partyDamageDealt : result.enemyDamageDealt) +=
+            attack.damage;
+        // Same HP path as the ModifyHP action.
+        model::setCharacterHp(setup.player,
+                              *target,
+                              model::getCharacterHp(setup.player, *target) -
+                                  attack.damage);
+      }
+
+      const bool partyStanding = isSideStanding(setup, true);
+      const bool enemiesStanding = isSideStanding(setup, false);
+      if (!partyStanding || !enemiesStanding) {
+        result.partyWon = partyStanding;
+        decided = true;
+      }
+    }
+  }
+  result.draw = !decided;
+
+  for (const auto& member : setup.player.party) {
+    if (member.currentHp <= 0) {
+      result.partyMembersDefeated++;
+    } else {
+      result.partyHpRemaining += member.currentHp;
+    }
+  }
+
+  return result;
+}
+
+CombatBalanceReport CombatBalanceSimulator::run(const CombatBalanceParams& params) const {
+  const uint64_t startNs = profiling::nowNs();
+  const int trials = std::max(0, params.trials);
+  bmin::DynArray<CombatTrialResult> results;
+  results.resize(static_cast<size_t>(trials));
+
+  const int threadsUsed = resolveThreadCount(params.numThreads, trials);
+  std::atomic<int> nextTrial{0};
+  auto worker = [&]() {
+    for (int i = nextTrial.fetch_add(1); i < trials; i = nextTrial.fetch_add(1)) {
+      results[static_cast<size_t>(i)] = runTrial(params, i);
+    }
+  };
+
+#ifdef __EMSCRIPTEN__
+  worker();
+#else
+  if (threadsUsed <= 1) {
+    worker();
+  } else {
+    bmin::DynArray<std::thread> threads;
+    threads.reserve(static_cast<size_t>(threadsUsed));
+    for (int i = 0; i < threadsUsed; i++) {
+      threads.pushBack(std::thread(worker));
+    }
+    for (auto& thread : threads) {
+      thread.join();
+    }
+  }
+#endif
+
+  CombatBalanceReport report;
+  report.trials = trials;
+  report.threadsUsed = threadsUsed;
+  bmin::DynArray<int> rounds;
+  bmin::DynArray<int> turns;
+  bmin::DynArray<int> partyDamage;
+  bmin::DynArray<int> enemyDamage;
+  bmin::DynArray<int> hpOnWin;
+  bmin::DynArray<int> membersDefeated;
+  int partyAttacks = 0;
+  int partyHits = 0;
+  int enemyAttacks = 0;
+  int enemyHits = 0;
+  for (const auto& result : results) {
+    if (result.draw) {
+      report.draws++;
+    } else if (result.partyWon) {
+      report.partyWins++;
+      hpOnWin.pushBack(result.partyHpRemaining);
+    } else {
+      report.enemyWins++;
+    }
+    rounds.pushBack(result.rounds);
+    turns.pushBack(result.turns);
+    partyDamage.pushBack(result.partyDamageDealt);
+    enemyDamage.pushBack(result.enemyDamageDealt);
+    membersDefeated.pushBack(result.partyMembersDefeated);
+    partyAttacks += result.partyAttacks;
+    partyHits += result.partyHits;
+    enemyAttacks += result.enemyAttacks;
+    enemyHits += result.enemyHits;
+  }
+  report.partyHitRate =
+      partyAttacks > 0 ? static_cast<double>(partyHits) / partyAttacks : 0.;
+  report.enemyHitRate =
+      enemyAttacks > 0 ? static_cast<double>(enemyHits) / enemyAttacks : 0.;
+  report.rounds = makeDistribution(std::move(rounds));
+  report.turns = makeDistribution(std::move(turns));
+  report.partyDamageDealt = makeDistribution(std::move(partyDamage));
+  report.enemyDamageDealt = makeDistribution(std::move(enemyDamage));
+  report.partyHpRemainingOnWin = makeDistribution(std::move(hpOnWin));
+  report.partyMembersDefeated = makeDistribution(std::move(membersDefeated));
+  report.wallMs = static_cast<double>(profiling::nowNs() - startNs) / 1e6;
+  return report;
+}
+
+bmin::String CombatBalanceSimulator::formatReport(const CombatBalanceReport& report) {
+  bmin::StringStream ss;
+  ss << "Combat balance: " << report.trials << " trials on " << report.threadsUsed
+     << " thread(s) in " << report.wallMs << "ms\n";
+  ss << "  party wins=" << report.partyWins << " (" << report.getPartyWinRate() * 100.
+     << "%) enemy wins=" << report.enemyWins << " draws=" << report.draws << "\n";
+  ss << "  hit rate: party=" << report.partyHitRate * 100.
+     << "% enemy=" << report.enemyHitRate * 100. << "%\n";
+  appendDistribution(ss, "rounds", report.rounds);
+  appendDistribution(ss, "turns", report.turns);
+  appendDistribution(ss, "party damage dealt", report.partyDamageDealt);
+  appendDistribution(ss, "enemy damage dealt", report.enemyDamageDealt);
+  appendDistribution(ss, "party hp left on win", report.partyHpRemainingOnWin);
+  appendDistribution(ss, "party members defeated", report.partyMembersDefeated);
+  return bmin::String(ss.str().cStr());
+}
+
+} // namespace game
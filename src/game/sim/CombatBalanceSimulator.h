@@ -0,0 +1,96 @@
+#pragma once
+
+#include "bmin/DynArray.h"
+#include "bmin/String.h"
+#include <cstdint>
+
+namespace db {
+class Database;
+}
+
+namespace game {
+
+enum class CombatTargetPolicy {
+  // First living opponent in turn order (stable, like focus fire).
+  FIRST_IN_TURN_ORDER,
+  // Living opponent with the least HP.
+  LOWEST_HP,
+};
+
+struct CombatBalanceParams {
+  bmin::DynArray<bmin::String> partyTemplateNames;
+  bmin::DynArray<bmin::String> enemyTemplateNames;
+  int trials = 1000;
+  uint64_t seed = 1;
+  // 0 = std::thread::hardware_concurrency(). Always 1 on Emscripten.
+  int numThreads = 0;
+  // Trials still undecided after this many rounds count as draws.
+  int maxRounds = 200;
+  CombatTargetPolicy partyTargetPolicy = CombatTargetPolicy::FIRST_IN_TURN_ORDER;
+  CombatTargetPolicy enemyTargetPolicy = CombatTargetPolicy::FIRST_IN_TURN_ORDER;
+};
+
+// Per-trial outcome; the report is aggregated from these in trial order.
+struct CombatTrialResult {
+  bool partyWon = false;
+  bool draw = false;
+  int rounds = 0;
+  int turns = 0;
+  int partyAttacks = 0;
+  int partyHits = 0;
+  int enemyAttacks = 0;
+  int enemyHits = 0;
+  int partyDamageDealt = 0;
+  int enemyDamageDealt = 0;
+  int partyHpRemaining = 0;
+  int partyMembersDefeated = 0;
+};
+
+struct CombatDistribution {
+  double mean = 0.;
+  int min = 0;
+  int p10 = 0;
+  int p50 = 0;
+  int p90 = 0;
+  int max = 0;
+};
+
+struct CombatBalanceReport {
+  int trials = 0;
+  int partyWins = 0;
+  int enemyWins = 0;
+  int draws = 0;
+  double partyHitRate = 0.;
+  double enemyHitRate = 0.;
+  CombatDistribution rounds;
+  CombatDistribution turns;
+  CombatDistribution partyDamageDealt;
+  CombatDistribution enemyDamageDealt;
+  // Only over trials the party won.
+  CombatDistribution partyHpRemainingOnWin;
+  CombatDistribution partyMembersDefeated;
+  double wallMs = 0.;
+  int threadsUsed = 1;
+
+  double getPartyWinRate() const;
+};
+
+// Monte Carlo balance runs for one encounter. Each trial builds a World/Player from
+// the Database templates the same way StartCombat does and resolves turns with the
+// shared combat rules (createCombatFromWorld, resetAllCombatAp, resolveMeleeAttack,
+// get/setCharacterHp), but without the action queue, the map or any rendering.
+// Every combatant is assumed engaged in melee. Trial i is seeded with
+// randomDeriveSeed(seed, i), so the report does not depend on the thread count.
+class CombatBalanceSimulator {
+  const db::Database& database;
+
+public:
+  explicit CombatBalanceSimulator(const db::Database& _database);
+
+  CombatTrialResult runTrial(const CombatBalanceParams& params, int trialIndex) const;
+  CombatBalanceReport run(const CombatBalanceParams& params) const;
+
+  static bmin::String formatReport(const CombatBalanceReport& report);
+};
+
+} // namespace game
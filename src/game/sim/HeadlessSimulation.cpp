@@ -0,0 +1,282 @@
+#include "game/sim/HeadlessSimulation.h"
+#include "db/Database.h"
+#include "game/map/ActiveMapOrchestrator.h"
+#include "game/map/MapPersistence.h"
+#include "lib/Profiling.h"
+#include "model/Combat.h"
+#include "model/instances/CharacterPlayer.h"
+#include "sdl2w/Logger.h"
+#include "state/State.h"
+#include "state/StateManager.h"
+#include "state/WorldUpdater.h"
+#include "state/actions/combat/DoCombatAction.hpp"
+#include "state/actions/world/WorldLoadActiveMap.hpp"
+#include "state/actions/world/WorldMovePlayer.hpp"
+#include "state/actions/world/WorldSpawnPlayerAtMarker.hpp"
+#include <algorithm>
+
+namespace game {
+
+namespace {
+
+struct DirectionToken {
+  std::string_view name;
+  int dx;
+  int dy;
+};
+
+constexpr DirectionToken DIRECTION_TOKENS[] = {
+    {"n", 0, -1},
+    {"ne", 1, -1},
+    {"e", 1, 0},
+    {"se", 1, 1},
+    {"s", 0, 1},
+    {"sw", -1, 1},
+    {"w", -1, 0},
+    {"nw", -1, -1},
+};
+
+int getRemainingMs(const model::TimerStruct& timer) {
+  return std::max(0, timer.duration - timer.t);
+}
+
+} // namespace
+
+HeadlessSimulation::HeadlessSimulation(state::StateManager& _stateManager,
+                                       HeadlessSimulationParams _params)
+    : stateManager(_stateManager), params(std::move(_params)) {
+  stateManager.setCollapseDelays(params.collapseDelays);
+  model::randomStreamsSeed(stateManager.getState().rng, params.seed);
+  if (params.script.empty()) {
+    params.script.pushBack(SimulationInput{SimulationInputType::WAIT, 0, 0});
+  }
+}
+
+bool HeadlessSimulation::setupWorld(
+    state::StateManager& stateManager,
+    db::Database& database,
+    std::string_view mapName,
+    const bmin::DynArray<bmin::String>& partyTemplateNames) {
+  auto& state = stateManager.getState();
+  state.player.party.clear();
+  state.player.currentPartyMemberIndex = 0;
+  for (const auto& templateName : partyTemplateNames) {
+    state.player.party.pushBack(
+        model::CharacterPlayer(database.getCharacterTemplate(templateName)));
+  }
+  if (state.player.party.empty()) {
+    LOG(ERROR) << "HeadlessSimulation::setupWorld - empty party" << LOG_ENDL;
+    return false;
+  }
+
+  game::createMapInstances(state, database);
+  auto loadMap = state::actions::WorldLoadActiveMap(bmin::String(mapName));
+  loadMap.execute(&state);
+  auto spawnPlayer = state::actions::WorldSpawnPlayerAtMarker("MarkerPlayer");
+  spawnPlayer.execute(&state);
+
+  game::ActiveMapOrchestrator orch;
+  if (state.world.activeMap.gridId.empty() ||
+      orch.findCharacterById(state.player.party[0].instanceId) == nullptr) {
+    LOG(ERROR) << "HeadlessSimulation::setupWorld - could not spawn party on "
+               << mapName << LOG_ENDL;
+    return false;
+  }
+  return true;
+}
+
+bmin::DynArray<SimulationInput> HeadlessSimulation::parseScript(std::string_view script) {
+  bmin::DynArray<SimulationInput> inputs;
+  size_t i = 0;
+  while (i < script.size()) {
+    while (i < script.size() && (script[i] == ' ' || script[i] == ',' ||
+                                 script[i] == '\n' || script[i] == '\t')) {
+      i++;
+    }
+    const size_t start = i;
+    while (i < script.size() && script[i] != ' ' && script[i] != ',' &&
+           script[i] != '\n' && script[i] != '\t') {
+      i++;
+    }
+    const auto token = script.substr(start, i - start);
+    if (token.empty()) {
+      continue;
+    }
+    if (token == "wait") {
+      inputs.pushBack(SimulationInput{SimulationInputType::WAIT, 0, 0});
+      continue;
+    }
+    bool found = false;
+    for (const auto& direction : DIRECTION_TOKENS) {
+      if (direction.name == token) {
+        inputs.pushBack(
+            SimulationInput{SimulationInputType::MOVE, direction.dx, direction.dy});
+        found = true;
+        break;
+      }
+    }
+    if (!found) {
+      LOG(WARN) << "HeadlessSimulation::parseScript - unknown token '" << token << "'"
+                << LOG_ENDL;
+    }
+  }
+  return inputs;
+}
+
+bool HeadlessSimulation::isIdle() const {
+  const auto& actionData = stateManager.getActionData();
+  return actionData.sequentialActions.empty() &&
+         actionData.sequentialActionsNext.empty() && actionData.insertActions.empty() &&
+         actionData.parallelActions.empty();
+}
+
+bool HeadlessSimulation::canIssueInput() const {
+  if (!isIdle()) {
+    return false;
+  }
+  const auto& state = stateManager.getState();
+  const auto& combat = state.world.combat;
+  if (combat.active) {
+    return combat.isWaitingForAction &&
+           model::isPartyMember(state.player, combat.activeCharacterId);
+  }
+  return !state.world.resolvingTownEnemyAi;
+}
+
+void HeadlessSimulation::issueInput() {
+  const auto& input = params.script[scriptIndex];
+  scriptIndex = (scriptIndex + 1) % params.script.size();
+  stats.playerInputs++;
+  stepsSinceInput = 0;
+
+  auto& actionData = stateManager.getActionData();
+  if (stateManager.getState().world.combat.active) {
+    if (input.type == SimulationInputType::MOVE) {
+      stats.combatMoves++;
+      stateManager.enqueueAction(
+          actionData,
+          new state::actions::DoCombatAction(
+              model::CombatActionType::MOVE, input.dx, input.dy),
+          0);
+    } else {
+      stats.combatWaits++;
+      stateManager.enqueueAction(
+          actionData,
+          new state::actions::DoCombatAction(model::CombatActionType::WAIT),
+          0);
+    }
+    return;
+  }
+
+  if (input.type == SimulationInputType::MOVE) {
+    stats.worldMoves++;
+    stateManager.enqueueAction(
+        actionData, new state::actions::WorldMovePlayer(input.dx, input.dy), 0);
+  }
+}
+
+int HeadlessSimulation::getNextStepMs() const {
+  const auto& actionData = stateManager.getActionData();
+  int nextMs = -1;
+  auto consider = [&](int remainingMs) {
+    nextMs = nextMs < 0 ? remainingMs : std::min(nextMs, remainingMs);
+  };
+
+  // Only the front sequential entry is counting down.
+  if (!actionData.sequentialActions.empty()) {
+    consider(getRemainingMs(actionData.sequentialActions[0].timer));
+  } else if (!actionData.sequentialActionsNext.empty()) {
+    consider(getRemainingMs(actionData.sequentialActionsNext[0].timer));
+  }
+  for (const auto& asyncAction : actionData.parallelActions) {
+    consider(getRemainingMs(asyncAction.timer));
+  }
+
+  if (nextMs < 0) {
+    return params.idleStepMs;
+  }
+  return std::max(1, nextMs);
+}
+
+void HeadlessSimulation::processTriggers() {
+  auto& state = stateManager.getState();
+  if (state.triggers.pendingSpecialEventId) {
+    LOG(INFO) << "HeadlessSimulation: skipping special event "
+              << *state.triggers.pendingSpecialEventId << LOG_ENDL;
+    state.triggers.pendingSpecialEventId.reset();
+    stats.skippedSpecialEvents++;
+  }
+  if (state.triggers.pendingTravel) {
+    stats.travels++;
+  }
+  // With the special event cleared this only runs travel, which needs no window.
+  state::worldProcessPendingTriggers(nullptr, stateManager);
+}
+
+void HeadlessSimulation::trackCombat() {
+  const auto& combat = stateManager.getState().world.combat;
+  if (combat.active && !wasCombatActive) {
+    stats.combatsStarted++;
+    lastCombatCharacterId.clear();
+  }
+  if (combat.active && combat.activeCharacterId != lastCombatCharacterId) {
+    stats.combatTurns++;
+    lastCombatCharacterId = combat.activeCharacterId;
+  }
+  wasCombatActive = combat.active;
+}
+
+bool HeadlessSimulation::isDone() const {
+  return stats.stalled || stats.playerInputs >= params.maxPlayerInputs ||
+         stats.steps >= params.maxSteps || stateManager.getState().player.party.empty();
+}
+
+bool HeadlessSimulation::step() {
+  if (isDone()) {
+    return false;
+  }
+  const uint64_t startNs = profiling::nowNs();
+
+  if (canIssueInput()) {
+    issueInput();
+  }
+  const int dt = getNextStepMs();
+  stateManager.update(dt);
+  processTriggers();
+  trackCombat();
+
+  stats.steps++;
+  stats.simulatedMs += static_cast<uint64_t>(dt);
+  stats.wallNs += profiling::nowNs() - startNs;
+  if (++stepsSinceInput >= params.stallSteps) {
+    LOG(WARN) << "HeadlessSimulation: no player input possible for " << stepsSinceInput
+              << " steps, stopping" << LOG_ENDL;
+    stats.stalled = true;
+  }
+  return !isDone();
+}
+
+const HeadlessSimulationStats& HeadlessSimulation::run() {
+  while (step()) {
+  }
+  return stats;
+}
+
+void HeadlessSimulation::logStats() const {
+  const double wallMs = static_cast<double>(stats.wallNs) / 1e6;
+  const double seconds = std::max(wallMs / 1000., 1e-9);
+  LOG(INFO) << "HeadlessSimulation: steps=" << stats.steps
+            << " inputs=" << stats.playerInputs << " (worldMoves=" << stats.worldMoves
+            << " combatMoves=" << stats.combatMoves
+            << " combatWaits=" << stats.combatWaits << ")" << LOG_ENDL;
+  LOG(INFO) << "HeadlessSimulation: combats=" << stats.combatsStarted
+            << " combatTurns=" << stats.combatTurns << " travels=" << stats.travels
+            << " skippedSpecialEvents=" << stats.skippedSpecialEvents
+            << (stats.stalled ? " STALLED" : "") << LOG_ENDL;
+  LOG(INFO) << "HeadlessSimulation: simulated " << stats.simulatedMs << "ms in "
+            << wallMs << "ms wall (" << static_cast<double>(stats.steps) / seconds
+            << " steps/s, " << static_cast<double>(stats.combatTurns) / seconds
+            << " combat turns/s)" << LOG_ENDL;
+}
+
+} // namespace game
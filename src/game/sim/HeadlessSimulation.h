@@ -0,0 +1,103 @@
+#pragma once
+
+#include "bmin/DynArray.h"
+#include "bmin/String.h"
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+namespace db {
+class Database;
+}
+
+namespace state {
+class StateManager;
+}
+
+namespace game {
+
+// One scripted party input. MOVE is a WorldMovePlayer outside combat and a combat
+// MOVE during the party's turn (same split as LayerWorld::enqueueMapMove). WAIT is
+// a combat WAIT; outside combat it just lets a turn pass.
+enum class SimulationInputType { MOVE, WAIT };
+
+struct SimulationInput {
+  SimulationInputType type = SimulationInputType::WAIT;
+  int dx = 0;
+  int dy = 0;
+};
+
+struct HeadlessSimulationParams {
+  // Cycled until maxPlayerInputs have been issued.
+  bmin::DynArray<SimulationInput> script;
+  uint64_t maxPlayerInputs = 1000;
+  uint64_t maxSteps = 1000000;
+  // Simulated dt when no action timer is pending (CPU turns, idle world).
+  int idleStepMs = 16;
+  // Consecutive steps without a player input before the run is declared stalled.
+  uint64_t stallSteps = 10000;
+  // Drop pure-delay (nullptr action) queue entries instead of waiting them out.
+  bool collapseDelays = true;
+  // Reseeds State::rng so a script replays identically.
+  uint64_t seed = 1;
+};
+
+struct HeadlessSimulationStats {
+  uint64_t steps = 0;
+  uint64_t simulatedMs = 0;
+  uint64_t wallNs = 0;
+  uint64_t playerInputs = 0;
+  uint64_t worldMoves = 0;
+  uint64_t combatMoves = 0;
+  uint64_t combatWaits = 0;
+  uint64_t combatsStarted = 0;
+  uint64_t combatTurns = 0;
+  uint64_t travels = 0;
+  // Special events need a dialogue layer; headless runs skip them.
+  uint64_t skippedSpecialEvents = 0;
+  bool stalled = false;
+};
+
+// Drives a StateManager with no window or layers as fast as the CPU allows. Each
+// step jumps simulated time straight to the next pending action timer, so a 300ms
+// combat delay costs one update instead of ~19 frames. Used for soak tests and to
+// measure the throughput of the game logic on its own.
+class HeadlessSimulation {
+  state::StateManager& stateManager;
+  HeadlessSimulationParams params;
+  HeadlessSimulationStats stats;
+  size_t scriptIndex = 0;
+  uint64_t stepsSinceInput = 0;
+  bool wasCombatActive = false;
+  bmin::String lastCombatCharacterId;
+
+  bool isIdle() const;
+  bool canIssueInput() const;
+  void issueInput();
+  int getNextStepMs() const;
+  void processTriggers();
+  void trackCombat();
+
+public:
+  HeadlessSimulation(state::StateManager& _stateManager,
+                     HeadlessSimulationParams _params);
+
+  // Loads mapName's grid, builds the party from partyTemplateNames and spawns it
+  // at MarkerPlayer. The Database must already be loaded and set.
+  static bool setupWorld(state::StateManager& stateManager,
+                         db::Database& database,
+                         std::string_view mapName,
+                         const bmin::DynArray<bmin::String>& partyTemplateNames);
+
+  // Whitespace/comma separated tokens: n ne e se s sw w nw (MOVE) or wait (WAIT).
+  static bmin::DynArray<SimulationInput> parseScript(std::string_view script);
+
+  bool isDone() const;
+  // One StateManager::update. Returns false once the run is done.
+  bool step();
+  const HeadlessSimulationStats& run();
+  const HeadlessSimulationStats& getStats() const { return stats; }
+  void logStats() const;
+};
+
+} // namespace game
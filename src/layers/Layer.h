@@ -63,14 +63,7 @@ public:
     if (!hasStateManager()) {
       return;
     }
-    getStateManager()->getActionBus().subscribe(
-        this,
-        std::type_index(typeid(ActionT)),
-        [fn = std::forward<Fn>(fn)](state::AbstractAction& action, state::State& state) {
-          if (auto* typed = dynamic_cast<ActionT*>(&action)) {
-            fn(*typed, state);
-          }
-        });
+    getStateManager()->getActionBus().subscribe<ActionT>(this, std::forward<Fn>(fn));
   }
 
   // Getters
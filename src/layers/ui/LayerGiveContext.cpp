@@ -73,7 +73,8 @@ LayerGiveContext::LayerGiveContext(sdl2w::Window* _window,
       database->getItemTemplate(bmin::toStringView(itemInstance.itemTemplateName)).stackable &&
       itemInstance.quantity > 1;
   for (const auto& member : player.party) {
-    const auto label = member.params.label.empty() ? member.name : member.params.label;
+    const auto& params = model::characterPlayerGetParams(member);
+    const auto label = params.label.empty() ? member.name : params.label;
     popupProps.partyMembers.pushBack(
         {.characterPlayerId = member.instanceId,
          .label = label,
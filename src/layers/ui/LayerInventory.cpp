@@ -111,7 +111,8 @@ void LayerInventory::syncInventoryPartyMember() {
 
   auto pageProps = pageInventory->getProps();
   pageProps.characterPlayerId = inventoryPartyMember->instanceId;
-  pageProps.characterPlayerLabel = inventoryPartyMember->params.label;
+  pageProps.characterPlayerLabel =
+      model::characterPlayerGetParams(*inventoryPartyMember).label;
   pageProps.partyMemberInventoryIndex = player.currentPartyMemberInventoryIndex;
   pageProps.partyMembers.clear();
   for (const auto& member : player.party) {
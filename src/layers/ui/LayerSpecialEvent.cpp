@@ -88,7 +88,7 @@ LayerSpecialEvent::LayerSpecialEvent(
     sdl2w::Window* _window,
     const model::GameEvent& gameEvent,
     const bmin::Map<bmin::String, model::GameEvent>& gameEvents,
-    const bmin::Map<bmin::String, bmin::String>& initialStorage)
+    const model::EventStorage& initialStorage)
     : Layer(_window, LAYER_ID),
       runner(initialStorage, gameEvent, gameEvents),
       runnerInterface(runner) {
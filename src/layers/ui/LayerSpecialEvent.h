@@ -49,7 +49,7 @@ public:
   LayerSpecialEvent(sdl2w::Window* _window,
                     const model::GameEvent& gameEvent,
                     const bmin::Map<bmin::String, model::GameEvent>& gameEvents,
-                    const bmin::Map<bmin::String, bmin::String>& initialStorage = {});
+                    const model::EventStorage& initialStorage = {});
   ~LayerSpecialEvent() override = default;
 
   void onKeyDown(std::string_view key, int keyCode) override;
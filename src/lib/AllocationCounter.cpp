@@ -0,0 +1,43 @@
+#include "lib/AllocationCounter.h"
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+
+// Kept apart from the code that reads the counters: compilers that can see both the
+// replaced operator delete and an inlined allocation warn about a new/free mismatch.
+
+namespace {
+
+// Plain thread_local integers: operator new may run before any other initialization.
+thread_local uint64_t threadAllocations = 0;
+thread_local uint64_t threadAllocatedBytes = 0;
+
+} // namespace
+
+AllocationCounts getThreadAllocationCounts() {
+  return AllocationCounts{threadAllocations, threadAllocatedBytes};
+}
+
+// The array and nothrow forms of the standard library call these, so every new
+// expression is counted.
+void* operator new(std::size_t size) {
+  threadAllocations++;
+  threadAllocatedBytes += size;
+  if (size == 0) {
+    size = 1;
+  }
+  while (true) {
+    if (void* ptr = std::malloc(size)) {
+      return ptr;
+    }
+    std::new_handler handler = std::get_new_handler();
+    if (!handler) {
+      throw std::bad_alloc();
+    }
+    handler();
+  }
+}
+
+void operator delete(void* ptr) noexcept { std::free(ptr); }
+
+void operator delete(void* ptr, std::size_t) noexcept { std::free(ptr); }
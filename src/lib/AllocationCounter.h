@@ -0,0 +1,14 @@
+#pragma once
+
+#include <cstdint>
+
+// Heap allocations made through operator new by the calling thread since it started.
+// AllocationCounter.cpp replaces the global operator new/delete to count them, so
+// allocations made inside sdl2w and bmin are included. Sanitizer runtimes bring their
+// own operator new, so the counts stay 0 in ASan/TSan builds.
+struct AllocationCounts {
+  uint64_t allocations = 0;
+  uint64_t bytes = 0;
+};
+
+AllocationCounts getThreadAllocationCounts();
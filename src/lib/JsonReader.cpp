@@ -0,0 +1,412 @@
+#include "lib/JsonReader.h"
+
+#include "lib/Json.h"
+
+#include "bmin/StringStream.h"
+
+#include <cctype>
+#include <climits>
+#include <stdexcept>
+
+JsonReader::JsonReader(const char* text, bool ignoreComments)
+    : _cursor(text), _start(text), _ignoreComments(ignoreComments) {}
+
+size_t JsonReader::column() const {
+  return static_cast<size_t>(_cursor - _start) + 1;
+}
+
+void JsonReader::throwError(const char* message) const {
+  bmin::StringStream ss;
+  ss << "parse error at column " << column() << ": " << message;
+  throw Json::parse_error(ss.str());
+}
+
+void JsonReader::skipWsAndComments() {
+  while (true) {
+    while (*_cursor != '\0' && std::isspace(static_cast<unsigned char>(*_cursor)) != 0) {
+      ++_cursor;
+    }
+    if (!_ignoreComments) {
+      return;
+    }
+    if (_cursor[0] == '/' && _cursor[1] == '/') {
+      _cursor += 2;
+      while (*_cursor != '\0' && *_cursor != '\n') {
+        ++_cursor;
+      }
+      continue;
+    }
+    if (_cursor[0] == '/' && _cursor[1] == '*') {
+      _cursor += 2;
+      while (_cursor[0] != '\0' && !(_cursor[0] == '*' && _cursor[1] == '/')) {
+        ++_cursor;
+      }
+      if (_cursor[0] == '\0') {
+        throwError("unterminated block comment");
+      }
+      _cursor += 2;
+      continue;
+    }
+    return;
+  }
+}
+
+bool JsonReader::startsWith(const char* literal) const {
+  for (size_t i = 0; literal[i] != '\0'; ++i) {
+    if (_cursor[i] != literal[i]) {
+      return false;
+    }
+  }
+  return true;
+}
+
+JsonReader::Type JsonReader::peekType() {
+  skipWsAndComments();
+  const char ch = *_cursor;
+  if (ch == '{') {
+    return Type::Object;
+  }
+  if (ch == '[') {
+    return Type::Array;
+  }
+  if (ch == '"') {
+    return Type::String;
+  }
+  if (ch == '-' || std::isdigit(static_cast<unsigned char>(ch)) != 0) {
+    const char* it = _cursor + 1;
+    while (std::isdigit(static_cast<unsigned char>(*it)) != 0) {
+      ++it;
+    }
+    return *it == '.' || *it == 'e' || *it == 'E' ? Type::Float : Type::Int;
+  }
+  if (startsWith("true") || startsWith("false")) {
+    return Type::Bool;
+  }
+  if (ch == '\0') {
+    throwError("unexpected end of input");
+  }
+  if (startsWith("null")) {
+    throwError("null values are not supported");
+  }
+  throwError("invalid value");
+}
+
+void JsonReader::enterContainer() {
+  ++_cursor;
+  _hasMember.pushBack(0);
+}
+
+bool JsonReader::nextInContainer(char close) {
+  skipWsAndComments();
+  if (*_cursor == close) {
+    ++_cursor;
+    _hasMember.popBack();
+    return false;
+  }
+  uint8_t& hasMember = _hasMember.back();
+  if (hasMember != 0) {
+    if (*_cursor != ',') {
+      throwError(close == '}' ? "expected ',' or '}'" : "expected ',' or ']'");
+    }
+    ++_cursor;
+    skipWsAndComments();
+  }
+  hasMember = 1;
+  return true;
+}
+
+void JsonReader::beginObject() {
+  if (peekType() != Type::Object) {
+    throw std::runtime_error("Json value is not an object");
+  }
+  enterContainer();
+}
+
+bool JsonReader::nextKey(std::string_view& key) {
+  if (!nextInContainer('}')) {
+    return false;
+  }
+  if (*_cursor != '"') {
+    throwError("expected string key");
+  }
+  key = scanString();
+  skipWsAndComments();
+  if (*_cursor != ':') {
+    throwError("expected token");
+  }
+  ++_cursor;
+  return true;
+}
+
+void JsonReader::beginArray() {
+  if (peekType() != Type::Array) {
+    throw std::runtime_error("Json value is not an array");
+  }
+  enterContainer();
+}
+
+bool JsonReader::nextElement() {
+  return nextInContainer(']');
+}
+
+bool JsonReader::tryBeginObject() {
+  if (peekType() != Type::Object) {
+    skipValue();
+    return false;
+  }
+  enterContainer();
+  return true;
+}
+
+bool JsonReader::tryBeginArray() {
+  if (peekType() != Type::Array) {
+    skipValue();
+    return false;
+  }
+  enterContainer();
+  return true;
+}
+
+std::string_view JsonReader::scanString() {
+  ++_cursor;
+  const char* begin = _cursor;
+  while (*_cursor != '"' && *_cursor != '\\') {
+    if (*_cursor == '\0') {
+      throwError("unterminated string");
+    }
+    if (static_cast<unsigned char>(*_cursor) < 0x20) {
+      throwError("control character in string");
+    }
+    ++_cursor;
+  }
+  if (*_cursor == '"') {
+    ++_cursor;
+    return std::string_view(begin, static_cast<size_t>(_cursor - 1 - begin));
+  }
+
+  // Escapes present: decode into the scratch buffer.
+  _scratch = bmin::String(begin, static_cast<size_t>(_cursor - begin));
+  while (true) {
+    const char ch = *_cursor;
+    if (ch == '\0') {
+      throwError("unterminated string");
+    }
+    ++_cursor;
+    if (ch == '"') {
+      break;
+    }
+    if (ch == '\\') {
+      const char escaped = *_cursor;
+      if (escaped == '\0') {
+        throwError("invalid string escape");
+      }
+      ++_cursor;
+      switch (escaped) {
+        case '"':
+        case '\\':
+        case '/':
+          _scratch.pushBack(escaped);
+          break;
+        case 'b':
+          _scratch.pushBack('\b');
+          break;
+        case 'f':
+          _scratch.pushBack('\f');
+          break;
+        case 'n':
+          _scratch.pushBack('\n');
+          break;
+        case 'r':
+          _scratch.pushBack('\r');
+          break;
+        case 't':
+          _scratch.pushBack('\t');
+          break;
+        case 'u':
+          throwError("unicode escapes are not supported");
+        default:
+          throwError("invalid string escape");
+      }
+      continue;
+    }
+    if (static_cast<unsigned char>(ch) < 0x20) {
+      --_cursor;
+      throwError("control character in string");
+    }
+    _scratch.pushBack(ch);
+  }
+  return std::string_view(_scratch.cStr(), _scratch.size());
+}
+
+void JsonReader::skipNumber() {
+  if (*_cursor == '-') {
+    ++_cursor;
+  }
+  if (*_cursor == '0') {
+    ++_cursor;
+    if (std::isdigit(static_cast<unsigned char>(*_cursor)) != 0) {
+      throwError("invalid number");
+    }
+  } else {
+    if (std::isdigit(static_cast<unsigned char>(*_cursor)) == 0) {
+      throwError("invalid number");
+    }
+    while (std::isdigit(static_cast<unsigned char>(*_cursor)) != 0) {
+      ++_cursor;
+    }
+  }
+  if (*_cursor == '.') {
+    ++_cursor;
+    if (std::isdigit(static_cast<unsigned char>(*_cursor)) == 0) {
+      throwError("invalid number");
+    }
+    while (std::isdigit(static_cast<unsigned char>(*_cursor)) != 0) {
+      ++_cursor;
+    }
+  }
+  if (*_cursor == 'e' || *_cursor == 'E') {
+    ++_cursor;
+    if (*_cursor == '+' || *_cursor == '-') {
+      ++_cursor;
+    }
+    if (std::isdigit(static_cast<unsigned char>(*_cursor)) == 0) {
+      throwError("invalid number");
+    }
+    while (std::isdigit(static_cast<unsigned char>(*_cursor)) != 0) {
+      ++_cursor;
+    }
+  }
+}
+
+int JsonReader::scanInteger() {
+  const bool negative = *_cursor == '-';
+  if (negative) {
+    ++_cursor;
+  }
+  if (std::isdigit(static_cast<unsigned char>(*_cursor)) == 0) {
+    throwError("invalid number");
+  }
+  if (*_cursor == '0' && std::isdigit(static_cast<unsigned char>(_cursor[1])) != 0) {
+    ++_cursor;
+    throwError("invalid number");
+  }
+  const std::int64_t limit = negative ? -static_cast<std::int64_t>(INT_MIN) : INT_MAX;
+  std::int64_t value = 0;
+  while (std::isdigit(static_cast<unsigned char>(*_cursor)) != 0) {
+    value = value * 10 + (*_cursor - '0');
+    if (value > limit) {
+      throwError("integer out of range");
+    }
+    ++_cursor;
+  }
+  if (*_cursor == '.' || *_cursor == 'e' || *_cursor == 'E') {
+    throw std::runtime_error("Json value is not an integer");
+  }
+  return static_cast<int>(negative ? -value : value);
+}
+
+bmin::String JsonReader::readString() {
+  if (peekType() != Type::String) {
+    throw std::runtime_error("Json value is not a string");
+  }
+  const std::string_view text = scanString();
+  return bmin::String(text.data(), text.size());
+}
+
+int JsonReader::readInt() {
+  if (peekType() != Type::Int) {
+    throw std::runtime_error("Json value is not an integer");
+  }
+  return scanInteger();
+}
+
+bool JsonReader::readBool() {
+  if (peekType() != Type::Bool) {
+    throw std::runtime_error("Json value is not a boolean");
+  }
+  const bool value = *_cursor == 't';
+  _cursor += value ? 4 : 5;
+  return value;
+}
+
+bmin::String JsonReader::readStringOr(const bmin::String& defaultValue) {
+  if (peekType() != Type::String) {
+    skipValue();
+    return defaultValue;
+  }
+  return readString();
+}
+
+int JsonReader::readIntOr(int defaultValue) {
+  if (peekType() != Type::Int) {
+    skipValue();
+    return defaultValue;
+  }
+  return readInt();
+}
+
+bool JsonReader::readBoolOr(bool defaultValue) {
+  if (peekType() != Type::Bool) {
+    skipValue();
+    return defaultValue;
+  }
+  return readBool();
+}
+
+void JsonReader::readIntArrayInto(bmin::DynArray<int>& out) {
+  beginArray();
+  // Tile layers hold thousands of values: size the array from the separators first.
+  size_t count = 1;
+  for (const char* it = _cursor; *it != ']' && *it != '\0'; ++it) {
+    count += *it == ',' ? 1 : 0;
+  }
+  out.reserve(out.size() + count);
+  while (nextElement()) {
+    const bool isNumber =
+        *_cursor == '-' || std::isdigit(static_cast<unsigned char>(*_cursor)) != 0;
+    out.pushBack(isNumber ? scanInteger() : readInt());
+  }
+}
+
+void JsonReader::readStringArrayInto(bmin::DynArray<bmin::String>& out) {
+  beginArray();
+  while (nextElement()) {
+    out.pushBack(readString());
+  }
+}
+
+void JsonReader::skipValue() {
+  switch (peekType()) {
+    case Type::Object: {
+      enterContainer();
+      std::string_view key;
+      while (nextKey(key)) {
+        skipValue();
+      }
+      break;
+    }
+    case Type::Array:
+      enterContainer();
+      while (nextElement()) {
+        skipValue();
+      }
+      break;
+    case Type::String:
+      scanString();
+      break;
+    case Type::Int:
+    case Type::Float:
+      skipNumber();
+      break;
+    case Type::Bool:
+      _cursor += *_cursor == 't' ? 4 : 5;
+      break;
+  }
+}
+
+void JsonReader::expectEnd() {
+  skipWsAndComments();
+  if (*_cursor != '\0') {
+    throwError("unexpected trailing input");
+  }
+}
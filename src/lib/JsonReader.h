@@ -0,0 +1,93 @@
+#pragma once
+
+#include "bmin/String.h"
+#include "bmin/DynArray.h"
+
+#include <cstdint>
+#include <string_view>
+
+// Pull parser over the same JSON dialect as Json::parse (optional comments, no null,
+// no unicode escapes). Values are decoded straight into the caller's structures
+// instead of building a Json tree first, which keeps large files such as maps.json
+// from being held in memory twice.
+//
+//   JsonReader reader(text, true);
+//   reader.beginObject();
+//   std::string_view key;
+//   while (reader.nextKey(key)) {
+//     if (key == "width") {
+//       width = reader.readInt();
+//     } else {
+//       reader.skipValue();
+//     }
+//   }
+//   reader.expectEnd();
+//
+// After nextKey or nextElement returns true the caller must consume exactly one value
+// (read, begin or skip it). Syntax errors throw Json::parse_error; reading a value as
+// the wrong type throws std::runtime_error with the same messages as Json::get.
+class JsonReader {
+ public:
+  enum class Type { Object, Array, String, Int, Float, Bool };
+
+  // text must stay alive and NUL terminated while the reader is used.
+  JsonReader(const char* text, bool ignoreComments);
+
+  // Type of the next value, without consuming it.
+  Type peekType();
+
+  void beginObject();
+  // Advances to the next member and points key at its name (valid until the next
+  // call). Returns false, consuming the '}', once the object is exhausted.
+  bool nextKey(std::string_view& key);
+
+  void beginArray();
+  // Returns false, consuming the ']', once the array is exhausted.
+  bool nextElement();
+
+  // Begin the object or array when the next value is one; otherwise skip the value and
+  // return false. For optional members the tree loaders guarded with is_object().
+  bool tryBeginObject();
+  bool tryBeginArray();
+
+  bmin::String readString();
+  int readInt();
+  bool readBool();
+
+  // Like Json::value: a value of another type is skipped and the default returned.
+  bmin::String readStringOr(const bmin::String& defaultValue);
+  int readIntOr(int defaultValue);
+  bool readBoolOr(bool defaultValue);
+
+  // Appends every element of an array of integers (or strings) to out.
+  void readIntArrayInto(bmin::DynArray<int>& out);
+  void readStringArrayInto(bmin::DynArray<bmin::String>& out);
+
+  void skipValue();
+
+  // Throws unless only whitespace and comments follow the top-level value.
+  void expectEnd();
+
+  // Position of the next unread character, counted from the start of the text. A
+  // reader constructed at text + getOffset() can re-read a value later.
+  size_t getOffset() const { return static_cast<size_t>(_cursor - _start); }
+
+ private:
+  const char* _cursor;
+  const char* _start;
+  bool _ignoreComments;
+  // One entry per open object or array: whether a member has been read yet, so the
+  // next one must be preceded by a comma.
+  bmin::DynArray<uint8_t> _hasMember;
+  bmin::String _scratch;
+
+  size_t column() const;
+  [[noreturn]] void throwError(const char* message) const;
+  void skipWsAndComments();
+  bool startsWith(const char* literal) const;
+  void enterContainer();
+  bool nextInContainer(char close);
+  std::string_view scanString();
+  int scanInteger();
+  void skipNumber();
+};
@@ -0,0 +1,56 @@
+#pragma once
+
+#include "bmin/String.h"
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+// Clock and text helpers shared by the profilers (ActionProfiler, StartupProfiler) and
+// the timing logs of the simulators and Autosave, so every report uses one time base
+// and one number format.
+namespace profiling {
+
+// Monotonic nanoseconds (std::chrono::steady_clock); only differences are meaningful.
+inline uint64_t nowNs() {
+  return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                   std::chrono::steady_clock::now().time_since_epoch())
+                                   .count());
+}
+
+// ns as a decimal number of units (1000 = microseconds, 1000000 = milliseconds) with
+// one digit after the point.
+inline bmin::String formatScaled(uint64_t ns, uint64_t unitNs) {
+  const uint64_t tenths = ns / (unitNs / 10);
+  bmin::String out = bmin::toString(tenths / 10);
+  out += '.';
+  out += static_cast<char>('0' + tenths % 10);
+  return out;
+}
+
+// Chrome trace timestamps and durations are microseconds.
+inline bmin::String formatMicros(uint64_t ns) { return formatScaled(ns, 1000); }
+
+// Table cell: value left aligned in width columns, then a separating space.
+inline void appendPadded(bmin::String& out, const bmin::String& value, size_t width) {
+  out += value;
+  for (size_t i = value.size(); i < width; i++) {
+    out += ' ';
+  }
+  out += ' ';
+}
+
+// Quoted JSON string; names are class and phase names, so only " and \ need escaping.
+inline void appendJsonString(bmin::String& out, const bmin::String& value) {
+  out += '"';
+  for (size_t i = 0; i < value.size(); i++) {
+    const char c = value[i];
+    if (c == '"' || c == '\\') {
+      out += '\\';
+    }
+    out += c;
+  }
+  out += '"';
+}
+
+} // namespace profiling
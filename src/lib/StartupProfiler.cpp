@@ -0,0 +1,185 @@
+#include "lib/StartupProfiler.h"
+#include "bmin/StringInterop.h"
+#include "lib/Profiling.h"
+#include "sdl2w/AssetLoader.h"
+#include "sdl2w/Logger.h"
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+
+namespace {
+
+thread_local uint32_t threadDepth = 0;
+thread_local int64_t threadIndex = -1;
+
+struct ProfilerData {
+  std::mutex mutex;
+  bmin::DynArray<StartupPhase> phases;
+  uint64_t originNs = 0;
+  std::atomic<bool> enabled{false};
+  std::atomic<uint32_t> nextThreadIndex{0};
+};
+
+ProfilerData& data() {
+  static ProfilerData instance;
+  return instance;
+}
+
+uint64_t getOriginNs() {
+  auto& d = data();
+  std::lock_guard<std::mutex> lock(d.mutex);
+  return d.originNs;
+}
+
+} // namespace
+
+StartupProfiler::Scope::Scope(std::string_view _name) {
+  if (!isEnabled()) {
+    return;
+  }
+  if (threadIndex < 0) {
+    threadIndex = data().nextThreadIndex.fetch_add(1);
+  }
+  name = bmin::String(_name.data(), _name.size());
+  active = true;
+  depth = threadDepth++;
+  startAllocated = getThreadAllocationCounts();
+  startNs = profiling::nowNs();
+}
+
+StartupProfiler::Scope::~Scope() { end(); }
+
+void StartupProfiler::Scope::end() {
+  if (!active) {
+    return;
+  }
+  active = false;
+  const uint64_t endNs = profiling::nowNs();
+  const AllocationCounts endAllocated = getThreadAllocationCounts();
+  threadDepth--;
+
+  StartupPhase phase;
+  phase.name = std::move(name);
+  phase.thread = static_cast<uint32_t>(threadIndex);
+  phase.depth = depth;
+  phase.startNs = startNs;
+  phase.durationNs = endNs - startNs;
+  phase.allocated.allocations = endAllocated.allocations - startAllocated.allocations;
+  phase.allocated.bytes = endAllocated.bytes - startAllocated.bytes;
+  record(std::move(phase));
+}
+
+void StartupProfiler::setEnabled(bool enabled) {
+  auto& d = data();
+  {
+    std::lock_guard<std::mutex> lock(d.mutex);
+    if (enabled && d.originNs == 0) {
+      d.originNs = profiling::nowNs();
+    }
+  }
+  d.enabled.store(enabled, std::memory_order_release);
+}
+
+bool StartupProfiler::isEnabled() {
+  return data().enabled.load(std::memory_order_acquire);
+}
+
+void StartupProfiler::reset() {
+  auto& d = data();
+  std::lock_guard<std::mutex> lock(d.mutex);
+  d.phases.clear();
+  d.originNs = isEnabled() ? profiling::nowNs() : 0;
+}
+
+void StartupProfiler::record(StartupPhase phase) {
+  auto& d = data();
+  std::lock_guard<std::mutex> lock(d.mutex);
+  d.phases.pushBack(std::move(phase));
+}
+
+bmin::DynArray<StartupPhase> StartupProfiler::getPhases() {
+  bmin::DynArray<StartupPhase> phases;
+  {
+    auto& d = data();
+    std::lock_guard<std::mutex> lock(d.mutex);
+    phases = d.phases;
+  }
+  // Phases are recorded when they end; a parent starts before its children.
+  std::stable_sort(
+      phases.begin(), phases.end(), [](const StartupPhase& a, const StartupPhase& b) {
+        return a.startNs < b.startNs;
+      });
+  return phases;
+}
+
+bmin::String StartupProfiler::formatReport() {
+  const auto phases = getPhases();
+  const uint64_t originNs = getOriginNs();
+  size_t nameWidth = 5;
+  for (const auto& phase : phases) {
+    nameWidth = std::max(nameWidth, phase.name.size() + 2 * phase.depth);
+  }
+
+  bmin::String out;
+  profiling::appendPadded(out, "phase", nameWidth);
+  profiling::appendPadded(out, "thread", 6);
+  profiling::appendPadded(out, "start_ms", 9);
+  profiling::appendPadded(out, "ms", 9);
+  profiling::appendPadded(out, "allocs", 9);
+  out += "bytes\n";
+  for (const auto& phase : phases) {
+    bmin::String indented;
+    for (uint32_t i = 0; i < phase.depth; i++) {
+      indented += "  ";
+    }
+    indented += phase.name;
+    profiling::appendPadded(out, indented, nameWidth);
+    profiling::appendPadded(out, bmin::toString(phase.thread), 6);
+    const uint64_t startNs = phase.startNs >= originNs ? phase.startNs - originNs : 0;
+    profiling::appendPadded(out, profiling::formatScaled(startNs, 1000000), 9);
+    profiling::appendPadded(out, profiling::formatScaled(phase.durationNs, 1000000), 9);
+    profiling::appendPadded(out, bmin::toString(phase.allocated.allocations), 9);
+    out += bmin::toString(phase.allocated.bytes);
+    out += '\n';
+  }
+  return out;
+}
+
+void StartupProfiler::logReport() {
+  LOG(INFO) << "StartupProfiler report:\n" << formatReport() << LOG_ENDL;
+}
+
+bmin::String StartupProfiler::formatChromeTrace() {
+  const auto phases = getPhases();
+  const uint64_t originNs = getOriginNs();
+
+  bmin::String out("{\"traceEvents\":[");
+  bool first = true;
+  for (const auto& phase : phases) {
+    if (!first) {
+      out += ",\n";
+    }
+    first = false;
+    const uint64_t startNs = phase.startNs >= originNs ? phase.startNs - originNs : 0;
+    out += "{\"name\":";
+    profiling::appendJsonString(out, phase.name);
+    out += ",\"cat\":\"startup\",\"ph\":\"X\",\"pid\":1,\"tid\":";
+    out += bmin::toString(phase.thread + 1);
+    out += ",\"ts\":";
+    out += profiling::formatScaled(startNs, 1000);
+    out += ",\"dur\":";
+    out += profiling::formatScaled(phase.durationNs, 1000);
+    out += ",\"args\":{\"allocations\":";
+    out += bmin::toString(phase.allocated.allocations);
+    out += ",\"bytes\":";
+    out += bmin::toString(phase.allocated.bytes);
+    out += "}}";
+  }
+  out += "]}\n";
+  return out;
+}
+
+void StartupProfiler::writeChromeTrace(std::string_view path) {
+  sdl2w::saveFileAsString(path, bmin::toStringView(formatChromeTrace()));
+  LOG(INFO) << "StartupProfiler: wrote " << path << LOG_ENDL;
+}
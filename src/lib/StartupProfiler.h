@@ -0,0 +1,63 @@
+#pragma once
+
+#include "bmin/DynArray.h"
+#include "bmin/String.h"
+#include "lib/AllocationCounter.h"
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+struct StartupPhase {
+  bmin::String name;
+  // 0 for the first thread that recorded a phase, then 1, 2, ... in order of first use.
+  uint32_t thread = 0;
+  // Number of enclosing phases on the same thread.
+  uint32_t depth = 0;
+  uint64_t startNs = 0;
+  uint64_t durationNs = 0;
+  // Made by this phase's thread while it ran, nested phases included. Work the phase
+  // hands to other threads is counted by the phases those threads record.
+  AllocationCounts allocated;
+};
+
+// Opt-in, process-wide record of where launch time goes. Code wraps each step in a
+// StartupProfiler::Scope ("window", "font default", "asset assets/assets.game.txt",
+// "db maps", ...); while enabled, every scope records its wall time and allocation
+// counts, from any thread. The result is read back as a table in start order, or as
+// Chrome trace JSON like ActionProfiler's. Scopes are cheap no-ops while disabled.
+class StartupProfiler {
+public:
+  class Scope {
+  public:
+    explicit Scope(std::string_view name);
+    ~Scope();
+    Scope(const Scope&) = delete;
+    Scope& operator=(const Scope&) = delete;
+
+    // Records the phase now instead of at destruction, for steps that construct an
+    // object the rest of the function needs.
+    void end();
+
+  private:
+    bmin::String name;
+    bool active = false;
+    uint32_t depth = 0;
+    uint64_t startNs = 0;
+    AllocationCounts startAllocated;
+  };
+
+  static void setEnabled(bool enabled);
+  static bool isEnabled();
+  static void reset();
+
+  // Finished phases in the order they started.
+  static bmin::DynArray<StartupPhase> getPhases();
+
+  static bmin::String formatReport();
+  static void logReport();
+  static bmin::String formatChromeTrace();
+  static void writeChromeTrace(std::string_view path);
+
+private:
+  static void record(StartupPhase phase);
+};
@@ -1,16 +1,38 @@
+#include "lib/StartupProfiler.h"
 #include "lib/hiscore/hiscore.h"
+#include "model/Random.h"
 #include "sdl2w/AssetLoader.h"
 #include "sdl2w/Draw.h"
 #include "sdl2w/Events.h"
 #include "sdl2w/Init.h"
 #include "sdl2w/L10n.h"
 #include "sdl2w/Logger.h"
+#include <string_view>
+
+namespace {
+
+// --startup-profile: time the launch steps, log the table and write the Chrome trace
+// at exit.
+constexpr std::string_view STARTUP_PROFILE_ARG = "--startup-profile";
+constexpr char STARTUP_PROFILE_PATH[] = "startup-profile.json";
+
+bool hasArg(int argc, char** argv, std::string_view arg) {
+  for (int i = 1; i < argc; i++) {
+    if (arg == argv[i]) {
+      return true;
+    }
+  }
+  return false;
+}
+
+} // namespace
 
 void runProgram(int argc, char** argv) {
   const int w = 640;
   const int h = 480;
 
   sdl2w::Store store;
+  StartupProfiler::Scope windowScope("window");
   sdl2w::Window window(store,
                        {
                            .mode = sdl2w::DrawMode::GPU,
@@ -22,14 +44,24 @@ void runProgram(int argc, char** argv) {
                            .renderW = w,
                            .renderH = h,
                        });
-  sdl2w::L10n::init({"en", "la"});
-  sdl2w::setupStartupArgs(argc, argv, window);
-  sdl2w::L10n::setLanguage(DISABLE_TRANSLATIONS);
+  windowScope.end();
+  {
+    StartupProfiler::Scope scope("l10n");
+    sdl2w::L10n::init({"en", "la"});
+    sdl2w::setupStartupArgs(argc, argv, window);
+    sdl2w::L10n::setLanguage(DISABLE_TRANSLATIONS);
+  }
   window.getDraw().setBackgroundColor({0, 0, 0});
 
   sdl2w::AssetLoader assetLoader(window.getDraw(), window.getStore());
-  window.getStore().loadAndStoreFont("default", "assets/cabal.ttf");
-  window.getStore().loadAndStoreFont("alternate", "assets/monofonto.ttf");
+  {
+    StartupProfiler::Scope scope("font default");
+    window.getStore().loadAndStoreFont("default", "assets/cabal.ttf");
+  }
+  {
+    StartupProfiler::Scope scope("font alternate");
+    window.getStore().loadAndStoreFont("alternate", "assets/monofonto.ttf");
+  }
 
   sdl2w::Draw& d = window.getDraw();
   window.setSoundPct(33);
@@ -73,12 +105,21 @@ void runProgram(int argc, char** argv) {
 
 int main(int argc, char** argv) {
   LOG(INFO) << "Start program" << LOG_ENDL;
-  sdl2w::Window::init();
-  srand(time(NULL));
+  const bool profileStartup = hasArg(argc, argv, STARTUP_PROFILE_ARG);
+  StartupProfiler::setEnabled(profileStartup);
+  {
+    StartupProfiler::Scope scope("sdl2w init");
+    sdl2w::Window::init();
+  }
+  model::setDefaultRandomSeed(static_cast<uint64_t>(time(NULL)));
 
   runProgram(argc, argv);
 
   sdl2w::Window::unInit();
+  if (profileStartup) {
+    StartupProfiler::logReport();
+    StartupProfiler::writeChromeTrace(STARTUP_PROFILE_PATH);
+  }
   LOG(INFO) << "End program" << LOG_ENDL;
 
   return 0;
@@ -5,6 +5,7 @@
 #include "model/instances/CharacterInstance.h"
 #include "model/instances/Player.h"
 #include "model/instances/World.h"
+#include "model/Random.h"
 #include "model/templates/CharacterTemplate.h"
 #include "state/State.h"
 #include "bmin/StringStream.h"
@@ -46,7 +47,7 @@ int getCharacterHp(const Player& player, const CharacterInstance& character) {
   if (character.currentHp > 0) {
     return character.currentHp;
   }
-  return character.maxHp;
+  return characterInstanceGetMaxHp(character);
 }
 
 void setCharacterHp(Player& player, CharacterInstance& character, int hp) {
@@ -95,6 +96,13 @@ void removeCharacterFromCombatTurnOrder(Combat& combat, const bmin::String& char
   }
 }
 
+MeleeAttackResult resolveMeleeAttack(RandomStream& combatRng) {
+  MeleeAttackResult result;
+  result.hit = randomChancePercent(combatRng, COMBAT_HIT_CHANCE_PERCENT);
+  result.damage = result.hit ? COMBAT_MELEE_DAMAGE : 0;
+  return result;
+}
+
 void resetAllCombatAp(World& world, int ap) {
   for (auto& character : world.activeMap.characters) {
     character.currentAp = ap;
@@ -124,11 +132,12 @@ void addPartyMembersToCombatMap(World& world, Player& player, const db::Database
       continue;
     }
 
+    const auto& params = characterPlayerGetParams(member);
     auto instance = CharacterInstance{};
     instance.id = member.instanceId;
-    instance.name = member.name.empty() ? member.params.name : member.name;
+    instance.name = member.name.empty() ? params.name : member.name;
     instance.templateName =
-        member.templateName.empty() ? member.params.name : member.templateName;
+        member.templateName.empty() ? params.name : member.templateName;
     instance.x = spawnX;
     instance.y = spawnY;
     instance.spawnX = spawnX;
@@ -141,7 +150,7 @@ void addPartyMembersToCombatMap(World& world, Player& player, const db::Database
 
   for (auto& character : activeMap.characters) {
     if (character.currentHp <= 0 && isCharacterEnemy(character)) {
-      character.currentHp = character.maxHp;
+      character.currentHp = characterInstanceGetMaxHp(character);
     }
   }
 }
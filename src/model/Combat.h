@@ -20,6 +20,7 @@ struct Player;
 struct World;
 struct CharacterInstance;
 struct ActiveMap;
+struct RandomStream;
 
 inline constexpr int COMBAT_STARTING_AP = 4;
 inline constexpr int COMBAT_MOVE_COST = 1;
@@ -36,6 +37,11 @@ struct CombatSpellTarget {
   int tileY = 0;
 };
 
+struct MeleeAttackResult {
+  bool hit = false;
+  int damage = 0;
+};
+
 struct Combat {
   bool active = false;
   bmin::DynArray<bmin::String> turnOrderIds;
@@ -56,6 +62,9 @@ void setCharacterHp(Player& player, CharacterInstance& character, int hp);
 bool modifyPartyMemberHp(Player& player, const bmin::String& instanceId, int delta);
 bool isCharacterDefeated(const Player& player, const CharacterInstance& character);
 
+/** Melee hit/damage roll. PerformMeleeAttack and the balance simulator both use it. */
+MeleeAttackResult resolveMeleeAttack(RandomStream& combatRng);
+
 void resetAllCombatAp(World& world, int ap = COMBAT_STARTING_AP);
 void onNewCombatRound(state::State& state);
 void addPartyMembersToCombatMap(World& world, Player& player, const db::Database& database);
@@ -0,0 +1,302 @@
+#include "model/EventStorage.h"
+#include "bmin/Map.h"
+#include <algorithm>
+#include <cmath>
+#include <climits>
+#include <deque>
+#include <mutex>
+
+namespace model {
+
+namespace {
+
+struct StorageKeyTable {
+  std::mutex mutex;
+  bmin::Map<bmin::String, StorageKey> ids;
+  // deque so names handed out by getStorageKeyName never move.
+  std::deque<bmin::String> names;
+  std::deque<StorageNamespace> namespaces;
+};
+
+StorageKeyTable& getStorageKeyTable() {
+  static StorageKeyTable table;
+  return table;
+}
+
+uint32_t makeSlot(uint32_t index, StorageNamespace ns) {
+  return index << STORAGE_NAMESPACE_BITS | static_cast<uint32_t>(ns);
+}
+
+uint32_t slotIndex(uint32_t slot) { return slot >> STORAGE_NAMESPACE_BITS; }
+
+int slotNamespace(uint32_t slot) {
+  return static_cast<int>(slot & ((1u << STORAGE_NAMESPACE_BITS) - 1));
+}
+
+bool isIntegralInIntRange(double n) {
+  double intPart;
+  return std::modf(n, &intPart) == 0.0 && n >= INT_MIN && n <= INT_MAX;
+}
+
+} // namespace
+
+StorageNamespace getStorageNamespace(const bmin::String& name) {
+  if (name.startsWith("vars.")) {
+    return StorageNamespace::VARS;
+  }
+  if (name.startsWith("once.")) {
+    return StorageNamespace::ONCE;
+  }
+  if (name.startsWith("tmp.")) {
+    return StorageNamespace::TMP;
+  }
+  return StorageNamespace::OTHER;
+}
+
+StorageKey internStorageKey(const bmin::String& name) {
+  auto& table = getStorageKeyTable();
+  std::lock_guard<std::mutex> lock(table.mutex);
+  auto it = table.ids.find(name);
+  if (it != table.ids.end()) {
+    return it->value;
+  }
+  const StorageKey key = static_cast<StorageKey>(table.names.size());
+  table.names.push_back(name);
+  table.namespaces.push_back(getStorageNamespace(name));
+  table.ids[name] = key;
+  return key;
+}
+
+StorageKey findStorageKey(const bmin::String& name) {
+  auto& table = getStorageKeyTable();
+  std::lock_guard<std::mutex> lock(table.mutex);
+  auto it = table.ids.find(name);
+  return it != table.ids.end() ? it->value : NO_STORAGE_KEY;
+}
+
+const bmin::String& getStorageKeyName(StorageKey key) {
+  auto& table = getStorageKeyTable();
+  std::lock_guard<std::mutex> lock(table.mutex);
+  return table.names[key];
+}
+
+StorageNamespace getStorageKeyNamespace(StorageKey key) {
+  auto& table = getStorageKeyTable();
+  std::lock_guard<std::mutex> lock(table.mutex);
+  return table.namespaces[key];
+}
+
+bmin::String formatStorageNumber(double n) {
+  if (isIntegralInIntRange(n)) {
+    return bmin::toString(static_cast<int>(n));
+  }
+
+  bmin::String result = bmin::toString(n);
+  while (!result.empty() && result[result.size() - 1] == '0') {
+    result.erase(result.size() - 1, 1);
+  }
+  if (!result.empty() && result[result.size() - 1] == '.') {
+    result.erase(result.size() - 1, 1);
+  }
+  return result;
+}
+
+StorageValue storageValueFromText(const bmin::String& text) {
+  StorageValue value;
+  if (text == "true" || text == "false") {
+    value.type = StorageValueType::BOOL;
+    value.boolValue = text == "true";
+    return value;
+  }
+  if (bmin::isDouble(text)) {
+    const double n = bmin::parseDouble(text);
+    // Only canonical texts are unboxed, so "05" and "5" stay distinct.
+    if (formatStorageNumber(n) == text) {
+      if (isIntegralInIntRange(n)) {
+        value.type = StorageValueType::INT;
+        value.intValue = static_cast<int>(n);
+      } else {
+        value.type = StorageValueType::DOUBLE;
+        value.doubleValue = n;
+      }
+      return value;
+    }
+  }
+  value.stringValue = text;
+  return value;
+}
+
+StorageValue storageValueFromNumber(double n) {
+  if (isIntegralInIntRange(n)) {
+    StorageValue value;
+    value.type = StorageValueType::INT;
+    value.intValue = static_cast<int>(n);
+    return value;
+  }
+  return storageValueFromText(formatStorageNumber(n));
+}
+
+StorageValue storageValueFromBool(bool b) {
+  StorageValue value;
+  value.type = StorageValueType::BOOL;
+  value.boolValue = b;
+  return value;
+}
+
+bmin::String storageValueToText(const StorageValue& value) {
+  switch (value.type) {
+  case StorageValueType::BOOL:
+    return value.boolValue ? "true" : "false";
+  case StorageValueType::INT:
+    return bmin::toString(value.intValue);
+  case StorageValueType::DOUBLE:
+    return formatStorageNumber(value.doubleValue);
+  case StorageValueType::STRING:
+    break;
+  }
+  return value.stringValue;
+}
+
+std::optional<double> storageValueToNumber(const StorageValue& value) {
+  switch (value.type) {
+  case StorageValueType::BOOL:
+    return std::nullopt;
+  case StorageValueType::INT:
+    return static_cast<double>(value.intValue);
+  case StorageValueType::DOUBLE:
+    return value.doubleValue;
+  case StorageValueType::STRING:
+    break;
+  }
+  if (bmin::isDouble(value.stringValue)) {
+    return bmin::parseDouble(value.stringValue);
+  }
+  return std::nullopt;
+}
+
+bool storageValueIsSet(const StorageValue& value) {
+  switch (value.type) {
+  case StorageValueType::BOOL:
+    return value.boolValue;
+  case StorageValueType::INT:
+    return value.intValue != 0;
+  case StorageValueType::DOUBLE:
+    return true;
+  case StorageValueType::STRING:
+    break;
+  }
+  return !value.stringValue.empty() && value.stringValue != "0" &&
+         value.stringValue != "false";
+}
+
+bool operator==(const StorageValue& a, const StorageValue& b) {
+  if (a.type != b.type) {
+    return false;
+  }
+  switch (a.type) {
+  case StorageValueType::BOOL:
+    return a.boolValue == b.boolValue;
+  case StorageValueType::INT:
+    return a.intValue == b.intValue;
+  case StorageValueType::DOUBLE:
+    return a.doubleValue == b.doubleValue;
+  case StorageValueType::STRING:
+    break;
+  }
+  return a.stringValue == b.stringValue;
+}
+
+const StorageValue* eventStorageGet(const EventStorage& storage, StorageKey key) {
+  if (key >= storage.slots.size() || storage.slots[key] == NO_STORAGE_KEY) {
+    return nullptr;
+  }
+  const uint32_t slot = storage.slots[key];
+  return &storage.entries[slotNamespace(slot)][slotIndex(slot)].value;
+}
+
+const StorageValue* eventStorageGet(const EventStorage& storage,
+                                    const bmin::String& name) {
+  const StorageKey key = findStorageKey(name);
+  return key == NO_STORAGE_KEY ? nullptr : eventStorageGet(storage, key);
+}
+
+void eventStorageSet(EventStorage& storage, StorageKey key, const StorageValue& value) {
+  if (key >= storage.slots.size()) {
+    storage.slots.resize(key + 1, NO_STORAGE_KEY);
+  }
+  const uint32_t slot = storage.slots[key];
+  if (slot != NO_STORAGE_KEY) {
+    storage.entries[slotNamespace(slot)][slotIndex(slot)].value = value;
+    return;
+  }
+  const StorageNamespace ns = getStorageKeyNamespace(key);
+  auto& entries = storage.entries[static_cast<int>(ns)];
+  storage.slots[key] = makeSlot(static_cast<uint32_t>(entries.size()), ns);
+  entries.pushBack(StorageEntry{key, value});
+}
+
+void eventStorageSet(EventStorage& storage,
+                     const bmin::String& name,
+                     const bmin::String& text) {
+  eventStorageSet(storage, internStorageKey(name), storageValueFromText(text));
+}
+
+bool eventStorageContains(const EventStorage& storage, const bmin::String& name) {
+  return eventStorageGet(storage, name) != nullptr;
+}
+
+bool eventStorageErase(EventStorage& storage, StorageKey key) {
+  if (key >= storage.slots.size() || storage.slots[key] == NO_STORAGE_KEY) {
+    return false;
+  }
+  const uint32_t slot = storage.slots[key];
+  auto& entries = storage.entries[slotNamespace(slot)];
+  const uint32_t index = slotIndex(slot);
+  if (index + 1 < entries.size()) {
+    entries[index] = std::move(entries[entries.size() - 1]);
+    storage.slots[entries[index].key] = slot;
+  }
+  entries.popBack();
+  storage.slots[key] = NO_STORAGE_KEY;
+  return true;
+}
+
+void eventStorageClearNamespace(EventStorage& storage, StorageNamespace ns) {
+  auto& entries = storage.entries[static_cast<int>(ns)];
+  for (const auto& entry : entries) {
+    storage.slots[entry.key] = NO_STORAGE_KEY;
+  }
+  entries.clear();
+}
+
+void eventStorageClear(EventStorage& storage) {
+  for (auto& entries : storage.entries) {
+    entries.clear();
+  }
+  storage.slots.clear();
+}
+
+size_t eventStorageSize(const EventStorage& storage) {
+  size_t size = 0;
+  for (const auto& entries : storage.entries) {
+    size += entries.size();
+  }
+  return size;
+}
+
+bmin::DynArray<const StorageEntry*>
+eventStorageSortedEntries(const EventStorage& storage) {
+  bmin::DynArray<const StorageEntry*> sorted;
+  sorted.reserve(eventStorageSize(storage));
+  for (const auto& entries : storage.entries) {
+    for (const auto& entry : entries) {
+      sorted.pushBack(&entry);
+    }
+  }
+  std::sort(sorted.begin(), sorted.end(), [](const auto* a, const auto* b) {
+    return getStorageKeyName(a->key) < getStorageKeyName(b->key);
+  });
+  return sorted;
+}
+
+} // namespace model
@@ -0,0 +1,101 @@
+#pragma once
+
+#include "bmin/DynArray.h"
+#include "bmin/String.h"
+#include <cstdint>
+#include <optional>
+
+namespace model {
+
+// Special-event storage keys are interned once ("vars.quests.lark.started" -> id) in a
+// process-wide table, so compiled scripts and storages can address them by index.
+using StorageKey = uint32_t;
+constexpr StorageKey NO_STORAGE_KEY = UINT32_MAX;
+
+// Top-level key segment. Each namespace is indexed separately so that e.g. every tmp.*
+// key can be dropped without visiting the rest.
+enum class StorageNamespace : uint8_t {
+  VARS,
+  ONCE,
+  TMP,
+  OTHER,
+};
+constexpr int STORAGE_NAMESPACE_COUNT = 4;
+constexpr int STORAGE_NAMESPACE_BITS = 2;
+
+// The namespace a key name belongs to, from its first segment.
+StorageNamespace getStorageNamespace(const bmin::String& name);
+
+// Thread-safe; ids and names stay valid for the life of the process.
+StorageKey internStorageKey(const bmin::String& name);
+// NO_STORAGE_KEY when name was never interned (so no storage can hold it).
+StorageKey findStorageKey(const bmin::String& name);
+const bmin::String& getStorageKeyName(StorageKey key);
+StorageNamespace getStorageKeyNamespace(StorageKey key);
+
+enum class StorageValueType : uint8_t {
+  BOOL,
+  INT,
+  DOUBLE,
+  STRING,
+};
+
+// A storage value, kept unboxed when its text is the canonical form of a bool or
+// number. Texts map to values one to one, so comparing values compares texts.
+struct StorageValue {
+  StorageValueType type = StorageValueType::STRING;
+  bool boolValue = false;
+  int intValue = 0;
+  double doubleValue = 0.0;
+  bmin::String stringValue;
+};
+
+// Integer text when there is no fractional part, otherwise trailing zeros trimmed.
+bmin::String formatStorageNumber(double n);
+
+// "true"/"false" -> BOOL; text formatStorageNumber would produce -> INT or DOUBLE;
+// anything else (including "05" or "1e3") stays a STRING.
+StorageValue storageValueFromText(const bmin::String& text);
+// Same value storageValueFromText(formatStorageNumber(n)) gives; integers skip the text.
+StorageValue storageValueFromNumber(double n);
+StorageValue storageValueFromBool(bool b);
+bmin::String storageValueToText(const StorageValue& value);
+// Numbers directly; strings only when they parse as a double.
+std::optional<double> storageValueToNumber(const StorageValue& value);
+// False for "", "0" and "false".
+bool storageValueIsSet(const StorageValue& value);
+bool operator==(const StorageValue& a, const StorageValue& b);
+
+struct StorageEntry {
+  StorageKey key;
+  StorageValue value;
+};
+
+// Flat key/value storage for dialogue scripts (State::specialEventStorage and each
+// runner's working copy).
+struct EventStorage {
+  // Entries grouped by the namespace of their key, in insertion order (erasing swaps
+  // the last entry of that namespace into the hole).
+  bmin::DynArray<StorageEntry> entries[STORAGE_NAMESPACE_COUNT];
+  // Indexed by StorageKey: (position in its namespace's entries << 2 | namespace), or
+  // NO_STORAGE_KEY. Lookups never touch the key table.
+  bmin::DynArray<uint32_t> slots;
+};
+
+const StorageValue* eventStorageGet(const EventStorage& storage, StorageKey key);
+const StorageValue* eventStorageGet(const EventStorage& storage,
+                                    const bmin::String& name);
+void eventStorageSet(EventStorage& storage, StorageKey key, const StorageValue& value);
+void eventStorageSet(EventStorage& storage,
+                     const bmin::String& name,
+                     const bmin::String& text);
+bool eventStorageContains(const EventStorage& storage, const bmin::String& name);
+bool eventStorageErase(EventStorage& storage, StorageKey key);
+void eventStorageClearNamespace(EventStorage& storage, StorageNamespace ns);
+void eventStorageClear(EventStorage& storage);
+size_t eventStorageSize(const EventStorage& storage);
+// Every entry, ordered by key name (for saves and debug output).
+bmin::DynArray<const StorageEntry*>
+eventStorageSortedEntries(const EventStorage& storage);
+
+} // namespace model
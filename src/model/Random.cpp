@@ -0,0 +1,177 @@
+#include "model/Random.h"
+#include <initializer_list>
+
+namespace model {
+
+namespace {
+
+constexpr uint64_t PCG_MULTIPLIER = 6364136223846793005ULL;
+constexpr uint64_t FIXED_DEFAULT_SEED = 0x853c49e6748fea9bULL;
+
+enum RandomStreamId : uint64_t {
+  STREAM_COMBAT = 1,
+  STREAM_LOOT = 2,
+  STREAM_IDS = 3,
+  STREAM_EFFECTS = 4,
+};
+
+uint64_t defaultRandomSeed = FIXED_DEFAULT_SEED;
+thread_local RandomStreams* activeRandomStreams = nullptr;
+
+RandomStreams& getFallbackRandomStreams() {
+  thread_local RandomStreams fallback;
+  return fallback;
+}
+
+void appendHex(bmin::String& out, uint64_t value) {
+  constexpr const char* HEX_DIGITS = "0123456789abcdef";
+  for (int shift = 60; shift >= 0; shift -= 4) {
+    out += HEX_DIGITS[(value >> shift) & 0xF];
+  }
+}
+
+bool parseHex(std::string_view text, size_t& index, uint64_t& out) {
+  while (index < text.size() && text[index] == ' ') {
+    index++;
+  }
+  const size_t start = index;
+  uint64_t value = 0;
+  while (index < text.size() && text[index] != ' ') {
+    const char c = text[index];
+    uint64_t digit = 0;
+    if (c >= '0' && c <= '9') {
+      digit = static_cast<uint64_t>(c - '0');
+    } else if (c >= 'a' && c <= 'f') {
+      digit = static_cast<uint64_t>(c - 'a' + 10);
+    } else {
+      return false;
+    }
+    value = (value << 4) | digit;
+    index++;
+  }
+  if (index == start || index - start > 16) {
+    return false;
+  }
+  out = value;
+  return true;
+}
+
+} // namespace
+
+RandomStreams::RandomStreams() : RandomStreams(getDefaultRandomSeed()) {}
+
+RandomStreams::RandomStreams(uint64_t _seed) { randomStreamsSeed(*this, _seed); }
+
+void randomStreamSeed(RandomStream& stream, uint64_t seed, uint64_t streamId) {
+  stream.state = 0;
+  stream.inc = (streamId << 1u) | 1u;
+  randomNext(stream);
+  stream.state += seed;
+  randomNext(stream);
+}
+
+uint32_t randomNext(RandomStream& stream) {
+  const uint64_t oldState = stream.state;
+  stream.state = oldState * PCG_MULTIPLIER + stream.inc;
+  const auto xorShifted = static_cast<uint32_t>(((oldState >> 18u) ^ oldState) >> 27u);
+  const auto rot = static_cast<uint32_t>(oldState >> 59u);
+  return (xorShifted >> rot) | (xorShifted << ((32u - rot) & 31u));
+}
+
+int randomInt(RandomStream& stream, int bound) {
+  if (bound <= 0) {
+    return 0;
+  }
+  // Lemire's multiply-shift with rejection: unbiased, usually one draw.
+  const auto range = static_cast<uint32_t>(bound);
+  uint64_t product = static_cast<uint64_t>(randomNext(stream)) * range;
+  auto low = static_cast<uint32_t>(product);
+  if (low < range) {
+    const uint32_t threshold = (0u - range) % range;
+    while (low < threshold) {
+      product = static_cast<uint64_t>(randomNext(stream)) * range;
+      low = static_cast<uint32_t>(product);
+    }
+  }
+  return static_cast<int>(product >> 32);
+}
+
+int randomRange(RandomStream& stream, int min, int max) {
+  if (max <= min) {
+    return min;
+  }
+  return min + randomInt(stream, max - min + 1);
+}
+
+bool randomChancePercent(RandomStream& stream, int percent) {
+  return randomInt(stream, 100) < percent;
+}
+
+void randomStreamsSeed(RandomStreams& streams, uint64_t seed) {
+  streams.seed = seed;
+  randomStreamSeed(streams.combat, seed, STREAM_COMBAT);
+  randomStreamSeed(streams.loot, seed, STREAM_LOOT);
+  randomStreamSeed(streams.ids, seed, STREAM_IDS);
+  randomStreamSeed(streams.effects, seed, STREAM_EFFECTS);
+}
+
+uint64_t randomDeriveSeed(uint64_t seed, uint64_t index) {
+  uint64_t z = seed + (index + 1) * 0x9e3779b97f4a7c15ULL;
+  z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+  z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+  return z ^ (z >> 31);
+}
+
+bmin::String randomStreamsSerialize(const RandomStreams& streams) {
+  bmin::String out;
+  appendHex(out, streams.seed);
+  for (const auto* stream :
+       {&streams.combat, &streams.loot, &streams.ids, &streams.effects}) {
+    out += ' ';
+    appendHex(out, stream->state);
+    out += ' ';
+    appendHex(out, stream->inc);
+  }
+  return out;
+}
+
+bool randomStreamsDeserialize(std::string_view text, RandomStreams& streams) {
+  RandomStreams parsed(0);
+  size_t index = 0;
+  if (!parseHex(text, index, parsed.seed)) {
+    return false;
+  }
+  for (auto* stream : {&parsed.combat, &parsed.loot, &parsed.ids, &parsed.effects}) {
+    if (!parseHex(text, index, stream->state) || !parseHex(text, index, stream->inc)) {
+      return false;
+    }
+  }
+  streams = parsed;
+  return true;
+}
+
+void setDefaultRandomSeed(uint64_t seed) { defaultRandomSeed = seed; }
+
+uint64_t getDefaultRandomSeed() { return defaultRandomSeed; }
+
+void setActiveRandomStreams(RandomStreams* streams) { activeRandomStreams = streams; }
+
+RandomStreams& getActiveRandomStreams() {
+  if (activeRandomStreams != nullptr) {
+    return *activeRandomStreams;
+  }
+  return getFallbackRandomStreams();
+}
+
+bool isActiveRandomStreams(const RandomStreams* streams) {
+  return activeRandomStreams == streams;
+}
+
+ScopedActiveRandomStreams::ScopedActiveRandomStreams(RandomStreams* streams)
+    : previous(activeRandomStreams) {
+  activeRandomStreams = streams;
+}
+
+ScopedActiveRandomStreams::~ScopedActiveRandomStreams() { activeRandomStreams = previous; }
+
+} // namespace model
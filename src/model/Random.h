@@ -0,0 +1,69 @@
+#pragma once
+
+#include "bmin/String.h"
+#include <cstdint>
+#include <string_view>
+
+namespace model {
+
+// PCG32 (XSH RR): 64-bit state, 32-bit output, selectable stream via inc.
+struct RandomStream {
+  uint64_t state = 0;
+  uint64_t inc = 1;
+};
+
+// Independent streams so that, e.g., generating more ids never shifts combat rolls.
+// One instance lives on each state::State; copies replay identically.
+struct RandomStreams {
+  uint64_t seed = 0;
+  RandomStream combat;
+  RandomStream loot;
+  RandomStream ids;
+  // Cosmetic choices (blood variants, ...).
+  RandomStream effects;
+
+  RandomStreams();
+  explicit RandomStreams(uint64_t seed);
+};
+
+void randomStreamSeed(RandomStream& stream, uint64_t seed, uint64_t streamId);
+uint32_t randomNext(RandomStream& stream);
+// Uniform in [0, bound); 0 when bound <= 0.
+int randomInt(RandomStream& stream, int bound);
+// Uniform in [min, max].
+int randomRange(RandomStream& stream, int min, int max);
+bool randomChancePercent(RandomStream& stream, int percent);
+
+void randomStreamsSeed(RandomStreams& streams, uint64_t seed);
+// Well-mixed seed for the index-th independent run derived from seed (splitmix64).
+uint64_t randomDeriveSeed(uint64_t seed, uint64_t index);
+// "seed state inc state inc ..." in hex; round-trips through randomStreamsDeserialize.
+bmin::String randomStreamsSerialize(const RandomStreams& streams);
+bool randomStreamsDeserialize(std::string_view text, RandomStreams& streams);
+
+// Seed used by default-constructed RandomStreams (main seeds it from the clock; tests
+// and simulations keep the fixed default or seed explicitly).
+void setDefaultRandomSeed(uint64_t seed);
+uint64_t getDefaultRandomSeed();
+
+// Streams used by code without a State at hand (createRandomId, addTileField). Per
+// thread, so parallel simulations each point at their own State. Falls back to a
+// thread-local instance when nothing is set.
+void setActiveRandomStreams(RandomStreams* streams);
+RandomStreams& getActiveRandomStreams();
+bool isActiveRandomStreams(const RandomStreams* streams);
+
+// Makes streams the active ones for a scope, then restores whatever was active before
+// (a StateManager's State::rng, or nothing) on every exit path, exceptions included.
+class ScopedActiveRandomStreams {
+public:
+  explicit ScopedActiveRandomStreams(RandomStreams* streams);
+  ~ScopedActiveRandomStreams();
+  ScopedActiveRandomStreams(const ScopedActiveRandomStreams&) = delete;
+  ScopedActiveRandomStreams& operator=(const ScopedActiveRandomStreams&) = delete;
+
+private:
+  RandomStreams* previous = nullptr;
+};
+
+} // namespace model
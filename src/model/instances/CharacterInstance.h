@@ -29,8 +29,6 @@ struct CharacterInstance {
   // Combat runtime (meaningful while world.combat.active).
   int currentAp = 0;
   int currentHp = 0; // enemies only; party HP lives on CharacterPlayer
-  // Cached from CharacterTemplate.combat.hp (enemies/NPCs); party HP lives on CharacterPlayer.
-  int maxHp = 0;
   // True once currentHp has been set from combat (distinguishes 0 HP from uninitialized).
   bool hpInitialized = false;
   // Transient pose offset (e.g. weapon swing frame); reset via CharacterSetSpriteIndexOffset.
@@ -40,18 +38,30 @@ struct CharacterInstance {
   // Map AI: set when IMMOBILE_UNTIL_ENEMY_SPOTTED spots the party (not persisted).
   bool agitated = false;
 
-  // Cached from CharacterTemplate at spawn / active-map hoist (for AI without DB lookups).
-  CharacterTemplateType type = CharacterTemplateType::TOWNSPERSON;
-  bmin::String label;
-  bmin::String behaviorName;
-  int visionRadius = 0;
-  CombatBehaviorName combatBehaviorTown = CombatBehaviorName::SEEK_AND_MELEE;
-  CombatBehaviorName combatBehaviorCombat = CombatBehaviorName::SEEK_AND_MELEE;
+  // Shared, immutable template owned by the Database, set at spawn / active-map hoist
+  // by applyCharacterTemplateToInstance (AI reads it without DB lookups). Null for
+  // characters without a template.
+  const CharacterTemplate* characterTemplate = nullptr;
 };
 
 inline bool characterInstanceIsEnemy(const CharacterInstance& character) {
-  return character.type == CharacterTemplateType::ENEMY ||
-         character.type == CharacterTemplateType::ENEMY_STATIC;
+  if (character.characterTemplate == nullptr) {
+    return false;
+  }
+  const auto type = character.characterTemplate->type;
+  return type == CharacterTemplateType::ENEMY ||
+         type == CharacterTemplateType::ENEMY_STATIC;
+}
+
+// Template combat.hp (enemies/NPCs); party HP lives on CharacterPlayer.
+inline int characterInstanceGetMaxHp(const CharacterInstance& character) {
+  return character.characterTemplate ? character.characterTemplate->combat.hp : 0;
+}
+
+inline CombatBehaviorName
+characterInstanceGetCombatBehavior(const CharacterInstance& character) {
+  return character.characterTemplate ? character.characterTemplate->combatBehavior.combat
+                                     : CombatBehaviorName::SEEK_AND_MELEE;
 }
 
 inline void updateCharacterFacingFromMove(CharacterInstance& character, int dx, int dy) {
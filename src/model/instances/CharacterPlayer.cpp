@@ -107,9 +107,16 @@ EquipItemResult equipSingleSlot(CharacterPlayerEquipment& equipment,
 
 } // namespace
 
+const CharacterTemplate&
+characterPlayerGetParams(const CharacterPlayer& characterPlayer) {
+  static const CharacterTemplate emptyTemplate{};
+  return characterPlayer.params != nullptr ? *characterPlayer.params : emptyTemplate;
+}
+
 bmin::String characterPlayerGetSpriteAtIndexOffset(const CharacterPlayer& characterPlayer,
                                                      int indexOffset) {
-  return characterGetSpriteAtIndexOffset(characterPlayer.params, indexOffset);
+  return characterGetSpriteAtIndexOffset(characterPlayerGetParams(characterPlayer),
+                                         indexOffset);
 }
 
 bmin::String characterPlayerGetSprite(const CharacterPlayer& characterPlayer) {
@@ -39,24 +39,36 @@ struct CharacterPlayer {
   bmin::String templateName;
   bmin::DynArray<CharacterInventoryItem> inventory;
   CharacterPlayerEquipment equipment;
-  CharacterTemplate params;
+  // Shared, immutable template owned by the Database (null for a blank character);
+  // read it through characterPlayerGetParams. Per-character state (stats, HP, gear)
+  // is copied out of it on construction.
+  const CharacterTemplate* params = nullptr;
   CharacterStats stats;
   int currentHp = 0;
   int currentMp = 0;
 
-  CharacterPlayer(const CharacterTemplate& _params = CharacterTemplate(),
+  CharacterPlayer() { instanceId = createRandomId(); }
+  CharacterPlayer(const CharacterTemplate& _params,
                   const bmin::DynArray<CharacterInventoryItem>& _inventory = {},
                   const CharacterPlayerEquipment& _equipment = {}) {
     instanceId = createRandomId();
-    params = _params;
+    params = &_params;
     initCharacterStatsFromTemplate(stats, _params);
     currentHp = _params.combat.hp;
     currentMp = _params.combat.mp;
     inventory = _inventory;
     equipment = _equipment;
   }
+  // params must outlive the character; a temporary template would dangle.
+  CharacterPlayer(CharacterTemplate&&,
+                  const bmin::DynArray<CharacterInventoryItem>& = {},
+                  const CharacterPlayerEquipment& = {}) = delete;
 };
 
+// The character's template, or an empty one when it has none.
+const CharacterTemplate&
+characterPlayerGetParams(const CharacterPlayer& characterPlayer);
+
 bmin::String characterPlayerGetSprite(const CharacterPlayer& characterPlayer);
 bmin::String characterPlayerGetSpriteAtIndexOffset(const CharacterPlayer& characterPlayer,
                                                    int indexOffset);
@@ -0,0 +1,42 @@
+#include "model/instances/World.h"
+
+namespace model {
+
+DamageParticle& spawnDamageParticle(ActiveMap& activeMap, DamageParticle particle) {
+  auto& particles = activeMap.damageParticles;
+  particle.id = activeMap.nextDamageParticleId++;
+  if (particles.size() < DAMAGE_PARTICLE_CAPACITY) {
+    if (particles.empty()) {
+      // One allocation for the whole burst instead of growth mid-AoE.
+      particles.reserve(DAMAGE_PARTICLE_CAPACITY);
+    }
+    particles.pushBack(std::move(particle));
+    return particles.back();
+  }
+
+  // Pool is full (large AoE): the particle furthest through its lifetime is the
+  // least noticeable one to drop.
+  size_t oldestIndex = 0;
+  for (size_t i = 1; i < particles.size(); i++) {
+    if (timerStructGetPct(particles[i].lifetime) >
+        timerStructGetPct(particles[oldestIndex].lifetime)) {
+      oldestIndex = i;
+    }
+  }
+  particles[oldestIndex] = std::move(particle);
+  return particles[oldestIndex];
+}
+
+void removeDamageParticleAt(ActiveMap& activeMap, size_t index) {
+  auto& particles = activeMap.damageParticles;
+  if (index >= particles.size()) {
+    return;
+  }
+  const auto lastIndex = particles.size() - 1;
+  if (index != lastIndex) {
+    particles[index] = std::move(particles[lastIndex]);
+  }
+  particles.erase(lastIndex);
+}
+
+} // namespace model
@@ -5,6 +5,8 @@
 #include "model/Combat.h"
 #include "model/instances/MapInstance.h"
 #include "model/templates/UtilityTypes.h"
+#include <cstddef>
+#include <cstdint>
 #include <optional>
 
 namespace model {
@@ -13,8 +15,13 @@ enum class CameraMode { Follow, Aiming, Dragging, Controlled };
 
 enum class WorldActionMode { NONE, EXAMINE, TALK };
 
+// Upper bound on live damage particles; a full pool recycles the oldest particle.
+constexpr size_t DAMAGE_PARTICLE_CAPACITY = 64;
+
 // Map-space hit feedback: splash animation plus a numeric label (not UI floating text).
 struct DamageParticle {
+  // Stable across swap-removes so renderers can keep per-particle state.
+  uint32_t id = 0;
   bmin::String animationName;
   int tileX = 0;
   int tileY = 0;
@@ -38,7 +45,10 @@ struct ActiveMap {
   bmin::DynArray<CharacterInstance> characters;
   bmin::DynArray<ItemInstance> items;
   // bmin::DynArray<TileField> fields;
+  // Unordered, at most DAMAGE_PARTICLE_CAPACITY entries. Use spawnDamageParticle /
+  // removeDamageParticleAt so removal stays a swap with the last slot.
   bmin::DynArray<DamageParticle> damageParticles;
+  uint32_t nextDamageParticleId = 1;
 };
 
 struct World {
@@ -56,4 +66,10 @@ struct World {
   Combat combat;
 };
 
+// Assigns the particle an id and stores it, recycling the oldest particle when the
+// pool is full. Returns the stored particle.
+DamageParticle& spawnDamageParticle(ActiveMap& activeMap, DamageParticle particle);
+// O(1) removal: the last particle is moved into index.
+void removeDamageParticleAt(ActiveMap& activeMap, size_t index);
+
 } // namespace model
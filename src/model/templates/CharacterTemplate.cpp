@@ -41,13 +41,7 @@ bmin::String characterGetSprite(const CharacterTemplate& characterTemplate) {
 
 void applyCharacterTemplateToInstance(CharacterInstance& character,
                                       const CharacterTemplate& characterTemplate) {
-  character.type = characterTemplate.type;
-  character.label = characterTemplate.label;
-  character.behaviorName = characterTemplate.behavior.behaviorName;
-  character.visionRadius = characterTemplate.vision.radius;
-  character.combatBehaviorTown = characterTemplate.combatBehavior.town;
-  character.combatBehaviorCombat = characterTemplate.combatBehavior.combat;
-  character.maxHp = characterTemplate.combat.hp;
+  character.characterTemplate = &characterTemplate;
   if (character.name.empty()) {
     character.name = characterTemplate.label.empty() ? characterTemplate.name
                                                      : characterTemplate.label;
@@ -85,7 +85,7 @@ bmin::String characterGetSprite(const CharacterTemplate& character);
 bmin::String characterGetSpriteAtIndexOffset(const CharacterTemplate& characterTemplate,
                                              int indexOffset);
 
-/** Copy AI/faction fields from template onto a map character instance. */
+/** Point a map character instance at its (Database-owned) template. */
 void applyCharacterTemplateToInstance(CharacterInstance& character,
                                       const CharacterTemplate& characterTemplate);
 
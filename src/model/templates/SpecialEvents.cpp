@@ -0,0 +1,52 @@
+#include "model/templates/SpecialEvents.h"
+
+#include <algorithm>
+
+namespace model {
+
+const bmin::String& getGameEventChildId(const GameEventChild& child) {
+  return std::visit([](const auto& node) -> const bmin::String& { return node.id; },
+                    child);
+}
+
+void indexGameEventChildren(GameEvent& gameEvent) {
+  gameEvent.childIndex.clear();
+  gameEvent.childIndex.reserve(gameEvent.children.size());
+  for (size_t i = 0; i < gameEvent.children.size(); i++) {
+    gameEvent.childIndex.pushBack(
+        {getGameEventChildId(gameEvent.children[i]), static_cast<int>(i)});
+  }
+  // Stable so that duplicate ids resolve to the first authored child, as a scan would.
+  std::stable_sort(
+      gameEvent.childIndex.begin(),
+      gameEvent.childIndex.end(),
+      [](const GameEventChildIndexEntry& a, const GameEventChildIndexEntry& b) {
+        return a.id < b.id;
+      });
+}
+
+const GameEventChild* findGameEventChild(const GameEvent& gameEvent,
+                                         const bmin::String& childId) {
+  if (gameEvent.childIndex.size() != gameEvent.children.size()) {
+    for (const auto& child : gameEvent.children) {
+      if (getGameEventChildId(child) == childId) {
+        return &child;
+      }
+    }
+    return nullptr;
+  }
+
+  const auto it = std::lower_bound(
+      gameEvent.childIndex.begin(),
+      gameEvent.childIndex.end(),
+      childId,
+      [](const GameEventChildIndexEntry& entry, const bmin::String& id) {
+        return entry.id < id;
+      });
+  if (it == gameEvent.childIndex.end() || it->id != childId) {
+    return nullptr;
+  }
+  return &gameEvent.children[it->childIndex];
+}
+
+} // namespace model
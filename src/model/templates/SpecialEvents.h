@@ -1,8 +1,10 @@
 #pragma once
 
+#include <cstdint>
 #include <optional>
 #include "bmin/DynArray.h"
 #include "bmin/String.h"
+#include "model/EventStorage.h"
 #include <variant>
 
 namespace model {
@@ -26,6 +28,24 @@ using GameEventChild = std::variant<GameEventChildChoice,
                                     GameEventChildExec,
                                     GameEventChildEnd>;
 
+// Authored text with @variables split out at load (see runner/ScriptCompiler.h).
+struct TextSegment {
+  bmin::String literal;
+  int variableIndex = -1; // into GameEvent::variableValues; -1 for literal text
+};
+
+struct TextTemplate {
+  bmin::DynArray<TextSegment> segments;
+  // False for events that were never compiled; the runner then replaces variables in
+  // the source text instead.
+  bool compiled = false;
+};
+
+struct GameEventChildIndexEntry {
+  bmin::String id;
+  int childIndex;
+};
+
 struct GameEvent {
   bmin::String id;
   bmin::String title;
@@ -34,6 +54,10 @@ struct GameEvent {
   // a mapping from variable name to its original text and it's evaluated value
   bmin::DynArray<Variable> vars;
   bmin::DynArray<GameEventChild> children;
+  // children sorted by id, built once by indexGameEventChildren (at load)
+  bmin::DynArray<GameEventChildIndexEntry> childIndex;
+  // values of vars with imports flattened in, indexed by TextSegment::variableIndex
+  bmin::DynArray<bmin::String> variableValues;
 };
 
 struct Variable {
@@ -96,9 +120,77 @@ struct AudioInfo {
 //   std::map<bmin::String, KeywordData> keywords;
 // };
 
+// Opcodes for compiled conditionStr/execStr/evalStr (see runner/ScriptCompiler.h).
+enum class ScriptOp : uint8_t {
+  PUSH, // push constants[operand]
+  FAIL, // error found at compile time; raised with constants[operand].text when reached
+  // conditions: pop argCount values, push the FALSE/TRUE constant
+  IS,
+  ISNOT,
+  EQ,
+  NEQ,
+  GT,
+  GTE,
+  LT,
+  LTE,
+  ALL,
+  ANY,
+  ONCE,               // operand: "once.<name>" key
+  HAS_ITEM,           // operand: "vars.items.<name>" key
+  QUEST_IS_STARTED,   // operand: "vars.quests.<name>.started" key
+  QUEST_IS_COMPLETE,  // operand: "vars.quests.<name>.completed" key
+  QUEST_STEP_EQ,      // operand: "vars.quests.<name>.step" key, pops the step
+  // exec statements: pop argCount values
+  GET,
+  STORE, // SET_BOOL/SET_NUM/SET_STR with the stored value formatted at compile time
+  MOD_NUM,
+  SETUP_DISPOSITION,
+  START_QUEST,
+  COMPLETE_QUEST_STEP,
+  COMPLETE_QUEST,
+  SPAWN_CH,
+  DESPAWN_CH,
+  CHANGE_TILE_AT,
+  TELEPORT_TO,
+  ADD_ITEM_AT,
+  REMOVE_ITEM_AT,
+};
+
+// A literal argument; when it names a storage key, its text is that key.
+struct ScriptConstant {
+  bmin::String text;
+  bool isNumber = false; // text parses as a double
+  double number = 0.0;
+  // text interned as a storage key when the operand names one (a key argument, or a
+  // non-number in vars/once/tmp), and text as the value it would be stored as.
+  StorageKey key = NO_STORAGE_KEY;
+  StorageValue value;
+};
+
+struct ScriptInstruction {
+  ScriptOp op;
+  uint8_t argCount;
+  uint16_t operand;
+};
+
+struct ScriptProgram {
+  // Constants 0 and 1 are always "false" and "true" (condition results).
+  static constexpr uint16_t FALSE_CONSTANT = 0;
+  static constexpr uint16_t TRUE_CONSTANT = 1;
+
+  bmin::DynArray<ScriptInstruction> code;
+  bmin::DynArray<ScriptConstant> constants;
+  int maxStack = 0;
+  // False for events that were never compiled (built by hand); the runner then
+  // evaluates the source string instead.
+  bool compiled = false;
+};
+
 struct ChoiceSwitchText {
   bmin::String conditionStr;
   bmin::String text;
+  ScriptProgram condition;
+  TextTemplate textTemplate;
 };
 
 struct Choice {
@@ -108,6 +200,10 @@ struct Choice {
   bmin::String conditionStr;
   bmin::String evalStr;
   bmin::String next;
+  ScriptProgram condition;
+  ScriptProgram eval;
+  TextTemplate textTemplate;
+  TextTemplate prefixTemplate;
 };
 
 
@@ -118,11 +214,13 @@ struct GameEventChildChoice {
   bmin::String text;
   bmin::DynArray<Choice> choices;
   std::optional<AudioInfo> audioInfo;
+  TextTemplate textTemplate;
 };
 
 struct SwitchCase {
   bmin::String conditionStr;
   bmin::String next;
+  ScriptProgram condition;
 };
 
 struct GameEventChildSwitch {
@@ -139,6 +237,8 @@ struct GameEventChildExec {
   bmin::String execStr;
   bmin::String next;
   bool autoAdvance;
+  ScriptProgram exec;
+  TextTemplate textTemplate; // paragraphs joined by newlines
   std::optional<AudioInfo> audioInfo;
 };
 
@@ -148,4 +248,13 @@ struct GameEventChildEnd {
   bmin::String next;
 };
 
+const bmin::String& getGameEventChildId(const GameEventChild& child);
+
+// Builds gameEvent.childIndex; call again after editing children.
+void indexGameEventChildren(GameEvent& gameEvent);
+// Binary search over childIndex (linear scan if the event was never indexed).
+// Returns nullptr when no child has this id.
+const GameEventChild* findGameEventChild(const GameEvent& gameEvent,
+                                         const bmin::String& childId);
+
 } // namespace model
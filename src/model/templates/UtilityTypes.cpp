@@ -1,13 +1,12 @@
 #include "model/templates/UtilityTypes.h"
-
-#include <cstdlib>
+#include "model/Random.h"
 
 namespace model {
 
 TimerStruct::TimerStruct(int duration) : duration(duration) {}
 
 bmin::String createRandomId() {
-  return bmin::toString((rand() % 1000000) + (rand() % 1000000) + (rand() % 1000000));
+  return bmin::toString(randomInt(getActiveRandomStreams().ids, 1000000000));
 }
 
 void timerStructStart(TimerStruct& timer, int duration) {
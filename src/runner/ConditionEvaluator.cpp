@@ -1,84 +1,85 @@
 #include "ConditionEvaluator.h"
 #include "EventRunnerHelpers.h"
+#include "ScriptCompiler.h"
 #include <algorithm>
 #include <stdexcept>
 
 namespace runner {
 
-ConditionEvaluatorFuncs::ConditionEvaluatorFuncs(const bmin::Map<bmin::String, bmin::String>& storage)
+ConditionEvaluatorFuncs::ConditionEvaluatorFuncs(const model::EventStorage& storage)
     : storage(storage) {}
 
-std::optional<int> ConditionEvaluatorFuncs::getNumFromStorageOrArgInt(const bmin::String& a) {
-  if (bmin::isInt(a)) {
-    return bmin::parseInt(a);
+const model::StorageValue*
+ConditionEvaluatorFuncs::lookup(const model::ScriptConstant& key) {
+  if (key.key != model::NO_STORAGE_KEY) {
+    return model::eventStorageGet(storage, key.key);
   }
-  auto v = getStorage(storage, a);
-  if (v && bmin::isInt(*v)) {
-    return bmin::parseInt(*v);
-  }
-  return std::nullopt;
+  return model::eventStorageGet(storage, key.text);
 }
 
 std::optional<double>
-ConditionEvaluatorFuncs::getNumFromStorageOrArgDouble(const bmin::String& a) {
-  if (bmin::isDouble(a)) {
-    return bmin::parseDouble(a);
+ConditionEvaluatorFuncs::getNumFromStorageOrArg(const model::ScriptConstant& a) {
+  if (a.isNumber) {
+    return a.number;
   }
-  auto v = getStorage(storage, a);
-  if (v && bmin::isDouble(*v)) {
-    return bmin::parseDouble(*v);
+  const auto* v = lookup(a);
+  if (v) {
+    return model::storageValueToNumber(*v);
   }
   return std::nullopt;
 }
 
-bool ConditionEvaluatorFuncs::isNumber(const bmin::String& a) {
-  return getNumFromStorageOrArgDouble(a).has_value();
+bool ConditionEvaluatorFuncs::isNumber(const model::ScriptConstant& a) {
+  return getNumFromStorageOrArg(a).has_value();
 }
 
-bool ConditionEvaluatorFuncs::IS(const bmin::String& a) {
-  if (a == "true") {
-    return true;
-  }
-  if (a == "false") {
-    return false;
-  }
-  const bmin::String vStr = getStorage(storage, a).value_or("");
-  if (vStr == "0" || vStr == "false" || vStr.empty()) {
-    return false;
+bool ConditionEvaluatorFuncs::isKeySet(const model::ScriptConstant& key) {
+  const auto* v = lookup(key);
+  return v && model::storageValueIsSet(*v);
+}
+
+bool ConditionEvaluatorFuncs::IS(const model::ScriptConstant& a) {
+  if (a.value.type == model::StorageValueType::BOOL) {
+    return a.value.boolValue;
   }
-  return true;
+  return isKeySet(a);
 }
 
-bool ConditionEvaluatorFuncs::ISNOT(const bmin::String& a) { return !IS(a); }
+bool ConditionEvaluatorFuncs::ISNOT(const model::ScriptConstant& a) { return !IS(a); }
 
-bool ConditionEvaluatorFuncs::EQ(const bmin::String& a, const bmin::String& b) {
-  auto aStorage = getStorage(storage, a);
-  auto bStorage = getStorage(storage, b);
+bool ConditionEvaluatorFuncs::EQ(const model::ScriptConstant& a,
+                                 const model::ScriptConstant& b) {
+  const auto* aStorage = lookup(a);
+  const auto* bStorage = lookup(b);
 
   if (aStorage && bStorage) {
     return *aStorage == *bStorage;
   } else if (aStorage && !bStorage) {
     if (isNumber(b)) {
-      return *aStorage == b;
+      return *aStorage == b.value;
     }
     return false;
   } else if (!aStorage && bStorage) {
     if (isNumber(a)) {
-      return a == *bStorage;
+      return a.value == *bStorage;
     }
     return false;
   }
   if (isNumber(a) && isNumber(b)) {
-    return a == b;
+    return a.text == b.text;
   }
   return false;
 }
 
-bool ConditionEvaluatorFuncs::NEQ(const bmin::String& a, const bmin::String& b) { return !EQ(a, b); }
+bool ConditionEvaluatorFuncs::NEQ(const model::ScriptConstant& a,
+                                  const model::ScriptConstant& b) {
+  return !EQ(a, b);
+}
 
-bool ConditionEvaluatorFuncs::GT(const bmin::String& a, const bmin::String& b) {
-  auto num1 = getNumFromStorageOrArgDouble(a);
-  auto num2 = getNumFromStorageOrArgDouble(b);
+bool ConditionEvaluatorFuncs::GT(const model::ScriptConstant& a,
+                                 const model::ScriptConstant& b) {
+  auto num1 = getNumFromStorageOrArg(a);
+  auto num2 = getNumFromStorageOrArg(b);
   if (!num1 || !num2) {
     return false;
   }
@@ -86,198 +87,129 @@ bool ConditionEvaluatorFuncs::GT(const bmin::String& a, const bmin::String& b) {
   return *num1 > *num2;
 }
 
-bool ConditionEvaluatorFuncs::GTE(const bmin::String& a, const bmin::String& b) {
+bool ConditionEvaluatorFuncs::GTE(const model::ScriptConstant& a,
+                                  const model::ScriptConstant& b) {
   return EQ(a, b) || GT(a, b);
 }
 
-bool ConditionEvaluatorFuncs::LT(const bmin::String& a, const bmin::String& b) {
-  auto num1 = getNumFromStorageOrArgDouble(a);
-  auto num2 = getNumFromStorageOrArgDouble(b);
+bool ConditionEvaluatorFuncs::LT(const model::ScriptConstant& a,
+                                 const model::ScriptConstant& b) {
+  auto num1 = getNumFromStorageOrArg(a);
+  auto num2 = getNumFromStorageOrArg(b);
   if (!num1 || !num2) {
     return false;
   }
   return *num1 < *num2;
 }
 
-bool ConditionEvaluatorFuncs::LTE(const bmin::String& a, const bmin::String& b) {
+bool ConditionEvaluatorFuncs::LTE(const model::ScriptConstant& a,
+                                  const model::ScriptConstant& b) {
   return EQ(a, b) || LT(a, b);
 }
 
-bool ConditionEvaluatorFuncs::ALL(const bmin::DynArray<bmin::String>& args) {
-  for (const auto& arg : args) {
-    if (arg == "false") {
-      return false;
-    }
-    if (arg != "true") {
-      throw std::runtime_error(("Invalid argument for ALL: " + arg).cStr());
-    }
-  }
-  return true;
-}
-
-bool ConditionEvaluatorFuncs::ANY(const bmin::DynArray<bmin::String>& args) {
-  for (const auto& arg : args) {
-    if (arg == "true") {
-      return true;
-    }
-    if (arg != "false") {
-      throw std::runtime_error(("Invalid argument for ANY: " + arg).cStr());
-    }
-  }
-  return false;
-}
-
-bool ConditionEvaluatorFuncs::ONCE(const bmin::String& a) {
-  const bmin::String onceKey = "once." + a;
-  auto v = getStorage(storage, onceKey);
-  if (v && *v == "true") {
+bool ConditionEvaluatorFuncs::ONCE(const model::ScriptConstant& onceKey) {
+  const auto* v = lookup(onceKey);
+  if (v && v->type == model::StorageValueType::BOOL && v->boolValue) {
     return false;
   }
-  if (std::find(onceKeysToCommit.begin(), onceKeysToCommit.end(), onceKey) ==
+  if (std::find(onceKeysToCommit.begin(), onceKeysToCommit.end(), onceKey.text) ==
       onceKeysToCommit.end()) {
-    onceKeysToCommit.pushBack(onceKey);
+    onceKeysToCommit.pushBack(onceKey.text);
   }
   return true;
 }
 
-bool ConditionEvaluatorFuncs::FUNC_HasItem(const bmin::String& itemName) {
-  auto v = getStorage(storage, "vars.items." + itemName);
-  return v && !v->empty() && *v != "0" && *v != "false";
-}
-
-bool ConditionEvaluatorFuncs::FUNC_QuestStarted(const bmin::String& questName) {
-  auto v = getStorage(storage, "vars.quests." + questName + ".started");
-  return v && !v->empty() && *v != "0" && *v != "false";
-}
-
-bool ConditionEvaluatorFuncs::FUNC_QuestCompleted(const bmin::String& questName) {
-  auto v = getStorage(storage, "vars.quests." + questName + ".completed");
-  return v && !v->empty() && *v != "0" && *v != "false";
-}
-
-bool ConditionEvaluatorFuncs::FUNC_QuestStepEq(const bmin::String& questName,
-                                               const bmin::String& stepId) {
-  auto v = getStorage(storage, "vars.quests." + questName + ".step");
-  return v && *v == stepId;
+bool ConditionEvaluatorFuncs::QUEST_STEP_EQ(const model::ScriptConstant& stepKey,
+                                            const model::ScriptConstant& stepId) {
+  const auto* v = lookup(stepKey);
+  return v && *v == stepId.value;
 }
 
-ConditionEvaluator::ConditionEvaluator(const bmin::Map<bmin::String, bmin::String>& storage,
+ConditionEvaluator::ConditionEvaluator(const model::EventStorage& storage,
                                        const bmin::String& baseConditionStr)
     : baseConditionStr(baseConditionStr), funcs(storage) {}
 
-void ConditionEvaluator::assertFuncArgs(const bmin::String& funcName,
-                                        const bmin::DynArray<bmin::String>& funcArgs,
-                                        size_t expectedArgs) {
-  if (funcArgs.size() != expectedArgs) {
-    throw std::runtime_error(("Invalid number of arguments for function '" + funcName +
-                              "'. Expected " + bmin::toString(expectedArgs) + ", got " +
-                              bmin::toString(funcArgs.size()))
-                                 .cStr());
-  }
+bool ConditionEvaluator::evalCondition(const bmin::String& str) {
+  bmin::DynArray<bmin::String> compileErrors;
+  const model::ScriptProgram program = compileCondition(str, compileErrors);
+  return evalProgram(program);
 }
 
-bool ConditionEvaluator::evalFunc(const bmin::String& funcName,
-                                  const bmin::DynArray<bmin::String>& funcArgs) {
-  auto simplifyArg = [this](const bmin::String& arg) -> bmin::String {
-    if (isFunctionCall(arg)) {
-      FunctionCall call = parseFunctionCall(arg);
-      const bool result = evalFunc(call.funcName, call.args);
-      return result ? "true" : "false";
-    }
-    return arg;
-  };
+bool ConditionEvaluator::evalProgram(const model::ScriptProgram& program) {
+  using model::ScriptOp;
+  constexpr uint16_t FALSE_CONSTANT = model::ScriptProgram::FALSE_CONSTANT;
+  constexpr uint16_t TRUE_CONSTANT = model::ScriptProgram::TRUE_CONSTANT;
+
+  const auto& constants = program.constants;
+  uint16_t stack[SCRIPT_MAX_STACK];
+  int sp = 0;
 
-  if (funcName == "IS") {
-    assertFuncArgs(funcName, funcArgs, 1);
-    const bmin::String val = simplifyArg(funcArgs[0]);
-    return funcs.IS(val);
-  } else if (funcName == "ISNOT") {
-    assertFuncArgs(funcName, funcArgs, 1);
-    const bmin::String val = simplifyArg(funcArgs[0]);
-    return funcs.ISNOT(val);
-  } else if (funcName == "EQ") {
-    assertFuncArgs(funcName, funcArgs, 2);
-    const bmin::String a = simplifyArg(funcArgs[0]);
-    const bmin::String b = simplifyArg(funcArgs[1]);
-    return funcs.EQ(a, b);
-  } else if (funcName == "NEQ") {
-    assertFuncArgs(funcName, funcArgs, 2);
-    const bmin::String a = simplifyArg(funcArgs[0]);
-    const bmin::String b = simplifyArg(funcArgs[1]);
-    return funcs.NEQ(a, b);
-  } else if (funcName == "GT") {
-    assertFuncArgs(funcName, funcArgs, 2);
-    const bmin::String a = simplifyArg(funcArgs[0]);
-    const bmin::String b = simplifyArg(funcArgs[1]);
-    return funcs.GT(a, b);
-  } else if (funcName == "GTE") {
-    assertFuncArgs(funcName, funcArgs, 2);
-    const bmin::String a = simplifyArg(funcArgs[0]);
-    const bmin::String b = simplifyArg(funcArgs[1]);
-    return funcs.GTE(a, b);
-  } else if (funcName == "LT") {
-    assertFuncArgs(funcName, funcArgs, 2);
-    const bmin::String a = simplifyArg(funcArgs[0]);
-    const bmin::String b = simplifyArg(funcArgs[1]);
-    return funcs.LT(a, b);
-  } else if (funcName == "LTE") {
-    assertFuncArgs(funcName, funcArgs, 2);
-    const bmin::String a = simplifyArg(funcArgs[0]);
-    const bmin::String b = simplifyArg(funcArgs[1]);
-    return funcs.LTE(a, b);
-  } else if (funcName == "ALL") {
-    bmin::DynArray<bmin::String> subArgs;
-    for (const auto& arg : funcArgs) {
-      subArgs.pushBack(simplifyArg(arg));
+  for (const auto& instruction : program.code) {
+    if (instruction.op == ScriptOp::PUSH) {
+      stack[sp++] = instruction.operand;
+      continue;
     }
-    return funcs.ALL(subArgs);
-  } else if (funcName == "ANY") {
-    bmin::DynArray<bmin::String> subArgs;
-    for (const auto& arg : funcArgs) {
-      subArgs.pushBack(simplifyArg(arg));
+    if (instruction.op == ScriptOp::FAIL) {
+      throw std::runtime_error(constants[instruction.operand].text.cStr());
     }
-    return funcs.ANY(subArgs);
-  } else if (funcName == "ONCE") {
-    assertFuncArgs(funcName, funcArgs, 1);
-    const bmin::String a = simplifyArg(funcArgs[0]);
-    return funcs.ONCE(a);
-  } else if (funcName == "HAS_ITEM") {
-    assertFuncArgs(funcName, funcArgs, 1);
-    const bmin::String itemName = simplifyArg(funcArgs[0]);
-    return funcs.FUNC_HasItem(itemName);
-  } else if (funcName == "QUEST_IS_STARTED") {
-    assertFuncArgs(funcName, funcArgs, 1);
-    const bmin::String questName = simplifyArg(funcArgs[0]);
-    return funcs.FUNC_QuestStarted(questName);
-  } else if (funcName == "QUEST_IS_COMPLETE") {
-    assertFuncArgs(funcName, funcArgs, 1);
-    const bmin::String questName = simplifyArg(funcArgs[0]);
-    return funcs.FUNC_QuestCompleted(questName);
-  } else if (funcName == "QUEST_STEP_EQ") {
-    assertFuncArgs(funcName, funcArgs, 2);
-    const bmin::String questName = simplifyArg(funcArgs[0]);
-    const bmin::String stepNum = simplifyArg(funcArgs[1]);
-    return funcs.FUNC_QuestStepEq(questName, stepNum);
-  }
-  throw std::runtime_error(("Conditional function '" + funcName + "' not found.").cStr());
-}
 
-bool ConditionEvaluator::evalCondition(const bmin::String& str) {
-  const bmin::String conditionStr = trim(str);
-  if (conditionStr.empty()) {
-    return true;
-  }
-  if (conditionStr == "true") {
-    return true;
-  }
-  if (conditionStr == "false") {
-    return false;
-  }
-  if (isFunctionCall(conditionStr)) {
-    FunctionCall call = parseFunctionCall(conditionStr);
-    return evalFunc(call.funcName, call.args);
+    sp -= instruction.argCount;
+    const uint16_t* args = &stack[sp];
+    const auto& key = constants[instruction.operand];
+    auto arg = [&](int i) -> const model::ScriptConstant& { return constants[args[i]]; };
+
+    bool result = false;
+    switch (instruction.op) {
+    case ScriptOp::IS:
+      result = funcs.IS(arg(0));
+      break;
+    case ScriptOp::ISNOT:
+      result = funcs.ISNOT(arg(0));
+      break;
+    case ScriptOp::EQ:
+      result = funcs.EQ(arg(0), arg(1));
+      break;
+    case ScriptOp::NEQ:
+      result = funcs.NEQ(arg(0), arg(1));
+      break;
+    case ScriptOp::GT:
+      result = funcs.GT(arg(0), arg(1));
+      break;
+    case ScriptOp::GTE:
+      result = funcs.GTE(arg(0), arg(1));
+      break;
+    case ScriptOp::LT:
+      result = funcs.LT(arg(0), arg(1));
+      break;
+    case ScriptOp::LTE:
+      result = funcs.LTE(arg(0), arg(1));
+      break;
+    case ScriptOp::ALL:
+      // Operands were checked to be true/false at compile time.
+      result = std::find(args, args + instruction.argCount, FALSE_CONSTANT) ==
+               args + instruction.argCount;
+      break;
+    case ScriptOp::ANY:
+      result = std::find(args, args + instruction.argCount, TRUE_CONSTANT) !=
+               args + instruction.argCount;
+      break;
+    case ScriptOp::ONCE:
+      result = funcs.ONCE(key);
+      break;
+    case ScriptOp::HAS_ITEM:
+    case ScriptOp::QUEST_IS_STARTED:
+    case ScriptOp::QUEST_IS_COMPLETE:
+      result = funcs.isKeySet(key);
+      break;
+    case ScriptOp::QUEST_STEP_EQ:
+      result = funcs.QUEST_STEP_EQ(key, arg(0));
+      break;
+    default:
+      throw std::runtime_error("Exec statement in a condition");
+    }
+    stack[sp++] = result ? TRUE_CONSTANT : FALSE_CONSTANT;
   }
-  throw std::runtime_error(("Invalid condition: " + baseConditionStr).cStr());
+  return sp > 0 && stack[sp - 1] == TRUE_CONSTANT;
 }
 
 } // namespace runner
@@ -3,37 +3,37 @@
 #include "bmin/DynArray.h"
 #include "bmin/String.h"
 #include "lib/bmin/Map.h"
+#include "model/templates/SpecialEvents.h"
 
 #include <optional>
 
 namespace runner {
 
+// Condition primitives over compiled constants. A constant's text is either a literal or
+// the storage key it names; keyed functions (ONCE, HAS_ITEM, QUEST_*) get the full key.
+// Stored values are compared unboxed, without formatting or parsing numbers.
 struct ConditionEvaluatorFuncs {
-  const bmin::Map<bmin::String, bmin::String>& storage;
+  const model::EventStorage& storage;
   bmin::DynArray<bmin::String> onceKeysToCommit;
 
-  ConditionEvaluatorFuncs(const bmin::Map<bmin::String, bmin::String>& storage);
-
-  std::optional<int> getNumFromStorageOrArgInt(const bmin::String& a);
-  std::optional<double> getNumFromStorageOrArgDouble(const bmin::String& a);
-  bool isNumber(const bmin::String& a);
-
-  bool IS(const bmin::String& a);
-  bool ISNOT(const bmin::String& a);
-  bool EQ(const bmin::String& a, const bmin::String& b);
-  bool NEQ(const bmin::String& a, const bmin::String& b);
-  bool GT(const bmin::String& a, const bmin::String& b);
-  bool GTE(const bmin::String& a, const bmin::String& b);
-  bool LT(const bmin::String& a, const bmin::String& b);
-  bool LTE(const bmin::String& a, const bmin::String& b);
-  bool ALL(const bmin::DynArray<bmin::String>& args);
-  bool ANY(const bmin::DynArray<bmin::String>& args);
-  bool ONCE(const bmin::String& a);
-
-  bool FUNC_HasItem(const bmin::String& itemName);
-  bool FUNC_QuestStarted(const bmin::String& questName);
-  bool FUNC_QuestCompleted(const bmin::String& questName);
-  bool FUNC_QuestStepEq(const bmin::String& questName, const bmin::String& stepId);
+  ConditionEvaluatorFuncs(const model::EventStorage& storage);
+
+  std::optional<double> getNumFromStorageOrArg(const model::ScriptConstant& a);
+  bool isNumber(const model::ScriptConstant& a);
+  bool isKeySet(const model::ScriptConstant& key);
+  const model::StorageValue* lookup(const model::ScriptConstant& key);
+
+  bool IS(const model::ScriptConstant& a);
+  bool ISNOT(const model::ScriptConstant& a);
+  bool EQ(const model::ScriptConstant& a, const model::ScriptConstant& b);
+  bool NEQ(const model::ScriptConstant& a, const model::ScriptConstant& b);
+  bool GT(const model::ScriptConstant& a, const model::ScriptConstant& b);
+  bool GTE(const model::ScriptConstant& a, const model::ScriptConstant& b);
+  bool LT(const model::ScriptConstant& a, const model::ScriptConstant& b);
+  bool LTE(const model::ScriptConstant& a, const model::ScriptConstant& b);
+  bool ONCE(const model::ScriptConstant& onceKey);
+  bool QUEST_STEP_EQ(const model::ScriptConstant& stepKey,
+                     const model::ScriptConstant& stepId);
 };
 
 class ConditionEvaluator {
@@ -41,14 +41,12 @@ public:
   bmin::String baseConditionStr;
   ConditionEvaluatorFuncs funcs;
 
-  ConditionEvaluator(const bmin::Map<bmin::String, bmin::String>& storage,
-                     const bmin::String& baseConditionStr);
-  void assertFuncArgs(const bmin::String& funcName,
-                      const bmin::DynArray<bmin::String>& funcArgs,
-                      size_t expectedArgs);
-  bool evalFunc(const bmin::String& funcName,
-                const bmin::DynArray<bmin::String>& funcArgs);
+  ConditionEvaluator(const model::EventStorage& storage,
+                     const bmin::String& baseConditionStr = "");
+  // Compiles and runs str; throws on compile or evaluation errors.
   bool evalCondition(const bmin::String& str);
+  // Runs a program from runner/ScriptCompiler.h; throws if it reaches a FAIL.
+  bool evalProgram(const model::ScriptProgram& program);
 };
 
 } // namespace runner
@@ -0,0 +1,262 @@
+#include "EventBundle.h"
+#include "bmin/StringInterop.h"
+#include "game/save/SaveBinary.h"
+#include <optional>
+#include <stdexcept>
+#include <variant>
+
+namespace runner {
+
+namespace {
+
+constexpr uint16_t EVENT_BUNDLE_VERSION = 1;
+constexpr size_t EVENT_BUNDLE_HEADER_SIZE = 4 + 2 + 4 + 4;
+
+struct BundleContext {
+  game::SaveStringTable strings;
+};
+
+void writeChild(game::SaveWriter& out,
+                BundleContext& ctx,
+                const model::GameEventChild& child) {
+  std::visit(
+      [&](const auto& node) {
+        using T = std::decay_t<decltype(node)>;
+        out.writeU8(static_cast<uint8_t>(node.eventChildType));
+        out.writeString(ctx.strings, node.id);
+        if constexpr (std::is_same_v<T, model::GameEventChildExec>) {
+          out.writeVarUint(node.paragraphs.size());
+          for (const auto& paragraph : node.paragraphs) {
+            out.writeString(ctx.strings, paragraph);
+          }
+          out.writeString(ctx.strings, node.execStr);
+          out.writeString(ctx.strings, node.next);
+          out.writeBool(node.autoAdvance);
+          out.writeBool(node.audioInfo.has_value());
+          if (node.audioInfo.has_value()) {
+            out.writeString(ctx.strings, node.audioInfo->audioName);
+            out.writeVarInt(node.audioInfo->volume);
+            out.writeVarInt(node.audioInfo->offset);
+          }
+        } else if constexpr (std::is_same_v<T, model::GameEventChildChoice>) {
+          out.writeString(ctx.strings, node.text);
+          out.writeVarUint(node.choices.size());
+          for (const auto& choice : node.choices) {
+            out.writeString(ctx.strings, choice.text);
+            out.writeString(ctx.strings, choice.prefixText);
+            out.writeString(ctx.strings, choice.conditionStr);
+            out.writeString(ctx.strings, choice.evalStr);
+            out.writeString(ctx.strings, choice.next);
+            out.writeVarUint(choice.switchText.size());
+            for (const auto& switchText : choice.switchText) {
+              out.writeString(ctx.strings, switchText.conditionStr);
+              out.writeString(ctx.strings, switchText.text);
+            }
+          }
+          out.writeBool(node.audioInfo.has_value());
+          if (node.audioInfo.has_value()) {
+            out.writeString(ctx.strings, node.audioInfo->audioName);
+            out.writeVarInt(node.audioInfo->volume);
+            out.writeVarInt(node.audioInfo->offset);
+          }
+        } else if constexpr (std::is_same_v<T, model::GameEventChildSwitch>) {
+          out.writeString(ctx.strings, node.defaultNext);
+          out.writeVarUint(node.cases.size());
+          for (const auto& switchCase : node.cases) {
+            out.writeString(ctx.strings, switchCase.conditionStr);
+            out.writeString(ctx.strings, switchCase.next);
+          }
+        } else if constexpr (std::is_same_v<T, model::GameEventChildEnd>) {
+          out.writeString(ctx.strings, node.next);
+        }
+      },
+      child);
+}
+
+std::optional<model::AudioInfo> readAudioInfo(game::SaveReader& in,
+                                              const BundleContext& ctx) {
+  if (!in.readBool()) {
+    return std::nullopt;
+  }
+  model::AudioInfo audioInfo;
+  audioInfo.audioName = in.readString(ctx.strings);
+  audioInfo.volume = in.readInt();
+  audioInfo.offset = in.readInt();
+  return audioInfo;
+}
+
+model::GameEventChild readChild(game::SaveReader& in, const BundleContext& ctx) {
+  const auto type = static_cast<model::GameEventChildType>(in.readU8());
+  const bmin::String id = in.readString(ctx.strings);
+  switch (type) {
+  case model::GameEventChildType::EXEC: {
+    model::GameEventChildExec node;
+    node.id = id;
+    const int paragraphCount = in.readCount();
+    node.paragraphs.reserve(paragraphCount);
+    for (int i = 0; i < paragraphCount; i++) {
+      node.paragraphs.pushBack(in.readString(ctx.strings));
+    }
+    node.execStr = in.readString(ctx.strings);
+    node.next = in.readString(ctx.strings);
+    node.autoAdvance = in.readBool();
+    node.audioInfo = readAudioInfo(in, ctx);
+    return node;
+  }
+  case model::GameEventChildType::CHOICE: {
+    model::GameEventChildChoice node;
+    node.id = id;
+    node.text = in.readString(ctx.strings);
+    const int choiceCount = in.readCount();
+    node.choices.reserve(choiceCount);
+    for (int i = 0; i < choiceCount; i++) {
+      model::Choice choice;
+      choice.text = in.readString(ctx.strings);
+      choice.prefixText = in.readString(ctx.strings);
+      choice.conditionStr = in.readString(ctx.strings);
+      choice.evalStr = in.readString(ctx.strings);
+      choice.next = in.readString(ctx.strings);
+      const int switchTextCount = in.readCount();
+      for (int j = 0; j < switchTextCount; j++) {
+        model::ChoiceSwitchText switchText;
+        switchText.conditionStr = in.readString(ctx.strings);
+        switchText.text = in.readString(ctx.strings);
+        choice.switchText.pushBack(std::move(switchText));
+      }
+      node.choices.pushBack(std::move(choice));
+    }
+    node.audioInfo = readAudioInfo(in, ctx);
+    return node;
+  }
+  case model::GameEventChildType::SWITCH: {
+    model::GameEventChildSwitch node;
+    node.id = id;
+    node.defaultNext = in.readString(ctx.strings);
+    const int caseCount = in.readCount();
+    node.cases.reserve(caseCount);
+    for (int i = 0; i < caseCount; i++) {
+      model::SwitchCase switchCase;
+      switchCase.conditionStr = in.readString(ctx.strings);
+      switchCase.next = in.readString(ctx.strings);
+      node.cases.pushBack(std::move(switchCase));
+    }
+    return node;
+  }
+  case model::GameEventChildType::END: {
+    model::GameEventChildEnd node;
+    node.id = id;
+    node.next = in.readString(ctx.strings);
+    return node;
+  }
+  case model::GameEventChildType::KEYWORD:
+    break;
+  }
+  throw std::runtime_error(("Invalid event child type in bundle: " + id).cStr());
+}
+
+} // namespace
+
+bmin::DynArray<uint8_t>
+encodeEventBundle(const bmin::DynArray<model::GameEvent>& events) {
+  BundleContext ctx;
+  game::SaveWriter body;
+  body.writeVarUint(events.size());
+  for (const auto& event : events) {
+    body.writeString(ctx.strings, event.id);
+    body.writeString(ctx.strings, event.title);
+    body.writeU8(event.eventType == model::GameEventType::MODAL ? 0 : 1);
+    body.writeString(ctx.strings, event.icon);
+    body.writeVarUint(event.vars.size());
+    for (const auto& var : event.vars) {
+      body.writeString(ctx.strings, var.id);
+      body.writeString(ctx.strings, var.key);
+      body.writeString(ctx.strings, var.value);
+      body.writeString(ctx.strings, var.importFrom);
+    }
+    body.writeVarUint(event.children.size());
+    for (const auto& child : event.children) {
+      writeChild(body, ctx, child);
+    }
+  }
+
+  game::SaveWriter payload;
+  payload.writeVarUint(ctx.strings.size());
+  for (size_t i = 0; i < ctx.strings.size(); i++) {
+    payload.writeRawString(bmin::toStringView(ctx.strings.at(static_cast<uint32_t>(i))));
+  }
+  payload.writeBytes(body.getBytes().data(), body.size());
+
+  const auto& payloadBytes = payload.getBytes();
+  const std::string_view payloadView(reinterpret_cast<const char*>(payloadBytes.data()),
+                                     payloadBytes.size());
+  game::SaveWriter file;
+  file.writeBytes(reinterpret_cast<const uint8_t*>(EVENT_BUNDLE_MAGIC),
+                  sizeof(EVENT_BUNDLE_MAGIC));
+  file.writeU16(EVENT_BUNDLE_VERSION);
+  file.writeU32(static_cast<uint32_t>(payloadBytes.size()));
+  file.writeU32(game::saveChecksum(payloadView));
+  file.writeBytes(payloadBytes.data(), payloadBytes.size());
+  return file.getBytes();
+}
+
+bmin::DynArray<model::GameEvent> decodeEventBundle(std::string_view bytes) {
+  if (bytes.size() < EVENT_BUNDLE_HEADER_SIZE ||
+      bytes.substr(0, sizeof(EVENT_BUNDLE_MAGIC)) !=
+          std::string_view(EVENT_BUNDLE_MAGIC, sizeof(EVENT_BUNDLE_MAGIC))) {
+    throw std::runtime_error("Not a special event bundle");
+  }
+  game::SaveReader header(bytes.substr(sizeof(EVENT_BUNDLE_MAGIC),
+                                       EVENT_BUNDLE_HEADER_SIZE -
+                                           sizeof(EVENT_BUNDLE_MAGIC)));
+  if (header.readU16() > EVENT_BUNDLE_VERSION) {
+    throw std::runtime_error("Special event bundle is newer than this build");
+  }
+  const uint32_t payloadSize = header.readU32();
+  const uint32_t checksum = header.readU32();
+  const auto payload = bytes.substr(EVENT_BUNDLE_HEADER_SIZE);
+  if (payload.size() != payloadSize || game::saveChecksum(payload) != checksum) {
+    throw std::runtime_error("Special event bundle is truncated or corrupt");
+  }
+
+  game::SaveReader in(payload);
+  BundleContext ctx;
+  const int stringCount = in.readCount();
+  for (int i = 0; i < stringCount; i++) {
+    const auto text = in.readRawString();
+    ctx.strings.append(bmin::String(text.data(), text.size()));
+  }
+
+  bmin::DynArray<model::GameEvent> events;
+  const int eventCount = in.readCount();
+  events.reserve(eventCount);
+  for (int i = 0; i < eventCount; i++) {
+    model::GameEvent event;
+    event.id = in.readString(ctx.strings);
+    event.title = in.readString(ctx.strings);
+    event.eventType =
+        in.readU8() == 0 ? model::GameEventType::MODAL : model::GameEventType::TALK;
+    event.icon = in.readString(ctx.strings);
+    const int varCount = in.readCount();
+    event.vars.reserve(varCount);
+    for (int j = 0; j < varCount; j++) {
+      model::Variable var;
+      var.id = in.readString(ctx.strings);
+      var.key = in.readString(ctx.strings);
+      var.value = in.readString(ctx.strings);
+      var.importFrom = in.readString(ctx.strings);
+      event.vars.pushBack(std::move(var));
+    }
+    const int childCount = in.readCount();
+    event.children.reserve(childCount);
+    for (int j = 0; j < childCount; j++) {
+      event.children.pushBack(readChild(in, ctx));
+    }
+    events.pushBack(std::move(event));
+  }
+  if (!in.atEnd()) {
+    throw std::runtime_error("Special event bundle has trailing data");
+  }
+  return events;
+}
+
+} // namespace runner
@@ -0,0 +1,24 @@
+#pragma once
+
+#include "bmin/DynArray.h"
+#include "model/templates/SpecialEvents.h"
+#include <cstdint>
+#include <string_view>
+
+namespace runner {
+
+// Binary form of a list of special events, written by the se compiler tool and read
+// by db::loadSpecialEvents for files ending in EVENT_BUNDLE_EXTENSION. Layout:
+// magic, u16 version, u32 payload size, u32 checksum, then the payload (string table
+// followed by the events). Only authored fields are stored; loaders index and compile
+// the events exactly as they do after reading JSON.
+inline constexpr char EVENT_BUNDLE_MAGIC[4] = {'C', 'S', 'E', 'B'};
+inline constexpr char EVENT_BUNDLE_EXTENSION[] = ".seb";
+
+bmin::DynArray<uint8_t> encodeEventBundle(const bmin::DynArray<model::GameEvent>& events);
+
+// Throws std::runtime_error for data that is not a bundle, is truncated or corrupt, or
+// was written by a newer build.
+bmin::DynArray<model::GameEvent> decodeEventBundle(std::string_view bytes);
+
+} // namespace runner
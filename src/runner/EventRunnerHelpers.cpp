@@ -1,33 +1,35 @@
 #include "EventRunnerHelpers.h"
 #include "lib/StringUtil.h"
+#include <algorithm>
 
 namespace runner {
 
-// Helper functions for storage (flat map, no nesting)
-void setStorage(bmin::Map<bmin::String, bmin::String>& storage, const bmin::String& key,
+static bmin::String replaceAll(bmin::String str, const bmin::String& from, const bmin::String& to) {
+  size_t pos = 0;
+  while ((pos = str.find(from, pos)) != bmin::String::npos) {
+    str.erase(pos, from.size());
+    str.insert(pos, to);
+    pos += to.size();
+  }
+  return str;
+}
+
+void setStorage(model::EventStorage& storage, const bmin::String& key,
                 const bmin::String& value) {
-  storage[key] = value;
+  model::eventStorageSet(storage, key, value);
 }
 
-std::optional<bmin::String> getStorage(const bmin::Map<bmin::String, bmin::String>& storage,
-                                 const bmin::String& key) {
-  auto it = const_cast<bmin::Map<bmin::String, bmin::String>&>(storage).find(key);
-  if (it != storage.end()) {
-    return it->value;
+std::optional<bmin::String> getStorage(const model::EventStorage& storage,
+                                       const bmin::String& key) {
+  const auto* value = model::eventStorageGet(storage, key);
+  if (value) {
+    return model::storageValueToText(*value);
   }
   return std::nullopt;
 }
 
-void clearTmpStorageKeys(bmin::Map<bmin::String, bmin::String>& storage) {
-  bmin::DynArray<bmin::String> keysToErase;
-  for (auto it = storage.begin(); it != storage.end(); ++it) {
-    if (it->key.startsWith("tmp.")) {
-      keysToErase.pushBack(it->key);
-    }
-  }
-  for (const auto& key : keysToErase) {
-    storage.erase(key);
-  }
+void clearTmpStorageKeys(model::EventStorage& storage) {
+  model::eventStorageClearNamespace(storage, model::StorageNamespace::TMP);
 }
 
 // Helper to trim whitespace
@@ -127,4 +129,73 @@ bool isFunctionCall(const bmin::String& str) {
   return str.find("(") != bmin::String::npos && str.find(")") != bmin::String::npos;
 }
 
+static void
+collectVariablesFrom(const model::GameEvent& event,
+                     const bmin::Map<bmin::String, model::GameEvent>& gameEvents,
+                     bmin::DynArray<bmin::String>& usedEvents,
+                     bmin::DynArray<model::Variable>& vars) {
+  if (std::find(usedEvents.begin(), usedEvents.end(), event.id) != usedEvents.end()) {
+    return;
+  }
+  usedEvents.pushBack(event.id);
+
+  for (const auto& variable : event.vars) {
+    if (variable.importFrom.empty()) {
+      vars.pushBack(variable);
+    }
+  }
+
+  auto& events = const_cast<bmin::Map<bmin::String, model::GameEvent>&>(gameEvents);
+  for (const auto& variable : event.vars) {
+    if (!variable.importFrom.empty()) {
+      auto it = events.find(variable.importFrom);
+      if (it != events.end()) {
+        collectVariablesFrom((*it).value, gameEvents, usedEvents, vars);
+      }
+    }
+  }
+}
+
+bmin::DynArray<model::Variable>
+collectGameEventVariables(const model::GameEvent& gameEvent,
+                          const bmin::Map<bmin::String, model::GameEvent>& gameEvents) {
+  bmin::DynArray<model::Variable> vars;
+  bmin::DynArray<bmin::String> usedEvents;
+  collectVariablesFrom(gameEvent, gameEvents, usedEvents, vars);
+  return vars;
+}
+
+void appendTextTemplate(bmin::String& out,
+                        const model::TextTemplate& text,
+                        const model::GameEvent& gameEvent) {
+  for (const auto& segment : text.segments) {
+    if (segment.variableIndex < 0) {
+      out += segment.literal;
+    } else {
+      out += gameEvent.variableValues[segment.variableIndex];
+    }
+  }
+}
+
+bmin::String joinParagraphs(const bmin::DynArray<bmin::String>& paragraphs) {
+  bmin::String result;
+  for (size_t i = 0; i < paragraphs.size(); ++i) {
+    if (i > 0) {
+      result += "\n";
+    }
+    result += paragraphs[i];
+  }
+  return result;
+}
+
+bmin::String applyVariables(const bmin::String& text,
+                            const bmin::DynArray<model::Variable>& vars) {
+  bmin::String result = trim(text);
+  for (const auto& variable : vars) {
+    const bmin::String placeholder = "@" + variable.key;
+    result = replaceAll(result, placeholder, variable.value);
+  }
+  return result;
+}
+
 } // namespace runner
@@ -3,20 +3,23 @@
 #include "bmin/DynArray.h"
 #include "bmin/String.h"
 #include "lib/bmin/Map.h"
+#include "model/EventStorage.h"
+#include "model/templates/SpecialEvents.h"
 
 #include <optional>
 
 namespace runner {
 
-// Helper functions for storage (flat map, no nesting)
-void setStorage(bmin::Map<bmin::String, bmin::String>& storage, const bmin::String& key,
+// Text-level helpers for storage (flat keys, no nesting); scripts use the typed
+// model::eventStorage* functions with keys interned at compile time.
+void setStorage(model::EventStorage& storage, const bmin::String& key,
                 const bmin::String& value);
 
-std::optional<bmin::String> getStorage(const bmin::Map<bmin::String, bmin::String>& storage,
+std::optional<bmin::String> getStorage(const model::EventStorage& storage,
                                        const bmin::String& key);
 
 // Drop per-conversation scratch keys (prefix "tmp."). Keeps once.tmp.* and vars.*.
-void clearTmpStorageKeys(bmin::Map<bmin::String, bmin::String>& storage);
+void clearTmpStorageKeys(model::EventStorage& storage);
 
 // Split exec/eval strings into statements (newlines or semicolons, not inside parens)
 bmin::DynArray<bmin::String> splitExecStatements(const bmin::String& str);
@@ -37,4 +40,21 @@ FunctionCall parseFunctionCall(const bmin::String& str);
 
 bool isFunctionCall(const bmin::String& str);
 
+// Variables visible to an event: its own first, then those of each importFrom event
+// (followed recursively, each event once).
+bmin::DynArray<model::Variable>
+collectGameEventVariables(const model::GameEvent& gameEvent,
+                          const bmin::Map<bmin::String, model::GameEvent>& gameEvents);
+
+// Trims text, then replaces "@KEY" with each variable's value in order.
+bmin::String applyVariables(const bmin::String& text,
+                            const bmin::DynArray<model::Variable>& vars);
+
+// Appends a compiled template, reading variables from gameEvent.variableValues.
+void appendTextTemplate(bmin::String& out,
+                        const model::TextTemplate& text,
+                        const model::GameEvent& gameEvent);
+
+bmin::String joinParagraphs(const bmin::DynArray<bmin::String>& paragraphs);
+
 } // namespace runner
@@ -0,0 +1,413 @@
+#include "ScriptCompiler.h"
+#include "EventRunnerHelpers.h"
+#include <stdexcept>
+#include <variant>
+
+namespace runner {
+
+namespace {
+
+struct ConditionFunc {
+  const char* name;
+  model::ScriptOp op;
+  int argCount; // -1 for any number
+  // Functions that read a storage key built from their first argument.
+  const char* keyPrefix;
+  const char* keySuffix;
+};
+
+constexpr ConditionFunc CONDITION_FUNCS[] = {
+    {"IS", model::ScriptOp::IS, 1, nullptr, nullptr},
+    {"ISNOT", model::ScriptOp::ISNOT, 1, nullptr, nullptr},
+    {"EQ", model::ScriptOp::EQ, 2, nullptr, nullptr},
+    {"NEQ", model::ScriptOp::NEQ, 2, nullptr, nullptr},
+    {"GT", model::ScriptOp::GT, 2, nullptr, nullptr},
+    {"GTE", model::ScriptOp::GTE, 2, nullptr, nullptr},
+    {"LT", model::ScriptOp::LT, 2, nullptr, nullptr},
+    {"LTE", model::ScriptOp::LTE, 2, nullptr, nullptr},
+    {"ALL", model::ScriptOp::ALL, -1, nullptr, nullptr},
+    {"ANY", model::ScriptOp::ANY, -1, nullptr, nullptr},
+    {"ONCE", model::ScriptOp::ONCE, 1, "once.", ""},
+    {"HAS_ITEM", model::ScriptOp::HAS_ITEM, 1, "vars.items.", ""},
+    {"QUEST_IS_STARTED",
+     model::ScriptOp::QUEST_IS_STARTED,
+     1,
+     "vars.quests.",
+     ".started"},
+    {"QUEST_IS_COMPLETE",
+     model::ScriptOp::QUEST_IS_COMPLETE,
+     1,
+     "vars.quests.",
+     ".completed"},
+    {"QUEST_STEP_EQ", model::ScriptOp::QUEST_STEP_EQ, 2, "vars.quests.", ".step"},
+};
+
+struct ExecFunc {
+  const char* name;
+  model::ScriptOp op;
+  int argCount;
+};
+
+// SET_BOOL/SET_NUM/SET_STR (compiled to STORE) and MOD_NUM are handled separately.
+constexpr ExecFunc EXEC_FUNCS[] = {
+    {"GET", model::ScriptOp::GET, 1},
+    {"SETUP_DISPOSITION", model::ScriptOp::SETUP_DISPOSITION, 1},
+    {"START_QUEST", model::ScriptOp::START_QUEST, 1},
+    {"COMPLETE_QUEST_STEP", model::ScriptOp::COMPLETE_QUEST_STEP, 2},
+    {"COMPLETE_QUEST", model::ScriptOp::COMPLETE_QUEST, 1},
+    {"SPAWN_CH", model::ScriptOp::SPAWN_CH, 1},
+    {"DESPAWN_CH", model::ScriptOp::DESPAWN_CH, 1},
+    {"CHANGE_TILE_AT", model::ScriptOp::CHANGE_TILE_AT, 3},
+    {"TELEPORT_TO", model::ScriptOp::TELEPORT_TO, 3},
+    {"ADD_ITEM_AT", model::ScriptOp::ADD_ITEM_AT, 3},
+    {"REMOVE_ITEM_AT", model::ScriptOp::REMOVE_ITEM_AT, 3},
+};
+
+void assertFuncArgs(const bmin::String& funcName,
+                    const bmin::DynArray<bmin::String>& funcArgs,
+                    size_t expectedArgs) {
+  if (funcArgs.size() != expectedArgs) {
+    throw std::runtime_error(("Invalid number of arguments for function '" + funcName +
+                              "'. Expected " + bmin::toString(expectedArgs) + ", got " +
+                              bmin::toString(funcArgs.size()))
+                                 .cStr());
+  }
+}
+
+class ScriptBuilder {
+  int depth = 0;
+
+public:
+  model::ScriptProgram program;
+
+  ScriptBuilder() {
+    addConstant("false");
+    addConstant("true");
+    program.compiled = true;
+  }
+
+  // Operands that name a storage slot are interned: key arguments, and any other
+  // operand in the vars/once/tmp namespaces, so comparisons such as GT(vars.gold, 10)
+  // also read storage by key. Numbers and other literals stay out of the key table.
+  uint16_t addConstant(const bmin::String& text, bool isStorageKey = false) {
+    isStorageKey = isStorageKey || (!bmin::isDouble(text) &&
+                                    model::getStorageNamespace(text) !=
+                                        model::StorageNamespace::OTHER);
+    for (size_t i = 0; i < program.constants.size(); i++) {
+      auto& constant = program.constants[i];
+      if (constant.text == text) {
+        if (isStorageKey && constant.key == model::NO_STORAGE_KEY) {
+          constant.key = model::internStorageKey(text);
+        }
+        return static_cast<uint16_t>(i);
+      }
+    }
+    model::ScriptConstant constant;
+    constant.text = text;
+    if (bmin::isDouble(text)) {
+      constant.isNumber = true;
+      constant.number = bmin::parseDouble(text);
+    }
+    if (isStorageKey) {
+      constant.key = model::internStorageKey(text);
+    }
+    constant.value = model::storageValueFromText(text);
+    program.constants.pushBack(constant);
+    return static_cast<uint16_t>(program.constants.size() - 1);
+  }
+
+  void push(const bmin::String& text, bool isStorageKey = false) {
+    program.code.pushBack({model::ScriptOp::PUSH, 0, addConstant(text, isStorageKey)});
+    depth++;
+    if (depth > program.maxStack) {
+      program.maxStack = depth;
+    }
+  }
+
+  // Pops argCount operands; conditions leave their result on the stack.
+  void call(model::ScriptOp op, size_t argCount, uint16_t operand, bool pushesResult) {
+    if (argCount > 255) {
+      throw std::runtime_error("Too many arguments in one call");
+    }
+    program.code.pushBack({op, static_cast<uint8_t>(argCount), operand});
+    depth -= static_cast<int>(argCount);
+    if (pushesResult) {
+      depth++;
+      if (depth > program.maxStack) {
+        program.maxStack = depth;
+      }
+    }
+  }
+
+  // Messages are not interned as storage keys.
+  void fail(const bmin::String& message) {
+    model::ScriptConstant constant;
+    constant.text = message;
+    program.constants.pushBack(constant);
+    program.code.pushBack({model::ScriptOp::FAIL,
+                           0,
+                           static_cast<uint16_t>(program.constants.size() - 1)});
+  }
+};
+
+model::ScriptProgram failedProgram(const bmin::String& message) {
+  ScriptBuilder builder;
+  builder.fail(message);
+  return std::move(builder.program);
+}
+
+void compileConditionCall(ScriptBuilder& builder, const FunctionCall& call) {
+  const ConditionFunc* func = nullptr;
+  for (const auto& candidate : CONDITION_FUNCS) {
+    if (call.funcName == candidate.name) {
+      func = &candidate;
+      break;
+    }
+  }
+  if (!func) {
+    throw std::runtime_error(
+        ("Conditional function '" + call.funcName + "' not found.").cStr());
+  }
+  if (func->argCount >= 0) {
+    assertFuncArgs(call.funcName, call.args, static_cast<size_t>(func->argCount));
+  }
+
+  uint16_t operand = 0;
+  size_t firstStackArg = 0;
+  if (func->keyPrefix) {
+    if (isFunctionCall(call.args[0])) {
+      throw std::runtime_error(("Function '" + call.funcName +
+                                "' expects a name, got: " + call.args[0])
+                                   .cStr());
+    }
+    operand = builder.addConstant(bmin::String(func->keyPrefix) + call.args[0] +
+                                      bmin::String(func->keySuffix),
+                                  true);
+    firstStackArg = 1;
+  }
+
+  const bool boolArgsOnly =
+      func->op == model::ScriptOp::ALL || func->op == model::ScriptOp::ANY;
+  // IS and ISNOT read their argument as a key, whatever its namespace.
+  const bool keyArg =
+      func->op == model::ScriptOp::IS || func->op == model::ScriptOp::ISNOT;
+  for (size_t i = firstStackArg; i < call.args.size(); i++) {
+    const auto& arg = call.args[i];
+    if (isFunctionCall(arg)) {
+      compileConditionCall(builder, parseFunctionCall(arg));
+    } else {
+      if (boolArgsOnly && arg != "true" && arg != "false") {
+        throw std::runtime_error(
+            ("Invalid argument for " + call.funcName + ": " + arg).cStr());
+      }
+      builder.push(arg, keyArg);
+    }
+  }
+  builder.call(func->op, call.args.size() - firstStackArg, operand, true);
+}
+
+void compileExecStatement(ScriptBuilder& builder, const bmin::String& statement) {
+  if (statement == "true" || statement == "false") {
+    return;
+  }
+  if (!isFunctionCall(statement)) {
+    throw std::runtime_error(("Invalid eval string: " + statement).cStr());
+  }
+
+  const FunctionCall call = parseFunctionCall(statement);
+  const auto& args = call.args;
+  if (call.funcName == "SET_BOOL") {
+    if (args.size() != 1) {
+      assertFuncArgs(call.funcName, args, 2);
+    }
+    const bool value = args.size() == 1 || args[1] != "false";
+    builder.push(args[0], true);
+    builder.push(value ? "true" : "false");
+    builder.call(model::ScriptOp::STORE, 2, 0, false);
+    return;
+  }
+  if (call.funcName == "SET_NUM" || call.funcName == "MOD_NUM") {
+    assertFuncArgs(call.funcName, args, 2);
+    if (!bmin::isDouble(args[1])) {
+      throw std::runtime_error(("Invalid number value: " + args[1]).cStr());
+    }
+    builder.push(args[0], true);
+    if (call.funcName == "SET_NUM") {
+      builder.push(model::formatStorageNumber(bmin::parseDouble(args[1])));
+      builder.call(model::ScriptOp::STORE, 2, 0, false);
+    } else {
+      builder.push(args[1]);
+      builder.call(model::ScriptOp::MOD_NUM, 2, 0, false);
+    }
+    return;
+  }
+  if (call.funcName == "SET_STR") {
+    assertFuncArgs(call.funcName, args, 2);
+    builder.push(args[0], true);
+    builder.push(args[1]);
+    builder.call(model::ScriptOp::STORE, 2, 0, false);
+    return;
+  }
+
+  for (const auto& func : EXEC_FUNCS) {
+    if (call.funcName == func.name) {
+      assertFuncArgs(call.funcName, args, static_cast<size_t>(func.argCount));
+      for (size_t i = 0; i < args.size(); i++) {
+        builder.push(args[i], func.op == model::ScriptOp::GET && i == 0);
+      }
+      builder.call(func.op, args.size(), 0, false);
+      return;
+    }
+  }
+  throw std::runtime_error(
+      ("Function '" + call.funcName + "' not found: " + statement).cStr());
+}
+
+} // namespace
+
+model::ScriptProgram compileCondition(const bmin::String& conditionStr,
+                                      bmin::DynArray<bmin::String>& errors) {
+  const bmin::String trimmed = trim(conditionStr);
+  try {
+    ScriptBuilder builder;
+    if (trimmed.empty() || trimmed == "true") {
+      builder.push("true");
+    } else if (trimmed == "false") {
+      builder.push("false");
+    } else if (isFunctionCall(trimmed)) {
+      compileConditionCall(builder, parseFunctionCall(trimmed));
+    } else {
+      throw std::runtime_error(("Invalid condition: " + conditionStr).cStr());
+    }
+    if (builder.program.maxStack > SCRIPT_MAX_STACK) {
+      throw std::runtime_error(("Condition nests too deeply: " + conditionStr).cStr());
+    }
+    return std::move(builder.program);
+  } catch (const std::exception& e) {
+    const bmin::String message = e.what();
+    errors.pushBack(message);
+    return failedProgram(message);
+  }
+}
+
+model::ScriptProgram compileExec(const bmin::String& execStr,
+                                 bmin::DynArray<bmin::String>& errors) {
+  ScriptBuilder builder;
+  for (const auto& statement : splitExecStatements(execStr)) {
+    // Validate before emitting so a bad statement leaves no operands behind.
+    ScriptBuilder statementBuilder;
+    try {
+      compileExecStatement(statementBuilder, statement);
+    } catch (const std::exception& e) {
+      const bmin::String message = e.what();
+      errors.pushBack(message);
+      builder.fail(message);
+      continue;
+    }
+    const auto& compiled = statementBuilder.program;
+    for (const auto& instruction : compiled.code) {
+      uint16_t operand = instruction.operand;
+      if (instruction.op == model::ScriptOp::PUSH) {
+        const auto& constant = compiled.constants[operand];
+        operand =
+            builder.addConstant(constant.text, constant.key != model::NO_STORAGE_KEY);
+      }
+      builder.program.code.pushBack({instruction.op, instruction.argCount, operand});
+    }
+    if (compiled.maxStack > builder.program.maxStack) {
+      builder.program.maxStack = compiled.maxStack;
+    }
+  }
+  return std::move(builder.program);
+}
+
+model::TextTemplate compileTextTemplate(const bmin::String& text,
+                                        const bmin::DynArray<model::Variable>& vars) {
+  model::TextTemplate result;
+  result.compiled = true;
+  const bmin::String trimmed = trim(text);
+  if (!trimmed.empty()) {
+    result.segments.pushBack({trimmed, -1});
+  }
+
+  // Same order as applyVariables, so earlier variables win overlapping placeholders.
+  for (size_t varIndex = 0; varIndex < vars.size(); varIndex++) {
+    const bmin::String placeholder = "@" + vars[varIndex].key;
+    bmin::DynArray<model::TextSegment> split;
+    for (const auto& segment : result.segments) {
+      if (segment.variableIndex >= 0) {
+        split.pushBack(segment);
+        continue;
+      }
+      size_t start = 0;
+      size_t pos = 0;
+      while ((pos = segment.literal.find(placeholder, start)) != bmin::String::npos) {
+        if (pos > start) {
+          split.pushBack({segment.literal.substr(start, pos - start), -1});
+        }
+        split.pushBack({"", static_cast<int>(varIndex)});
+        start = pos + placeholder.size();
+      }
+      if (start < segment.literal.size()) {
+        split.pushBack({segment.literal.substr(start), -1});
+      }
+    }
+    result.segments = std::move(split);
+  }
+  return result;
+}
+
+bmin::DynArray<ErrorInfo>
+compileGameEventScripts(model::GameEvent& gameEvent,
+                        const bmin::Map<bmin::String, model::GameEvent>& gameEvents) {
+  const auto vars = collectGameEventVariables(gameEvent, gameEvents);
+  gameEvent.variableValues.clear();
+  for (const auto& variable : vars) {
+    gameEvent.variableValues.pushBack(variable.value);
+  }
+  bmin::DynArray<ErrorInfo> errors;
+  bmin::DynArray<bmin::String> messages;
+
+  auto flush = [&](const bmin::String& nodeId) {
+    for (const auto& message : messages) {
+      errors.pushBack({nodeId, message});
+    }
+    messages.clear();
+  };
+
+  for (auto& child : gameEvent.children) {
+    std::visit(
+        [&](auto& node) {
+          using T = std::decay_t<decltype(node)>;
+          if constexpr (std::is_same_v<T, model::GameEventChildExec>) {
+            node.exec = compileExec(applyVariables(node.execStr, vars), messages);
+            node.textTemplate =
+                compileTextTemplate(joinParagraphs(node.paragraphs), vars);
+          } else if constexpr (std::is_same_v<T, model::GameEventChildChoice>) {
+            node.textTemplate = compileTextTemplate(node.text, vars);
+            for (auto& choice : node.choices) {
+              choice.condition =
+                  compileCondition(applyVariables(choice.conditionStr, vars), messages);
+              choice.eval = compileExec(applyVariables(choice.evalStr, vars), messages);
+              choice.textTemplate = compileTextTemplate(choice.text, vars);
+              choice.prefixTemplate = compileTextTemplate(choice.prefixText, vars);
+              for (auto& switchText : choice.switchText) {
+                switchText.condition = compileCondition(
+                    applyVariables(switchText.conditionStr, vars), messages);
+                switchText.textTemplate = compileTextTemplate(switchText.text, vars);
+              }
+            }
+          } else if constexpr (std::is_same_v<T, model::GameEventChildSwitch>) {
+            for (auto& switchCase : node.cases) {
+              switchCase.condition = compileCondition(
+                  applyVariables(switchCase.conditionStr, vars), messages);
+            }
+          }
+          flush(node.id);
+        },
+        child);
+  }
+  return errors;
+}
+
+} // namespace runner
@@ -0,0 +1,36 @@
+#pragma once
+
+#include "bmin/DynArray.h"
+#include "bmin/String.h"
+#include "lib/bmin/Map.h"
+#include "model/templates/SpecialEvents.h"
+#include "runner/SpecialEventRunner.h"
+
+namespace runner {
+
+// Deepest operand stack a compiled script may use (nested calls plus ALL/ANY args).
+constexpr int SCRIPT_MAX_STACK = 32;
+
+// Compiles a conditionStr (variables already replaced). Compile errors are appended
+// to errors and also compiled into the program, which raises them when evaluated.
+model::ScriptProgram compileCondition(const bmin::String& conditionStr,
+                                      bmin::DynArray<bmin::String>& errors);
+
+// Compiles an execStr/evalStr (variables already replaced). A statement that fails to
+// compile becomes a FAIL instruction; the other statements still run.
+model::ScriptProgram compileExec(const bmin::String& execStr,
+                                 bmin::DynArray<bmin::String>& errors);
+
+// Splits text (trimmed, as applyVariables does) into literals and references to vars
+// by index. A variable's value is not itself searched for placeholders.
+model::TextTemplate compileTextTemplate(const bmin::String& text,
+                                        const bmin::DynArray<model::Variable>& vars);
+
+// Flattens gameEvent's variables (imports resolved through gameEvents) into
+// variableValues, then compiles every script with them substituted in and every text
+// field into a TextTemplate. Returns the script compile errors by node id.
+bmin::DynArray<ErrorInfo>
+compileGameEventScripts(model::GameEvent& gameEvent,
+                        const bmin::Map<bmin::String, model::GameEvent>& gameEvents);
+
+} // namespace runner
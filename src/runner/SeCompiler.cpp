@@ -0,0 +1,762 @@
+#include "SeCompiler.h"
+#include "EventRunnerHelpers.h"
+#include "ScriptCompiler.h"
+#include "lib/StringUtil.h"
+#include <algorithm>
+#include <cstdint>
+#include <optional>
+#include <utility>
+#include <variant>
+
+namespace runner {
+
+namespace {
+
+enum class SeNodeType { EXEC, CHOICE, SWITCH, BOOL, END, KEYWORD };
+
+struct SeNodeTypeName {
+  const char* name;
+  SeNodeType type;
+};
+
+constexpr SeNodeTypeName SE_NODE_TYPES[] = {
+    {"exec", SeNodeType::EXEC},
+    {"choice", SeNodeType::CHOICE},
+    {"switch", SeNodeType::SWITCH},
+    {"bool", SeNodeType::BOOL},
+    {"end", SeNodeType::END},
+    {"keyword", SeNodeType::KEYWORD},
+};
+
+struct SeReference {
+  int line;
+  bmin::String next;
+};
+
+struct SeScript {
+  int line;
+  bool isCondition;
+  bmin::String source;
+};
+
+size_t findLast(const bmin::String& str, char c) {
+  for (size_t i = str.size(); i > 0; --i) {
+    if (str[i - 1] == c) {
+      return i - 1;
+    }
+  }
+  return bmin::String::npos;
+}
+
+// "FUNC:a,b" -> "FUNC(a, b)". Text already in call syntax, or without a colon, is
+// returned trimmed.
+bmin::String toCallSyntax(const bmin::String& text) {
+  const bmin::String trimmed = trim(text);
+  const size_t colon = trimmed.find(":");
+  if (isFunctionCall(trimmed) || colon == bmin::String::npos) {
+    return trimmed;
+  }
+  bmin::String result = trim(trimmed.substr(0, colon)) + "(";
+  const auto args = strutil::splitByChar(trimmed.substr(colon + 1), ',');
+  for (size_t i = 0; i < args.size(); ++i) {
+    if (i > 0) {
+      result += ", ";
+    }
+    result += trim(args[i]);
+  }
+  result += ")";
+  return result;
+}
+
+bmin::String toConditionStr(const bmin::String& text) {
+  const bmin::String call = toCallSyntax(text);
+  if (call.empty() || call == "true" || call == "false" || isFunctionCall(call)) {
+    return call;
+  }
+  return "IS(" + call + ")";
+}
+
+// Statements separated by '|' become one statement per line.
+bmin::String toExecStr(const bmin::String& text) {
+  bmin::String result;
+  for (const auto& statement : strutil::splitByChar(text, '|')) {
+    const bmin::String call = toCallSyntax(statement);
+    if (call.empty()) {
+      continue;
+    }
+    if (!result.empty()) {
+      result += "\n";
+    }
+    result += call;
+  }
+  return result;
+}
+
+class SeParser {
+  bmin::DynArray<SeDiagnostic>& diagnostics;
+  const bool checkScripts;
+  bmin::DynArray<model::GameEvent> events;
+
+  bool inEvent = false;
+  // Set after a malformed header so the lines under it are not reported again.
+  bool skipEvent = false;
+  bool skipNode = false;
+  int eventLine = 0;
+  model::GameEvent event;
+  bmin::DynArray<SeReference> references;
+  bmin::DynArray<SeScript> scripts;
+  bmin::DynArray<int> childLines;
+
+  bool inNode = false;
+  SeNodeType nodeType = SeNodeType::EXEC;
+  model::GameEventChild node;
+  int nodeLine = 0;
+  bmin::DynArray<bmin::String> nodeFields;
+  // bool nodes: the case is assembled from +check and +pass when the node closes.
+  bmin::String boolCondition;
+  bmin::String boolPass;
+  int boolLine = 0;
+
+  void error(int line, const bmin::String& message) {
+    diagnostics.pushBack({line, true, message});
+  }
+
+  void warning(int line, const bmin::String& message) {
+    diagnostics.pushBack({line, false, message});
+  }
+
+  void addReference(int line, const bmin::String& next) {
+    if (!next.empty()) {
+      references.pushBack({line, next});
+    }
+  }
+
+  void addScript(int line, bool isCondition, const bmin::String& source) {
+    if (!source.empty()) {
+      scripts.pushBack({line, isCondition, source});
+    }
+  }
+
+  void finishNode() {
+    if (!inNode) {
+      return;
+    }
+    inNode = false;
+    if (nodeType == SeNodeType::KEYWORD) {
+      return;
+    }
+    if (nodeType == SeNodeType::BOOL) {
+      auto& switchNode = std::get<model::GameEventChildSwitch>(node);
+      if (boolCondition.empty()) {
+        error(nodeLine, "bool node '" + switchNode.id + "' has no +check");
+      } else {
+        switchNode.cases.pushBack({boolCondition, boolPass, {}});
+        addScript(boolLine, true, boolCondition);
+      }
+    }
+    event.children.pushBack(std::move(node));
+    childLines.pushBack(nodeLine);
+  }
+
+  void checkEvent() {
+    for (size_t i = 0; i < event.children.size(); ++i) {
+      const auto& id = model::getGameEventChildId(event.children[i]);
+      for (size_t j = 0; j < i; ++j) {
+        if (model::getGameEventChildId(event.children[j]) == id) {
+          error(childLines[i], "duplicate node id '" + id + "'");
+          break;
+        }
+      }
+    }
+    for (const auto& reference : references) {
+      // "end" without a node of that name finishes the conversation.
+      if (reference.next != "end" && !model::findGameEventChild(event, reference.next)) {
+        warning(reference.line, "next '" + reference.next + "' is not a node of '" +
+                                    event.id + "'");
+      }
+    }
+    if (!checkScripts) {
+      return;
+    }
+    for (const auto& script : scripts) {
+      const bmin::String source = applyVariables(script.source, event.vars);
+      bmin::DynArray<bmin::String> errors;
+      if (script.isCondition) {
+        compileCondition(source, errors);
+      } else {
+        compileExec(source, errors);
+      }
+      for (const auto& message : errors) {
+        error(script.line, message);
+      }
+    }
+  }
+
+  void finishEvent() {
+    finishNode();
+    if (!inEvent) {
+      return;
+    }
+    inEvent = false;
+    if (event.children.empty()) {
+      warning(eventLine, "event '" + event.id + "' has no nodes");
+    }
+    model::indexGameEventChildren(event);
+    checkEvent();
+    events.pushBack(std::move(event));
+    event = model::GameEvent();
+    references.clear();
+    scripts.clear();
+    childLines.clear();
+  }
+
+  void parseEventHeader(int line, const bmin::String& text) {
+    finishEvent();
+    skipEvent = true;
+    skipNode = false;
+    const auto fields = strutil::splitByChar(text, ',');
+    if (fields.size() < 3 || trim(fields[0]).empty()) {
+      error(line, "expected !id,modal|talk,Title,icon");
+      return;
+    }
+    const bmin::String type = trim(fields[1]);
+    if (type != "modal" && type != "talk") {
+      error(line, "unknown event type '" + type + "' (expected modal or talk)");
+      return;
+    }
+    for (const auto& other : events) {
+      if (other.id == trim(fields[0])) {
+        error(line, "duplicate event id '" + other.id + "'");
+        return;
+      }
+    }
+    inEvent = true;
+    skipEvent = false;
+    eventLine = line;
+    event.id = trim(fields[0]);
+    event.eventType =
+        type == "modal" ? model::GameEventType::MODAL : model::GameEventType::TALK;
+    // The title may itself contain commas; the icon is always the last field.
+    const size_t titleEnd = fields.size() > 3 ? fields.size() - 1 : fields.size();
+    for (size_t i = 2; i < titleEnd; ++i) {
+      if (i > 2) {
+        event.title += ",";
+      }
+      event.title += fields[i];
+    }
+    event.title = trim(event.title);
+    event.icon = fields.size() > 3 ? trim(fields[fields.size() - 1]) : bmin::String();
+  }
+
+  void parseVariable(int line, const bmin::String& text) {
+    if (inNode || !event.children.empty()) {
+      warning(line, "variable declared after the first node");
+    }
+    const size_t eq = text.find("=");
+    model::Variable var;
+    var.key = trim(eq == bmin::String::npos ? text : text.substr(0, eq));
+    var.value = eq == bmin::String::npos ? bmin::String() : trim(text.substr(eq + 1));
+    var.id = var.key;
+    if (var.key.empty()) {
+      error(line, "expected @KEY=value");
+      return;
+    }
+    for (const auto& other : event.vars) {
+      if (other.key == var.key) {
+        error(line, "duplicate variable '@" + var.key + "'");
+        return;
+      }
+    }
+    event.vars.pushBack(var);
+  }
+
+  void parseNodeHeader(int line, const bmin::String& text) {
+    finishNode();
+    skipNode = true;
+    const auto fields = strutil::splitByChar(text, ',');
+    const bmin::String id = trim(fields[0]);
+    const bmin::String type = fields.size() == 2 ? trim(fields[1]) : bmin::String();
+    if (fields.size() != 2 || id.empty()) {
+      error(line, "expected >id,type");
+      return;
+    }
+    const SeNodeTypeName* nodeTypeName = nullptr;
+    for (const auto& candidate : SE_NODE_TYPES) {
+      if (type == candidate.name) {
+        nodeTypeName = &candidate;
+      }
+    }
+    if (!nodeTypeName) {
+      error(line, "unknown node type '" + type + "'");
+      return;
+    }
+
+    inNode = true;
+    skipNode = false;
+    nodeType = nodeTypeName->type;
+    nodeLine = line;
+    nodeFields.clear();
+    switch (nodeType) {
+    case SeNodeType::EXEC: {
+      model::GameEventChildExec execNode;
+      execNode.id = id;
+      execNode.autoAdvance = false;
+      node = std::move(execNode);
+      break;
+    }
+    case SeNodeType::CHOICE: {
+      model::GameEventChildChoice choiceNode;
+      choiceNode.id = id;
+      node = std::move(choiceNode);
+      break;
+    }
+    case SeNodeType::SWITCH:
+    case SeNodeType::BOOL: {
+      model::GameEventChildSwitch switchNode;
+      switchNode.id = id;
+      node = std::move(switchNode);
+      boolCondition.clear();
+      boolPass.clear();
+      break;
+    }
+    case SeNodeType::END: {
+      model::GameEventChildEnd endNode;
+      endNode.id = id;
+      node = std::move(endNode);
+      break;
+    }
+    case SeNodeType::KEYWORD:
+      warning(line, "keyword node '" + id + "' is not supported by the runtime; skipped");
+      break;
+    }
+  }
+
+  // Fields that may appear at most once per node.
+  bool firstUse(int line, const bmin::String& field) {
+    if (std::find(nodeFields.begin(), nodeFields.end(), field) != nodeFields.end()) {
+      error(line, "duplicate +" + field);
+      return false;
+    }
+    nodeFields.pushBack(field);
+    return true;
+  }
+
+  void parseExecField(int line, const bmin::String& field, const bmin::String& value) {
+    auto& execNode = std::get<model::GameEventChildExec>(node);
+    if (field == "p") {
+      execNode.paragraphs.pushBack(value);
+    } else if (field == "e") {
+      const bmin::String execStr = toExecStr(value);
+      if (!execNode.execStr.empty() && !execStr.empty()) {
+        execNode.execStr += "\n";
+      }
+      execNode.execStr += execStr;
+      addScript(line, false, execStr);
+    } else if (field == "n") {
+      if (firstUse(line, field)) {
+        execNode.next = value;
+        addReference(line, value);
+      }
+    } else if (field == "auto") {
+      if (value != "true" && value != "false") {
+        error(line, "expected +auto: true|false");
+      } else if (firstUse(line, field)) {
+        execNode.autoAdvance = value == "true";
+      }
+    } else if (field == "audio") {
+      const auto parts = strutil::splitByChar(value, ',');
+      model::AudioInfo audioInfo{trim(parts[0]), 0, 0};
+      if (parts.size() > 3 || audioInfo.audioName.empty() ||
+          (parts.size() > 1 && !bmin::isInt(trim(parts[1]))) ||
+          (parts.size() > 2 && !bmin::isInt(trim(parts[2])))) {
+        error(line, "expected +audio: name[,volume[,offset]]");
+      } else if (firstUse(line, field)) {
+        audioInfo.volume = parts.size() > 1 ? bmin::parseInt(trim(parts[1])) : 0;
+        audioInfo.offset = parts.size() > 2 ? bmin::parseInt(trim(parts[2])) : 0;
+        execNode.audioInfo = audioInfo;
+      }
+    } else {
+      error(line, "+" + field + " is not valid in an exec node");
+    }
+  }
+
+  void parseChoiceField(int line, const bmin::String& field, const bmin::String& value) {
+    auto& choiceNode = std::get<model::GameEventChildChoice>(node);
+    if (field == "p") {
+      if (!choiceNode.text.empty()) {
+        choiceNode.text += "\n";
+      }
+      choiceNode.text += value;
+    } else if (field == "c") {
+      const size_t firstBar = value.find("|");
+      if (firstBar == bmin::String::npos) {
+        error(line, "expected +c: next|text|condition");
+        return;
+      }
+      model::Choice choice;
+      choice.next = trim(value.substr(0, firstBar));
+      bmin::String rest = value.substr(firstBar + 1);
+      const size_t lastBar = findLast(rest, '|');
+      if (lastBar != bmin::String::npos) {
+        choice.conditionStr = toConditionStr(rest.substr(lastBar + 1));
+        rest = rest.substr(0, lastBar);
+      }
+      choice.text = trim(rest);
+      addReference(line, choice.next);
+      addScript(line, true, choice.conditionStr);
+      choiceNode.choices.pushBack(std::move(choice));
+    } else {
+      error(line, "+" + field + " is not valid in a choice node");
+    }
+  }
+
+  void parseSwitchField(int line, const bmin::String& field, const bmin::String& value) {
+    auto& switchNode = std::get<model::GameEventChildSwitch>(node);
+    const bool isBool = nodeType == SeNodeType::BOOL;
+    if (field == "check" && isBool) {
+      if (firstUse(line, field)) {
+        boolCondition = toConditionStr(value);
+        boolLine = line;
+      }
+    } else if (field == "check") {
+      const size_t bar = findLast(value, '|');
+      const bmin::String next =
+          bar == bmin::String::npos ? bmin::String() : trim(value.substr(bar + 1));
+      if (next.empty()) {
+        error(line, "expected +check: condition|next");
+        return;
+      }
+      model::SwitchCase switchCase;
+      switchCase.conditionStr = toConditionStr(value.substr(0, bar));
+      switchCase.next = next;
+      addReference(line, next);
+      addScript(line, true, switchCase.conditionStr);
+      switchNode.cases.pushBack(std::move(switchCase));
+    } else if ((field == "default" && !isBool) || (field == "fail" && isBool)) {
+      if (firstUse(line, field)) {
+        switchNode.defaultNext = value;
+        addReference(line, value);
+      }
+    } else if (field == "pass" && isBool) {
+      if (firstUse(line, field)) {
+        boolPass = value;
+        addReference(line, value);
+      }
+    } else {
+      error(line, "+" + field + " is not valid in a " + (isBool ? "bool" : "switch") +
+                      " node");
+    }
+  }
+
+  void parseField(int line, const bmin::String& text) {
+    if (!inNode) {
+      if (!skipNode) {
+        error(line, "field outside of a node");
+      }
+      return;
+    }
+    if (nodeType == SeNodeType::KEYWORD) {
+      return;
+    }
+    const size_t colon = text.find(":");
+    if (colon == bmin::String::npos) {
+      error(line, "expected +field: value");
+      return;
+    }
+    const bmin::String field = trim(text.substr(0, colon));
+    const bmin::String value = trim(text.substr(colon + 1));
+    switch (nodeType) {
+    case SeNodeType::EXEC:
+      parseExecField(line, field, value);
+      break;
+    case SeNodeType::CHOICE:
+      parseChoiceField(line, field, value);
+      break;
+    case SeNodeType::SWITCH:
+    case SeNodeType::BOOL:
+      parseSwitchField(line, field, value);
+      break;
+    case SeNodeType::END:
+      if (field == "n") {
+        if (firstUse(line, field)) {
+          std::get<model::GameEventChildEnd>(node).next = value;
+        }
+      } else {
+        error(line, "+" + field + " is not valid in an end node");
+      }
+      break;
+    case SeNodeType::KEYWORD:
+      break;
+    }
+  }
+
+public:
+  SeParser(bmin::DynArray<SeDiagnostic>& _diagnostics, bool _checkScripts)
+      : diagnostics(_diagnostics), checkScripts(_checkScripts) {}
+
+  bmin::DynArray<model::GameEvent> parse(const bmin::String& source) {
+    const auto lines = strutil::splitLines(source);
+    for (size_t i = 0; i < lines.size(); ++i) {
+      const int line = static_cast<int>(i) + 1;
+      const bmin::String text = trim(lines[i]);
+      if (text.empty() || text.startsWith("//")) {
+        continue;
+      }
+      const char marker = text[0];
+      const bmin::String rest = text.substr(1);
+      if (marker == '!') {
+        parseEventHeader(line, rest);
+        continue;
+      }
+      if (!inEvent) {
+        if (!skipEvent) {
+          error(line, "expected an event header (!id,type,Title,icon)");
+        }
+        continue;
+      }
+      if (marker == '@') {
+        parseVariable(line, rest);
+      } else if (marker == '>') {
+        parseNodeHeader(line, rest);
+      } else if (marker == '+') {
+        parseField(line, rest);
+      } else if (marker == '|' &&
+                 (skipNode || (inNode && nodeType == SeNodeType::KEYWORD))) {
+        // +kSwitch continuation line
+      } else {
+        error(line, "unexpected line");
+      }
+    }
+    finishEvent();
+    return std::move(events);
+  }
+};
+
+void appendJsonString(bmin::String& out, const bmin::String& value) {
+  out += "\"";
+  for (size_t i = 0; i < value.size(); ++i) {
+    const char c = value[i];
+    if (c == '"' || c == '\\') {
+      out += "\\";
+      out += c;
+    } else if (c == '\n') {
+      out += "\\n";
+    } else if (c == '\r') {
+      out += "\\r";
+    } else if (c == '\t') {
+      out += "\\t";
+    } else {
+      out += c;
+    }
+  }
+  out += "\"";
+}
+
+// Pretty printer for the special-events.json layout (two-space indent).
+class JsonWriter {
+  // One entry per open object/array: true until its first member is written.
+  bmin::DynArray<uint8_t> firstInScope;
+  bool afterKey = false;
+
+  void newline() {
+    out += "\n";
+    for (size_t i = 0; i < firstInScope.size(); ++i) {
+      out += "  ";
+    }
+  }
+
+  void beginValue() {
+    if (afterKey) {
+      afterKey = false;
+      return;
+    }
+    if (firstInScope.empty()) {
+      return;
+    }
+    uint8_t& first = firstInScope[firstInScope.size() - 1];
+    if (!first) {
+      out += ",";
+    }
+    first = 0;
+    newline();
+  }
+
+  void close(const char* bracket) {
+    const bool empty = firstInScope[firstInScope.size() - 1] != 0;
+    firstInScope.popBack();
+    if (!empty) {
+      newline();
+    }
+    out += bracket;
+  }
+
+public:
+  bmin::String out;
+
+  void beginObject() {
+    beginValue();
+    out += "{";
+    firstInScope.pushBack(1);
+  }
+  void endObject() { close("}"); }
+  void beginArray() {
+    beginValue();
+    out += "[";
+    firstInScope.pushBack(1);
+  }
+  void endArray() { close("]"); }
+
+  void key(const char* name) {
+    beginValue();
+    appendJsonString(out, name);
+    out += ": ";
+    afterKey = true;
+  }
+  void string(const char* name, const bmin::String& value) {
+    key(name);
+    beginValue();
+    appendJsonString(out, value);
+  }
+  void raw(const char* name, const bmin::String& value) {
+    key(name);
+    beginValue();
+    out += value;
+  }
+};
+
+void writeAudioInfoJson(JsonWriter& json, const std::optional<model::AudioInfo>& audio) {
+  if (!audio.has_value()) {
+    return;
+  }
+  json.key("audioInfo");
+  json.beginObject();
+  json.string("audioName", audio->audioName);
+  json.raw("volume", bmin::toString(audio->volume));
+  json.raw("offset", bmin::toString(audio->offset));
+  json.endObject();
+}
+
+void writeChildJson(JsonWriter& json, const model::GameEventChild& child) {
+  json.beginObject();
+  json.string("id", model::getGameEventChildId(child));
+  std::visit(
+      [&json](const auto& node) {
+        using T = std::decay_t<decltype(node)>;
+        if constexpr (std::is_same_v<T, model::GameEventChildExec>) {
+          json.string("eventChildType", "EXEC");
+          json.string("p", joinParagraphs(node.paragraphs));
+          json.string("execStr", node.execStr);
+          json.string("next", node.next);
+          json.raw("autoAdvance", node.autoAdvance ? "true" : "false");
+          writeAudioInfoJson(json, node.audioInfo);
+        } else if constexpr (std::is_same_v<T, model::GameEventChildChoice>) {
+          json.string("eventChildType", "CHOICE");
+          json.string("text", node.text);
+          json.key("choices");
+          json.beginArray();
+          for (const auto& choice : node.choices) {
+            json.beginObject();
+            json.string("text", choice.text);
+            json.string("prefixText", choice.prefixText);
+            json.string("conditionStr", choice.conditionStr);
+            json.string("evalStr", choice.evalStr);
+            json.string("next", choice.next);
+            if (!choice.switchText.empty()) {
+              json.key("switchText");
+              json.beginArray();
+              for (const auto& switchText : choice.switchText) {
+                json.beginObject();
+                json.string("conditionStr", switchText.conditionStr);
+                json.string("text", switchText.text);
+                json.endObject();
+              }
+              json.endArray();
+            }
+            json.endObject();
+          }
+          json.endArray();
+          writeAudioInfoJson(json, node.audioInfo);
+        } else if constexpr (std::is_same_v<T, model::GameEventChildSwitch>) {
+          json.string("eventChildType", "SWITCH");
+          json.string("defaultNext", node.defaultNext);
+          json.key("cases");
+          json.beginArray();
+          for (const auto& switchCase : node.cases) {
+            json.beginObject();
+            json.string("conditionStr", switchCase.conditionStr);
+            json.string("next", switchCase.next);
+            json.endObject();
+          }
+          json.endArray();
+        } else if constexpr (std::is_same_v<T, model::GameEventChildEnd>) {
+          json.string("eventChildType", "END");
+          json.string("next", node.next);
+        }
+      },
+      child);
+  json.endObject();
+}
+
+} // namespace
+
+bmin::DynArray<model::GameEvent>
+compileSeSource(const bmin::String& source,
+                bmin::DynArray<SeDiagnostic>& diagnostics,
+                bool checkScripts) {
+  const size_t firstDiagnostic = diagnostics.size();
+  SeParser parser(diagnostics, checkScripts);
+  auto events = parser.parse(source);
+  // Event-level checks run when an event closes; report everything in line order.
+  std::stable_sort(diagnostics.begin() + firstDiagnostic,
+                   diagnostics.end(),
+                   [](const auto& a, const auto& b) { return a.line < b.line; });
+  return events;
+}
+
+bool hasSeErrors(const bmin::DynArray<SeDiagnostic>& diagnostics) {
+  return std::any_of(diagnostics.begin(), diagnostics.end(), [](const auto& diagnostic) {
+    return diagnostic.isError;
+  });
+}
+
+bmin::String formatSeDiagnostic(const bmin::String& fileName,
+                                const SeDiagnostic& diagnostic) {
+  return fileName + ":" + bmin::toString(diagnostic.line) +
+         (diagnostic.isError ? ": error: " : ": warning: ") + diagnostic.message;
+}
+
+bmin::String gameEventsToJson(const bmin::DynArray<model::GameEvent>& events) {
+  JsonWriter json;
+  json.beginArray();
+  for (const auto& event : events) {
+    json.beginObject();
+    json.string("id", event.id);
+    json.string("title", event.title);
+    json.string("eventType",
+                event.eventType == model::GameEventType::MODAL ? "MODAL" : "TALK");
+    json.string("icon", event.icon);
+    json.key("vars");
+    json.beginArray();
+    for (const auto& var : event.vars) {
+      json.beginObject();
+      json.string("id", var.id);
+      json.string("key", var.key);
+      json.string("value", var.value);
+      json.string("importFrom", var.importFrom);
+      json.endObject();
+    }
+    json.endArray();
+    json.key("children");
+    json.beginArray();
+    for (const auto& child : event.children) {
+      writeChildJson(json, child);
+    }
+    json.endArray();
+    json.endObject();
+  }
+  json.endArray();
+  json.out += "\n";
+  return std::move(json.out);
+}
+
+} // namespace runner
@@ -0,0 +1,53 @@
+#pragma once
+
+#include "bmin/DynArray.h"
+#include "bmin/String.h"
+#include "model/templates/SpecialEvents.h"
+
+namespace runner {
+
+// Compiles special events written in the .se text format (see
+// event-syntax/example.se) into the same model the JSON loader builds:
+//
+//   // comment
+//   !eventId,modal|talk,Title,icon
+//   @KEY=value                      (event variable; "@KEY" alone for an empty one)
+//   >nodeId,exec|choice|switch|bool|end
+//     +p: paragraph text            (exec: one paragraph per line; choice: prompt)
+//     +e: FUNC:a,b|FUNC2:c          (exec statements; "FUNC(a, b)" is also accepted)
+//     +n: nextId                    ("end" finishes the conversation)
+//     +auto: true                   (exec autoAdvance)
+//     +audio: name,volume,offset
+//     +c: nextId|text|CONDITION     (choice; the condition is optional)
+//     +check: CONDITION|nextId      (switch case; bool: "+check: CONDITION")
+//     +default: nextId              (switch)
+//     +pass: nextId / +fail: nextId (bool, a switch with one case)
+//
+// A condition is "FUNC:a,b", "FUNC(a, b)" or a bare value, which means IS(value).
+// Keyword nodes have no runtime support; they are reported and skipped.
+
+struct SeDiagnostic {
+  int line; // 1-based
+  bool isError; // false for warnings
+  bmin::String message;
+};
+
+// Parses source into events in file order. Problems are appended to diagnostics with
+// their line; a malformed node or field is skipped and the rest still compiles. When
+// checkScripts is set, every condition and exec string is also compiled (with the
+// event's own variables substituted) so script errors carry a line as well.
+bmin::DynArray<model::GameEvent>
+compileSeSource(const bmin::String& source,
+                bmin::DynArray<SeDiagnostic>& diagnostics,
+                bool checkScripts = true);
+
+bool hasSeErrors(const bmin::DynArray<SeDiagnostic>& diagnostics);
+
+// "<fileName>:<line>: error: <message>"
+bmin::String formatSeDiagnostic(const bmin::String& fileName,
+                                const SeDiagnostic& diagnostic);
+
+// The events in the special-events.json schema db::loadSpecialEvents reads.
+bmin::String gameEventsToJson(const bmin::DynArray<model::GameEvent>& events);
+
+} // namespace runner
@@ -3,22 +3,12 @@
 #include "EventRunnerHelpers.h"
 #include "StringEvaluator.h"
 #include <algorithm>
-#include <functional>
+#include <utility>
 
 namespace runner {
 
-static bmin::String replaceAll(bmin::String str, const bmin::String& from, const bmin::String& to) {
-  size_t pos = 0;
-  while ((pos = str.find(from, pos)) != bmin::String::npos) {
-    str.erase(pos, from.size());
-    str.insert(pos, to);
-    pos += to.size();
-  }
-  return str;
-}
-
 SpecialEventRunner::SpecialEventRunner(
-    const bmin::Map<bmin::String, bmin::String>& initialStorage,
+    const model::EventStorage& initialStorage,
     const model::GameEvent& gameEvent,
     const bmin::Map<bmin::String, model::GameEvent>& gameEvents)
     : storage(initialStorage), gameEvent(gameEvent), gameEvents(gameEvents) {
@@ -26,51 +16,27 @@ SpecialEventRunner::SpecialEventRunner(
 }
 
 void SpecialEventRunner::reset() {
-  bool hasRoot = false;
   displayText.clear();
   displayTextChoices.clear();
   autoAdvancedText.clear();
   chosenChoiceKeys.clear();
   errors.clear();
-  currentNodeId = "";
-  for (const auto& child : gameEvent.children) {
-    std::visit(
-        [&hasRoot](const auto& node) {
-          if (node.id == "root") {
-            hasRoot = true;
-          }
-        },
-        child);
-  }
-  if (hasRoot) {
-    currentNodeId = "root";
+  static const bmin::String rootId = "root";
+  if (model::findGameEventChild(gameEvent, rootId)) {
+    currentNodeId = rootId;
   } else if (!gameEvent.children.empty()) {
-    std::visit([this](const auto& node) { currentNodeId = node.id; },
-               gameEvent.children[0]);
+    currentNodeId = model::getGameEventChildId(gameEvent.children[0]);
   } else {
-    currentNodeId = "";
+    currentNodeId.clear();
   }
 }
 
-std::optional<model::GameEventChild> SpecialEventRunner::getCurrentNode() const {
-  for (const auto& child : gameEvent.children) {
-    bool matches = false;
-    std::visit(
-        [&matches, this](const auto& node) {
-          if (node.id == this->currentNodeId) {
-            matches = true;
-          }
-        },
-        child);
-    if (matches) {
-      return child;
-    }
-  }
-  return std::nullopt;
+const model::GameEventChild* SpecialEventRunner::getCurrentNode() const {
+  return model::findGameEventChild(gameEvent, currentNodeId);
 }
 
 bool SpecialEventRunner::isAtEndNode() const {
-  auto currentNode = getCurrentNode();
+  const auto* currentNode = getCurrentNode();
   if (!currentNode) {
     return false;
   }
@@ -78,7 +44,7 @@ bool SpecialEventRunner::isAtEndNode() const {
 }
 
 bmin::String SpecialEventRunner::getNextNodeId() {
-  auto currentNode = getCurrentNode();
+  const auto* currentNode = getCurrentNode();
   if (!currentNode) {
     return "";
   }
@@ -95,49 +61,11 @@ bmin::String SpecialEventRunner::getNextNodeId() {
 }
 
 bmin::DynArray<model::Variable> SpecialEventRunner::getVarsFromNode() {
-  bmin::DynArray<model::Variable> vars;
-  bmin::DynArray<bmin::String> usedNodes;
-
-  std::function<void(const model::GameEvent&)> innerHelper =
-      [&](const model::GameEvent& event) {
-        if (std::find(usedNodes.begin(), usedNodes.end(), event.id) != usedNodes.end()) {
-          return;
-        }
-        usedNodes.pushBack(event.id);
-
-        for (const auto& variable : event.vars) {
-          if (variable.importFrom.empty()) {
-            vars.pushBack(variable);
-          }
-        }
-
-        for (const auto& variable : event.vars) {
-          if (!variable.importFrom.empty()) {
-            for (auto it = gameEvents.begin(); it != gameEvents.end(); ++it) {
-              if (it->value.id == variable.importFrom) {
-                innerHelper(it->value);
-                break;
-              }
-            }
-          }
-        }
-      };
-
-  innerHelper(gameEvent);
-  return vars;
+  return collectGameEventVariables(gameEvent, gameEvents);
 }
 
 bmin::String SpecialEventRunner::replaceVariables(const bmin::String& text) {
-  auto vars = getVarsFromNode();
-  bmin::String result = trim(text);
-
-  for (const auto& variable : vars) {
-    const bmin::String placeholder = "@" + variable.key;
-    const bmin::String value = variable.value;
-    result = replaceAll(result, placeholder, value);
-  }
-
-  return result;
+  return applyVariables(text, getVarsFromNode());
 }
 
 bool SpecialEventRunner::evalExecStr(const bmin::String& str) {
@@ -162,6 +90,40 @@ bool SpecialEventRunner::evalExecStr(const bmin::String& str) {
   }
 }
 
+ConditionResult SpecialEventRunner::evalCondition(const model::ScriptProgram& program,
+                                                  const bmin::String& conditionStr) {
+  if (!program.compiled) {
+    return evalCondition(replaceVariables(conditionStr));
+  }
+  ConditionEvaluator evaluator(storage);
+  try {
+    const bool result = evaluator.evalProgram(program);
+    return {result, evaluator.funcs.onceKeysToCommit};
+  } catch (const std::exception& e) {
+    errors.pushBack({currentNodeId, e.what()});
+    return {false, {}};
+  }
+}
+
+void SpecialEventRunner::runExec(const model::ScriptProgram* program,
+                                 const bmin::String& execStr) {
+  if (program && program->compiled) {
+    StringEvaluator evaluator(storage);
+    bmin::DynArray<bmin::String> messages;
+    evaluator.evalProgram(*program, messages);
+    for (const auto& message : messages) {
+      errors.pushBack({currentNodeId, message});
+    }
+    return;
+  }
+  if (!execStr.empty()) {
+    auto strLines = splitExecStatements(execStr);
+    for (const auto& strLine : strLines) {
+      evalExecStr(replaceVariables(strLine));
+    }
+  }
+}
+
 ConditionResult SpecialEventRunner::evalCondition(const bmin::String& conditionStr) {
   ConditionEvaluator evaluator(storage, conditionStr);
   try {
@@ -175,33 +137,38 @@ ConditionResult SpecialEventRunner::evalCondition(const bmin::String& conditionS
 
 void SpecialEventRunner::commitOnceKeys(const bmin::DynArray<bmin::String>& onceKeysToCommit) {
   for (const auto& onceKeyToCommit : onceKeysToCommit) {
-    setStorage(storage, onceKeyToCommit, "true");
+    model::eventStorageSet(storage,
+                           model::internStorageKey(onceKeyToCommit),
+                           model::storageValueFromBool(true));
   }
 }
 
-bmin::String SpecialEventRunner::joinParagraphs(const bmin::DynArray<bmin::String>& paragraphs) {
-  if (paragraphs.empty()) {
-    return "";
-  }
-  bmin::String result;
-  for (size_t i = 0; i < paragraphs.size(); ++i) {
-    if (i > 0) {
-      result += "\n";
-    }
-    result += paragraphs[i];
+void SpecialEventRunner::renderText(const model::TextTemplate& text,
+                                    const bmin::String& source,
+                                    bmin::String& out) {
+  out.clear();
+  if (text.compiled) {
+    appendTextTemplate(out, text, gameEvent);
+  } else {
+    out += replaceVariables(source);
   }
-  return result;
 }
 
-bmin::String SpecialEventRunner::joinDisplaySegments(const bmin::String& earlier,
-                                                     const bmin::String& later) {
-  if (earlier.empty()) {
-    return later;
+void SpecialEventRunner::appendDisplaySegment(bmin::String& out,
+                                              const bmin::String& segment) {
+  if (segment.empty()) {
+    return;
   }
-  if (later.empty()) {
-    return earlier;
+  if (!out.empty()) {
+    out += "\n\n";
   }
-  return earlier + "\n\n" + later;
+  out += segment;
+}
+
+void SpecialEventRunner::flushDisplayText(const bmin::String& segment) {
+  std::swap(displayText, autoAdvancedText);
+  appendDisplaySegment(displayText, segment);
+  autoAdvancedText.clear();
 }
 
 bool SpecialEventRunner::wasChoiceChosen(const bmin::String& choiceKey) const {
@@ -223,41 +190,45 @@ void SpecialEventRunner::markChoiceChosen(const bmin::String& choiceKey) {
   chosenChoiceKeys.pushBack(choiceKey);
 }
 
-bmin::String SpecialEventRunner::resolveChoiceText(const model::Choice& choice,
-                                             bmin::DynArray<bmin::String>& onceKeysToCommit) {
+void SpecialEventRunner::resolveChoiceText(const model::Choice& choice,
+                                           bmin::DynArray<bmin::String>& onceKeysToCommit,
+                                           bmin::String& out) {
   for (const auto& switchText : choice.switchText) {
     if (!switchText.conditionStr.empty()) {
-      ConditionResult obj = evalCondition(replaceVariables(switchText.conditionStr));
+      ConditionResult obj = evalCondition(switchText.condition, switchText.conditionStr);
       if (obj.result) {
         for (const auto& key : obj.onceKeysToCommit) {
           onceKeysToCommit.pushBack(key);
         }
-        return replaceVariables(switchText.text);
+        renderText(switchText.textTemplate, switchText.text, out);
+        return;
       }
     }
   }
-  return replaceVariables(choice.text);
+  renderText(choice.textTemplate, choice.text, out);
+}
+
+void SpecialEventRunner::advance(const bmin::String& nodeId,
+                                 const bmin::DynArray<bmin::String>& onceKeysToCommit,
+                                 const bmin::String& execStr) {
+  advance(nodeId, onceKeysToCommit, nullptr, execStr);
 }
 
 void SpecialEventRunner::advance(const bmin::String& nodeId,
                                  const bmin::DynArray<bmin::String>& onceKeysToCommit,
+                                 const model::ScriptProgram* exec,
                                  const bmin::String& execStr) {
   if (!errors.empty()) {
     return;
   }
 
   commitOnceKeys(onceKeysToCommit);
-  if (!execStr.empty()) {
-    auto strLines = splitExecStatements(execStr);
-    for (const auto& strLine : strLines) {
-      evalExecStr(replaceVariables(strLine));
-    }
-  }
+  runExec(exec, execStr);
 
   displayTextChoices.clear();
 
   currentNodeId = nodeId;
-  auto currentNode = getCurrentNode();
+  const auto* currentNode = getCurrentNode();
   if (nodeId.empty() || !currentNode) {
     return;
   }
@@ -266,11 +237,14 @@ void SpecialEventRunner::advance(const bmin::String& nodeId,
       [this](const auto& node) {
         using T = std::decay_t<decltype(node)>;
         if constexpr (std::is_same_v<T, model::GameEventChildExec>) {
-          auto strLines = splitExecStatements(node.execStr);
-          for (const auto& strLine : strLines) {
-            evalExecStr(replaceVariables(strLine));
+          runExec(&node.exec, node.execStr);
+          if (node.textTemplate.compiled) {
+            textBuffer.clear();
+            appendTextTemplate(textBuffer, node.textTemplate, gameEvent);
+          } else {
+            textBuffer = replaceVariables(joinParagraphs(node.paragraphs));
           }
-          const bmin::String nodeText = replaceVariables(joinParagraphs(node.paragraphs));
+          const bmin::String& nodeText = textBuffer;
           // MODAL: wait for Continue whenever there is text; ignore autoAdvance.
           // TALK (and others): keep authored autoAdvance behavior, but preserve
           // non-empty EXEC text across the auto-advance chain until the next stop.
@@ -278,13 +252,10 @@ void SpecialEventRunner::advance(const bmin::String& nodeId,
               nodeText.empty() ||
               (gameEvent.eventType != model::GameEventType::MODAL && node.autoAdvance);
           if (shouldAutoAdvance) {
-            if (!nodeText.empty()) {
-              autoAdvancedText = joinDisplaySegments(autoAdvancedText, nodeText);
-            }
+            appendDisplaySegment(autoAdvancedText, nodeText);
             advance(node.next, {}, "");
           } else {
-            displayText = joinDisplaySegments(autoAdvancedText, nodeText);
-            autoAdvancedText.clear();
+            flushDisplayText(nodeText);
             // TALK has no Continue button — surface a choice so the player can advance.
             if (gameEvent.eventType == model::GameEventType::TALK && !node.next.empty()) {
               DisplayTextChoice continueChoice;
@@ -295,12 +266,12 @@ void SpecialEventRunner::advance(const bmin::String& nodeId,
             }
           }
         } else if constexpr (std::is_same_v<T, model::GameEventChildChoice>) {
-          const bmin::String choiceDisplayText = replaceVariables(node.text);
+          renderText(node.textTemplate, node.text, textBuffer);
           // Flush auto-advanced EXEC text into this stop. If both are empty, keep
           // whatever displayText was already showing (e.g. MODAL continue into an
           // empty-text CHOICE menu).
-          if (!autoAdvancedText.empty() || !choiceDisplayText.empty()) {
-            displayText = joinDisplaySegments(autoAdvancedText, choiceDisplayText);
+          if (!autoAdvancedText.empty() || !textBuffer.empty()) {
+            flushDisplayText(textBuffer);
           }
           autoAdvancedText.clear();
           for (int authoredIndex = 0; authoredIndex < static_cast<int>(node.choices.size());
@@ -308,16 +279,20 @@ void SpecialEventRunner::advance(const bmin::String& nodeId,
             const auto& choice = node.choices[authoredIndex];
             ConditionResult obj;
             if (!choice.conditionStr.empty()) {
-              obj = evalCondition(replaceVariables(choice.conditionStr));
+              obj = evalCondition(choice.condition, choice.conditionStr);
             } else {
               obj = {true, {}};
             }
             if (obj.result) {
               DisplayTextChoice displayChoice;
-              displayChoice.prefix = replaceVariables(choice.prefixText);
+              renderText(choice.prefixTemplate, choice.prefixText, displayChoice.prefix);
               bmin::DynArray<bmin::String> switchOnceKeys;
-              displayChoice.text = resolveChoiceText(choice, switchOnceKeys);
-              displayChoice.execStr = replaceVariables(choice.evalStr);
+              resolveChoiceText(choice, switchOnceKeys, displayChoice.text);
+              if (choice.eval.compiled) {
+                displayChoice.exec = &choice.eval;
+              } else {
+                displayChoice.execStr = replaceVariables(choice.evalStr);
+              }
               displayChoice.next = choice.next;
               displayChoice.onceKeysToCommit = obj.onceKeysToCommit;
               for (const auto& key : switchOnceKeys) {
@@ -331,7 +306,7 @@ void SpecialEventRunner::advance(const bmin::String& nodeId,
         } else if constexpr (std::is_same_v<T, model::GameEventChildSwitch>) {
           bool found = false;
           for (const auto& c : node.cases) {
-            ConditionResult obj = evalCondition(replaceVariables(c.conditionStr));
+            ConditionResult obj = evalCondition(c.condition, c.conditionStr);
             if (obj.result) {
               advance(c.next, obj.onceKeysToCommit, "");
               found = true;
@@ -348,8 +323,8 @@ void SpecialEventRunner::advance(const bmin::String& nodeId,
             displayTextChoices.clear();
             autoAdvancedText.clear();
           } else {
-            displayText = joinDisplaySegments(autoAdvancedText, "End.");
-            autoAdvancedText.clear();
+            static const bmin::String endText = "End.";
+            flushDisplayText(endText);
           }
         }
       },
@@ -357,19 +332,10 @@ void SpecialEventRunner::advance(const bmin::String& nodeId,
 }
 
 bmin::String SpecialEventRunner::storageToString() const {
-  bmin::DynArray<std::pair<bmin::String, bmin::String>> pairs;
-  pairs.reserve(storage.size());
-  auto& mutableStorage = const_cast<bmin::Map<bmin::String, bmin::String>&>(storage);
-  for (auto it = mutableStorage.begin(); it != mutableStorage.end(); ++it) {
-    pairs.emplaceBack(it->key, it->value);
-  }
-
-  std::sort(pairs.begin(), pairs.end(),
-            [](const auto& a, const auto& b) { return a.first < b.first; });
-
   bmin::String result;
-  for (const auto& [key, value] : pairs) {
-    result += key + "=" + value + "\n";
+  for (const auto* entry : model::eventStorageSortedEntries(storage)) {
+    result += model::getStorageKeyName(entry->key) + "=" +
+              model::storageValueToText(entry->value) + "\n";
   }
   return result;
 }
@@ -396,7 +362,7 @@ void SpecialEventRunnerInterface::selectChoice(int choiceIndex) {
   }
   const auto choice = runner.displayTextChoices[choiceIndex];
   runner.markChoiceChosen(choice.choiceKey);
-  runner.advance(choice.next, choice.onceKeysToCommit, choice.execStr);
+  runner.advance(choice.next, choice.onceKeysToCommit, choice.exec, choice.execStr);
 }
 
 SpecialEventRunnerInterfaceState SpecialEventRunnerInterface::getState() {
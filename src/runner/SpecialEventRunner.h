@@ -5,8 +5,6 @@
 #include "lib/bmin/Map.h"
 #include "model/templates/SpecialEvents.h"
 
-#include <optional>
-
 namespace runner {
 
 struct ConditionResult {
@@ -15,6 +13,9 @@ struct ConditionResult {
 };
 
 struct DisplayTextChoice {
+  // Compiled evalStr of the authored choice; null for uncompiled events, which carry
+  // the variable-replaced source in execStr instead.
+  const model::ScriptProgram* exec = nullptr;
   bmin::String execStr;
   bmin::String text;
   bmin::String prefix;
@@ -31,9 +32,11 @@ struct ErrorInfo {
 
 class SpecialEventRunner {
 public:
-  bmin::Map<bmin::String, bmin::String> storage;
-  model::GameEvent gameEvent;
-  bmin::Map<bmin::String, model::GameEvent> gameEvents;
+  // Working copy; callers persist it when the conversation ends.
+  model::EventStorage storage;
+  // Borrowed from the Database (or test fixture); must outlive the runner.
+  const model::GameEvent& gameEvent;
+  const bmin::Map<bmin::String, model::GameEvent>& gameEvents;
   bmin::String currentNodeId;
 
   bmin::String displayText;
@@ -42,12 +45,21 @@ public:
   // Choice keys selected earlier in this conversation (for dimming repeats).
   bmin::DynArray<bmin::String> chosenChoiceKeys;
 
-  SpecialEventRunner(const bmin::Map<bmin::String, bmin::String>& initialStorage,
+  SpecialEventRunner(const model::EventStorage& initialStorage,
                      const model::GameEvent& gameEvent,
                      const bmin::Map<bmin::String, model::GameEvent>& gameEvents);
+  // gameEvent and gameEvents are borrowed, so temporaries would dangle.
+  SpecialEventRunner(const model::EventStorage& initialStorage,
+                     model::GameEvent&& gameEvent,
+                     const bmin::Map<bmin::String, model::GameEvent>& gameEvents) =
+      delete;
+  SpecialEventRunner(const model::EventStorage& initialStorage,
+                     const model::GameEvent& gameEvent,
+                     bmin::Map<bmin::String, model::GameEvent>&& gameEvents) = delete;
 
   void reset();
-  std::optional<model::GameEventChild> getCurrentNode() const;
+  // Points into gameEvent.children; nullptr when currentNodeId names no child.
+  const model::GameEventChild* getCurrentNode() const;
   bmin::String getNextNodeId();
   bmin::String replaceVariables(const bmin::String& text);
   bool evalExecStr(const bmin::String& str);
@@ -56,6 +68,11 @@ public:
   void advance(const bmin::String& nodeId,
                const bmin::DynArray<bmin::String>& onceKeysToCommit = {},
                const bmin::String& execStr = "");
+  // Runs exec when compiled, otherwise execStr.
+  void advance(const bmin::String& nodeId,
+               const bmin::DynArray<bmin::String>& onceKeysToCommit,
+               const model::ScriptProgram* exec,
+               const bmin::String& execStr);
   bmin::String storageToString() const;
   bool wasChoiceChosen(const bmin::String& choiceKey) const;
   void markChoiceChosen(const bmin::String& choiceKey);
@@ -64,13 +81,26 @@ public:
 private:
   // EXEC text queued while auto-advancing; flushed into displayText at the next stop.
   bmin::String autoAdvancedText;
+  // Scratch for the current node's text, reused across advances.
+  bmin::String textBuffer;
 
   bmin::DynArray<model::Variable> getVarsFromNode();
-  bmin::String joinParagraphs(const bmin::DynArray<bmin::String>& paragraphs);
-  bmin::String resolveChoiceText(const model::Choice& choice,
-                                 bmin::DynArray<bmin::String>& onceKeysToCommit);
-  static bmin::String joinDisplaySegments(const bmin::String& earlier,
-                                          const bmin::String& later);
+  // Compiled scripts from LoadSpecialEvents; the source string is the fallback for
+  // events that were never compiled.
+  ConditionResult evalCondition(const model::ScriptProgram& program,
+                                const bmin::String& conditionStr);
+  void runExec(const model::ScriptProgram* program, const bmin::String& execStr);
+  // Writes text into out from its compiled template, or from source when uncompiled.
+  void renderText(const model::TextTemplate& text,
+                  const bmin::String& source,
+                  bmin::String& out);
+  void resolveChoiceText(const model::Choice& choice,
+                         bmin::DynArray<bmin::String>& onceKeysToCommit,
+                         bmin::String& out);
+  // Appends segment to out, separated by a blank line when both are non-empty.
+  static void appendDisplaySegment(bmin::String& out, const bmin::String& segment);
+  // Sets displayText to the queued auto-advanced text followed by segment.
+  void flushDisplayText(const bmin::String& segment);
 };
 
 enum class SpecialEventRunnerInterfaceState {
@@ -1,28 +1,11 @@
 #include "StringEvaluator.h"
 #include "EventRunnerHelpers.h"
-#include <cmath>
+#include "ScriptCompiler.h"
 #include <stdexcept>
 
 namespace runner {
 
-// Helper function to format number as string: integer if no decimal, otherwise keep decimals
-static bmin::String formatNumber(double n) {
-  double intPart;
-  if (std::modf(n, &intPart) == 0.0) {
-    return bmin::toString(static_cast<int>(n));
-  }
-
-  bmin::String result = bmin::toString(n);
-  while (!result.empty() && result[result.size() - 1] == '0') {
-    result.erase(result.size() - 1, 1);
-  }
-  if (!result.empty() && result[result.size() - 1] == '.') {
-    result.erase(result.size() - 1, 1);
-  }
-  return result;
-}
-
-StringEvaluatorFuncs::StringEvaluatorFuncs(bmin::Map<bmin::String, bmin::String>& storage)
+StringEvaluatorFuncs::StringEvaluatorFuncs(model::EventStorage& storage)
     : storage(storage) {}
 
 bmin::String StringEvaluatorFuncs::GET(const bmin::String& a) {
@@ -30,44 +13,24 @@ bmin::String StringEvaluatorFuncs::GET(const bmin::String& a) {
   return v.value_or("");
 }
 
-void StringEvaluatorFuncs::SET_BOOL(const bmin::String& a, const bmin::String& b) {
-  bool v = true;
-  if (b == "true") {
-    v = true;
-  } else if (b == "false") {
-    v = false;
-  } else {
-    v = true;
-  }
-  setStorage(storage, a, v ? "true" : "false");
-}
-
-void StringEvaluatorFuncs::SET_NUM(const bmin::String& a, const bmin::String& b) {
-  if (!bmin::isDouble(b)) {
-    throw std::runtime_error(("Invalid number value: " + b).cStr());
-  }
-  const double n = bmin::parseDouble(b);
-  setStorage(storage, a, formatNumber(n));
+void StringEvaluatorFuncs::STORE(const model::ScriptConstant& key,
+                                 const model::ScriptConstant& value) {
+  model::eventStorageSet(storage, key.key, value.value);
 }
 
-void StringEvaluatorFuncs::MOD_NUM(const bmin::String& a, const bmin::String& b) {
-  if (!bmin::isDouble(b)) {
-    throw std::runtime_error(("Invalid number value: " + b).cStr());
-  }
-  const double n = bmin::parseDouble(b);
-  auto current = getStorage(storage, a);
+void StringEvaluatorFuncs::MOD_NUM(const model::ScriptConstant& key,
+                                   const model::ScriptConstant& delta) {
+  const auto* current = model::eventStorageGet(storage, key.key);
   double currentN = 0.0;
   if (current) {
-    if (!bmin::isDouble(*current)) {
-      throw std::runtime_error(("Variable " + a + " is not a number").cStr());
+    const auto number = model::storageValueToNumber(*current);
+    if (!number) {
+      throw std::runtime_error(("Variable " + key.text + " is not a number").cStr());
     }
-    currentN = bmin::parseDouble(*current);
+    currentN = *number;
   }
-  setStorage(storage, a, formatNumber(currentN + n));
-}
-
-void StringEvaluatorFuncs::SET_STR(const bmin::String& a, const bmin::String& b) {
-  setStorage(storage, a, b);
+  model::eventStorageSet(
+      storage, key.key, model::storageValueFromNumber(currentN + delta.number));
 }
 
 void StringEvaluatorFuncs::SETUP_DISPOSITION(const bmin::String& characterName) {
@@ -127,79 +90,88 @@ void StringEvaluatorFuncs::OPEN_SHOP(const bmin::String& shopName) {
   // noop
 }
 
-StringEvaluator::StringEvaluator(bmin::Map<bmin::String, bmin::String>& storage,
+StringEvaluator::StringEvaluator(model::EventStorage& storage,
                                  const bmin::String& baseStringStr)
     : baseStringStr(baseStringStr), funcs(storage) {}
 
-void StringEvaluator::assertFuncArgs(const bmin::String& funcName,
-                                     const bmin::DynArray<bmin::String>& funcArgs,
-                                     size_t expectedArgs) {
-  if (funcArgs.size() != expectedArgs) {
-    throw std::runtime_error(
-        ("Invalid number of arguments for function '" + funcName + "'. Expected " +
-         bmin::toString(expectedArgs) + ", got " + bmin::toString(funcArgs.size()))
-            .cStr());
+void StringEvaluator::evalStr(const bmin::String& str) {
+  if (!isFunctionCall(str)) {
+    throw std::runtime_error(("Invalid eval string: " + baseStringStr).cStr());
+  }
+  bmin::DynArray<bmin::String> errors;
+  evalProgram(compileExec(str, errors), errors);
+  if (!errors.empty()) {
+    throw std::runtime_error(errors[0].cStr());
   }
 }
 
-void StringEvaluator::evalStr(const bmin::String& str) {
-  if (isFunctionCall(str)) {
-    FunctionCall call = parseFunctionCall(str);
-    if (call.funcName == "GET") {
-      assertFuncArgs(call.funcName, call.args, 1);
-      strResult = funcs.GET(call.args[0]);
-    } else if (call.funcName == "SET_BOOL") {
-      if (call.args.size() == 1) {
-        funcs.SET_BOOL(call.args[0], "true");
-      } else {
-        assertFuncArgs(call.funcName, call.args, 2);
-        funcs.SET_BOOL(call.args[0], call.args[1]);
+void StringEvaluator::evalProgram(const model::ScriptProgram& program,
+                                  bmin::DynArray<bmin::String>& errors) {
+  using model::ScriptOp;
+  const auto& constants = program.constants;
+  uint16_t stack[SCRIPT_MAX_STACK];
+  int sp = 0;
+
+  for (const auto& instruction : program.code) {
+    if (instruction.op == ScriptOp::PUSH) {
+      stack[sp++] = instruction.operand;
+      continue;
+    }
+    sp -= instruction.argCount;
+    auto arg = [&](int i) -> const model::ScriptConstant& {
+      return constants[stack[sp + i]];
+    };
+
+    // Each call ends a statement; a failing statement does not stop the ones after it.
+    try {
+      switch (instruction.op) {
+      case ScriptOp::FAIL:
+        throw std::runtime_error(constants[instruction.operand].text.cStr());
+      case ScriptOp::GET:
+        strResult = funcs.GET(arg(0).text);
+        break;
+      case ScriptOp::STORE:
+        funcs.STORE(arg(0), arg(1));
+        break;
+      case ScriptOp::MOD_NUM:
+        funcs.MOD_NUM(arg(0), arg(1));
+        break;
+      case ScriptOp::SETUP_DISPOSITION:
+        funcs.SETUP_DISPOSITION(arg(0).text);
+        break;
+      case ScriptOp::START_QUEST:
+        funcs.START_QUEST(arg(0).text);
+        break;
+      case ScriptOp::COMPLETE_QUEST_STEP:
+        funcs.COMPLETE_QUEST_STEP(arg(0).text, arg(1).text);
+        break;
+      case ScriptOp::COMPLETE_QUEST:
+        funcs.COMPLETE_QUEST(arg(0).text);
+        break;
+      case ScriptOp::SPAWN_CH:
+        funcs.SPAWN_CH(arg(0).text);
+        break;
+      case ScriptOp::DESPAWN_CH:
+        funcs.DESPAWN_CH(arg(0).text);
+        break;
+      case ScriptOp::CHANGE_TILE_AT:
+        funcs.CHANGE_TILE_AT(arg(0).text, arg(1).text, arg(2).text);
+        break;
+      case ScriptOp::TELEPORT_TO:
+        funcs.TELEPORT_TO(arg(0).text, arg(1).text, arg(2).text);
+        break;
+      case ScriptOp::ADD_ITEM_AT:
+        funcs.ADD_ITEM_AT(arg(0).text, arg(1).text, arg(2).text);
+        break;
+      case ScriptOp::REMOVE_ITEM_AT:
+        funcs.REMOVE_ITEM_AT(arg(0).text, arg(1).text, arg(2).text);
+        break;
+      default:
+        throw std::runtime_error("Condition in an exec statement");
       }
-    } else if (call.funcName == "SET_NUM") {
-      assertFuncArgs(call.funcName, call.args, 2);
-      funcs.SET_NUM(call.args[0], call.args[1]);
-    } else if (call.funcName == "MOD_NUM") {
-      assertFuncArgs(call.funcName, call.args, 2);
-      funcs.MOD_NUM(call.args[0], call.args[1]);
-    } else if (call.funcName == "SET_STR") {
-      assertFuncArgs(call.funcName, call.args, 2);
-      funcs.SET_STR(call.args[0], call.args[1]);
-    } else if (call.funcName == "SETUP_DISPOSITION") {
-      assertFuncArgs(call.funcName, call.args, 1);
-      funcs.SETUP_DISPOSITION(call.args[0]);
-    } else if (call.funcName == "START_QUEST") {
-      assertFuncArgs(call.funcName, call.args, 1);
-      funcs.START_QUEST(call.args[0]);
-    } else if (call.funcName == "COMPLETE_QUEST_STEP") {
-      assertFuncArgs(call.funcName, call.args, 2);
-      funcs.COMPLETE_QUEST_STEP(call.args[0], call.args[1]);
-    } else if (call.funcName == "COMPLETE_QUEST") {
-      assertFuncArgs(call.funcName, call.args, 1);
-      funcs.COMPLETE_QUEST(call.args[0]);
-    } else if (call.funcName == "SPAWN_CH") {
-      assertFuncArgs(call.funcName, call.args, 1);
-      funcs.SPAWN_CH(call.args[0]);
-    } else if (call.funcName == "DESPAWN_CH") {
-      assertFuncArgs(call.funcName, call.args, 1);
-      funcs.DESPAWN_CH(call.args[0]);
-    } else if (call.funcName == "CHANGE_TILE_AT") {
-      assertFuncArgs(call.funcName, call.args, 3);
-      funcs.CHANGE_TILE_AT(call.args[0], call.args[1], call.args[2]);
-    } else if (call.funcName == "TELEPORT_TO") {
-      assertFuncArgs(call.funcName, call.args, 3);
-      funcs.TELEPORT_TO(call.args[0], call.args[1], call.args[2]);
-    } else if (call.funcName == "ADD_ITEM_AT") {
-      assertFuncArgs(call.funcName, call.args, 3);
-      funcs.ADD_ITEM_AT(call.args[0], call.args[1], call.args[2]);
-    } else if (call.funcName == "REMOVE_ITEM_AT") {
-      assertFuncArgs(call.funcName, call.args, 3);
-      funcs.REMOVE_ITEM_AT(call.args[0], call.args[1], call.args[2]);
-    } else {
-      throw std::runtime_error(
-          ("Function '" + call.funcName + "' not found: " + baseStringStr).cStr());
+    } catch (const std::exception& e) {
+      errors.pushBack(e.what());
     }
-  } else {
-    throw std::runtime_error(("Invalid eval string: " + baseStringStr).cStr());
   }
 }
 
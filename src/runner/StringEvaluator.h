@@ -3,19 +3,19 @@
 #include "bmin/DynArray.h"
 #include "bmin/String.h"
 #include "lib/bmin/Map.h"
+#include "model/templates/SpecialEvents.h"
 
 namespace runner {
 
 struct StringEvaluatorFuncs {
-  bmin::Map<bmin::String, bmin::String>& storage;
+  model::EventStorage& storage;
 
-  StringEvaluatorFuncs(bmin::Map<bmin::String, bmin::String>& storage);
+  StringEvaluatorFuncs(model::EventStorage& storage);
 
   bmin::String GET(const bmin::String& a);
-  void SET_BOOL(const bmin::String& a, const bmin::String& b);
-  void SET_NUM(const bmin::String& a, const bmin::String& b);
-  void MOD_NUM(const bmin::String& a, const bmin::String& b);
-  void SET_STR(const bmin::String& a, const bmin::String& b);
+  // SET_BOOL/SET_NUM/SET_STR; the value was formatted and typed at compile time.
+  void STORE(const model::ScriptConstant& key, const model::ScriptConstant& value);
+  void MOD_NUM(const model::ScriptConstant& key, const model::ScriptConstant& delta);
   void SETUP_DISPOSITION(const bmin::String& characterName);
   void START_QUEST(const bmin::String& questName);
   void COMPLETE_QUEST_STEP(const bmin::String& questName, const bmin::String& stepId);
@@ -37,13 +37,15 @@ public:
   StringEvaluatorFuncs funcs;
   bmin::String strResult;
 
-  StringEvaluator(bmin::Map<bmin::String, bmin::String>& storage,
-                  const bmin::String& baseStringStr);
+  StringEvaluator(model::EventStorage& storage,
+                  const bmin::String& baseStringStr = "");
 
-  void assertFuncArgs(const bmin::String& funcName,
-                      const bmin::DynArray<bmin::String>& funcArgs,
-                      size_t expectedArgs);
+  // Compiles and runs one statement; throws on compile or evaluation errors.
   void evalStr(const bmin::String& str);
+  // Runs a program from runner/ScriptCompiler.h. Errors are appended to errors and the
+  // remaining statements still run.
+  void evalProgram(const model::ScriptProgram& program,
+                   bmin::DynArray<bmin::String>& errors);
 };
 
 } // namespace runner
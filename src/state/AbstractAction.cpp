@@ -0,0 +1,11 @@
+#include "state/AbstractAction.h"
+#include "state/ActionBus.h"
+#include <typeinfo>
+
+namespace state {
+
+bmin::String AbstractAction::getName() const {
+  return ActionBus::getActionTypeName(ActionBus::getActionTypeId(typeid(*this)));
+}
+
+} // namespace state
@@ -3,11 +3,10 @@
 #include "bmin/UniquePtr.h"
 #include "sdl2w/Logger.h"
 #include "model/templates/UtilityTypes.h"
+#include "state/ActionPool.h"
 #include "state/DatabaseInterface.h"
 #include "state/LayerManagerInterface.h"
-#ifdef __GNUG__
-#include <cxxabi.h>
-#endif
+#include <cstddef>
 
 namespace state {
 
@@ -23,20 +22,16 @@ protected:
   };
 
 public:
-  virtual bmin::String getName() const {
-#ifdef __GNUG__
-    int status;
-    char* realname = abi::__cxa_demangle(typeid(*this).name(), 0, 0, &status);
-    bmin::String name = (status == 0) ? realname : typeid(*this).name();
-    free(realname);
-    return name;
-#else
-    return typeid(*this).name();
-#endif
-  }
+  // Demangled class name, from the ActionBus type registry.
+  virtual bmin::String getName() const;
 
   void setState(State* state) { this->state = state; }
 
+  // Every `new SomeAction(...)` goes through ActionPool; the virtual destructor
+  // hands the most-derived size back to operator delete.
+  static void* operator new(size_t size) { return ActionPool::allocate(size); }
+  static void operator delete(void* ptr, size_t size) { ActionPool::release(ptr, size); }
+
   void execute(State* state) {
     this->state = state;
     // LOG(INFO) << "Executing action: " << getName() << LOG_ENDL;
@@ -46,6 +41,8 @@ public:
   virtual ~AbstractAction() = default;
 };
 
+// Queue entry. Held by value in ActionData, so a delay-only entry (action ==
+// nullptr) needs no heap allocation.
 struct AsyncAction {
   bmin::UniquePtr<state::AbstractAction> action;
   model::TimerStruct timer;
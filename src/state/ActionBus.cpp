@@ -1,29 +1,210 @@
 #include "state/ActionBus.h"
 #include "state/AbstractAction.h"
+#include "bmin/UniquePtr.h"
+#include <cstdlib>
+#include <mutex>
+#ifdef __GNUG__
+#include <cxxabi.h>
+#endif
 
 namespace state {
 
-void ActionBus::subscribe(void* owner,
-                           std::type_index actionType,
-                           std::function<void(AbstractAction&, State&)> handler) {
-  entries.pushBack(Entry{
-      .owner = owner,
-      .actionType = actionType,
+namespace {
+
+struct ActionTypeRecord {
+  std::type_index type;
+  bmin::String name;
+};
+
+struct ActionTypeRegistry {
+  std::mutex mutex;
+  // Records are individually allocated so returned names stay valid as it grows.
+  bmin::DynArray<bmin::UniquePtr<ActionTypeRecord>> records;
+  // std::type_index::hash_code() -> index into records; verified on lookup.
+  bmin::Map<size_t, ActionBus::ActionTypeId> idsByHash;
+};
+
+ActionTypeRegistry& getActionTypeRegistry() {
+  static ActionTypeRegistry registry;
+  return registry;
+}
+
+struct CachedActionType {
+  const std::type_info* type = nullptr;
+  ActionBus::ActionTypeId id = 0;
+};
+
+bmin::String demangle(const std::type_info& type) {
+#ifdef __GNUG__
+  int status;
+  char* realname = abi::__cxa_demangle(type.name(), 0, 0, &status);
+  bmin::String name = (status == 0) ? realname : type.name();
+  free(realname);
+  return name;
+#else
+  return type.name();
+#endif
+}
+
+// Ids this thread has already resolved, by hash_code(), so notify() takes no lock.
+thread_local bmin::Map<size_t, CachedActionType> cachedActionTypes;
+
+} // namespace
+
+ActionBus::ActionTypeId ActionBus::getActionTypeId(const std::type_info& actionType) {
+  const size_t hash = actionType.hash_code();
+  auto it = cachedActionTypes.find(hash);
+  if (it != cachedActionTypes.end() && *(*it).value.type == actionType) {
+    return (*it).value.id;
+  }
+  const ActionTypeId id = registerActionType(actionType);
+  if (it == cachedActionTypes.end()) {
+    cachedActionTypes.insert(hash, CachedActionType{&actionType, id});
+  }
+  return id;
+}
+
+const bmin::String& ActionBus::getActionTypeName(ActionTypeId actionTypeId) {
+  auto& registry = getActionTypeRegistry();
+  const std::lock_guard<std::mutex> lock(registry.mutex);
+  return registry.records[actionTypeId]->name;
+}
+
+ActionBus::ActionTypeId ActionBus::registerActionType(const std::type_info& actionType) {
+  auto& registry = getActionTypeRegistry();
+  const std::lock_guard<std::mutex> lock(registry.mutex);
+  const auto typeIndex = std::type_index(actionType);
+  auto it = registry.idsByHash.find(typeIndex.hash_code());
+  if (it != registry.idsByHash.end() &&
+      registry.records[(*it).value]->type == typeIndex) {
+    return (*it).value;
+  }
+  // Unseen class, or a hash_code collision: a scan of the (small) registry keeps
+  // the result exact.
+  for (size_t i = 0; i < registry.records.size(); i++) {
+    if (registry.records[i]->type == typeIndex) {
+      return i;
+    }
+  }
+  const ActionTypeId id = registry.records.size();
+  registry.records.pushBack(bmin::makeUnique<ActionTypeRecord>(
+      ActionTypeRecord{typeIndex, demangle(actionType)}));
+  if (it == registry.idsByHash.end()) {
+    registry.idsByHash.insert(typeIndex.hash_code(), id);
+  }
+  return id;
+}
+
+uint32_t ActionBus::getOrCreateSubscriberId(void* owner) {
+  const auto key = reinterpret_cast<uintptr_t>(owner);
+  auto it = ownerSubscriberIds.find(key);
+  if (it != ownerSubscriberIds.end()) {
+    return (*it).value;
+  }
+  const auto subscriberId = static_cast<uint32_t>(subscriberAlive.size());
+  subscriberAlive.pushBack(1);
+  ownerSubscriberIds.insert(key, subscriberId);
+  return subscriberId;
+}
+
+void ActionBus::addHandler(void* owner, ActionTypeId actionTypeId, Handler handler) {
+  Entry entry{
+      .subscriberId = getOrCreateSubscriberId(owner),
       .handler = std::move(handler),
-  });
+  };
+  if (dispatchDepth > 0) {
+    pendingEntries.pushBack(PendingEntry{
+        .actionTypeId = actionTypeId,
+        .entry = std::move(entry),
+    });
+    return;
+  }
+  insertEntry(actionTypeId, std::move(entry));
+}
+
+void ActionBus::insertEntry(ActionTypeId actionTypeId, Entry entry) {
+  if (actionTypeId >= buckets.size()) {
+    buckets.resize(actionTypeId + 1);
+  }
+  buckets[actionTypeId].entries.pushBack(std::move(entry));
 }
 
 void ActionBus::unsubscribe(void* owner) {
-  entries.eraseIf([owner](const Entry& entry) { return entry.owner == owner; });
+  const auto key = reinterpret_cast<uintptr_t>(owner);
+  auto it = ownerSubscriberIds.find(key);
+  if (it == ownerSubscriberIds.end()) {
+    return;
+  }
+  subscriberAlive[(*it).value] = 0;
+  ownerSubscriberIds.erase(key);
+  unsubscribeGeneration++;
+}
+
+void ActionBus::sweepBucket(Bucket& bucket) {
+  if (bucket.sweptGeneration == unsubscribeGeneration) {
+    return;
+  }
+  bucket.entries.eraseIf(
+      [this](const Entry& entry) { return !subscriberAlive[entry.subscriberId]; });
+  bucket.sweptGeneration = unsubscribeGeneration;
+}
+
+void ActionBus::flushPendingEntries() {
+  if (pendingEntries.empty()) {
+    return;
+  }
+  auto pending = std::move(pendingEntries);
+  pendingEntries.clear();
+  for (auto& pendingEntry : pending) {
+    if (subscriberAlive[pendingEntry.entry.subscriberId]) {
+      insertEntry(pendingEntry.actionTypeId, std::move(pendingEntry.entry));
+    }
+  }
 }
 
-void ActionBus::notify(AbstractAction& action, State& state) {
-  const std::type_index actionType = std::type_index(typeid(action));
-  for (const auto& entry : entries) {
-    if (entry.actionType == actionType) {
+size_t ActionBus::notify(AbstractAction& action, State& state) {
+  const ActionTypeId actionTypeId = getActionTypeId(typeid(action));
+  if (actionTypeId >= buckets.size()) {
+    // Nobody has ever subscribed to this action class.
+    return 0;
+  }
+
+  if (dispatchDepth == 0) {
+    sweepBucket(buckets[actionTypeId]);
+  }
+
+  dispatchDepth++;
+  // Handlers may unsubscribe (tombstone only) or subscribe (deferred), so the
+  // bucket does not change size or move while it is being walked.
+  const auto& entries = buckets[actionTypeId].entries;
+  const size_t numEntries = entries.size();
+  size_t numInvoked = 0;
+  for (size_t i = 0; i < numEntries; i++) {
+    const auto& entry = entries[i];
+    if (subscriberAlive[entry.subscriberId]) {
       entry.handler(action, state);
+      numInvoked++;
+    }
+  }
+  dispatchDepth--;
+
+  if (dispatchDepth == 0) {
+    flushPendingEntries();
+  }
+  return numInvoked;
+}
+
+size_t ActionBus::getNumHandlers(ActionTypeId actionTypeId) const {
+  if (actionTypeId >= buckets.size()) {
+    return 0;
+  }
+  size_t count = 0;
+  for (const auto& entry : buckets[actionTypeId].entries) {
+    if (subscriberAlive[entry.subscriberId]) {
+      count++;
     }
   }
+  return count;
 }
 
 } // namespace state
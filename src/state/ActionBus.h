@@ -1,30 +1,93 @@
 #pragma once
 
 #include "bmin/DynArray.h"
+#include "bmin/Map.h"
+#include "bmin/String.h"
 #include "state/State.h"
+#include <cstddef>
+#include <cstdint>
 #include <functional>
 #include <typeindex>
+#include <typeinfo>
+#include <utility>
 
 namespace state {
 
 class AbstractAction;
 
+// Dispatch table of action observers. Each action class gets a dense type id the
+// first time it is seen (subscribed to or notified), and handlers live in one
+// contiguous bucket per id. notify() resolves the executed action's id once and only
+// walks that bucket, so the cost scales with interested subscribers.
+//
+// Buckets match the exact dynamic type (same as typeid equality), which is what
+// lets typed handlers static_cast instead of dynamic_cast.
 class ActionBus {
+public:
+  using ActionTypeId = size_t;
+  using Handler = std::function<void(AbstractAction&, State&)>;
+
+  template <typename ActionT> static ActionTypeId getActionTypeId() {
+    static const ActionTypeId id = getActionTypeId(typeid(ActionT));
+    return id;
+  }
+  // Assigns the next id to a class on first sight. Thread safe: ids never change, so
+  // each thread caches the ones it has resolved and only locks for unseen classes.
+  static ActionTypeId getActionTypeId(const std::type_info& actionType);
+  // Demangled class name for an id, computed once per class. Thread safe.
+  static const bmin::String& getActionTypeName(ActionTypeId actionTypeId);
+
+  template <typename ActionT, typename Fn> void subscribe(void* owner, Fn&& fn) {
+    addHandler(owner,
+               getActionTypeId<ActionT>(),
+               [fn = std::forward<Fn>(fn)](AbstractAction& action, State& state) {
+                 fn(static_cast<ActionT&>(action), state);
+               });
+  }
+
+  // O(1): the owner's handlers are tombstoned and swept from each bucket the next
+  // time that bucket is notified. Safe to call from inside a handler.
+  void unsubscribe(void* owner);
+  // Returns the number of handlers invoked.
+  size_t notify(AbstractAction& action, State& state);
+
+  size_t getNumHandlers(ActionTypeId actionTypeId) const;
+
+private:
+  static constexpr uint32_t NO_SUBSCRIBER = UINT32_MAX;
+
   struct Entry {
-    void* owner = nullptr;
-    std::type_index actionType{typeid(void)};
-    std::function<void(AbstractAction&, State&)> handler;
+    uint32_t subscriberId = NO_SUBSCRIBER;
+    Handler handler;
   };
 
-  bmin::DynArray<Entry> entries;
+  struct Bucket {
+    bmin::DynArray<Entry> entries;
+    uint64_t sweptGeneration = 0;
+  };
 
-public:
-  void subscribe(void* owner,
-                 std::type_index actionType,
-                 std::function<void(AbstractAction&, State&)> handler);
+  struct PendingEntry {
+    ActionTypeId actionTypeId = 0;
+    Entry entry;
+  };
 
-  void unsubscribe(void* owner);
-  void notify(AbstractAction& action, State& state);
+  bmin::DynArray<Bucket> buckets;
+  // owner address -> subscriberId; ids are never reused, so a stale id is dead.
+  bmin::Map<uintptr_t, uint32_t> ownerSubscriberIds;
+  bmin::DynArray<uint8_t> subscriberAlive;
+  uint64_t unsubscribeGeneration = 0;
+  // Subscriptions made while handlers run are applied after dispatch so bucket
+  // storage never moves under an executing handler.
+  bmin::DynArray<PendingEntry> pendingEntries;
+  int dispatchDepth = 0;
+
+  static ActionTypeId registerActionType(const std::type_info& actionType);
+
+  uint32_t getOrCreateSubscriberId(void* owner);
+  void addHandler(void* owner, ActionTypeId actionTypeId, Handler handler);
+  void insertEntry(ActionTypeId actionTypeId, Entry entry);
+  void sweepBucket(Bucket& bucket);
+  void flushPendingEntries();
 };
 
 } // namespace state
@@ -0,0 +1,79 @@
+#include "state/ActionPool.h"
+#include <array>
+#include <new>
+
+namespace state {
+
+namespace {
+
+struct FreeBlock {
+  FreeBlock* next;
+};
+
+struct ThreadFreeLists {
+  std::array<FreeBlock*, ActionPool::NUM_SIZE_CLASSES> heads{};
+  ActionPoolStats stats;
+
+  ~ThreadFreeLists() {
+    for (auto* head : heads) {
+      while (head != nullptr) {
+        auto* next = head->next;
+        ::operator delete(static_cast<void*>(head));
+        head = next;
+      }
+    }
+  }
+};
+
+ThreadFreeLists& getFreeLists() {
+  thread_local ThreadFreeLists freeLists;
+  return freeLists;
+}
+
+size_t getSizeClass(size_t size) {
+  return (size + ActionPool::GRANULE - 1) / ActionPool::GRANULE - 1;
+}
+
+} // namespace
+
+void* ActionPool::allocate(size_t size) {
+  auto& freeLists = getFreeLists();
+  if (size == 0 || size > MAX_POOLED_SIZE) {
+    freeLists.stats.heapAllocations++;
+    return ::operator new(size);
+  }
+
+  const auto sizeClass = getSizeClass(size);
+  auto*& head = freeLists.heads[sizeClass];
+  if (head != nullptr) {
+    auto* block = head;
+    head = block->next;
+    freeLists.stats.pooledAllocations++;
+    return block;
+  }
+  freeLists.stats.heapAllocations++;
+  // Round up so any request in this class can reuse the block later.
+  return ::operator new((sizeClass + 1) * GRANULE);
+}
+
+void ActionPool::release(void* ptr, size_t size) {
+  if (ptr == nullptr) {
+    return;
+  }
+  auto& freeLists = getFreeLists();
+  freeLists.stats.releases++;
+  if (size == 0 || size > MAX_POOLED_SIZE) {
+    ::operator delete(ptr);
+    return;
+  }
+  auto* block = static_cast<FreeBlock*>(ptr);
+  auto*& head = freeLists.heads[getSizeClass(size)];
+  block->next = head;
+  head = block;
+}
+
+const ActionPoolStats& ActionPool::getStats() { return getFreeLists().stats; }
+
+void ActionPool::resetStats() { getFreeLists().stats = ActionPoolStats{}; }
+
+} // namespace state
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace state {
+
+struct ActionPoolStats {
+  // Blocks served from a free list vs. fetched from the general heap.
+  uint64_t pooledAllocations = 0;
+  uint64_t heapAllocations = 0;
+  uint64_t releases = 0;
+};
+
+// Size-class free lists backing AbstractAction::operator new/delete. Actions are
+// small, short-lived and created in bursts (a melee swing queues ~8), so after the
+// first combat turn their storage is recycled instead of hitting malloc each time.
+// Free lists are per thread; a block freed on another thread simply joins that
+// thread's list.
+class ActionPool {
+public:
+  static constexpr size_t GRANULE = 16;
+  static constexpr size_t MAX_POOLED_SIZE = 512;
+  static constexpr size_t NUM_SIZE_CLASSES = MAX_POOLED_SIZE / GRANULE;
+
+  static void* allocate(size_t size);
+  static void release(void* ptr, size_t size);
+
+  // Counters for the calling thread.
+  static const ActionPoolStats& getStats();
+  static void resetStats();
+};
+
+} // namespace state
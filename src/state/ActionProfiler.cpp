@@ -0,0 +1,167 @@
+#include "state/ActionProfiler.h"
+#include "bmin/StringInterop.h"
+#include "lib/Profiling.h"
+#include "sdl2w/AssetLoader.h"
+#include "sdl2w/Logger.h"
+#include <algorithm>
+
+namespace state {
+
+void ActionProfiler::setEnabled(bool _enabled) {
+  if (_enabled && !enabled && originNs == 0) {
+    originNs = profiling::nowNs();
+  }
+  enabled = _enabled;
+}
+
+void ActionProfiler::reset() {
+  entries.clear();
+  queueDepths = ActionQueueDepthStats{};
+  traceEvents.clear();
+  originNs = enabled ? profiling::nowNs() : 0;
+}
+
+void ActionProfiler::pushTraceEvent(const TraceEvent& event) {
+  if (traceEvents.size() < MAX_TRACE_EVENTS) {
+    traceEvents.pushBack(event);
+  }
+}
+
+void ActionProfiler::recordAction(ActionBus::ActionTypeId actionTypeId,
+                                  uint64_t startNs,
+                                  uint64_t executedNs,
+                                  uint64_t notifiedNs,
+                                  size_t handlersInvoked) {
+  if (actionTypeId >= entries.size()) {
+    entries.resize(actionTypeId + 1);
+  }
+  auto& entry = entries[actionTypeId];
+  entry.actionTypeId = actionTypeId;
+  const uint64_t executeNs = executedNs - startNs;
+  const uint64_t notifyNs = notifiedNs - executedNs;
+  entry.executeCount++;
+  entry.executeNs += executeNs;
+  entry.executeMaxNs = std::max(entry.executeMaxNs, executeNs);
+  entry.notifyNs += notifyNs;
+  entry.notifyMaxNs = std::max(entry.notifyMaxNs, notifyNs);
+  entry.handlersInvoked += handlersInvoked;
+
+  const auto typeValue = static_cast<uint32_t>(actionTypeId);
+  pushTraceEvent(TraceEvent{TraceEventType::EXECUTE, typeValue, 0, startNs, executeNs});
+  if (handlersInvoked > 0) {
+    pushTraceEvent(
+        TraceEvent{TraceEventType::NOTIFY, typeValue, 0, executedNs, notifyNs});
+  }
+}
+
+void ActionProfiler::recordQueueDepths(size_t sequentialDepth, size_t parallelDepth) {
+  queueDepths.samples++;
+  queueDepths.sequentialSum += sequentialDepth;
+  queueDepths.parallelSum += parallelDepth;
+  queueDepths.sequentialMax = std::max(queueDepths.sequentialMax, sequentialDepth);
+  queueDepths.parallelMax = std::max(queueDepths.parallelMax, parallelDepth);
+  pushTraceEvent(TraceEvent{TraceEventType::QUEUES,
+                            static_cast<uint32_t>(sequentialDepth),
+                            static_cast<uint32_t>(parallelDepth),
+                            profiling::nowNs(),
+                            0});
+}
+
+bmin::DynArray<ActionProfileEntry> ActionProfiler::getSortedEntries() const {
+  bmin::DynArray<ActionProfileEntry> sorted;
+  for (const auto& entry : entries) {
+    if (entry.executeCount > 0) {
+      sorted.pushBack(entry);
+    }
+  }
+  std::sort(sorted.begin(),
+            sorted.end(),
+            [](const ActionProfileEntry& a, const ActionProfileEntry& b) {
+              return a.totalNs() > b.totalNs();
+            });
+  return sorted;
+}
+
+bmin::String ActionProfiler::formatReport() const {
+  const auto sorted = getSortedEntries();
+  size_t nameWidth = 6;
+  for (const auto& entry : sorted) {
+    nameWidth =
+        std::max(nameWidth, ActionBus::getActionTypeName(entry.actionTypeId).size());
+  }
+
+  bmin::String out;
+  profiling::appendPadded(out, "action", nameWidth);
+  out += "calls    exec_us   exec_max  notify_us  notify_max  handlers\n";
+  for (const auto& entry : sorted) {
+    profiling::appendPadded(
+        out, ActionBus::getActionTypeName(entry.actionTypeId), nameWidth);
+    profiling::appendPadded(out, bmin::toString(entry.executeCount), 8);
+    profiling::appendPadded(out, profiling::formatMicros(entry.executeNs), 9);
+    profiling::appendPadded(out, profiling::formatMicros(entry.executeMaxNs), 9);
+    profiling::appendPadded(out, profiling::formatMicros(entry.notifyNs), 10);
+    profiling::appendPadded(out, profiling::formatMicros(entry.notifyMaxNs), 11);
+    out += bmin::toString(entry.handlersInvoked);
+    out += '\n';
+  }
+
+  if (queueDepths.samples > 0) {
+    out += "queue depth (mean/max): sequential ";
+    out += bmin::toString(queueDepths.sequentialSum / queueDepths.samples);
+    out += '/';
+    out += bmin::toString(queueDepths.sequentialMax);
+    out += ", parallel ";
+    out += bmin::toString(queueDepths.parallelSum / queueDepths.samples);
+    out += '/';
+    out += bmin::toString(queueDepths.parallelMax);
+    out += " over ";
+    out += bmin::toString(queueDepths.samples);
+    out += " updates\n";
+  }
+  return out;
+}
+
+void ActionProfiler::logReport() const {
+  LOG(INFO) << "ActionProfiler report:\n" << formatReport() << LOG_ENDL;
+}
+
+bmin::String ActionProfiler::formatChromeTrace() const {
+  bmin::String out("{\"traceEvents\":[");
+  bool first = true;
+  for (const auto& event : traceEvents) {
+    if (!first) {
+      out += ",\n";
+    }
+    first = false;
+    const uint64_t startNs = event.startNs >= originNs ? event.startNs - originNs : 0;
+    if (event.type == TraceEventType::QUEUES) {
+      out += "{\"name\":\"queues\",\"ph\":\"C\",\"pid\":1,\"tid\":1,\"ts\":";
+      out += profiling::formatMicros(startNs);
+      out += ",\"args\":{\"sequential\":";
+      out += bmin::toString(event.value0);
+      out += ",\"parallel\":";
+      out += bmin::toString(event.value1);
+      out += "}}";
+      continue;
+    }
+    out += "{\"name\":";
+    profiling::appendJsonString(out, ActionBus::getActionTypeName(event.value0));
+    out += event.type == TraceEventType::EXECUTE ? ",\"cat\":\"execute\""
+                                                 : ",\"cat\":\"notify\"";
+    out += ",\"ph\":\"X\",\"pid\":1,\"tid\":1,\"ts\":";
+    out += profiling::formatMicros(startNs);
+    out += ",\"dur\":";
+    out += profiling::formatMicros(event.durationNs);
+    out += '}';
+  }
+  out += "]}\n";
+  return out;
+}
+
+void ActionProfiler::writeChromeTrace(std::string_view path) const {
+  sdl2w::saveFileAsString(path, bmin::toStringView(formatChromeTrace()));
+  LOG(INFO) << "ActionProfiler: wrote " << traceEvents.size() << " trace events to "
+            << path << LOG_ENDL;
+}
+
+} // namespace state
@@ -0,0 +1,86 @@
+#pragma once
+
+#include "bmin/DynArray.h"
+#include "bmin/String.h"
+#include "state/ActionBus.h"
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+namespace state {
+
+struct ActionProfileEntry {
+  ActionBus::ActionTypeId actionTypeId = 0;
+  uint64_t executeCount = 0;
+  uint64_t executeNs = 0;
+  uint64_t executeMaxNs = 0;
+  // ActionBus::notify fan-out for this action class.
+  uint64_t notifyNs = 0;
+  uint64_t notifyMaxNs = 0;
+  uint64_t handlersInvoked = 0;
+
+  uint64_t totalNs() const { return executeNs + notifyNs; }
+};
+
+struct ActionQueueDepthStats {
+  uint64_t samples = 0;
+  uint64_t sequentialSum = 0;
+  uint64_t parallelSum = 0;
+  size_t sequentialMax = 0;
+  size_t parallelMax = 0;
+};
+
+// Opt-in instrumentation for StateManager::update. While enabled, every executed
+// action records its execute() and ActionBus::notify() times under its dynamic
+// class, and each update samples the sequential/parallel queue depths. The
+// results can be read back as a table sorted by total time, or as Chrome trace
+// JSON (chrome://tracing, Perfetto) to see where a combat sequence hitches.
+class ActionProfiler {
+public:
+  // Trace recording stops (aggregates keep counting) after this many events.
+  static constexpr size_t MAX_TRACE_EVENTS = 200000;
+
+  void setEnabled(bool enabled);
+  bool isEnabled() const { return enabled; }
+  void reset();
+
+  void recordAction(ActionBus::ActionTypeId actionTypeId,
+                    uint64_t startNs,
+                    uint64_t executedNs,
+                    uint64_t notifiedNs,
+                    size_t handlersInvoked);
+  void recordQueueDepths(size_t sequentialDepth, size_t parallelDepth);
+
+  // Classes that have run at least once, most expensive (execute + notify) first.
+  bmin::DynArray<ActionProfileEntry> getSortedEntries() const;
+  const ActionQueueDepthStats& getQueueDepthStats() const { return queueDepths; }
+
+  bmin::String formatReport() const;
+  void logReport() const;
+  bmin::String formatChromeTrace() const;
+  void writeChromeTrace(std::string_view path) const;
+
+private:
+  enum class TraceEventType : uint8_t { EXECUTE, NOTIFY, QUEUES };
+
+  struct TraceEvent {
+    TraceEventType type = TraceEventType::EXECUTE;
+    // actionTypeId for EXECUTE/NOTIFY, sequential depth for QUEUES.
+    uint32_t value0 = 0;
+    // Unused for EXECUTE/NOTIFY, parallel depth for QUEUES.
+    uint32_t value1 = 0;
+    uint64_t startNs = 0;
+    uint64_t durationNs = 0;
+  };
+
+  bool enabled = false;
+  uint64_t originNs = 0;
+  // Indexed by ActionBus::ActionTypeId; executeCount == 0 marks classes not seen yet.
+  bmin::DynArray<ActionProfileEntry> entries;
+  ActionQueueDepthStats queueDepths;
+  bmin::DynArray<TraceEvent> traceEvents;
+
+  void pushTraceEvent(const TraceEvent& event);
+};
+
+} // namespace state
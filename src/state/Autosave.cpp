@@ -0,0 +1,174 @@
+#include "state/Autosave.h"
+#include "bmin/StringInterop.h"
+#include "game/save/SaveCompression.h"
+#include "game/save/SaveGame.h"
+#include "lib/Profiling.h"
+#include "state/StateManager.h"
+#include "state/actions/world/WorldAutosaveCompleted.hpp"
+#include <string_view>
+
+namespace state {
+
+namespace {
+
+double elapsedMsSince(uint64_t startNs) {
+  return static_cast<double>(profiling::nowNs() - startNs) / 1e6;
+}
+
+} // namespace
+
+Autosave::Autosave() = default;
+
+Autosave::~Autosave() {
+#ifndef __EMSCRIPTEN__
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    stopping = true;
+  }
+  wakeWorker.notify_all();
+  if (worker.joinable()) {
+    // Finishes the in-flight save first so the file is never left half replaced.
+    worker.join();
+  }
+#endif
+}
+
+void Autosave::setEnabled(bool _enabled) {
+  enabled = _enabled;
+  elapsedMs = 0;
+}
+
+void Autosave::setPath(const bmin::String& _path) { path = _path; }
+
+void Autosave::setIntervalMs(int _intervalMs) { intervalMs = _intervalMs; }
+
+void Autosave::request() { requested = true; }
+
+bool Autosave::isSafePoint(StateManager& stateManager) {
+  const auto& actions = stateManager.getActionData();
+  if (!actions.sequentialActions.empty() || !actions.sequentialActionsNext.empty() ||
+      !actions.insertActions.empty() || !actions.parallelActions.empty()) {
+    return false;
+  }
+  const auto& state = stateManager.getState();
+  return !state.world.activeMap.gridId.empty() && !state.world.combat.active &&
+         state.turnMode != model::TurnMode::TURN_COMBAT &&
+         !state.world.resolvingTownEnemyAi && !state.triggers.pendingSpecialEventId &&
+         !state.triggers.pendingTravel;
+}
+
+void Autosave::runJob(Job& job) {
+  const uint64_t startNs = profiling::nowNs();
+  auto& result = job.result;
+  try {
+    const auto raw = game::encodeSaveSnapshot(*job.snapshot);
+    result.rawBytes = raw.size();
+    const auto compressed = game::compressSaveData(
+        std::string_view(reinterpret_cast<const char*>(raw.data()), raw.size()));
+    result.fileBytes = compressed.size();
+    result.success = game::writeSaveFileAtomic(
+        bmin::toStringView(result.path), compressed, &result.error);
+  } catch (const std::exception& e) {
+    result.success = false;
+    result.error = e.what();
+  }
+  // The snapshot can be large; free it on this thread.
+  job.snapshot.reset();
+  result.writeMs = elapsedMsSince(startNs);
+}
+
+#ifndef __EMSCRIPTEN__
+void Autosave::workerLoop() {
+  std::unique_lock<std::mutex> lock(mutex);
+  while (true) {
+    wakeWorker.wait(lock, [this]() { return stopping || pendingJob.get() != nullptr; });
+    if (pendingJob.get() == nullptr) {
+      return;
+    }
+    auto job = std::move(pendingJob);
+    lock.unlock();
+    runJob(*job);
+    lock.lock();
+    completed.pushBack(std::move(job->result));
+    busy = false;
+    jobDone.notify_all();
+  }
+}
+#endif
+
+void Autosave::startJob(bmin::UniquePtr<Job> job) {
+#ifdef __EMSCRIPTEN__
+  runJob(*job);
+  completed.pushBack(std::move(job->result));
+#else
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    pendingJob = std::move(job);
+    busy = true;
+  }
+  if (!worker.joinable()) {
+    worker = std::thread([this]() { workerLoop(); });
+  }
+  wakeWorker.notify_one();
+#endif
+}
+
+bool Autosave::isBusy() {
+#ifdef __EMSCRIPTEN__
+  return false;
+#else
+  std::lock_guard<std::mutex> lock(mutex);
+  return busy;
+#endif
+}
+
+void Autosave::wait() {
+#ifndef __EMSCRIPTEN__
+  std::unique_lock<std::mutex> lock(mutex);
+  jobDone.wait(lock, [this]() { return !busy; });
+#endif
+}
+
+void Autosave::reportCompleted(StateManager& stateManager) {
+  bmin::DynArray<AutosaveResult> results;
+  {
+#ifndef __EMSCRIPTEN__
+    std::lock_guard<std::mutex> lock(mutex);
+#endif
+    results = std::move(completed);
+    completed.clear();
+  }
+  for (auto& result : results) {
+    stateManager.pllAction(stateManager.getActionData(),
+                           new actions::WorldAutosaveCompleted(std::move(result)),
+                           0);
+  }
+}
+
+void Autosave::update(StateManager& stateManager, const db::Database* database, int dt) {
+  reportCompleted(stateManager);
+  if (!enabled || database == nullptr) {
+    return;
+  }
+  elapsedMs += dt;
+  if (!requested && elapsedMs < intervalMs) {
+    return;
+  }
+  // Due: keep waiting (timer saturated) until the game is at rest.
+  if (isBusy() || !isSafePoint(stateManager)) {
+    return;
+  }
+
+  const uint64_t startNs = profiling::nowNs();
+  auto job = bmin::makeUnique<Job>();
+  job->snapshot = bmin::makeUnique<game::SaveSnapshot>(
+      game::captureSaveSnapshot(stateManager.getState(), *database));
+  job->result.generation = nextGeneration++;
+  job->result.path = path;
+  job->result.captureMs = elapsedMsSince(startNs);
+  requested = false;
+  elapsedMs = 0;
+  startJob(std::move(job));
+}
+
+} // namespace state
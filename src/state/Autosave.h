@@ -0,0 +1,109 @@
+#pragma once
+
+#include "bmin/DynArray.h"
+#include "bmin/String.h"
+#include "bmin/UniquePtr.h"
+#include <cstddef>
+#include <cstdint>
+
+#ifndef __EMSCRIPTEN__
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#endif
+
+namespace db {
+class Database;
+}
+
+namespace game {
+struct SaveSnapshot;
+}
+
+namespace state {
+
+class StateManager;
+
+struct AutosaveResult {
+  bool success = false;
+  // Increments per autosave started.
+  uint64_t generation = 0;
+  bmin::String path;
+  size_t rawBytes = 0;
+  size_t fileBytes = 0;
+  // Main thread: safe-point check + game::captureSaveSnapshot.
+  double captureMs = 0.;
+  // Worker: encode, compress and atomic file replace.
+  double writeMs = 0.;
+  bmin::String error;
+};
+
+// Background autosave, owned by StateManager and off by default. Every intervalMs
+// of game time (or after request()) it waits for a safe point (isSafePoint),
+// captures a game::SaveSnapshot on the main thread and hands it to a worker thread
+// that encodes, compresses and atomically replaces the file. Finished saves are
+// reported by queueing a WorldAutosaveCompleted action, so listeners subscribe on
+// the ActionBus like for any other action. Emscripten builds have no worker and
+// write during update().
+class Autosave {
+public:
+  static constexpr int DEFAULT_INTERVAL_MS = 5 * 60 * 1000;
+  static constexpr const char* DEFAULT_PATH = "autosave.sav";
+
+  Autosave();
+  ~Autosave();
+  Autosave(const Autosave&) = delete;
+  Autosave& operator=(const Autosave&) = delete;
+
+  void setEnabled(bool _enabled);
+  bool isEnabled() const { return enabled; }
+  void setPath(const bmin::String& _path);
+  const bmin::String& getPath() const { return path; }
+  void setIntervalMs(int _intervalMs);
+  // Save at the next safe point regardless of the interval.
+  void request();
+  bool isRequested() const { return requested; }
+
+  // Nothing queued, no combat, no pending trigger and a map loaded.
+  static bool isSafePoint(StateManager& stateManager);
+
+  // Called from StateManager::update.
+  void update(StateManager& stateManager, const db::Database* database, int dt);
+  // True while a snapshot is queued or being written.
+  bool isBusy();
+  // Blocks until the in-flight save (if any) is on disk. Its completion is still
+  // reported by the next update().
+  void wait();
+
+private:
+  struct Job {
+    bmin::UniquePtr<game::SaveSnapshot> snapshot;
+    AutosaveResult result;
+  };
+
+  bmin::String path = DEFAULT_PATH;
+  int intervalMs = DEFAULT_INTERVAL_MS;
+  int elapsedMs = 0;
+  bool enabled = false;
+  bool requested = false;
+  uint64_t nextGeneration = 1;
+
+  bmin::UniquePtr<Job> pendingJob;
+  bool busy = false;
+  bmin::DynArray<AutosaveResult> completed;
+#ifndef __EMSCRIPTEN__
+  bool stopping = false;
+  std::mutex mutex;
+  std::condition_variable wakeWorker;
+  std::condition_variable jobDone;
+  std::thread worker;
+
+  void workerLoop();
+#endif
+
+  static void runJob(Job& job);
+  void startJob(bmin::UniquePtr<Job> job);
+  void reportCompleted(StateManager& stateManager);
+};
+
+} // namespace state
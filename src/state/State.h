@@ -3,9 +3,11 @@
 #include "bmin/DynArray.h"
 #include "bmin/Map.h"
 #include "bmin/String.h"
+#include "model/EventStorage.h"
 #include "model/instances/MapInstance.h"
 #include "model/instances/Player.h"
 #include "model/instances/World.h"
+#include "model/Random.h"
 #include "model/templates/UtilityTypes.h"
 #include "state/Triggers.h"
 
@@ -55,12 +57,15 @@ struct State {
   bmin::Map<bmin::String, model::MapInstance> mapInstances;
   // Dialogue / special-event runner vars (vars.*, once.*, …). tmp.* is session-only
   // and stripped when a conversation ends.
-  bmin::Map<bmin::String, bmin::String> specialEventStorage;
+  model::EventStorage specialEventStorage;
 
   model::TurnMode turnMode = model::TurnMode::TURN_TOWN;
 
   // Monotonic counter of player movement ticks (world steps + combat rounds × 4).
   int playerMovementCount = 0;
+
+  // Seeded streams for every random roll in game logic (randomStreamsSerialize).
+  model::RandomStreams rng;
 };
 
 } // namespace state
@@ -1,11 +1,22 @@
 #include "state/StateManager.h"
+#include "lib/Profiling.h"
 #include "state/StateManagerInterface.h"
 #include "state/AbstractAction.h"
 #include "state/WorldUpdater.h"
+#include <algorithm>
 
 namespace state {
 
-StateManager::StateManager() { StateManagerInterface::setStateManager(this); }
+StateManager::StateManager() {
+  StateManagerInterface::setStateManager(this);
+  model::setActiveRandomStreams(&state.rng);
+}
+
+StateManager::~StateManager() {
+  if (model::isActiveRandomStreams(&state.rng)) {
+    model::setActiveRandomStreams(nullptr);
+  }
+}
 
 state::State& StateManager::getState() { return state; }
 
@@ -15,61 +26,98 @@ ActionBus& StateManager::getActionBus() { return actionBus; }
 
 const ActionBus& StateManager::getActionBus() const { return actionBus; }
 
+ActionProfiler& StateManager::getActionProfiler() { return actionProfiler; }
+
+Autosave& StateManager::getAutosave() { return autosave; }
+
+void StateManager::setCollapseDelays(bool _collapseDelays) {
+  collapseDelays = _collapseDelays;
+}
+
 void StateManager::enqueueAction(ActionData& actions, AbstractAction* action, int ms) {
-  actions.sequentialActionsNext.pushBack(bmin::makeUnique<AsyncAction>(
-      AsyncAction{bmin::UniquePtr<AbstractAction>(action), model::TimerStruct(ms)}));
+  if (action == nullptr && collapseDelays) {
+    return;
+  }
+  actions.sequentialActionsNext.pushBack(
+      AsyncAction{bmin::UniquePtr<AbstractAction>(action), model::TimerStruct(ms)});
 }
 
 void StateManager::insertAction(ActionData& actions, AbstractAction* action, int ms) {
-  actions.insertActions.pushBack(bmin::makeUnique<AsyncAction>(
-      AsyncAction{bmin::UniquePtr<AbstractAction>(action), model::TimerStruct(ms)}));
+  if (action == nullptr && collapseDelays) {
+    return;
+  }
+  actions.insertActions.pushBack(
+      AsyncAction{bmin::UniquePtr<AbstractAction>(action), model::TimerStruct(ms)});
 }
 
 void StateManager::pllAction(ActionData& actions, AbstractAction* action, int ms) {
-  actions.parallelActions.pushBack(bmin::makeUnique<AsyncAction>(
-      AsyncAction{bmin::UniquePtr<AbstractAction>(action), model::TimerStruct(ms)}));
+  if (action == nullptr && collapseDelays) {
+    return;
+  }
+  actions.parallelActions.pushBack(
+      AsyncAction{bmin::UniquePtr<AbstractAction>(action), model::TimerStruct(ms)});
 }
 
 void StateManager::moveSequentialActions(ActionData& actions) {
-  actions.sequentialActions.splice(actions.sequentialActions.end(),
-                                   actions.sequentialActionsNext);
+  for (auto& asyncAction : actions.sequentialActionsNext) {
+    actions.sequentialActions.pushBack(std::move(asyncAction));
+  }
+  actions.sequentialActionsNext.clear();
 }
 
 void StateManager::moveInsertActions(ActionData& actions) {
   if (actions.insertActions.empty()) {
     return;
   }
-  // StateManager owns sequentialActions here. Splice deferred inserts
+  // StateManager owns sequentialActions here. Place deferred inserts
   // immediately after the front (currently executing / waiting) action.
-  if (actions.sequentialActions.empty()) {
-    actions.sequentialActions.splice(actions.sequentialActions.end(),
-                                     actions.insertActions);
+  auto& sequential = actions.sequentialActions;
+  const size_t oldSize = sequential.size();
+  for (auto& asyncAction : actions.insertActions) {
+    sequential.pushBack(std::move(asyncAction));
+  }
+  actions.insertActions.clear();
+  if (oldSize > 1) {
+    std::rotate(sequential.begin() + 1, sequential.begin() + oldSize, sequential.end());
+  }
+}
+
+void StateManager::runAction(AbstractAction& action) {
+  if (!actionProfiler.isEnabled()) {
+    action.execute(&state);
+    actionBus.notify(action, state);
     return;
   }
-  auto it = actions.sequentialActions.begin();
-  ++it;
-  actions.sequentialActions.splice(it, actions.insertActions);
+  const auto actionTypeId = ActionBus::getActionTypeId(typeid(action));
+  const uint64_t startNs = profiling::nowNs();
+  action.execute(&state);
+  const uint64_t executedNs = profiling::nowNs();
+  const size_t handlersInvoked = actionBus.notify(action, state);
+  actionProfiler.recordAction(
+      actionTypeId, startNs, executedNs, profiling::nowNs(), handlersInvoked);
 }
 
 void StateManager::update(int dt) {
   moveSequentialActions(actionData);
+  if (actionProfiler.isEnabled()) {
+    actionProfiler.recordQueueDepths(actionData.sequentialActions.size(),
+                                     actionData.parallelActions.size());
+  }
   while (!actionData.sequentialActions.empty()) {
-    auto& delayedActionPtr = actionData.sequentialActions.front();
-    AsyncAction& delayedAction = *delayedActionPtr;
-    if (delayedAction.action.get() != nullptr) {
-      AbstractAction& executedAction = *delayedAction.action;
-      executedAction.execute(&state);
-      actionBus.notify(executedAction, state);
-      delayedAction.action.reset();
-      // execute/notify may have deferred inserts; splice while this action
+    if (actionData.sequentialActions[0].action.get() != nullptr) {
+      auto executedAction = std::move(actionData.sequentialActions[0].action);
+      runAction(*executedAction);
+      // execute/notify may have deferred inserts; place them while this action
       // is still front so they land immediately after it.
       moveInsertActions(actionData);
     }
 
+    // Re-fetch: moveInsertActions may have grown (reallocated) the queue.
+    auto& delayedAction = actionData.sequentialActions[0];
     model::timerStructUpdate(delayedAction.timer, dt);
     if (model::timerStructIsComplete(delayedAction.timer)) {
       bool shouldLoop = delayedAction.timer.duration == 0;
-      actionData.sequentialActions.erase(actionData.sequentialActions.begin());
+      actionData.sequentialActions.erase(static_cast<size_t>(0));
       if (shouldLoop) {
         moveSequentialActions(actionData);
         continue;
@@ -81,21 +129,22 @@ void StateManager::update(int dt) {
     }
   }
   for (unsigned int i = 0; i < actionData.parallelActions.size(); i++) {
-    auto& delayedActionPtr = actionData.parallelActions[i];
-    AsyncAction& delayedAction = *delayedActionPtr;
+    auto& delayedAction = actionData.parallelActions[i];
     model::timerStructUpdate(delayedAction.timer, dt);
     if (model::timerStructIsComplete(delayedAction.timer)) {
-      if (delayedAction.action.get() != nullptr) {
-        AbstractAction& executedAction = *delayedAction.action;
-        executedAction.execute(&state);
-        actionBus.notify(executedAction, state);
-      }
+      // Take the action out first: execute may pllAction and grow this array.
+      auto executedAction = std::move(delayedAction.action);
       actionData.parallelActions.erase(static_cast<size_t>(i));
       i--;
+      if (executedAction.get() != nullptr) {
+        runAction(*executedAction);
+      }
     }
   }
   worldUpdate(*this, dt);
   uiManager.update(dt, state, *this);
+  // Last, so the safe-point check sees the queues after this frame's work.
+  autosave.update(*this, getDatabase(), dt);
 }
 
 } // namespace state
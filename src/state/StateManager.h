@@ -1,9 +1,10 @@
 #pragma once
 
 #include "bmin/DynArray.h"
-#include "bmin/List.h"
-#include "bmin/UniquePtr.h"
+#include "state/AbstractAction.h"
 #include "state/ActionBus.h"
+#include "state/ActionProfiler.h"
+#include "state/Autosave.h"
 #include "state/DatabaseInterface.h"
 #include "state/State.h"
 #include "state/UiManager.h"
@@ -14,14 +15,14 @@ class Database;
 
 namespace state {
 
-class AbstractAction;
-struct AsyncAction;
 
+// Queues hold AsyncAction by value: once their capacity has grown, queueing an
+// action costs no allocation beyond the (pooled) action itself.
 struct ActionData {
-  bmin::List<bmin::UniquePtr<AsyncAction>> sequentialActions;
-  bmin::List<bmin::UniquePtr<AsyncAction>> sequentialActionsNext;
-  bmin::List<bmin::UniquePtr<AsyncAction>> insertActions;
-  bmin::DynArray<bmin::UniquePtr<AsyncAction>> parallelActions;
+  bmin::DynArray<AsyncAction> sequentialActions;
+  bmin::DynArray<AsyncAction> sequentialActionsNext;
+  bmin::DynArray<AsyncAction> insertActions;
+  bmin::DynArray<AsyncAction> parallelActions;
 };
 
 class StateManager : public state::DatabaseInterface {
@@ -29,16 +30,27 @@ private:
   state::State state;
   ActionData actionData;
   ActionBus actionBus;
+  ActionProfiler actionProfiler;
   UiManager uiManager;
+  Autosave autosave;
+  bool collapseDelays = false;
+
+  void runAction(AbstractAction& action);
 
 public:
   StateManager();
-  ~StateManager() = default;
+  ~StateManager();
 
   state::State& getState();
   ActionData& getActionData();
   ActionBus& getActionBus();
   const ActionBus& getActionBus() const;
+  // Disabled by default; enable to time actions run by update().
+  ActionProfiler& getActionProfiler();
+  // Disabled by default; see Autosave.
+  Autosave& getAutosave();
+  // Headless runs: drop pure-delay (nullptr action) entries instead of queueing them.
+  void setCollapseDelays(bool _collapseDelays);
 
   void enqueueAction(ActionData& actions, AbstractAction* action, int ms);
   void insertAction(ActionData& actions, AbstractAction* action, int ms);
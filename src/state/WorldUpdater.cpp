@@ -56,7 +56,8 @@ void updateDamageParticles(model::World& world, int deltaTimeMs) {
     auto& particle = world.activeMap.damageParticles[i];
     timerStructUpdate(particle.lifetime, deltaTimeMs);
     if (timerStructIsComplete(particle.lifetime)) {
-      world.activeMap.damageParticles.erase(i);
+      // Swap-remove: index i now holds the former last particle, so do not advance.
+      model::removeDamageParticleAt(world.activeMap, i);
     } else {
       ++i;
     }
@@ -46,7 +46,8 @@ class DoCPUCombatTurn : public CombatAction {
       return;
     }
 
-    if (actor->combatBehaviorCombat == model::CombatBehaviorName::SEEK_AND_MELEE) {
+    if (model::characterInstanceGetCombatBehavior(*actor) ==
+        model::CombatBehaviorName::SEEK_AND_MELEE) {
       auto dx = 0;
       auto dy = 0;
       if (game::chooseSeekAndMeleeCombatAction(
@@ -2,6 +2,7 @@
 
 #include "model/instances/CharacterInstance.h"
 #include "model/Combat.h"
+#include "model/Random.h"
 #include "game/map/ActiveMapOrchestrator.h"
 #include "state/actions/combat/ActionBase.hpp"
 #include "state/actions/combat/CharacterSetSpriteIndexOffset.hpp"
@@ -37,16 +38,13 @@ class PerformMeleeAttack : public CombatAction {
 
     insertCombatAction(new CharacterSetSpriteIndexOffset(attackerId, 1), 0);
 
-    const auto hit = (std::rand() % 100) < model::COMBAT_HIT_CHANCE_PERCENT;
-    if (hit) {
+    const auto attack = model::resolveMeleeAttack(state->rng.combat);
+    if (attack.hit) {
       insertCombatAction(new PlaySound("punch1"), 0);
       insertCombatAction(nullptr, 75);
-      insertCombatAction(new ModifyHP(victimId, -model::COMBAT_MELEE_DAMAGE), 0);
-      insertCombatAction(new WorldSpawnDamageParticle("splash_attack",
-                                                      victim->x,
-                                                      victim->y,
-                                                      model::COMBAT_MELEE_DAMAGE,
-                                                      500),
+      insertCombatAction(new ModifyHP(victimId, -attack.damage), 0);
+      insertCombatAction(new WorldSpawnDamageParticle(
+                             "splash_attack", victim->x, victim->y, attack.damage, 500),
                          0);
       insertCombatAction(nullptr, 500);
     } else {
@@ -0,0 +1,38 @@
+#pragma once
+
+#include "bmin/StringInterop.h"
+#include "sdl2w/Logger.h"
+#include "state/AbstractAction.h"
+#include "state/Autosave.h"
+
+namespace state {
+
+namespace actions {
+
+// Queued by Autosave when the worker has finished (or failed) a save. Subscribe on
+// the ActionBus to react, e.g. to flash a save indicator.
+class WorldAutosaveCompleted : public AbstractAction {
+  AutosaveResult result;
+
+  void act() override {
+    if (result.success) {
+      LOG(INFO) << "Autosave " << bmin::toString(static_cast<int>(result.generation))
+                << " written to " << result.path << " ("
+                << bmin::toString(static_cast<int>(result.fileBytes))
+                << " bytes, capture " << result.captureMs << "ms, write "
+                << result.writeMs << "ms)" << LOG_ENDL;
+    } else {
+      LOG(ERROR) << "Autosave " << bmin::toString(static_cast<int>(result.generation))
+                 << " failed: " << result.error << LOG_ENDL;
+    }
+  }
+
+public:
+  explicit WorldAutosaveCompleted(AutosaveResult _result) : result(std::move(_result)) {}
+
+  const AutosaveResult& getResult() const { return result; }
+};
+
+} // namespace actions
+
+} // namespace state
@@ -91,6 +91,7 @@ class WorldLoadActiveMap : public AbstractAction {
     game::ActiveMapOrchestrator activeMap;
     activeMap.fetchMapGrid(resolvedGridId);
     auto& grid = activeMap.getMapGrid();
+    game::ensureGridMapInstances(localState, *database, grid);
     for (int y = 0; y < grid.gridHeight; y++) {
       for (int x = 0; x < grid.gridWidth; x++) {
         const auto& mapName = grid.cells[static_cast<size_t>(y)][static_cast<size_t>(x)];
@@ -28,7 +28,7 @@ class WorldSpawnDamageParticle : public AbstractAction {
     particle.tileY = tileY;
     particle.value = value;
     model::timerStructStart(particle.lifetime, lifetimeMs);
-    state->world.activeMap.damageParticles.pushBack(std::move(particle));
+    model::spawnDamageParticle(state->world.activeMap, std::move(particle));
   }
 
 public:
@@ -0,0 +1,202 @@
+// Packs the sprite sheets of sdl2w asset files into atlas pages. Run from src/.
+//
+//   ATLASPACK [-o dir] [--max-size n] [assets/assets.game.txt...]
+//
+// For each asset file (assets/assets.game.txt by default) writes into dir
+// (ui::SPRITE_ATLAS_DIR by default):
+//   <name>_<n>.png      atlas pages, where name is the file stem without "assets."
+//   <file>              the asset file with its sheets replaced by the pages
+//   <stem>.sprites.txt  page rects of every sprite, under its original name
+// ui::loadAssetsPreferAtlas reads the last two. Exits with 1 when a picture cannot be
+// read or does not fit on a page (nothing is written for that file then), 2 on bad
+// usage.
+
+#include "bmin/DynArray.h"
+#include "bmin/Map.h"
+#include "bmin/String.h"
+#include "bmin/StringInterop.h"
+#include "ui/SpriteAtlas.h"
+#include <exception>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <string>
+
+#if defined(MIYOOA30) || defined(MIYOOMINI)
+#include <SDL.h>
+#include <SDL_image.h>
+#else
+#include <SDL2/SDL.h>
+#include <SDL2/SDL_image.h>
+#endif
+
+namespace {
+
+int usage() {
+  std::cerr << "usage: ATLASPACK [-o dir] [--max-size n] [asset-file...]" << std::endl;
+  return 2;
+}
+
+bool readFile(const bmin::String& path, bmin::String& content) {
+  std::ifstream in{std::filesystem::path(path.cStr()), std::ios::binary};
+  if (!in) {
+    return false;
+  }
+  const std::string text{std::istreambuf_iterator<char>(in),
+                         std::istreambuf_iterator<char>()};
+  content = bmin::String(text.data(), text.size());
+  return true;
+}
+
+bool writeFile(const bmin::String& path, const bmin::String& content) {
+  std::ofstream out{std::filesystem::path(path.cStr()), std::ios::binary};
+  out.write(content.cStr(), static_cast<std::streamsize>(content.size()));
+  if (!out) {
+    std::cerr << path.cStr() << ": error: cannot write file" << std::endl;
+    return false;
+  }
+  return true;
+}
+
+// "assets/assets.game.txt" -> "game".
+bmin::String getAtlasName(const bmin::String& assetFilePath) {
+  std::string stem = std::filesystem::path(assetFilePath.cStr()).stem().string();
+  if (stem.starts_with("assets.")) {
+    stem = stem.substr(7);
+  }
+  return bmin::String(stem.data(), stem.size());
+}
+
+struct Surfaces {
+  bmin::Map<bmin::String, SDL_Surface*> byPath;
+
+  ~Surfaces() {
+    for (auto it = byPath.begin(); it != byPath.end(); ++it) {
+      SDL_FreeSurface(it->value);
+    }
+  }
+};
+
+bool packAssetFile(const bmin::String& assetFilePath,
+                   const bmin::String& outDir,
+                   int maxSize) {
+  bmin::String content;
+  if (!readFile(assetFilePath, content)) {
+    std::cerr << assetFilePath.cStr() << ": error: cannot open file" << std::endl;
+    return false;
+  }
+
+  Surfaces surfaces;
+  ui::SpriteAtlasLayout layout;
+  ui::SpriteAssetFile assetFile;
+  try {
+    assetFile = ui::parseSpriteAssetFile(bmin::toStringView(content));
+    bmin::Map<bmin::String, ui::ImageSize> sizes;
+    for (const auto& sheet : assetFile.sheets) {
+      if (surfaces.byPath.contains(sheet.path)) {
+        continue;
+      }
+      SDL_Surface* surface = IMG_Load(sheet.path.cStr());
+      if (surface == nullptr) {
+        std::cerr << sheet.path.cStr() << ": error: " << IMG_GetError() << std::endl;
+        return false;
+      }
+      surfaces.byPath[sheet.path] = surface;
+      sizes[sheet.path] = ui::ImageSize{surface->w, surface->h};
+    }
+    layout = ui::packSpriteAtlas(assetFile.sheets,
+                                 sizes,
+                                 bmin::toStringView(getAtlasName(assetFilePath)),
+                                 bmin::toStringView(outDir),
+                                 maxSize);
+  } catch (const std::exception& e) {
+    std::cerr << assetFilePath.cStr() << ": error: " << e.what() << std::endl;
+    return false;
+  }
+
+  std::error_code ec;
+  std::filesystem::create_directories(outDir.cStr(), ec);
+  for (size_t i = 0; i < layout.pages.size(); i++) {
+    const auto& page = layout.pages[i];
+    // New surfaces are zeroed, so everything between the pictures is transparent.
+    SDL_Surface* pageSurface = SDL_CreateRGBSurfaceWithFormat(
+        0, page.width, page.height, 32, SDL_PIXELFORMAT_RGBA32);
+    if (pageSurface == nullptr) {
+      std::cerr << page.path.cStr() << ": error: " << SDL_GetError() << std::endl;
+      return false;
+    }
+    for (const auto& image : layout.images) {
+      if (image.page != static_cast<int>(i)) {
+        continue;
+      }
+      SDL_Surface* source = surfaces.byPath[image.path];
+      // Copy alpha as is instead of blending it onto the empty page.
+      SDL_SetSurfaceBlendMode(source, SDL_BLENDMODE_NONE);
+      SDL_Rect from{0, 0, image.width, image.height};
+      SDL_Rect to{image.x, image.y, image.width, image.height};
+      SDL_BlitSurface(source, &from, pageSurface, &to);
+    }
+    const bool saved = IMG_SavePNG(pageSurface, page.path.cStr()) == 0;
+    SDL_FreeSurface(pageSurface);
+    if (!saved) {
+      std::cerr << page.path.cStr() << ": error: " << IMG_GetError() << std::endl;
+      return false;
+    }
+  }
+
+  const auto atlasAssetFilePath = ui::getAtlasAssetFilePath(
+      bmin::toStringView(assetFilePath), bmin::toStringView(outDir));
+  const auto spritesPath = ui::getAtlasSpritesPath(bmin::toStringView(assetFilePath),
+                                                   bmin::toStringView(outDir));
+  if (!writeFile(atlasAssetFilePath,
+                 ui::formatAtlasAssetFile(layout,
+                                          bmin::toStringView(assetFile.passThrough))) ||
+      !writeFile(spritesPath, ui::formatAtlasSprites(layout))) {
+    return false;
+  }
+
+  std::cout << "Wrote " << atlasAssetFilePath.cStr() << ": " << layout.sprites.size()
+            << " sprites from " << layout.images.size() << " pictures on "
+            << layout.pages.size() << " page(s)";
+  for (const auto& page : layout.pages) {
+    std::cout << " " << page.width << "x" << page.height;
+  }
+  std::cout << std::endl;
+  return true;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+  bmin::String outDir = ui::SPRITE_ATLAS_DIR;
+  int maxSize = ui::SPRITE_ATLAS_MAX_SIZE;
+  bmin::DynArray<bmin::String> inputs;
+  for (int i = 1; i < argc; i++) {
+    const bmin::String arg = argv[i];
+    if (arg == "-o" && i + 1 < argc) {
+      outDir = argv[++i];
+    } else if (arg == "--max-size" && i + 1 < argc) {
+      const bmin::String value = argv[++i];
+      if (!bmin::isInt(value) || bmin::parseInt(value) <= 0) {
+        return usage();
+      }
+      maxSize = bmin::parseInt(value);
+    } else if (arg.startsWith("-")) {
+      return usage();
+    } else {
+      inputs.pushBack(arg);
+    }
+  }
+  if (inputs.empty()) {
+    inputs.pushBack("assets/assets.game.txt");
+  }
+
+  IMG_Init(IMG_INIT_PNG);
+  bool failed = false;
+  for (const auto& input : inputs) {
+    failed = !packAssetFile(input, outDir, maxSize) || failed;
+  }
+  IMG_Quit();
+  return failed ? 1 : 0;
+}
@@ -0,0 +1,59 @@
+// Builds the binary content pack from the assets/db JSON files. Run from src/.
+//
+//   CONTENTPACK [-o out]
+//
+// Loads and validates every template the same way the game does without a pack, prints
+// cross-reference warnings to stderr as "warning: message", then writes the pack
+// (CONTENT_PACK_PATH by default). Exits with 1 when the content does not load (nothing
+// is written then), 2 on bad usage.
+
+#include "bmin/String.h"
+#include "db/ContentPack.h"
+#include "db/Database.h"
+#include <exception>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+
+namespace {
+
+int usage() {
+  std::cerr << "usage: CONTENTPACK [-o out]" << std::endl;
+  return 2;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+  bmin::String outPath = db::CONTENT_PACK_PATH;
+  for (int i = 1; i < argc; i++) {
+    const bmin::String arg = argv[i];
+    if (arg == "-o" && i + 1 < argc) {
+      outPath = argv[++i];
+    } else {
+      return usage();
+    }
+  }
+
+  db::Database database;
+  try {
+    database.loadFromJson();
+  } catch (const std::exception& e) {
+    std::cerr << "error: " << e.what() << std::endl;
+    return 1;
+  }
+  for (const auto& warning : db::findContentWarnings(database)) {
+    std::cerr << "warning: " << warning.cStr() << std::endl;
+  }
+
+  const auto bytes = db::encodeContentPack(database);
+  std::ofstream out{std::filesystem::path(outPath.cStr()), std::ios::binary};
+  out.write(reinterpret_cast<const char*>(bytes.data()),
+            static_cast<std::streamsize>(bytes.size()));
+  if (!out) {
+    std::cerr << outPath.cStr() << ": error: cannot write file" << std::endl;
+    return 1;
+  }
+  std::cout << "Wrote " << outPath.cStr() << " (" << bytes.size() << " bytes)" << std::endl;
+  return 0;
+}
@@ -0,0 +1,114 @@
+// Compiles .se special-event sources into special-events JSON or an event bundle.
+//
+//   SECOMPILER [--json|--bundle] [-o out] file.se...
+//
+// Diagnostics go to stderr as "file:line: error|warning: message". Exits with 1 when
+// any input has errors (nothing is written then), 2 on bad usage.
+
+#include "bmin/DynArray.h"
+#include "bmin/String.h"
+#include "runner/EventBundle.h"
+#include "runner/SeCompiler.h"
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <string>
+
+namespace {
+
+int usage() {
+  std::cerr << "usage: SECOMPILER [--json|--bundle] [-o out] file.se..." << std::endl;
+  return 2;
+}
+
+bool readFile(const bmin::String& path, bmin::String& content) {
+  std::ifstream in{std::filesystem::path(path.cStr()), std::ios::binary};
+  if (!in) {
+    return false;
+  }
+  const std::string text{std::istreambuf_iterator<char>(in),
+                         std::istreambuf_iterator<char>()};
+  content = bmin::String(text.data(), text.size());
+  return true;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+  bool bundle = false;
+  bmin::String outPath;
+  bmin::DynArray<bmin::String> inputs;
+  for (int i = 1; i < argc; i++) {
+    const bmin::String arg = argv[i];
+    if (arg == "--json") {
+      bundle = false;
+    } else if (arg == "--bundle") {
+      bundle = true;
+    } else if (arg == "-o" && i + 1 < argc) {
+      outPath = argv[++i];
+    } else if (arg.startsWith("-")) {
+      return usage();
+    } else {
+      inputs.pushBack(arg);
+    }
+  }
+  if (inputs.empty() || (bundle && outPath.empty())) {
+    return usage();
+  }
+
+  bool failed = false;
+  bmin::DynArray<model::GameEvent> events;
+  for (const auto& input : inputs) {
+    bmin::String source;
+    if (!readFile(input, source)) {
+      std::cerr << input.cStr() << ": error: cannot open file" << std::endl;
+      failed = true;
+      continue;
+    }
+    bmin::DynArray<runner::SeDiagnostic> diagnostics;
+    auto fileEvents = runner::compileSeSource(source, diagnostics);
+    for (const auto& diagnostic : diagnostics) {
+      std::cerr << runner::formatSeDiagnostic(input, diagnostic).cStr() << std::endl;
+    }
+    failed = failed || runner::hasSeErrors(diagnostics);
+    for (auto& event : fileEvents) {
+      for (const auto& other : events) {
+        if (other.id == event.id) {
+          std::cerr << input.cStr() << ": error: event '" << event.id.cStr()
+                    << "' is already defined by an earlier input" << std::endl;
+          failed = true;
+        }
+      }
+      events.pushBack(std::move(event));
+    }
+  }
+  if (failed) {
+    return 1;
+  }
+
+  if (bundle) {
+    const auto bytes = runner::encodeEventBundle(events);
+    std::ofstream out{std::filesystem::path(outPath.cStr()), std::ios::binary};
+    out.write(reinterpret_cast<const char*>(bytes.data()),
+              static_cast<std::streamsize>(bytes.size()));
+    if (!out) {
+      std::cerr << outPath.cStr() << ": error: cannot write file" << std::endl;
+      return 1;
+    }
+    return 0;
+  }
+
+  const bmin::String json = runner::gameEventsToJson(events);
+  if (outPath.empty()) {
+    std::cout << json.cStr();
+    return 0;
+  }
+  std::ofstream out{std::filesystem::path(outPath.cStr()), std::ios::binary};
+  out.write(json.cStr(), static_cast<std::streamsize>(json.size()));
+  if (!out) {
+    std::cerr << outPath.cStr() << ": error: cannot write file" << std::endl;
+    return 1;
+  }
+  return 0;
+}
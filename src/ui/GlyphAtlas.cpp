@@ -0,0 +1,325 @@
+#include "GlyphAtlas.h"
+#include "bmin/StringInterop.h"
+#include "sdl2w/Logger.h"
+#include "sdl2w/Store.h"
+#include "sdl2w/Window.h"
+#include "ui/RenderStats.h"
+#include "ui/TextTextureCache.h"
+#include <algorithm>
+
+#if defined(MIYOOA30) || defined(MIYOOMINI)
+#include <SDL_ttf.h>
+#else
+#include <SDL2/SDL_ttf.h>
+#endif
+
+namespace ui {
+
+GlyphAtlas::GlyphAtlas(TTF_Font* _font, std::string_view _textureKey)
+    : font(_font), textureKey(_textureKey.data(), _textureKey.size()) {
+  fontHeight = TTF_FontHeight(font);
+  asciiKerning.fill(KERNING_UNKNOWN);
+}
+
+uint32_t GlyphAtlas::decodeUtf8(std::string_view text, size_t& index) {
+  const auto lead = static_cast<unsigned char>(text[index++]);
+  if (lead < 0x80) {
+    return lead;
+  }
+
+  int extraBytes = 0;
+  uint32_t codepoint = 0;
+  if ((lead & 0xE0) == 0xC0) {
+    extraBytes = 1;
+    codepoint = lead & 0x1F;
+  } else if ((lead & 0xF0) == 0xE0) {
+    extraBytes = 2;
+    codepoint = lead & 0x0F;
+  } else if ((lead & 0xF8) == 0xF0) {
+    extraBytes = 3;
+    codepoint = lead & 0x07;
+  } else {
+    return '?';
+  }
+
+  for (int i = 0; i < extraBytes; i++) {
+    if (index >= text.size()) {
+      return '?';
+    }
+    const auto cont = static_cast<unsigned char>(text[index]);
+    if ((cont & 0xC0) != 0x80) {
+      return '?';
+    }
+    codepoint = (codepoint << 6) | (cont & 0x3F);
+    index++;
+  }
+  return codepoint;
+}
+
+GlyphInfo& GlyphAtlas::getGlyph(uint32_t codepoint) {
+  auto& glyph = codepoint < ASCII_GLYPHS ? asciiGlyphs[codepoint]
+                                         : extendedGlyphs[codepoint];
+  if (!glyph.loaded) {
+    int minX = 0;
+    int maxX = 0;
+    int minY = 0;
+    int maxY = 0;
+    int advance = 0;
+    if (TTF_GlyphMetrics32(font, codepoint, &minX, &maxX, &minY, &maxY, &advance) == 0) {
+      glyph.advance = advance;
+    }
+    glyph.loaded = true;
+  }
+  return glyph;
+}
+
+int GlyphAtlas::getKerning(uint32_t prev, uint32_t next) {
+  if (prev < ASCII_GLYPHS && next < ASCII_GLYPHS) {
+    auto& cached = asciiKerning[prev * ASCII_GLYPHS + next];
+    if (cached == KERNING_UNKNOWN) {
+      cached = static_cast<int16_t>(TTF_GetFontKerningSizeGlyphs32(font, prev, next));
+    }
+    return cached;
+  }
+
+  const auto pairKey = (static_cast<uint64_t>(prev) << 32) | next;
+  auto it = extendedKerning.find(pairKey);
+  if (it != extendedKerning.end()) {
+    return (*it).value;
+  }
+  const int kerning = TTF_GetFontKerningSizeGlyphs32(font, prev, next);
+  extendedKerning.insert(pairKey, kerning);
+  return kerning;
+}
+
+std::pair<int, int> GlyphAtlas::measureText(std::string_view text) {
+  int width = 0;
+  uint32_t prev = 0;
+  size_t i = 0;
+  while (i < text.size()) {
+    const auto codepoint = decodeUtf8(text, i);
+    if (prev != 0) {
+      width += getKerning(prev, codepoint);
+    }
+    width += getGlyph(codepoint).advance;
+    prev = codepoint;
+  }
+  return {width, fontHeight};
+}
+
+SDL_Texture* GlyphAtlas::getOrCreateTexture(sdl2w::Store& store, SDL_Renderer* renderer) {
+  const auto keyView = bmin::toStringView(textureKey);
+  if (store.hasDynamicTexture(keyView)) {
+    return store.getDynamicTexture(keyView);
+  }
+
+  auto* texture = SDL_CreateTexture(renderer,
+                                    SDL_PIXELFORMAT_ARGB8888,
+                                    SDL_TEXTUREACCESS_STATIC,
+                                    ATLAS_SIZE,
+                                    ATLAS_SIZE);
+  if (texture == nullptr) {
+    LOG(ERROR) << "GlyphAtlas::getOrCreateTexture - Failed to create texture: "
+               << SDL_GetError() << LOG_ENDL;
+    return nullptr;
+  }
+  SDL_SetTextureBlendMode(texture, SDL_BLENDMODE_BLEND);
+  bmin::DynArray<uint32_t> transparent(static_cast<size_t>(ATLAS_SIZE * ATLAS_SIZE), 0);
+  SDL_UpdateTexture(texture, nullptr, transparent.data(), ATLAS_SIZE * 4);
+
+  // A fresh texture (first use, or the Store was cleared) holds no glyphs yet.
+  for (auto& glyph : asciiGlyphs) {
+    glyph.rasterized = false;
+  }
+  for (auto it = extendedGlyphs.begin(); it != extendedGlyphs.end(); ++it) {
+    (*it).value.rasterized = false;
+  }
+  packX = 0;
+  packY = 0;
+  shelfHeight = 0;
+  atlasFull = false;
+
+  store.storeDynamicTexture(keyView, texture);
+  return texture;
+}
+
+bool GlyphAtlas::rasterizeGlyph(SDL_Texture* texture,
+                                uint32_t codepoint,
+                                GlyphInfo& glyph) {
+  auto* rendered =
+      TTF_RenderGlyph32_Blended(font, codepoint, SDL_Color{255, 255, 255, 255});
+  if (rendered == nullptr) {
+    // Whitespace and missing glyphs still advance the pen but draw nothing.
+    glyph.atlasRect = {0, 0, 0, 0};
+    glyph.rasterized = true;
+    return true;
+  }
+
+  auto* surf = rendered;
+  if (rendered->format->format != SDL_PIXELFORMAT_ARGB8888) {
+    surf = SDL_ConvertSurfaceFormat(rendered, SDL_PIXELFORMAT_ARGB8888, 0);
+    SDL_FreeSurface(rendered);
+    if (surf == nullptr) {
+      return false;
+    }
+  }
+
+  if (packX + surf->w > ATLAS_SIZE) {
+    packX = 0;
+    packY += shelfHeight + 1;
+    shelfHeight = 0;
+  }
+  if (surf->w > ATLAS_SIZE || packY + surf->h > ATLAS_SIZE) {
+    atlasFull = true;
+    SDL_FreeSurface(surf);
+    return false;
+  }
+
+  glyph.atlasRect = {packX, packY, surf->w, surf->h};
+  SDL_UpdateTexture(texture, &glyph.atlasRect, surf->pixels, surf->pitch);
+  packX += surf->w + 1;
+  shelfHeight = std::max(shelfHeight, surf->h);
+  glyph.rasterized = true;
+  SDL_FreeSurface(surf);
+  return true;
+}
+
+bool GlyphAtlas::drawText(sdl2w::Window& window,
+                          std::string_view text,
+                          const sdl2w::RenderTextParams& params) {
+  if (params.angleDeg != 0. || atlasFull) {
+    return false;
+  }
+
+  auto& draw = window.getDraw();
+  auto* renderer = draw.getSdlRenderer();
+  if (renderer == nullptr) {
+    return false;
+  }
+  auto* texture = getOrCreateTexture(window.getStore(), renderer);
+  if (texture == nullptr) {
+    return false;
+  }
+
+  const auto scaleX = static_cast<float>(params.scale.first);
+  const auto scaleY = static_cast<float>(params.scale.second);
+  auto originX = static_cast<float>(params.x);
+  auto originY = static_cast<float>(params.y);
+  if (params.centered) {
+    const auto [textWidth, textHeight] = measureText(text);
+    originX -= textWidth * scaleX / 2.f;
+    originY -= textHeight * scaleY / 2.f;
+  }
+
+  SDL_Color color = params.color;
+  color.a = static_cast<Uint8>(std::clamp(draw.getGlobalAlpha() * color.a / 255, 0, 255));
+  constexpr float invAtlasSize = 1.f / ATLAS_SIZE;
+
+  vertices.clear();
+  indices.clear();
+  int penX = 0;
+  uint32_t prev = 0;
+  size_t i = 0;
+  while (i < text.size()) {
+    const auto codepoint = decodeUtf8(text, i);
+    if (prev != 0) {
+      penX += getKerning(prev, codepoint);
+    }
+    prev = codepoint;
+
+    auto& glyph = getGlyph(codepoint);
+    if (!glyph.rasterized && !rasterizeGlyph(texture, codepoint, glyph)) {
+      return false;
+    }
+
+    const auto& rect = glyph.atlasRect;
+    if (rect.w > 0 && rect.h > 0) {
+      const float x0 = originX + penX * scaleX;
+      const float y0 = originY;
+      const float x1 = x0 + rect.w * scaleX;
+      const float y1 = y0 + rect.h * scaleY;
+      const float u0 = rect.x * invAtlasSize;
+      const float v0 = rect.y * invAtlasSize;
+      const float u1 = (rect.x + rect.w) * invAtlasSize;
+      const float v1 = (rect.y + rect.h) * invAtlasSize;
+
+      const int base = static_cast<int>(vertices.size());
+      vertices.pushBack(SDL_Vertex{{x0, y0}, color, {u0, v0}});
+      vertices.pushBack(SDL_Vertex{{x1, y0}, color, {u1, v0}});
+      vertices.pushBack(SDL_Vertex{{x1, y1}, color, {u1, v1}});
+      vertices.pushBack(SDL_Vertex{{x0, y1}, color, {u0, v1}});
+      indices.pushBack(base);
+      indices.pushBack(base + 1);
+      indices.pushBack(base + 2);
+      indices.pushBack(base);
+      indices.pushBack(base + 2);
+      indices.pushBack(base + 3);
+    }
+    penX += glyph.advance;
+  }
+
+  if (!vertices.empty()) {
+    ++renderStats().text;
+    SDL_RenderGeometry(renderer,
+                       texture,
+                       vertices.data(),
+                       static_cast<int>(vertices.size()),
+                       indices.data(),
+                       static_cast<int>(indices.size()));
+  }
+  return true;
+}
+
+GlyphAtlasCache& GlyphAtlasCache::get() {
+  static GlyphAtlasCache cache;
+  return cache;
+}
+
+GlyphAtlas* GlyphAtlasCache::getAtlas(sdl2w::Store& store,
+                                      const sdl2w::RenderTextParams& params) {
+  bmin::String key("glyphs:");
+  key += params.fontName;
+  key += '|';
+  key += bmin::toString(static_cast<int>(params.fontSize));
+
+  auto* font = store.getFont(bmin::toStringView(params.fontName), params.fontSize);
+  if (font == nullptr) {
+    return nullptr;
+  }
+
+  auto it = atlases.find(key);
+  if (it != atlases.end() && (*it).value->getFont() == font) {
+    return (*it).value.get();
+  }
+  // Unknown key, or the Store reloaded the font: (re)build the tables.
+  auto atlas = bmin::makeUnique<GlyphAtlas>(font, bmin::toStringView(key));
+  auto* atlasPtr = atlas.get();
+  atlases.insert(key, std::move(atlas));
+  return atlasPtr;
+}
+
+std::pair<int, int> GlyphAtlasCache::measureText(sdl2w::Window& window,
+                                                 std::string_view text,
+                                                 const sdl2w::RenderTextParams& params) {
+  auto* atlas = getAtlas(window.getStore(), params);
+  if (atlas == nullptr) {
+    return window.getDraw().measureText(text, params);
+  }
+  return atlas->measureText(text);
+}
+
+void GlyphAtlasCache::drawText(sdl2w::Window& window,
+                               std::string_view text,
+                               const sdl2w::RenderTextParams& params) {
+  if (text.empty()) {
+    return;
+  }
+  auto* atlas = getAtlas(window.getStore(), params);
+  if (atlas == nullptr || !atlas->drawText(window, text, params)) {
+    TextTextureCache::get().drawText(window, text, params);
+  }
+}
+
+void GlyphAtlasCache::clear() { atlases.clear(); }
+
+} // namespace ui
@@ -0,0 +1,106 @@
+#pragma once
+
+#include "bmin/DynArray.h"
+#include "bmin/Map.h"
+#include "bmin/String.h"
+#include "bmin/UniquePtr.h"
+#include "sdl2w/Defines.h"
+#include "sdl2w/Draw.h"
+#include "ui/SdlPixels.h" // IWYU pragma: keep
+#include <array>
+#include <cstdint>
+#include <string_view>
+#include <utility>
+
+#if defined(MIYOOA30) || defined(MIYOOMINI)
+#include <SDL.h>
+#else
+#include <SDL2/SDL.h>
+#endif
+
+namespace sdl2w {
+class Store;
+class Window;
+} // namespace sdl2w
+
+namespace ui {
+
+struct GlyphInfo {
+  int advance = 0;
+  SDL_Rect atlasRect = {0, 0, 0, 0};
+  bool loaded = false;
+  bool rasterized = false;
+};
+
+// Per (font, TextSize) table of glyph advances and kerning, plus a lazily packed
+// texture of white glyphs that is tinted per draw. Measuring a string is a sum over
+// the table (no SDL_ttf shaping), and drawing is one SDL_RenderGeometry call.
+class GlyphAtlas {
+private:
+  static constexpr int ASCII_GLYPHS = 128;
+  static constexpr int16_t KERNING_UNKNOWN = INT16_MIN;
+
+  TTF_Font* font = nullptr;
+  bmin::String textureKey;
+  int fontHeight = 0;
+
+  std::array<GlyphInfo, ASCII_GLYPHS> asciiGlyphs;
+  bmin::Map<uint32_t, GlyphInfo> extendedGlyphs;
+  std::array<int16_t, ASCII_GLYPHS * ASCII_GLYPHS> asciiKerning;
+  bmin::Map<uint64_t, int> extendedKerning;
+
+  int packX = 0;
+  int packY = 0;
+  int shelfHeight = 0;
+  bool atlasFull = false;
+
+  bmin::DynArray<SDL_Vertex> vertices;
+  bmin::DynArray<int> indices;
+
+  static uint32_t decodeUtf8(std::string_view text, size_t& index);
+
+  GlyphInfo& getGlyph(uint32_t codepoint);
+  int getKerning(uint32_t prev, uint32_t next);
+  SDL_Texture* getOrCreateTexture(sdl2w::Store& store, SDL_Renderer* renderer);
+  bool rasterizeGlyph(SDL_Texture* texture, uint32_t codepoint, GlyphInfo& glyph);
+
+public:
+  static constexpr int ATLAS_SIZE = 512;
+
+  GlyphAtlas(TTF_Font* _font, std::string_view _textureKey);
+
+  TTF_Font* getFont() const { return font; }
+  int getFontHeight() const { return fontHeight; }
+
+  // Matches sdl2w::Draw::measureText: {sum of advances + kerning, font height}.
+  std::pair<int, int> measureText(std::string_view text);
+
+  // Returns false when the atlas cannot serve this draw (full atlas, rotation, no
+  // renderer) so the caller can fall back to a string texture.
+  bool drawText(sdl2w::Window& window,
+                std::string_view text,
+                const sdl2w::RenderTextParams& params);
+};
+
+// Owns one GlyphAtlas per (font name, TextSize).
+class GlyphAtlasCache {
+private:
+  bmin::Map<bmin::String, bmin::UniquePtr<GlyphAtlas>> atlases;
+
+  GlyphAtlas* getAtlas(sdl2w::Store& store, const sdl2w::RenderTextParams& params);
+
+public:
+  static GlyphAtlasCache& get();
+
+  // Table-driven replacement for sdl2w::Draw::measureText.
+  std::pair<int, int> measureText(sdl2w::Window& window,
+                                  std::string_view text,
+                                  const sdl2w::RenderTextParams& params);
+  // Batched glyph quads; falls back to TextTextureCache when the atlas cannot draw.
+  void drawText(sdl2w::Window& window,
+                std::string_view text,
+                const sdl2w::RenderTextParams& params);
+  void clear();
+};
+
+} // namespace ui
@@ -0,0 +1,12 @@
+#include "RenderStats.h"
+
+namespace ui {
+
+RenderStats& renderStats() {
+  static RenderStats stats;
+  return stats;
+}
+
+void resetRenderStats() { renderStats() = RenderStats{}; }
+
+} // namespace ui
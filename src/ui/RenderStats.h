@@ -0,0 +1,24 @@
+#pragma once
+
+#include <cstdint>
+
+namespace ui {
+
+// Draw calls issued by game-side renderers: every UiElement render path, MapView and
+// the text caches. sdl2w::Draw keeps no counters of its own, so each call site counts
+// the draws it issues; sdl2w-internal work (e.g. the text fallback rasterizing) is not
+// included. Counting is a few increments per draw; reset once per measured frame.
+struct RenderStats {
+  uint64_t sprites = 0;
+  uint64_t rects = 0;
+  uint64_t lines = 0;
+  uint64_t text = 0;
+  uint64_t renderTargets = 0;
+
+  uint64_t total() const { return sprites + rects + lines + text + renderTargets; }
+};
+
+RenderStats& renderStats();
+void resetRenderStats();
+
+} // namespace ui
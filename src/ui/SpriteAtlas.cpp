@@ -0,0 +1,532 @@
+#include "SpriteAtlas.h"
+#include "bmin/StringInterop.h"
+#include "lib/StringUtil.h"
+#include "sdl2w/AssetLoader.h"
+#include "sdl2w/Draw.h"
+#include "sdl2w/Logger.h"
+#include "sdl2w/Store.h"
+#include <algorithm>
+#include <filesystem>
+#include <initializer_list>
+#include <stdexcept>
+#include <system_error>
+
+namespace ui {
+
+namespace {
+
+constexpr char ATLAS_ALIAS_PREFIX[] = "atlas_";
+constexpr char ATLAS_SPRITES_SUFFIX[] = ".sprites.txt";
+
+bmin::DynArray<bmin::String> splitFields(const bmin::String& line) {
+  auto fields = strutil::splitByChar(line, ',');
+  for (auto& field : fields) {
+    field = strutil::trim(field);
+  }
+  return fields;
+}
+
+[[noreturn]] void fail(const char* message, const bmin::String& detail) {
+  throw std::runtime_error((bmin::String(message) + detail).cStr());
+}
+
+int parseField(const bmin::String& field, const bmin::String& line) {
+  if (!bmin::isInt(field)) {
+    fail("Invalid number in line: ", line);
+  }
+  return bmin::parseInt(field);
+}
+
+void appendLine(bmin::String& out, std::initializer_list<bmin::String> fields) {
+  bool first = true;
+  for (const auto& field : fields) {
+    if (!first) {
+      out += ',';
+    }
+    first = false;
+    out += field;
+  }
+  out += '\n';
+}
+
+std::string_view baseName(std::string_view path) {
+  const size_t slash = path.find_last_of("/\\");
+  return slash == std::string_view::npos ? path : path.substr(slash + 1);
+}
+
+bmin::String joinPath(std::string_view dir, std::string_view name) {
+  bmin::String out(dir.data(), dir.size());
+  if (!out.empty() && out[out.size() - 1] != '/') {
+    out += '/';
+  }
+  out += bmin::String(name.data(), name.size());
+  return out;
+}
+
+// Top left of grid cell index in a picture of size full, if the whole cell is inside.
+bool findCell(const ImageSize& full, const SpriteSheetSource& sheet, int index, int& x,
+              int& y) {
+  const int columns = full.width / sheet.width;
+  if (columns == 0) {
+    return false;
+  }
+  x = index % columns * sheet.width;
+  y = index / columns * sheet.height;
+  return y + sheet.height <= full.height;
+}
+
+struct PackItem {
+  int width = 0;
+  int height = 0;
+  // Index into layout.images, or -1 for the transparent rect.
+  int image = -1;
+};
+
+struct Shelf {
+  int page = 0;
+  int y = 0;
+  int height = 0;
+  int x = 0;
+};
+
+struct Placement {
+  int page = 0;
+  int x = 0;
+  int y = 0;
+};
+
+class ShelfPacker {
+  int maxSize;
+  bmin::DynArray<Shelf> shelves;
+  // Next free shelf y of each page.
+  bmin::DynArray<int> pageBottoms;
+
+public:
+  explicit ShelfPacker(int _maxSize) : maxSize(_maxSize) {}
+
+  int getPageCount() const { return static_cast<int>(pageBottoms.size()); }
+
+  Placement place(int width, int height) {
+    for (auto& shelf : shelves) {
+      if (height <= shelf.height && shelf.x + width <= maxSize) {
+        const Placement placement{shelf.page, shelf.x, shelf.y};
+        shelf.x += width;
+        return placement;
+      }
+    }
+    int page = 0;
+    while (page < getPageCount() && pageBottoms[page] + height > maxSize) {
+      page++;
+    }
+    if (page == getPageCount()) {
+      pageBottoms.pushBack(0);
+    }
+    shelves.pushBack(Shelf{page, pageBottoms[page], height, width});
+    pageBottoms[page] += height;
+    return Placement{page, 0, shelves[shelves.size() - 1].y};
+  }
+};
+
+void applySpriteAtlas(sdl2w::AssetLoader& assetLoader,
+                      sdl2w::Store& store,
+                      std::string_view atlasAssetFilePath,
+                      const SpriteAtlasLayout& layout) {
+  assetLoader.loadAssetsFromFile(sdl2w::ASSET_FILE, atlasAssetFilePath);
+  bmin::Map<bmin::String, const AtlasPage*> pages;
+  for (const auto& page : layout.pages) {
+    pages[page.alias] = &page;
+  }
+  for (const auto& sprite : layout.sprites) {
+    const AtlasPage& page = *pages[sprite.atlas];
+    SDL_Texture* texture = store.getTexture(bmin::toStringView(page.alias));
+    if (texture == nullptr) {
+      // The page passed validateSpriteAtlas but did not decode; sounds and animations
+      // are registered by now, so there is no clean fallback.
+      fail("Atlas page failed to load: ", page.path);
+    }
+    // The Store owns stored sprites.
+    store.storeSprite(bmin::toStringView(sprite.name),
+                      new sdl2w::Sprite{
+                          .name = sprite.name,
+                          .renderable = {.tex = texture},
+                          .x = sprite.x,
+                          .y = sprite.y,
+                          .w = sprite.w,
+                          .h = sprite.h,
+                          .spritesheetWidth = page.width,
+                      });
+    assetLoader.spriteNameToPictureAlias[sprite.name] = page.alias;
+  }
+}
+
+#ifndef __EMSCRIPTEN__
+// An atlas older than its asset file or one of its pictures is stale (art edited since
+// the last pack). Emscripten builds package whatever atlas the build produced.
+bool spriteAtlasIsCurrent(std::string_view assetFilePath,
+                          std::string_view atlasAssetFilePath,
+                          std::string_view spritesPath,
+                          const SpriteAtlasLayout& layout) {
+  std::error_code assetEc;
+  std::error_code spritesEc;
+  const auto atlasTime =
+      std::min(std::filesystem::last_write_time(atlasAssetFilePath, assetEc),
+               std::filesystem::last_write_time(spritesPath, spritesEc));
+  if (assetEc || spritesEc) {
+    return false;
+  }
+  std::error_code ec;
+  auto isNewer = [&](std::string_view path) {
+    const auto sourceTime = std::filesystem::last_write_time(path, ec);
+    return !ec && sourceTime > atlasTime;
+  };
+  if (isNewer(assetFilePath)) {
+    return false;
+  }
+  for (const auto& image : layout.images) {
+    if (isNewer(bmin::toStringView(image.path))) {
+      return false;
+    }
+  }
+  return true;
+}
+#endif
+
+} // namespace
+
+SpriteAssetFile parseSpriteAssetFile(std::string_view content) {
+  const auto lines = strutil::splitLines(bmin::String(content.data(), content.size()));
+
+  bmin::Map<bmin::String, bmin::String> picturePaths;
+  bmin::Map<bmin::String, int> nextIndex;
+  SpriteAssetFile out;
+  for (const auto& line : lines) {
+    const auto fields = splitFields(strutil::trim(line));
+    if (fields[0] == "Pic" && fields.size() >= 3) {
+      picturePaths[fields[1]] = fields[2];
+    } else if (fields[0] == "Sprites" && fields.size() >= 5) {
+      auto pathIt = picturePaths.find(fields[1]);
+      if (pathIt == picturePaths.end()) {
+        fail("Sprites for unknown Pic: ", line);
+      }
+      SpriteSheetSource sheet;
+      sheet.alias = fields[1];
+      sheet.path = (*pathIt).value;
+      sheet.count = parseField(fields[2], line);
+      sheet.width = parseField(fields[3], line);
+      sheet.height = parseField(fields[4], line);
+      if (sheet.count < 0 || sheet.width <= 0 || sheet.height <= 0) {
+        fail("Invalid sprite sheet: ", line);
+      }
+      int& index = nextIndex[sheet.alias];
+      sheet.firstIndex = index;
+      index += sheet.count;
+      out.sheets.pushBack(sheet);
+    }
+  }
+
+  // Pictures with sprites come from the atlas; everything else is kept as written.
+  for (const auto& line : lines) {
+    const auto fields = splitFields(strutil::trim(line));
+    const bool packedPic = fields[0] == "Pic" && fields.size() >= 3 &&
+                           nextIndex.contains(fields[1]);
+    const bool sprites = fields[0] == "Sprites" && fields.size() >= 5;
+    // Removed sheets would leave runs of blank lines behind.
+    const auto written = bmin::toStringView(out.passThrough);
+    const bool repeatedBlank = strutil::trim(line).empty() &&
+                               (written.empty() || written.ends_with("\n\n"));
+    if (!packedPic && !sprites && !repeatedBlank) {
+      out.passThrough += line;
+      out.passThrough += '\n';
+    }
+  }
+  return out;
+}
+
+SpriteAtlasLayout packSpriteAtlas(const bmin::DynArray<SpriteSheetSource>& sheets,
+                                  const bmin::Map<bmin::String, ImageSize>& imageSizes,
+                                  std::string_view name,
+                                  std::string_view outDir,
+                                  int maxSize) {
+  auto& sizes = const_cast<bmin::Map<bmin::String, ImageSize>&>(imageSizes);
+  bmin::DynArray<AtlasImage> images;
+  bmin::DynArray<ImageSize> fullSizes;
+  bmin::Map<bmin::String, int> imageByPath;
+  int blankWidth = 0;
+  int blankHeight = 0;
+
+  // Crop each picture to the cells its sheets use.
+  for (const auto& sheet : sheets) {
+    if (!imageByPath.contains(sheet.path)) {
+      auto sizeIt = sizes.find(sheet.path);
+      if (sizeIt == sizes.end()) {
+        fail("No image size for ", sheet.path);
+      }
+      imageByPath[sheet.path] = static_cast<int>(images.size());
+      images.pushBack(AtlasImage{.path = sheet.path});
+      fullSizes.pushBack((*sizeIt).value);
+    }
+    const int image = imageByPath[sheet.path];
+    for (int i = 0; i < sheet.count; i++) {
+      int x = 0;
+      int y = 0;
+      if (findCell(fullSizes[image], sheet, sheet.firstIndex + i, x, y)) {
+        images[image].width = std::max(images[image].width, x + sheet.width);
+        images[image].height = std::max(images[image].height, y + sheet.height);
+      } else {
+        blankWidth = std::max(blankWidth, sheet.width);
+        blankHeight = std::max(blankHeight, sheet.height);
+      }
+    }
+  }
+
+  bmin::DynArray<PackItem> items;
+  for (size_t i = 0; i < images.size(); i++) {
+    if (images[i].width > 0) {
+      items.pushBack(PackItem{images[i].width, images[i].height, static_cast<int>(i)});
+    }
+  }
+  if (blankWidth > 0) {
+    items.pushBack(PackItem{blankWidth, blankHeight, -1});
+  }
+  std::stable_sort(items.begin(), items.end(), [](const PackItem& a, const PackItem& b) {
+    return a.height != b.height ? a.height > b.height : a.width > b.width;
+  });
+
+  ShelfPacker packer(maxSize);
+  Placement blank;
+  for (const auto& item : items) {
+    if (item.width > maxSize || item.height > maxSize) {
+      fail("Does not fit on an atlas page: ",
+           item.image < 0 ? bmin::String("transparent cell") : images[item.image].path);
+    }
+    const Placement placement = packer.place(item.width, item.height);
+    if (item.image < 0) {
+      blank = placement;
+    } else {
+      images[item.image].page = placement.page;
+      images[item.image].x = placement.x;
+      images[item.image].y = placement.y;
+    }
+  }
+
+  SpriteAtlasLayout layout;
+  const bmin::String nameString(name.data(), name.size());
+  for (int i = 0; i < packer.getPageCount(); i++) {
+    const bmin::String pageName = nameString + "_" + bmin::toString(i);
+    layout.pages.pushBack(AtlasPage{
+        .alias = bmin::String(ATLAS_ALIAS_PREFIX) + pageName,
+        .path = joinPath(outDir, bmin::toStringView(pageName)) + ".png",
+    });
+  }
+  auto growPage = [&](int page, int right, int bottom) {
+    layout.pages[page].width = std::max(layout.pages[page].width, right);
+    layout.pages[page].height = std::max(layout.pages[page].height, bottom);
+  };
+  for (const auto& image : images) {
+    if (image.width > 0) {
+      growPage(image.page, image.x + image.width, image.y + image.height);
+      layout.images.pushBack(image);
+    }
+  }
+  if (blankWidth > 0) {
+    growPage(blank.page, blank.x + blankWidth, blank.y + blankHeight);
+  }
+
+  for (const auto& sheet : sheets) {
+    const int image = imageByPath[sheet.path];
+    for (int i = 0; i < sheet.count; i++) {
+      AtlasSprite sprite{
+          .name = sheet.alias + "_" + bmin::toString(i),
+          .w = sheet.width,
+          .h = sheet.height,
+      };
+      int x = 0;
+      int y = 0;
+      if (findCell(fullSizes[image], sheet, sheet.firstIndex + i, x, y)) {
+        sprite.atlas = layout.pages[images[image].page].alias;
+        sprite.x = images[image].x + x;
+        sprite.y = images[image].y + y;
+      } else {
+        sprite.atlas = layout.pages[blank.page].alias;
+        sprite.x = blank.x;
+        sprite.y = blank.y;
+      }
+      layout.sprites.pushBack(sprite);
+    }
+  }
+  return layout;
+}
+
+bmin::String formatAtlasAssetFile(const SpriteAtlasLayout& layout,
+                                  std::string_view passThrough) {
+  bmin::String out("# Generated by ATLASPACK, do not edit.\n");
+  for (const auto& page : layout.pages) {
+    appendLine(out, {"Pic", page.alias, page.path});
+  }
+  out += "\n";
+  out += bmin::String(passThrough.data(), passThrough.size());
+  return out;
+}
+
+bmin::String formatAtlasSprites(const SpriteAtlasLayout& layout) {
+  bmin::String out;
+  for (const auto& page : layout.pages) {
+    appendLine(out, {"Atlas", page.alias, page.path, bmin::toString(page.width),
+                     bmin::toString(page.height)});
+  }
+  for (const auto& image : layout.images) {
+    appendLine(out, {"Image", image.path, bmin::toString(image.page),
+                     bmin::toString(image.x), bmin::toString(image.y),
+                     bmin::toString(image.width), bmin::toString(image.height)});
+  }
+  for (const auto& sprite : layout.sprites) {
+    appendLine(out, {"Sprite", sprite.name, sprite.atlas, bmin::toString(sprite.x),
+                     bmin::toString(sprite.y), bmin::toString(sprite.w),
+                     bmin::toString(sprite.h)});
+  }
+  return out;
+}
+
+SpriteAtlasLayout parseAtlasSprites(std::string_view content) {
+  SpriteAtlasLayout layout;
+  bmin::Map<bmin::String, int> pageByAlias;
+  for (const auto& rawLine :
+       strutil::splitLines(bmin::String(content.data(), content.size()))) {
+    const auto line = strutil::trim(rawLine);
+    if (line.empty() || line[0] == '#') {
+      continue;
+    }
+    const auto fields = splitFields(line);
+    if (fields[0] == "Atlas" && fields.size() == 5) {
+      pageByAlias[fields[1]] = static_cast<int>(layout.pages.size());
+      layout.pages.pushBack(AtlasPage{fields[1], fields[2], parseField(fields[3], line),
+                                      parseField(fields[4], line)});
+    } else if (fields[0] == "Image" && fields.size() == 7) {
+      const int page = parseField(fields[2], line);
+      if (page < 0 || page >= static_cast<int>(layout.pages.size())) {
+        fail("Image on unknown page: ", line);
+      }
+      layout.images.pushBack(AtlasImage{fields[1], page, parseField(fields[3], line),
+                                        parseField(fields[4], line),
+                                        parseField(fields[5], line),
+                                        parseField(fields[6], line)});
+    } else if (fields[0] == "Sprite" && fields.size() == 7) {
+      if (!pageByAlias.contains(fields[2])) {
+        fail("Sprite on unknown page: ", line);
+      }
+      layout.sprites.pushBack(AtlasSprite{fields[1], fields[2],
+                                          parseField(fields[3], line),
+                                          parseField(fields[4], line),
+                                          parseField(fields[5], line),
+                                          parseField(fields[6], line)});
+    } else {
+      fail("Invalid atlas line: ", line);
+    }
+  }
+  return layout;
+}
+
+void validateSpriteAtlas(const SpriteAtlasLayout& layout,
+                         std::string_view atlasAssetFile) {
+  bmin::Map<bmin::String, const AtlasPage*> pages;
+  for (const auto& page : layout.pages) {
+    pages[page.alias] = &page;
+  }
+  for (const auto& sprite : layout.sprites) {
+    if (!pages.contains(sprite.atlas)) {
+      fail("Sprite on unknown page: ", sprite.name);
+    }
+    const AtlasPage& page = *pages[sprite.atlas];
+    if (sprite.x < 0 || sprite.y < 0 || sprite.w <= 0 || sprite.h <= 0 ||
+        sprite.x + sprite.w > page.width || sprite.y + sprite.h > page.height) {
+      fail("Sprite outside its atlas page: ", sprite.name);
+    }
+  }
+
+  bmin::Map<bmin::String, bmin::String> picturePaths;
+  for (const auto& line :
+       strutil::splitLines(bmin::String(atlasAssetFile.data(), atlasAssetFile.size()))) {
+    const auto fields = splitFields(strutil::trim(line));
+    if (fields[0] == "Pic" && fields.size() >= 3) {
+      picturePaths[fields[1]] = fields[2];
+    }
+  }
+  for (const auto& page : layout.pages) {
+    if (!picturePaths.contains(page.alias) || picturePaths[page.alias] != page.path) {
+      fail("Atlas page missing from the asset file: ", page.path);
+    }
+    std::error_code ec;
+    if (!std::filesystem::exists(bmin::toStringView(page.path), ec)) {
+      fail("Atlas page not found: ", page.path);
+    }
+  }
+}
+
+bmin::String getAtlasAssetFilePath(std::string_view assetFilePath, std::string_view dir) {
+  return joinPath(dir, baseName(assetFilePath));
+}
+
+bmin::String getAtlasSpritesPath(std::string_view assetFilePath, std::string_view dir) {
+  std::string_view name = baseName(assetFilePath);
+  const size_t dot = name.rfind('.');
+  if (dot != std::string_view::npos && dot > 0) {
+    name = name.substr(0, dot);
+  }
+  return joinPath(dir, name) + ATLAS_SPRITES_SUFFIX;
+}
+
+void loadSpriteAtlas(sdl2w::AssetLoader& assetLoader,
+                     sdl2w::Store& store,
+                     std::string_view atlasAssetFilePath,
+                     std::string_view spritesPath) {
+  const auto layout =
+      parseAtlasSprites(bmin::toStringView(sdl2w::loadFileAsString(spritesPath)));
+  validateSpriteAtlas(layout,
+                      bmin::toStringView(sdl2w::loadFileAsString(atlasAssetFilePath)));
+  applySpriteAtlas(assetLoader, store, atlasAssetFilePath, layout);
+}
+
+bool loadAssetsPreferAtlas(sdl2w::AssetLoader& assetLoader,
+                           sdl2w::Store& store,
+                           std::string_view assetFilePath) {
+  const auto atlasAssetFilePath = getAtlasAssetFilePath(assetFilePath, SPRITE_ATLAS_DIR);
+  const auto spritesPath = getAtlasSpritesPath(assetFilePath, SPRITE_ATLAS_DIR);
+  std::error_code ec;
+  if (std::filesystem::exists(bmin::toStringView(spritesPath), ec) &&
+      std::filesystem::exists(bmin::toStringView(atlasAssetFilePath), ec)) {
+    // Everything that can reject the atlas runs before anything is registered, so the
+    // fallback below never loads the source file on top of half an atlas.
+    SpriteAtlasLayout layout;
+    bool usable = false;
+    try {
+      layout = parseAtlasSprites(bmin::toStringView(
+          sdl2w::loadFileAsString(bmin::toStringView(spritesPath))));
+      validateSpriteAtlas(layout,
+                          bmin::toStringView(sdl2w::loadFileAsString(
+                              bmin::toStringView(atlasAssetFilePath))));
+      usable = true;
+    } catch (const std::runtime_error& e) {
+      LOG(WARN) << "Ignoring sprite atlas " << atlasAssetFilePath << ": " << e.what()
+                << LOG_ENDL;
+    }
+#ifndef __EMSCRIPTEN__
+    if (usable && !spriteAtlasIsCurrent(assetFilePath,
+                                        bmin::toStringView(atlasAssetFilePath),
+                                        bmin::toStringView(spritesPath),
+                                        layout)) {
+      LOG(WARN) << "Ignoring stale sprite atlas " << atlasAssetFilePath
+                << " (run make atlas_pack)" << LOG_ENDL;
+      usable = false;
+    }
+#endif
+    if (usable) {
+      applySpriteAtlas(
+          assetLoader, store, bmin::toStringView(atlasAssetFilePath), layout);
+      return true;
+    }
+  }
+  assetLoader.loadAssetsFromFile(sdl2w::ASSET_FILE, assetFilePath);
+  return false;
+}
+
+} // namespace ui
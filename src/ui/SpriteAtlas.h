@@ -0,0 +1,134 @@
+#pragma once
+
+#include "bmin/DynArray.h"
+#include "bmin/Map.h"
+#include "bmin/String.h"
+#include <string_view>
+
+namespace sdl2w {
+class AssetLoader;
+class Store;
+} // namespace sdl2w
+
+namespace ui {
+
+// Where the ATLASPACK target writes, and where loadAssetsPreferAtlas looks.
+inline constexpr char SPRITE_ATLAS_DIR[] = "assets/atlas";
+// Atlas pages are at most this many pixels on a side; 2048 is the smallest maximum
+// texture size among the renderers the game targets.
+inline constexpr int SPRITE_ATLAS_MAX_SIZE = 2048;
+
+// One "Sprites,alias,count,w,h" line of an sdl2w asset file and the "Pic" it refers to.
+// Cell i is sprite "alias_i" at grid index firstIndex + i, in rows of imageWidth / width.
+struct SpriteSheetSource {
+  bmin::String alias;
+  bmin::String path;
+  int firstIndex = 0;
+  int count = 0;
+  int width = 0;
+  int height = 0;
+};
+
+struct SpriteAssetFile {
+  bmin::DynArray<SpriteSheetSource> sheets;
+  // Every other line (Sound, Anim blocks, comments, Pic lines without sprites), in
+  // order, for the generated asset file.
+  bmin::String passThrough;
+};
+
+struct AtlasPage {
+  bmin::String alias;
+  bmin::String path;
+  int width = 0;
+  int height = 0;
+};
+
+// Where the used part of a source picture was copied: its (0, 0, width, height) rect
+// lands at (x, y) of pages[page].
+struct AtlasImage {
+  bmin::String path;
+  int page = 0;
+  int x = 0;
+  int y = 0;
+  int width = 0;
+  int height = 0;
+};
+
+struct AtlasSprite {
+  bmin::String name;
+  bmin::String atlas;
+  int x = 0;
+  int y = 0;
+  int w = 0;
+  int h = 0;
+};
+
+struct SpriteAtlasLayout {
+  bmin::DynArray<AtlasPage> pages;
+  bmin::DynArray<AtlasImage> images;
+  bmin::DynArray<AtlasSprite> sprites;
+};
+
+struct ImageSize {
+  int width = 0;
+  int height = 0;
+};
+
+// Splits an sdl2w asset file into its sprite sheets and the lines that pass through.
+// Throws std::runtime_error for a Sprites line with bad numbers or an unknown Pic.
+SpriteAssetFile parseSpriteAssetFile(std::string_view content);
+
+// Packs every picture the sheets use onto pages of at most maxSize pixels a side
+// (first-fit shelves, tallest first). Each picture is cropped to the cells its sheets
+// use and placed whole, so a sheet stays contiguous on one page. Cells outside their
+// picture (sheets that declare more sprites than the image holds) point at one shared
+// transparent rect, so they draw nothing as before. Pages are named
+// "atlas_<name>_<n>" at "<outDir>/<name>_<n>.png". Throws std::runtime_error when a
+// picture is missing from imageSizes or does not fit on a page.
+SpriteAtlasLayout packSpriteAtlas(const bmin::DynArray<SpriteSheetSource>& sheets,
+                                  const bmin::Map<bmin::String, ImageSize>& imageSizes,
+                                  std::string_view name,
+                                  std::string_view outDir,
+                                  int maxSize = SPRITE_ATLAS_MAX_SIZE);
+
+// The generated sdl2w asset file: one Pic line per page, then the pass-through lines.
+bmin::String formatAtlasAssetFile(const SpriteAtlasLayout& layout,
+                                  std::string_view passThrough);
+// The sprite manifest: "Atlas,alias,path,width,height" per page,
+// "Image,path,page,x,y,width,height" per source picture, then
+// "Sprite,name,atlas,x,y,w,h" per sprite.
+bmin::String formatAtlasSprites(const SpriteAtlasLayout& layout);
+// Reads formatAtlasSprites output. Throws std::runtime_error for malformed lines and
+// for images or sprites on unknown pages.
+SpriteAtlasLayout parseAtlasSprites(std::string_view content);
+
+// Checks a manifest against its generated asset file before anything is loaded: every
+// sprite lies inside its page, and every page is a Pic of the asset file whose picture
+// exists. Throws std::runtime_error naming the first problem.
+void validateSpriteAtlas(const SpriteAtlasLayout& layout,
+                         std::string_view atlasAssetFile);
+
+// "<dir>/assets.game.txt" and "<dir>/assets.game.sprites.txt" for
+// "assets/assets.game.txt".
+bmin::String getAtlasAssetFilePath(std::string_view assetFilePath, std::string_view dir);
+bmin::String getAtlasSpritesPath(std::string_view assetFilePath, std::string_view dir);
+
+// Loads the generated asset file (atlas pages, sounds, animations) and registers
+// every sprite of the manifest as a rect of its page, under its original name. Throws
+// std::runtime_error when validateSpriteAtlas rejects the atlas (nothing is loaded
+// then) or when a page fails to decode.
+void loadSpriteAtlas(sdl2w::AssetLoader& assetLoader,
+                     sdl2w::Store& store,
+                     std::string_view atlasAssetFilePath,
+                     std::string_view spritesPath);
+
+// Loads assetFilePath through its atlas when SPRITE_ATLAS_DIR holds one that passes
+// validateSpriteAtlas and is not older than the source file or any picture it packed,
+// else the source file as is. Returns true for the atlas. A page that fails to decode
+// after validation throws instead of falling back, since the atlas's sounds and
+// animations are registered by then.
+bool loadAssetsPreferAtlas(sdl2w::AssetLoader& assetLoader,
+                           sdl2w::Store& store,
+                           std::string_view assetFilePath);
+
+} // namespace ui
@@ -0,0 +1,221 @@
+#include "TextTextureCache.h"
+#include "bmin/DynArray.h"
+#include "bmin/StringInterop.h"
+#include "sdl2w/Logger.h"
+#include "sdl2w/Store.h"
+#include "sdl2w/Window.h"
+#include "ui/RenderStats.h"
+#include <algorithm>
+
+#if defined(MIYOOA30) || defined(MIYOOMINI)
+#include <SDL.h>
+#include <SDL_ttf.h>
+#else
+#include <SDL2/SDL.h>
+#include <SDL2/SDL_ttf.h>
+#endif
+
+namespace ui {
+
+TextTextureCache::TextTextureCache() { stats.budgetBytes = DEFAULT_BUDGET_BYTES; }
+
+TextTextureCache& TextTextureCache::get() {
+  static TextTextureCache cache;
+  return cache;
+}
+
+bmin::String TextTextureCache::makeKey(std::string_view text,
+                                       const sdl2w::RenderTextParams& params) {
+  const uint32_t packedColor = (static_cast<uint32_t>(params.color.r) << 24) |
+                               (static_cast<uint32_t>(params.color.g) << 16) |
+                               (static_cast<uint32_t>(params.color.b) << 8) |
+                               static_cast<uint32_t>(params.color.a);
+  bmin::String key("text:");
+  key += params.fontName;
+  key += '|';
+  key += bmin::toString(static_cast<int>(params.fontSize));
+  key += '|';
+  key += bmin::toString(static_cast<unsigned>(packedColor));
+  key += '|';
+  key += bmin::String(text.data(), text.size());
+  return key;
+}
+
+SDL_Texture* TextTextureCache::rasterize(sdl2w::Window& window,
+                                         std::string_view text,
+                                         const sdl2w::RenderTextParams& params,
+                                         int& outWidth,
+                                         int& outHeight) {
+  auto& store = window.getStore();
+  auto* font = store.getFont(bmin::toStringView(params.fontName), params.fontSize);
+  if (font == nullptr) {
+    return nullptr;
+  }
+
+  const bmin::String textStr(text.data(), text.size());
+  auto* surf = TTF_RenderUTF8_Blended(font, textStr.cStr(), params.color);
+  if (surf == nullptr) {
+    LOG(WARN) << "TextTextureCache::rasterize - TTF_RenderUTF8_Blended failed: "
+              << SDL_GetError() << LOG_ENDL;
+    return nullptr;
+  }
+
+  auto* tex = SDL_CreateTextureFromSurface(window.getDraw().getSdlRenderer(), surf);
+  outWidth = surf->w;
+  outHeight = surf->h;
+  SDL_FreeSurface(surf);
+  if (tex == nullptr) {
+    LOG(WARN) << "TextTextureCache::rasterize - Failed to create texture: "
+              << SDL_GetError() << LOG_ENDL;
+    return nullptr;
+  }
+  SDL_SetTextureBlendMode(tex, SDL_BLENDMODE_BLEND);
+  return tex;
+}
+
+void TextTextureCache::blit(sdl2w::Window& window,
+                            SDL_Texture* tex,
+                            int width,
+                            int height,
+                            const sdl2w::RenderTextParams& params) {
+  auto& draw = window.getDraw();
+  SDL_Rect dest = {params.x,
+                   params.y,
+                   static_cast<int>(width * params.scale.first),
+                   static_cast<int>(height * params.scale.second)};
+  if (params.centered) {
+    dest.x -= dest.w / 2;
+    dest.y -= dest.h / 2;
+  }
+
+  const int alpha = draw.getGlobalAlpha() * params.color.a / 255;
+  SDL_SetTextureAlphaMod(tex, static_cast<Uint8>(std::clamp(alpha, 0, 255)));
+  ++renderStats().text;
+  SDL_RenderCopyEx(draw.getSdlRenderer(),
+                   tex,
+                   nullptr,
+                   &dest,
+                   params.angleDeg,
+                   nullptr,
+                   SDL_FLIP_NONE);
+}
+
+void TextTextureCache::evictToFit(sdl2w::Store& store, size_t incomingBytes) {
+  if (stats.bytesInUse + incomingBytes <= stats.budgetBytes) {
+    return;
+  }
+
+  struct Candidate {
+    uint64_t lastUsedTick;
+    bmin::String key;
+  };
+  bmin::DynArray<Candidate> candidates;
+  candidates.reserve(entries.size());
+  for (auto it = entries.begin(); it != entries.end(); ++it) {
+    candidates.pushBack(Candidate{(*it).value.lastUsedTick, (*it).key});
+  }
+  std::sort(candidates.begin(),
+            candidates.end(),
+            [](const Candidate& a, const Candidate& b) {
+              return a.lastUsedTick < b.lastUsedTick;
+            });
+
+  const auto targetBytes = static_cast<size_t>(stats.budgetBytes * EVICT_TARGET_RATIO);
+  for (const auto& candidate : candidates) {
+    if (stats.bytesInUse + incomingBytes <= targetBytes) {
+      break;
+    }
+    auto it = entries.find(candidate.key);
+    stats.bytesInUse -= (*it).value.bytes;
+    entries.erase(candidate.key);
+    store.dynamicTextures.erase(candidate.key);
+    stats.evictions++;
+  }
+  stats.entries = entries.size();
+}
+
+void TextTextureCache::drawText(sdl2w::Window& window,
+                                std::string_view text,
+                                const sdl2w::RenderTextParams& params) {
+  if (text.empty()) {
+    return;
+  }
+
+  auto& store = window.getStore();
+  const auto key = makeKey(text, params);
+  const auto keyView = bmin::toStringView(key);
+  tick++;
+
+  auto it = entries.find(key);
+  if (it != entries.end() && store.hasDynamicTexture(keyView)) {
+    auto& entry = (*it).value;
+    entry.lastUsedTick = tick;
+    stats.hits++;
+    blit(window, store.getDynamicTexture(keyView), entry.width, entry.height, params);
+    return;
+  }
+
+  if (it != entries.end()) {
+    // The Store was cleared underneath us; forget the stale bookkeeping.
+    stats.bytesInUse -= (*it).value.bytes;
+    entries.erase(key);
+  }
+
+  stats.misses++;
+  int width = 0;
+  int height = 0;
+  auto* tex = rasterize(window, text, params, width, height);
+  if (tex == nullptr) {
+    ++renderStats().text;
+    window.getDraw().drawText(text, params);
+    return;
+  }
+
+  const auto bytes = static_cast<size_t>(width) * static_cast<size_t>(height) * 4;
+  if (bytes > stats.budgetBytes) {
+    // Larger than the whole budget: draw once and let it go.
+    blit(window, tex, width, height, params);
+    SDL_DestroyTexture(tex);
+    return;
+  }
+
+  evictToFit(store, bytes);
+  store.storeDynamicTexture(keyView, tex);
+  entries.insert(key, Entry{width, height, bytes, tick});
+  stats.bytesInUse += bytes;
+  stats.entries = entries.size();
+  blit(window, tex, width, height, params);
+}
+
+void TextTextureCache::syncFontScale(sdl2w::Store& store, int fontScale) {
+  if (fontScale == currentFontScale) {
+    return;
+  }
+  currentFontScale = fontScale;
+  clear(store);
+}
+
+void TextTextureCache::setBudgetBytes(sdl2w::Store& store, size_t budgetBytes) {
+  stats.budgetBytes = budgetBytes;
+  evictToFit(store, 0);
+}
+
+void TextTextureCache::clear(sdl2w::Store& store) {
+  for (auto it = entries.begin(); it != entries.end(); ++it) {
+    store.dynamicTextures.erase((*it).key);
+  }
+  stats.evictions += entries.size();
+  entries.clear();
+  stats.entries = 0;
+  stats.bytesInUse = 0;
+}
+
+const TextTextureCacheStats& TextTextureCache::getStats() const { return stats; }
+
+void TextTextureCache::resetCounters() {
+  stats.hits = 0;
+  stats.misses = 0;
+  stats.evictions = 0;
+}
+
+} // namespace ui
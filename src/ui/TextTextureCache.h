@@ -0,0 +1,86 @@
+#pragma once
+
+#include "bmin/Map.h"
+#include "bmin/String.h"
+#include "sdl2w/Draw.h"
+#include "ui/SdlPixels.h" // IWYU pragma: keep
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+namespace sdl2w {
+class Store;
+class Window;
+} // namespace sdl2w
+
+namespace ui {
+
+struct TextTextureCacheStats {
+  uint64_t hits = 0;
+  uint64_t misses = 0;
+  uint64_t evictions = 0;
+  size_t entries = 0;
+  size_t bytesInUse = 0;
+  size_t budgetBytes = 0;
+};
+
+// LRU cache of rasterized text keyed by (font name, TextSize, color, UTF-8 text).
+// Textures are stored in the sdl2w::Store as dynamic textures so they share the
+// Store/renderer lifetime; this class only tracks recency and the byte budget.
+// Repeated labels, HUD numbers and dialog lines rasterize once instead of per frame.
+class TextTextureCache {
+private:
+  struct Entry {
+    int width = 0;
+    int height = 0;
+    size_t bytes = 0;
+    uint64_t lastUsedTick = 0;
+  };
+
+  bmin::Map<bmin::String, Entry> entries;
+  TextTextureCacheStats stats;
+  uint64_t tick = 0;
+  int currentFontScale = 0;
+
+  static bmin::String makeKey(std::string_view text,
+                              const sdl2w::RenderTextParams& params);
+  static SDL_Texture* rasterize(sdl2w::Window& window,
+                                std::string_view text,
+                                const sdl2w::RenderTextParams& params,
+                                int& outWidth,
+                                int& outHeight);
+  static void blit(sdl2w::Window& window,
+                   SDL_Texture* tex,
+                   int width,
+                   int height,
+                   const sdl2w::RenderTextParams& params);
+  void evictToFit(sdl2w::Store& store, size_t incomingBytes);
+
+public:
+  static constexpr size_t DEFAULT_BUDGET_BYTES = 8 * 1024 * 1024;
+  // Eviction trims down to this fraction of the budget so a full cache does not
+  // evict on every miss.
+  static constexpr float EVICT_TARGET_RATIO = 0.75f;
+
+  TextTextureCache();
+
+  // Process-wide cache used by TextLine and MapView.
+  static TextTextureCache& get();
+
+  // Drop-in replacement for sdl2w::Draw::drawText. Falls back to drawText if the
+  // font cannot be resolved.
+  void drawText(sdl2w::Window& window,
+                std::string_view text,
+                const sdl2w::RenderTextParams& params);
+
+  // Evicts every entry when the user font scale differs from the last one seen;
+  // cached textures for the old sizes would otherwise sit in the budget unused.
+  void syncFontScale(sdl2w::Store& store, int fontScale);
+  void setBudgetBytes(sdl2w::Store& store, size_t budgetBytes);
+  void clear(sdl2w::Store& store);
+
+  const TextTextureCacheStats& getStats() const;
+  void resetCounters();
+};
+
+} // namespace ui
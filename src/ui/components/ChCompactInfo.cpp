@@ -1,4 +1,5 @@
 #include "ChCompactInfo.h"
+#include "ui/RenderStats.h"
 #include "ui/colors.h"
 #include "ui/elements/OutsetRectangle.h"
 #include "ui/elements/Quad.h"
@@ -140,6 +141,7 @@ void ChCompactInfo::render(int dt) {
     const int y1 = style.y + scaledHeight - 1;
     const auto color = Colors::ButtonModalSelected;
 
+    renderStats().lines += 4;
     draw.drawLine({x0, y0}, {x1, y0}, lineWidth, color);
     draw.drawLine({x1, y0}, {x1, y1}, lineWidth, color);
     draw.drawLine({x0, y1}, {x1, y1}, lineWidth, color);
@@ -0,0 +1,101 @@
+#include "DamageParticleEffects.h"
+#include "sdl2w/Draw.h" // IWYU pragma: keep
+#include "sdl2w/Store.h"
+
+namespace ui {
+
+DamageParticleEffects::DamageParticleEffects() {
+  slots.reserve(model::DAMAGE_PARTICLE_CAPACITY);
+}
+
+DamageParticleEffects::Slot* DamageParticleEffects::findSlot(uint32_t particleId) {
+  for (auto& slot : slots) {
+    if (slot.particleId == particleId) {
+      return &slot;
+    }
+  }
+  return nullptr;
+}
+
+void DamageParticleEffects::initSlot(Slot& slot,
+                                     const model::DamageParticle& particle,
+                                     sdl2w::Store& store) {
+  slot.particleId = particle.id;
+  slot.lastT = particle.lifetime.t;
+  slot.definition = nullptr;
+  slot.animation = sdl2w::Animation();
+
+  auto it = store.anims.find(particle.animationName);
+  if (it == store.anims.end()) {
+    return;
+  }
+  slot.definition = (*it).value.get();
+  slot.animation = sdl2w::Animation(*slot.definition, store);
+  if (!slot.animation.isInitialized()) {
+    slot.definition = nullptr;
+    return;
+  }
+  slot.animation.start();
+  // The particle may have aged before its first rendered frame.
+  slot.animation.update(particle.lifetime.t);
+}
+
+void DamageParticleEffects::sync(const model::ActiveMap& activeMap,
+                                 sdl2w::Store& store) {
+  if (gridId != activeMap.gridId) {
+    // Particle ids restart with each ActiveMap.
+    clear();
+    gridId = activeMap.gridId;
+  }
+
+  for (auto& slot : slots) {
+    slot.live = false;
+  }
+
+  for (const auto& particle : activeMap.damageParticles) {
+    auto* slot = findSlot(particle.id);
+    if (slot == nullptr) {
+      if (slots.size() >= model::DAMAGE_PARTICLE_CAPACITY) {
+        continue;
+      }
+      slots.pushBack(Slot{});
+      slot = &slots.back();
+      initSlot(*slot, particle, store);
+    } else if (slot->definition != nullptr) {
+      const int delta = particle.lifetime.t - slot->lastT;
+      if (delta > 0) {
+        slot->animation.update(delta);
+      }
+      slot->lastT = particle.lifetime.t;
+    }
+    slot->live = true;
+  }
+
+  for (size_t i = 0; i < slots.size();) {
+    if (slots[i].live) {
+      ++i;
+      continue;
+    }
+    const auto lastIndex = slots.size() - 1;
+    if (i != lastIndex) {
+      slots[i] = slots[lastIndex];
+    }
+    slots.erase(lastIndex);
+  }
+}
+
+const sdl2w::Animation* DamageParticleEffects::getAnimation(uint32_t particleId) const {
+  for (const auto& slot : slots) {
+    if (slot.particleId == particleId) {
+      return slot.definition != nullptr ? &slot.animation : nullptr;
+    }
+  }
+  return nullptr;
+}
+
+void DamageParticleEffects::clear() {
+  slots.clear();
+  gridId.clear();
+}
+
+} // namespace ui
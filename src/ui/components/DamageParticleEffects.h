@@ -0,0 +1,49 @@
+#pragma once
+
+#include "bmin/DynArray.h"
+#include "bmin/String.h"
+#include "model/instances/World.h"
+#include "sdl2w/Animation.h"
+#include <cstdint>
+
+namespace sdl2w {
+class Store;
+} // namespace sdl2w
+
+namespace ui {
+
+// Persistent animations for State.world.activeMap.damageParticles, matched by
+// particle id. The animation definition is resolved once, when a particle is first
+// seen, and the instance is then advanced by the particle's lifetime delta each frame
+// instead of being re-created and replayed from t=0 per particle per frame.
+class DamageParticleEffects {
+private:
+  struct Slot {
+    uint32_t particleId = 0;
+    // Owned by the Store; nullptr when the Store has no such animation.
+    const sdl2w::AnimationDefinition* definition = nullptr;
+    sdl2w::Animation animation;
+    int lastT = 0;
+    bool live = false;
+  };
+
+  // Fixed capacity (model::DAMAGE_PARTICLE_CAPACITY), removal swaps with the last
+  // slot. Lookups are linear; at this size that beats hashing the id.
+  bmin::DynArray<Slot> slots;
+  bmin::String gridId;
+
+  Slot* findSlot(uint32_t particleId);
+  void initSlot(Slot& slot, const model::DamageParticle& particle, sdl2w::Store& store);
+
+public:
+  DamageParticleEffects();
+
+  // Creates slots for new particles, advances existing ones and frees slots whose
+  // particle expired. Call once per frame before getAnimation.
+  void sync(const model::ActiveMap& activeMap, sdl2w::Store& store);
+  // nullptr when the particle has no slot or its animation is unknown to the Store.
+  const sdl2w::Animation* getAnimation(uint32_t particleId) const;
+  void clear();
+};
+
+} // namespace ui
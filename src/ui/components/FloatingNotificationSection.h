@@ -3,7 +3,6 @@
 #include "../UiElement.h"
 #include "state/AbstractAction.h"
 #include "state/State.h"
-#include <typeindex>
 
 namespace ui {
 
@@ -20,14 +19,7 @@ private:
     if (!hasStateManager()) {
       return;
     }
-    getStateManager()->getActionBus().subscribe(
-        this,
-        std::type_index(typeid(ActionT)),
-        [fn = std::forward<Fn>(fn)](state::AbstractAction& action, state::State& state) {
-          if (auto* typed = dynamic_cast<ActionT*>(&action)) {
-            fn(*typed, state);
-          }
-        });
+    getStateManager()->getActionBus().subscribe<ActionT>(this, std::forward<Fn>(fn));
   }
 
   void syncFromState(const state::State& state);
@@ -11,6 +11,9 @@
 #include "sdl2w/Draw.h"
 #include "state/StateManager.h"
 #include "ui/FontScale.h"
+#include "ui/GlyphAtlas.h"
+#include "ui/RenderStats.h"
+#include "ui/TextTextureCache.h"
 #include "ui/colors.h"
 #include <cmath>
 #include <exception>
@@ -100,10 +103,14 @@ void MapView::renderDamageParticles(const model::World& world,
                                     int spriteW,
                                     int spriteH,
                                     int fontScale) {
-  if (world.activeMap.damageParticles.empty() || style.scale <= 0.f ||
-      world.activeMap.gridId.empty()) {
+  if (style.scale <= 0.f || world.activeMap.gridId.empty()) {
     return;
   }
+  damageParticleEffects.sync(world.activeMap, store);
+  if (world.activeMap.damageParticles.empty()) {
+    return;
+  }
+  TextTextureCache::get().syncFontScale(store, fontScale);
 
   game::ActiveMapOrchestrator orch;
   try {
@@ -124,7 +131,8 @@ void MapView::renderDamageParticles(const model::World& world,
     if (!game::isTileCurrentlyVisible(*map, local.x, local.y)) {
       continue;
     }
-    if (!store.anims.contains(particle.animationName)) {
+    const auto* animation = damageParticleEffects.getAnimation(particle.id);
+    if (animation == nullptr) {
       continue;
     }
 
@@ -138,14 +146,8 @@ void MapView::renderDamageParticles(const model::World& world,
     auto centerX = screenX + static_cast<int>(spriteW * style.scale / 2);
     auto centerY = screenY + static_cast<int>(spriteH * style.scale / 2);
 
-    auto animation = store.createAnimation(bmin::toStringView(particle.animationName));
-    if (!animation.isInitialized()) {
-      continue;
-    }
-    animation.start();
-    animation.update(particle.lifetime.t);
-
-    draw.drawAnimation(animation,
+    ++renderStats().sprites;
+    draw.drawAnimation(*animation,
                        sdl2w::RenderableParamsEx{
                            .scale = {style.scale, style.scale},
                            .x = centerX,
@@ -163,7 +165,9 @@ void MapView::renderDamageParticles(const model::World& world,
       textParams.color = Colors::White;
       textParams.centered = true;
       textParams.scale = {style.scale, style.scale};
-      draw.drawText(bmin::toStringView(damageText), textParams);
+      // Damage numbers change every hit; the glyph atlas avoids a texture per value.
+      GlyphAtlasCache::get().drawText(
+          *window, bmin::toStringView(damageText), textParams);
     }
   }
 }
@@ -219,6 +223,7 @@ void MapView::render(int /*dt*/) {
             screenY + scaledSpriteH <= contentY || screenY >= contentY + contentH) {
           return;
         }
+        ++renderStats().sprites;
         draw.drawSprite(sprite,
                         sdl2w::RenderableParamsEx{
                             .scale = {style.scale, style.scale},
@@ -258,6 +263,7 @@ void MapView::render(int /*dt*/) {
       if (!tile || !tile->isExplored) {
         if (screenX + scaledSpriteW > contentX && screenX < contentX + contentW &&
             screenY + scaledSpriteH > contentY && screenY < contentY + contentH) {
+          ++renderStats().rects;
           draw.drawRect(
               screenX, screenY, scaledSpriteW, scaledSpriteH, mapUnexploredColor);
         }
@@ -308,6 +314,7 @@ void MapView::render(int /*dt*/) {
       if (!tile->isVisible) {
         if (screenX + scaledSpriteW > contentX && screenX < contentX + contentW &&
             screenY + scaledSpriteH > contentY && screenY < contentY + contentH) {
+          ++renderStats().rects;
           draw.drawRect(screenX, screenY, scaledSpriteW, scaledSpriteH, mapFogColor);
         }
       }
@@ -362,6 +369,7 @@ void MapView::render(int /*dt*/) {
         centerY - scaledSpriteH / 2 >= contentY + contentH) {
       continue;
     }
+    ++renderStats().sprites;
     draw.drawSprite(sprite,
                     sdl2w::RenderableParamsEx{
                         .scale = {style.scale, style.scale},
@@ -399,6 +407,13 @@ void MapView::render(int /*dt*/) {
     if (member) {
       spriteName = model::characterPlayerGetSpriteAtIndexOffset(
           *member, character.spriteIndexOffset);
+    } else if (character.characterTemplate) {
+      try {
+        spriteName = model::characterGetSpriteAtIndexOffset(*character.characterTemplate,
+                                                            character.spriteIndexOffset);
+      } catch (const std::exception&) {
+        return;
+      }
     } else if (database) {
       try {
         const auto& characterTemplate =
@@ -453,6 +468,7 @@ void MapView::render(int /*dt*/) {
 
     if (screenX + scaledSpriteW > contentX && screenX < contentX + contentW &&
         screenY + scaledSpriteH > contentY && screenY < contentY + contentH) {
+      renderStats().rects += 5; // fill + four outline edges
       draw.drawRect(screenX, screenY, scaledSpriteW, scaledSpriteH, actionAimFillColor);
       const auto border = 2;
       draw.drawRect(screenX, screenY, scaledSpriteW, border, actionAimOutlineColor);
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "../UiElement.h"
+#include "DamageParticleEffects.h"
 #include "model/instances/World.h"
 #include "state/DatabaseInterface.h"
 #include <optional>
@@ -24,6 +25,8 @@ private:
   SDL_Color actionAimFillColor{66, 202, 253, 64};
   SDL_Color actionAimOutlineColor{66, 202, 253, 220};
 
+  DamageParticleEffects damageParticleEffects;
+
   void renderDamageParticles(const model::World& world,
                              sdl2w::Draw& draw,
                              sdl2w::Store& store,
@@ -2,6 +2,7 @@
 #include "bmin/StringInterop.h"
 #include "sdl2w/Draw.h"
 #include "sdl2w/Logger.h"
+#include "ui/RenderStats.h"
 
 namespace ui {
 
@@ -103,6 +104,7 @@ void TiledOverlay::render(int dt) {
 
   auto* previousTarget = SDL_GetRenderTarget(renderer);
   SDL_SetRenderTarget(renderer, renderTexture);
+  ++renderStats().renderTargets;
   SDL_SetRenderDrawColor(renderer, 0, 0, 0, 0);
   SDL_RenderClear(renderer);
 
@@ -110,6 +112,7 @@ void TiledOverlay::render(int dt) {
   // render target, so full-sprite draws are safe here.
   for (int y = 0; y < style.height; y += spriteH) {
     for (int x = 0; x < style.width; x += spriteW) {
+      ++renderStats().sprites;
       draw.drawSprite(sprite,
                       sdl2w::RenderableParams{
                           .scale = {1.0, 1.0},
@@ -126,6 +129,7 @@ void TiledOverlay::render(int dt) {
   const int scaledHeight = static_cast<int>(style.height * style.scale);
   SDL_SetTextureAlphaMod(renderTexture, static_cast<Uint8>(props.alpha));
   const SDL_Rect destRect = {style.x, style.y, scaledWidth, scaledHeight};
+  ++renderStats().sprites;
   SDL_RenderCopy(renderer, renderTexture, nullptr, &destRect);
 
   UiElement::render(dt);
@@ -1,5 +1,6 @@
 #include "BorderDropShadow.h"
 #include "bmin/UniquePtr.h"
+#include "ui/RenderStats.h"
 #include "ui/elements/Quad.h"
 
 namespace ui {
@@ -72,9 +73,11 @@ void BorderDropShadow::render(int dt) {
 
   const int shadowX = style.x + props.shadowOffsetX;
   const int shadowY = style.y + props.shadowOffsetY;
+  ++renderStats().rects;
   draw.drawRect(shadowX, shadowY, scaledWidth, scaledHeight, props.shadowColor);
 
   if (props.borderSize > 0) {
+    ++renderStats().rects;
     draw.drawRect(style.x - props.borderSize,
                   style.y - props.borderSize,
                   scaledWidth + 2 * props.borderSize,
@@ -1,4 +1,5 @@
 #include "BorderModalSmall.h"
+#include "ui/RenderStats.h"
 #include "ui/components/TiledOverlay.h"
 
 namespace ui {
@@ -104,15 +105,18 @@ void BorderModalSmall::render(int dt) {
   int scaledBorderWidth = static_cast<int>(props.borderWidth * style.scale);
   auto& draw = window->getDraw();
   // border
+  ++renderStats().rects;
   draw.drawRect(
       style.x, style.y, scaledWidth, scaledHeight, Colors::BorderModalStandardDark);
   // background
+  ++renderStats().rects;
   draw.drawRect(style.x + scaledBorderWidth,
                 style.y + scaledBorderWidth,
                 scaledWidth - scaledBorderWidth * 2,
                 scaledHeight - scaledBorderWidth * 2,
                 Colors::ModalStandardBackground);
   // title background
+  ++renderStats().rects;
   draw.drawRect(style.x + scaledBorderWidth,
                 style.y + scaledBorderWidth,
                 scaledWidth - scaledBorderWidth * 2,
@@ -120,6 +124,7 @@ void BorderModalSmall::render(int dt) {
                 Colors::ModalHeaderBackground);
   // icon background
   auto [iconBorderX, iconBorderY] = getIconBorderLocation();
+  ++renderStats().rects;
   draw.drawRect(iconBorderX,
                 iconBorderY,
                 props.iconSize * style.scale,
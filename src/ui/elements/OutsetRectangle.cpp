@@ -1,4 +1,5 @@
 #include "OutsetRectangle.h"
+#include "ui/RenderStats.h"
 
 namespace ui {
 
@@ -36,6 +37,7 @@ void OutsetRectangle::render(int dt) {
   int borderSize = static_cast<int>(props.borderSize * style.scale);
 
   // Draw the main rectangle
+  ++renderStats().rects;
   draw.drawRect(scaledX + borderSize,
                 scaledY + borderSize,
                 scaledWidth - borderSize * 2,
@@ -44,6 +46,7 @@ void OutsetRectangle::render(int dt) {
 
   // Draw outset border effect
   if (props.borderSize > 0) {
+    renderStats().rects += 4;
     // Top and Right borders
     draw.drawRect(scaledX, scaledY, scaledWidth, borderSize, props.colorTopRight);
     draw.drawRect(scaledX + scaledWidth - borderSize,
@@ -61,6 +64,7 @@ void OutsetRectangle::render(int dt) {
 
     if (borderSize > 1) {
       // Diagonal corners top left bottom right
+      renderStats().lines += static_cast<uint64_t>(borderSize) * 2;
       for (int i = 0; i < borderSize; i++) {
         auto topLeftX = scaledX;
         auto topLeftY = scaledY;
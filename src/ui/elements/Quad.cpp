@@ -2,6 +2,7 @@
 #include "bmin/StringInterop.h"
 #include "sdl2w/Draw.h"
 #include "sdl2w/Logger.h"
+#include "ui/RenderStats.h"
 #include "ui/uiUtils.h"
 
 namespace ui {
@@ -193,11 +194,13 @@ void Quad::render(int dt) {
 
   // Set render target to our texture
   SDL_SetRenderTarget(renderer, renderTexture);
+  ++renderStats().renderTargets;
 
   // Clear the texture with transparency
   SDL_SetRenderDrawColor(renderer, 0, 0, 0, 0);
   SDL_RenderClear(renderer);
 
+  ++renderStats().rects;
   draw.drawRect(0, 0, textureWidth, textureHeight, props.bgColor);
 
   // Render background sprite if specified
@@ -212,6 +215,7 @@ void Quad::render(int dt) {
     params.scale = {1.0, 1.0};
     params.centered = false;
 
+    ++renderStats().sprites;
     draw.drawSprite(spriteData, params);
   }
 
@@ -219,6 +223,7 @@ void Quad::render(int dt) {
   auto bs = props.borderSize;
 
   if (bs > 0) {
+    renderStats().rects += 4;
     // Top border
     draw.drawRect(0, 0, textureWidth, bs, props.borderColor);
     // Bottom border
@@ -237,6 +242,7 @@ void Quad::render(int dt) {
 
   // Blit texture scaled to screen position
   SDL_Rect destRect = {style.x, style.y, scaledWidth, scaledHeight};
+  ++renderStats().sprites;
   SDL_RenderCopy(renderer, renderTexture, nullptr, &destRect);
 }
 
@@ -2,6 +2,7 @@
 #include "bmin/StringInterop.h"
 #include "sdl2w/Draw.h"
 #include "sdl2w/Logger.h"
+#include "ui/RenderStats.h"
 
 namespace ui {
 
@@ -59,6 +60,7 @@ void SpriteElement::render(int dt) {
   params.scale = {style.scale, style.scale};
   params.centered = false;
 
+  ++renderStats().sprites;
   draw.drawSprite(sprite, params);
 }
 
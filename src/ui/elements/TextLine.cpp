@@ -1,9 +1,10 @@
 #include "TextLine.h"
 #include "bmin/StringInterop.h"
-#include "bmin/UniquePtr.h"
 #include "sdl2w/Draw.h"
 #include "state/StateManager.h"
 #include "ui/FontScale.h"
+#include "ui/GlyphAtlas.h"
+#include "ui/TextTextureCache.h"
 #include "ui/UiElement.h"
 
 namespace ui {
@@ -30,21 +31,20 @@ bmin::String TextLine::getFontNameFromFamily(FontFamily fontFamily) {
   return fontName;
 }
 
-sdl2w::RenderTextParams TextLine::makeRenderTextParams(const TextBlock& block) const {
+int TextLine::getCurrentFontScale() {
+  auto* stateManager = getStateManager();
+  if (!stateManager) {
+    // Some isolated UI tests do not initialize a StateManager.
+    return 0;
+  }
+  return stateManager->getState().settings.fontScale;
+}
+
+sdl2w::RenderTextParams TextLine::makeRenderTextParams(const TextBlock& block,
+                                                       int fontScale) const {
   auto fontFamily = block.fontFamily.value_or(props.fontFamily);
   auto baseFontSize = block.fontSize.value_or(props.fontSize);
   auto fontColor = block.fontColor.value_or(props.fontColor);
-  int fontScale = 0;
-  try {
-    auto stateManager = getStateManager();
-    if (!stateManager) {
-      throw std::runtime_error("StateManager not set");
-    }
-    fontScale = getStateManager()->getState().settings.fontScale;
-  } catch (...) {
-    // Some isolated UI tests do not initialize a StateManager.
-    fontScale = 0;
-  }
 
   sdl2w::RenderTextParams params;
   params.fontName = getFontNameFromFamily(fontFamily);
@@ -56,10 +56,14 @@ sdl2w::RenderTextParams TextLine::makeRenderTextParams(const TextBlock& block) c
 
 void TextLine::setProps(const TextLineProps& _props) {
   props = _props;
+  layoutDirty = true;
   build();
 }
 
-TextLineProps& TextLine::getProps() { return props; }
+TextLineProps& TextLine::getProps() {
+  layoutDirty = true;
+  return props;
+}
 
 const TextLineProps& TextLine::getProps() const { return props; }
 
@@ -78,14 +82,17 @@ std::pair<int, int> TextLine::calculateTextDims() const {
     return {0, 0};
   }
 
-  auto& draw = window->getDraw();
+  auto& glyphAtlases = GlyphAtlasCache::get();
+  const int fontScale = getCurrentFontScale();
   int totalWidth = 0;
   int totalHeight = 0;
 
   for (const auto& block : props.textBlocks) {
     const bmin::String& measureStr = block.text.empty() ? bmin::String(" ") : block.text;
     auto [textWidth, textHeight] =
-        draw.measureText(bmin::toStringView(measureStr), makeRenderTextParams(block));
+        glyphAtlases.measureText(*window,
+                                 bmin::toStringView(measureStr),
+                                 makeRenderTextParams(block, fontScale));
     if (!block.text.empty()) {
       totalWidth += textWidth;
     }
@@ -96,46 +103,76 @@ std::pair<int, int> TextLine::calculateTextDims() const {
 }
 
 const std::pair<int, int> TextLine::getDims() const {
-  auto [width, height] = calculateTextDims();
-  return {static_cast<int>(width * style.scale), static_cast<int>(height * style.scale)};
+  if (layoutDirty || layoutFontScale != getCurrentFontScale()) {
+    auto [width, height] = calculateTextDims();
+    return {static_cast<int>(width * style.scale),
+            static_cast<int>(height * style.scale)};
+  }
+  return {static_cast<int>(style.width * style.scale),
+          static_cast<int>(style.height * style.scale)};
 }
 
-void TextLine::build() {
+void TextLine::layoutText(int fontScale) {
+  TextTextureCache::get().syncFontScale(window->getStore(), fontScale);
   textRenderables.clear();
 
-  auto [totalWidth, totalHeight] = calculateTextDims();
-  style.width = totalWidth;
-  style.height = totalHeight;
-
-  auto currentX = static_cast<int>(style.x * style.scale);
-  auto currentY = static_cast<int>(style.y * style.scale);
+  auto& glyphAtlases = GlyphAtlasCache::get();
+  int totalWidth = 0;
+  int totalHeight = 0;
 
   for (const auto& block : props.textBlocks) {
+    auto renderTextParams = makeRenderTextParams(block, fontScale);
     if (block.text.empty()) {
-      // Blank line: reserve vertical space via calculateTextDims(), nothing to draw.
+      // Blank line: reserve vertical space, nothing to draw.
+      const auto blankDims = glyphAtlases.measureText(*window, " ", renderTextParams);
+      totalHeight = std::max(totalHeight, blankDims.second);
       continue;
     }
 
-    auto renderTextParams = makeRenderTextParams(block);
-    auto [textWidth, textHeight] =
-        window->getDraw().measureText(bmin::toStringView(block.text), renderTextParams);
-    textHeight += 2; // HACK: Measure text doesn't seem accurate per height, so this will
-                     // need overrides...
-
-    auto tlParams = bmin::makeUnique<TextLineRenderTextParams>();
-    tlParams->text = block.text;
-    renderTextParams.x = currentX;
-    renderTextParams.y = currentY;
+    auto [textWidth, textHeight] = glyphAtlases.measureText(
+        *window, bmin::toStringView(block.text), renderTextParams);
+    totalWidth += textWidth;
+    totalHeight = std::max(totalHeight, textHeight);
+
+    TextLineRenderTextParams renderable;
+    renderable.text = block.text;
+    renderable.params = renderTextParams;
+    renderable.textWidth = textWidth;
+    // HACK: Measure text doesn't seem accurate per height, so this will need
+    // overrides...
+    renderable.textHeight = textHeight + 2;
+    textRenderables.pushBack(std::move(renderable));
+  }
+
+  style.width = totalWidth;
+  style.height = totalHeight;
+  layoutFontScale = fontScale;
+  layoutDirty = false;
+}
+
+void TextLine::positionText() {
+  auto currentX = static_cast<int>(style.x * style.scale);
+  auto currentY = static_cast<int>(style.y * style.scale);
+
+  for (auto& renderable : textRenderables) {
+    const int textHeight = renderable.textHeight;
+    renderable.params.x = currentX;
+    renderable.params.y = currentY;
     if (props.textAlign == TextAlign::LEFT_CENTER) {
-      renderTextParams.y -= static_cast<int>((textHeight / 2.0) * style.scale);
+      renderable.params.y -= static_cast<int>((textHeight / 2.0) * style.scale);
     } else if (props.textAlign == TextAlign::LEFT_BOTTOM) {
-      renderTextParams.y -= static_cast<int>(textHeight * style.scale);
+      renderable.params.y -= static_cast<int>(textHeight * style.scale);
     }
-    tlParams->params = renderTextParams;
-    textRenderables.pushBack(std::move(tlParams));
+    currentX += static_cast<int>(renderable.textWidth * style.scale);
+  }
+}
 
-    currentX += static_cast<int>(textWidth * style.scale);
+void TextLine::build() {
+  const int fontScale = getCurrentFontScale();
+  if (layoutDirty || fontScale != layoutFontScale) {
+    layoutText(fontScale);
   }
+  positionText();
 }
 
 void TextLine::render(int dt) {
@@ -143,10 +180,10 @@ void TextLine::render(int dt) {
     return;
   }
 
-  auto& draw = window->getDraw();
+  auto& textCache = TextTextureCache::get();
 
   for (const auto& rtParams : textRenderables) {
-    draw.drawText(bmin::toStringView(rtParams->text), rtParams->params);
+    textCache.drawText(*window, bmin::toStringView(rtParams.text), rtParams.params);
   }
 }
 
@@ -31,15 +31,24 @@ struct TextLineProps {
 struct TextLineRenderTextParams {
   bmin::String text;
   sdl2w::RenderTextParams params;
+  int textWidth = 0;
+  int textHeight = 0;
 };
 
 // TextLine element - renders a stylized line of text
+// Measurement is cached until props or the user font scale change, so setPos /
+// setScale only re-bake positions.
 class TextLine : public UiElement {
 private:
   TextLineProps props;
-  bmin::DynArray<bmin::UniquePtr<TextLineRenderTextParams>> textRenderables;
+  bmin::DynArray<TextLineRenderTextParams> textRenderables;
+  bool layoutDirty = true;
+  int layoutFontScale = 0;
 
-  sdl2w::RenderTextParams makeRenderTextParams(const TextBlock& block) const;
+  sdl2w::RenderTextParams makeRenderTextParams(const TextBlock& block,
+                                               int fontScale) const;
+  void layoutText(int fontScale);
+  void positionText();
 
 public:
   TextLine(sdl2w::Window* _window, UiElement* _parent = nullptr);
@@ -47,8 +56,11 @@ public:
 
   // Static utility method to convert FontFamily to font name
   static bmin::String getFontNameFromFamily(FontFamily fontFamily);
+  // settings.fontScale, or 0 when no StateManager is set (isolated UI tests).
+  static int getCurrentFontScale();
 
   void setProps(const TextLineProps& _props);
+  // Mutable access invalidates the cached measurement; call build() afterwards.
   TextLineProps& getProps();
   const TextLineProps& getProps() const;
 
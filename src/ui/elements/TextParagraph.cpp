@@ -1,8 +1,8 @@
 #include "TextParagraph.h"
-#include "state/StateManager.h"
 #include "Quad.h"
 #include "sdl2w/Draw.h"
 #include "ui/FontScale.h"
+#include "ui/GlyphAtlas.h"
 #include <algorithm>
 #include "bmin/StringInterop.h"
 #include "bmin/UniquePtr.h"
@@ -11,11 +11,13 @@ namespace ui {
 
 namespace {
 
-std::pair<int, int> measureLine(sdl2w::Draw& draw,
+// Glyph-table measurement: a sum of cached advances instead of SDL_ttf shaping, so
+// re-wrapping long dialogue stays cheap.
+std::pair<int, int> measureLine(sdl2w::Window& window,
                                 const bmin::String& lineText,
                                 const sdl2w::RenderTextParams& params) {
   const bmin::String& sample = lineText.empty() ? bmin::String(" ") : lineText;
-  return draw.measureText(bmin::toStringView(sample), params);
+  return GlyphAtlasCache::get().measureText(window, bmin::toStringView(sample), params);
 }
 
 // Blank lines already store their gap height; content lines scale only the advance
@@ -37,21 +39,35 @@ TextParagraph::TextParagraph(sdl2w::Window* _window, UiElement* _parent)
 
 void TextParagraph::setProps(const TextParagraphProps& _props) {
   props = _props;
+  layoutDirty = true;
   build();
 }
 
-TextParagraphProps& TextParagraph::getProps() { return props; }
+TextParagraphProps& TextParagraph::getProps() {
+  layoutDirty = true;
+  return props;
+}
 
 const TextParagraphProps& TextParagraph::getProps() const { return props; }
 
 void TextParagraph::setPos(int x, int y) {
   UiElement::setPos(x, y);
-  build();
+  if (layoutDirty || TextLine::getCurrentFontScale() != layoutFontScale) {
+    build();
+    return;
+  }
+  // TextLines live in quad-local coordinates, so a move never re-wraps.
+  quad->setPos(style.x, style.y);
 }
 
 void TextParagraph::setScale(float scale) {
   UiElement::setScale(scale);
-  build();
+  if (layoutDirty || TextLine::getCurrentFontScale() != layoutFontScale) {
+    build();
+    return;
+  }
+  // The quad's render target stays at logical size; scale applies on blit.
+  quad->setScale(style.scale);
 }
 
 size_t TextParagraph::getNumLines() const {
@@ -120,21 +136,8 @@ const std::pair<int, int> TextParagraph::getDims() const {
           static_cast<int>(logicalH * style.scale)};
 }
 
-void TextParagraph::build() {
+void TextParagraph::wrapText(int fontScale) {
   generatedBlocks.clear();
-  style.width = props.width;
-  auto& draw = window->getDraw();
-  int fontScale = 0;
-  try {
-    auto stateManager = getStateManager();
-    if (!stateManager) {
-      throw std::runtime_error("StateManager not set");
-    }
-    fontScale = stateManager->getState().settings.fontScale;
-  } catch (...) {
-    // Some isolated UI tests do not initialize a StateManager.
-    fontScale = 0;
-  }
 
   int lineNumber = 0;
   int currentLineWidth = 0;
@@ -148,7 +151,7 @@ void TextParagraph::build() {
                          bool endLine,
                          bool emitEmptyIfNoSegment) {
     if (!segmentText.empty()) {
-      auto [textWidth, textHeight] = measureLine(draw, segmentText, params);
+      auto [textWidth, textHeight] = measureLine(*window, segmentText, params);
       // Store full glyph height; lineHeightScale is applied when advancing lines.
       generatedBlocks.pushBack(TextParagraphGeneratedBlock{
           lineNumber,
@@ -159,7 +162,7 @@ void TextParagraph::build() {
       segmentText.clear();
     } else if (emitEmptyIfNoSegment && currentLineWidth == 0) {
       // Blank line from a double line-break (`\n\n`): scaled paragraph gap.
-      auto [textWidth, textHeight] = measureLine(draw, segmentText, params);
+      auto [textWidth, textHeight] = measureLine(*window, segmentText, params);
       (void)textWidth;
       const int blankLineHeight = std::max(
           0, static_cast<int>(textHeight * props.blankLineHeightScale));
@@ -179,7 +182,7 @@ void TextParagraph::build() {
     if (text.empty()) {
       return;
     }
-    auto [pieceWidth, pieceHeight] = measureLine(draw, text, params);
+    auto [pieceWidth, pieceHeight] = measureLine(*window, text, params);
     (void)pieceHeight;
 
     if (currentLineWidth > 0 && currentLineWidth + pieceWidth >= style.width) {
@@ -254,88 +257,88 @@ void TextParagraph::build() {
       emitSegment(block, params, false, false);
     }
   }
+}
 
-  while (!quad->getChildren().empty()) {
-    quad->removeChildAtIndex(0);
-  }
-
-  // Create TextLine children inside the quad (texture-local coordinates)
-  if (!generatedBlocks.empty()) {
-    auto currentLineNumber = -1;
-    bmin::DynArray<TextBlock> currentLineBlocks;
-    auto currentY = props.padding;
-    int currentLineMaxHeight = 0;
-    bool currentLineIsBlank = true;
-
-    auto flushLine = [&]() {
-      if (currentLineBlocks.empty()) {
-        return;
-      }
-
-      auto textLine = new TextLine(window, quad.get());
-      textLine->setPos(props.padding, currentY);
-      textLine->setScale(1.f);
-
-      TextLineProps lineProps;
-      lineProps.textBlocks = currentLineBlocks;
-      lineProps.fontFamily =
-          currentLineBlocks[0].fontFamily.value_or(props.fontFamily);
-      lineProps.fontSize = currentLineBlocks[0].fontSize.value_or(props.fontSize);
-      lineProps.fontColor = currentLineBlocks[0].fontColor.value_or(props.fontColor);
-      lineProps.textAlign = props.textAlign;
-      textLine->setProps(lineProps);
-
+void TextParagraph::syncTextLines() {
+  // Existing TextLines are re-targeted in place; only the difference in line count
+  // is allocated or destroyed.
+  auto& lines = quad->getChildren();
+  size_t lineIndex = 0;
+  auto currentY = props.padding;
+  int currentLineNumber = -1;
+  int currentLineMaxHeight = 0;
+  bool currentLineIsBlank = true;
+  bmin::DynArray<TextBlock> currentLineBlocks;
+
+  auto placeLine = [&]() {
+    TextLine* textLine = nullptr;
+    if (lineIndex < lines.size()) {
+      // The quad is private to this paragraph and only ever holds TextLines.
+      textLine = static_cast<TextLine*>(lines[lineIndex].get());
+    } else {
+      textLine = new TextLine(window, quad.get());
       quad->addChild(textLine);
-      currentLineBlocks.clear();
-
-      currentY += lineBoxAdvance(currentLineMaxHeight,
-                                 currentLineIsBlank,
-                                 props.lineHeightScale) +
-                  props.lineSpacing;
-      currentLineMaxHeight = 0;
-      currentLineIsBlank = true;
-    };
-
-    for (const auto& genBlock : generatedBlocks) {
-      if (genBlock.lineNumber != currentLineNumber) {
-        if (currentLineNumber >= 0) {
-          flushLine();
-        }
-        currentLineNumber = genBlock.lineNumber;
-      }
+    }
+    lineIndex++;
+    textLine->setPos(props.padding, currentY);
+    textLine->setScale(1.f);
+
+    TextLineProps lineProps;
+    lineProps.fontFamily = currentLineBlocks[0].fontFamily.value_or(props.fontFamily);
+    lineProps.fontSize = currentLineBlocks[0].fontSize.value_or(props.fontSize);
+    lineProps.fontColor = currentLineBlocks[0].fontColor.value_or(props.fontColor);
+    lineProps.textAlign = props.textAlign;
+    lineProps.textBlocks = std::move(currentLineBlocks);
+    textLine->setProps(lineProps);
+    currentLineBlocks.clear();
+  };
 
-      currentLineMaxHeight = std::max(currentLineMaxHeight, genBlock.textHeight);
-      if (!genBlock.text.empty()) {
-        currentLineIsBlank = false;
+  for (const auto& genBlock : generatedBlocks) {
+    if (genBlock.lineNumber != currentLineNumber) {
+      if (currentLineNumber >= 0) {
+        placeLine();
+        currentY += lineBoxAdvance(currentLineMaxHeight,
+                                   currentLineIsBlank,
+                                   props.lineHeightScale) +
+                    props.lineSpacing;
+        currentLineMaxHeight = 0;
+        currentLineIsBlank = true;
       }
+      currentLineNumber = genBlock.lineNumber;
+    }
 
-      TextBlock textBlock;
-      textBlock.text = genBlock.text;
-      textBlock.fontFamily = genBlock.textBlock.fontFamily.value_or(props.fontFamily);
-      textBlock.fontSize = genBlock.textBlock.fontSize.value_or(props.fontSize);
-      textBlock.fontColor = genBlock.textBlock.fontColor.value_or(props.fontColor);
-      currentLineBlocks.pushBack(textBlock);
+    currentLineMaxHeight = std::max(currentLineMaxHeight, genBlock.textHeight);
+    if (!genBlock.text.empty()) {
+      currentLineIsBlank = false;
     }
 
-    if (!currentLineBlocks.empty()) {
-      const auto& lastGenBlock = generatedBlocks.back();
-      // Last line: place glyphs but do not advance — container height comes from
-      // getContentHeight(), which reserves full glyph bounds for descenders.
-      auto textLine = new TextLine(window, quad.get());
-      textLine->setPos(props.padding, currentY);
-      textLine->setScale(1.f);
-
-      TextLineProps lineProps;
-      lineProps.textBlocks = currentLineBlocks;
-      lineProps.fontFamily =
-          lastGenBlock.textBlock.fontFamily.value_or(props.fontFamily);
-      lineProps.fontSize = lastGenBlock.textBlock.fontSize.value_or(props.fontSize);
-      lineProps.fontColor = lastGenBlock.textBlock.fontColor.value_or(props.fontColor);
-      lineProps.textAlign = props.textAlign;
-      textLine->setProps(lineProps);
+    TextBlock textBlock;
+    textBlock.text = genBlock.text;
+    textBlock.fontFamily = genBlock.textBlock.fontFamily.value_or(props.fontFamily);
+    textBlock.fontSize = genBlock.textBlock.fontSize.value_or(props.fontSize);
+    textBlock.fontColor = genBlock.textBlock.fontColor.value_or(props.fontColor);
+    currentLineBlocks.pushBack(textBlock);
+  }
 
-      quad->addChild(textLine);
-    }
+  // Last line: place glyphs but do not advance — container height comes from
+  // getContentHeight(), which reserves full glyph bounds for descenders.
+  if (!currentLineBlocks.empty()) {
+    placeLine();
+  }
+
+  while (lines.size() > lineIndex) {
+    quad->removeChildAtIndex(lines.size() - 1);
+  }
+}
+
+void TextParagraph::build() {
+  style.width = props.width;
+  const int fontScale = TextLine::getCurrentFontScale();
+  if (layoutDirty || fontScale != layoutFontScale) {
+    wrapText(fontScale);
+    syncTextLines();
+    layoutFontScale = fontScale;
+    layoutDirty = false;
   }
 
   const int contentHeight = getContentHeight();
@@ -40,19 +40,26 @@ struct TextParagraphGeneratedBlock {
 };
 
 // TextParagraph element - lays out wrapped text into TextLines rendered via an internal Quad
+// Line breaking is cached: it only reruns when props or the user font scale change.
+// setPos / setScale just move the quad, which keeps scrolling and layout passes cheap.
 class TextParagraph : public UiElement {
 private:
   TextParagraphProps props;
   bmin::DynArray<TextParagraphGeneratedBlock> generatedBlocks;
   bmin::UniquePtr<Quad> quad;
+  bool layoutDirty = true;
+  int layoutFontScale = 0;
 
   int getContentHeight() const;
+  void wrapText(int fontScale);
+  void syncTextLines();
 
 public:
   TextParagraph(sdl2w::Window* _window, UiElement* _parent = nullptr);
   ~TextParagraph() override = default;
 
   void setProps(const TextParagraphProps& _props);
+  // Mutable access invalidates the cached layout; call build() afterwards.
   TextParagraphProps& getProps();
   const TextParagraphProps& getProps() const;
   size_t getNumLines() const;
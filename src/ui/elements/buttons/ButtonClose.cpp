@@ -1,4 +1,5 @@
 #include "ButtonClose.h"
+#include "ui/RenderStats.h"
 #include "ui/colors.h"
 #include "ui/elements/OutsetRectangle.h"
 
@@ -99,6 +100,7 @@ void ButtonClose::render(int dt) {
   }
 
   auto& draw = window->getDraw();
+  renderStats().lines += 2;
   draw.drawLine({centerX - scaledLength / 2, centerY - scaledLength / 2},
                 {centerX + scaledLength / 2, centerY + scaledLength / 2},
                 style.scale,
@@ -1,5 +1,6 @@
 #include "ButtonList.h"
 #include "../TextLine.h"
+#include "ui/RenderStats.h"
 #include "ui/elements/OutsetRectangle.h"
 #include <algorithm>
 
@@ -103,6 +104,7 @@ void ButtonList::render(int dt) {
     auto scaledHeight = static_cast<int>(style.height * style.scale);
     int borderSize = 2;
 
+    ++renderStats().rects;
     draw.drawRect(style.x - borderSize,
                   style.y - borderSize,
                   scaledWidth + borderSize * 2,
@@ -129,6 +131,7 @@ void ButtonList::render(int dt) {
 
   auto& draw = window->getDraw();
   if (*props.arrow == ScrollDirection::UP) {
+    renderStats().lines += 3;
     draw.drawLine({centerX - arrowLength, centerY},
                   {centerX, centerY - arrowLength},
                   style.scale,
@@ -142,6 +145,7 @@ void ButtonList::render(int dt) {
                   style.scale,
                   props.arrowColor);
   } else if (*props.arrow == ScrollDirection::DOWN) {
+    renderStats().lines += 3;
     draw.drawLine({centerX - arrowLength, centerY},
                   {centerX, centerY + arrowLength},
                   style.scale,
@@ -1,5 +1,6 @@
 #include "ButtonModal.h"
 #include "../TextLine.h"
+#include "ui/RenderStats.h"
 #include "ui/elements/OutsetRectangle.h"
 
 namespace ui {
@@ -96,6 +97,7 @@ void ButtonModal::render(int dt) {
     auto scaledHeight = static_cast<int>(style.height * style.scale);
     int borderSize = 2;
 
+    ++renderStats().rects;
     draw.drawRect(style.x - borderSize,
                   style.y - borderSize,
                   scaledWidth + borderSize * 2,
@@ -108,6 +110,7 @@ void ButtonModal::render(int dt) {
     auto& draw = window->getDraw();
     auto scaledWidth = static_cast<int>(style.width * style.scale);
     auto scaledHeight = static_cast<int>(style.height * style.scale);
+    ++renderStats().rects;
     draw.drawRect(style.x, style.y, scaledWidth, scaledHeight, SDL_Color{0, 0, 0, 25});
   }
 }
@@ -1,4 +1,5 @@
 #include "ButtonScroll.h"
+#include "ui/RenderStats.h"
 #include "ui/colors.h"
 #include "ui/elements/OutsetRectangle.h"
 #include <algorithm>
@@ -93,6 +94,7 @@ void ButtonScroll::render(int dt) {
     auto scaledHeight = static_cast<int>(style.height * style.scale);
     int borderSize = 2;
 
+    ++renderStats().rects;
     draw.drawRect(style.x - borderSize,
                   style.y - borderSize,
                   scaledWidth + borderSize * 2,
@@ -114,6 +116,7 @@ void ButtonScroll::render(int dt) {
 
   if (props.direction == ScrollDirection::UP) {
     auto& draw = window->getDraw();
+    renderStats().lines += 3;
     draw.drawLine({centerX - arrowLength, centerY},
                   {centerX, centerY - arrowLength},
                   style.scale,
@@ -128,6 +131,7 @@ void ButtonScroll::render(int dt) {
                   Colors::White);
   } else if (props.direction == ScrollDirection::DOWN) {
     auto& draw = window->getDraw();
+    renderStats().lines += 3;
     draw.drawLine({centerX - arrowLength, centerY},
                   {centerX, centerY + arrowLength},
                   style.scale,
@@ -142,6 +146,7 @@ void ButtonScroll::render(int dt) {
                   Colors::White);
   } else if (props.direction == ScrollDirection::LEFT) {
     auto& draw = window->getDraw();
+    renderStats().lines += 3;
     draw.drawLine({centerX, centerY - arrowLength},
                   {centerX - arrowLength, centerY},
                   style.scale,
@@ -156,6 +161,7 @@ void ButtonScroll::render(int dt) {
                   Colors::White);
   } else if (props.direction == ScrollDirection::RIGHT) {
     auto& draw = window->getDraw();
+    renderStats().lines += 3;
     draw.drawLine({centerX, centerY - arrowLength},
                   {centerX + arrowLength, centerY},
                   style.scale,
@@ -1,4 +1,5 @@
 #include "ButtonTextWrap.h"
+#include "ui/RenderStats.h"
 #include "ui/colors.h"
 #include <cmath>
 
@@ -66,6 +67,7 @@ void ButtonTextWrap::render(int dt) {
   auto& draw = window->getDraw();
   auto dims = getDims();
   int borderSize = 0;
+  ++renderStats().rects;
   draw.drawRect(style.x - borderSize,
                 style.y - borderSize,
                 dims.first + borderSize * 2,
@@ -1,6 +1,7 @@
 #include "ModalSmall.h"
 #include "bmin/StringInterop.h"
 #include "sdl2w/Draw.h"
+#include "ui/RenderStats.h"
 #include "ui/components/borders/BorderModalSmall.h"
 #include "ui/elements/Quad.h"
 #include "ui/elements/buttons/ButtonClose.h"
@@ -166,6 +167,7 @@ void ModalSmall::build() {
 
 void ModalSmall::render(int dt) {
   auto& draw = window->getDraw();
+  ++renderStats().rects;
   draw.drawRect(style.x, style.y, style.width, style.height, props.backgroundColor);
   UiElement::render(dt);
 }
@@ -373,8 +373,9 @@ void PageCharacter::build() {
   TextBlock titleBlock;
   if (props.characterPlayer && !props.characterPlayer->name.empty()) {
     titleBlock.text = props.characterPlayer->name;
-  } else if (props.characterPlayer && !props.characterPlayer->params.label.empty()) {
-    titleBlock.text = props.characterPlayer->params.label;
+  } else if (props.characterPlayer &&
+             !model::characterPlayerGetParams(*props.characterPlayer).label.empty()) {
+    titleBlock.text = model::characterPlayerGetParams(*props.characterPlayer).label;
   } else {
     titleBlock.text = "Character";
   }
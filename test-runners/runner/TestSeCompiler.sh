@@ -0,0 +1,4 @@
+#!/bin/bash
+SCRIPT_DIR=$(dirname "$0")
+node "$SCRIPT_DIR/../TestRunnerHelper.js" runner . TestSeCompiler "$@"
+
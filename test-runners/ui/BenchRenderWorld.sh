@@ -0,0 +1,3 @@
+#!/bin/bash
+SCRIPT_DIR=$(dirname "$0")
+node "$SCRIPT_DIR/../UiTestRunnerHelper.js" bench BenchRenderWorld "$@"